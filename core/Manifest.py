@@ -1,5 +1,6 @@
 files = [
     "tdc_controller.vhd",  "tdc_freqc.vhd",     "tdc_psync.vhd",
     "tdc_channelbank.vhd", "tdc_delayline.vhd", "tdc_lbc.vhd",     "tdc_ringosc.vhd",
-    "tdc_channel.vhd",     "tdc_divider.vhd",   "tdc_package.vhd", "tdc.vhd"
+    "tdc_channel.vhd",     "tdc_divider.vhd",   "tdc_package.vhd", "tdc.vhd",
+    "tdc_hisbook.vhd"
 ];
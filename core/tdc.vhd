@@ -12,6 +12,10 @@
 --
 -------------------------------------------------------------------------------
 -- last changes:
+-- 2026-10-18 agent Added epoch counter
+-- 2026-10-18 agent Added scaled online calibration
+-- 2026-10-18 agent Double-buffered LUT
+-- 2026-10-18 agent Added concurrent startup calibration
 -- 2011-11-05 SB Added extra histogram bits support
 -- 2011-08-17 SB Created file
 -------------------------------------------------------------------------------
@@ -51,12 +55,19 @@ entity tdc is
         g_EXHIS_COUNT    : positive := 4;
         -- Number of coarse counter bits.
         g_COARSE_COUNT   : positive := 25;
+        -- Number of epoch counter bits, extending the coarse counter.
+        g_EPOCH_COUNT    : natural := 0;
         -- Length of each ring oscillator.
         g_RO_LENGTH      : positive := 31;
         -- Frequency counter width.
         g_FCOUNTER_WIDTH : positive := 13;
         -- Frequency counter timer width.
-        g_FTIMER_WIDTH   : positive := 14
+        g_FTIMER_WIDTH   : positive := 14;
+        -- Book the startup calibration histograms of all channels at once.
+        g_CONCURRENT_SC  : boolean := false;
+        -- Scale the LUT outputs instead of rewriting the LUTs during online
+        -- calibration.
+        g_SCALED_OC      : boolean := false
     );
     port(
         clk_i        : in std_logic;
@@ -68,7 +79,7 @@ entity tdc is
         cc_cy_o      : out std_logic;
         
         -- Per-channel deskew inputs.
-        deskew_i     : in std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+        deskew_i     : in std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
         
         -- Per-channel signal inputs.
         signal_i     : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
@@ -78,7 +89,7 @@ entity tdc is
         detect_o     : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         polarity_o   : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         raw_o        : out std_logic_vector(g_CHANNEL_COUNT*g_RAW_COUNT-1 downto 0);
-        fp_o         : out std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+        fp_o         : out std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
         
         -- Debug interface.
         freeze_req_i : in std_logic;
@@ -98,6 +109,10 @@ entity tdc is
 end entity;
 
 architecture rtl of tdc is
+-- concurrent startup calibration needs the partitioned histogram memory of
+-- the multi-channel bank
+constant c_CONCURRENT_SC : boolean := g_CONCURRENT_SC and (g_CHANNEL_COUNT > 1);
+
 signal cs_next     : std_logic;
 signal cs_next_c   : std_logic;
 signal cs_last     : std_logic;
@@ -109,6 +124,10 @@ signal lut_a_c     : std_logic_vector(g_RAW_COUNT-1 downto 0);
 signal lut_we      : std_logic;
 signal lut_d_w     : std_logic_vector(g_FP_COUNT-1 downto 0);
 signal lut_d_r     : std_logic_vector(g_FP_COUNT-1 downto 0);
+signal lut_shadow  : std_logic;
+signal lut_swap    : std_logic;
+signal scale_we    : std_logic;
+signal scale_d     : std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
 
 signal c_detect    : std_logic;
 signal c_raw       : std_logic_vector(g_RAW_COUNT-1 downto 0);
@@ -117,6 +136,9 @@ signal his_a_c     : std_logic_vector(g_RAW_COUNT-1 downto 0);
 signal his_we      : std_logic;
 signal his_d_w     : std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
 signal his_d_r     : std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+signal sc_all      : std_logic;
+signal sc_book     : std_logic;
+signal sc_done     : std_logic;
 
 signal oc_start    : std_logic;
 signal oc_start_c  : std_logic;
@@ -135,9 +157,12 @@ begin
             g_FP_COUNT       => g_FP_COUNT,
             g_EXHIS_COUNT    => g_EXHIS_COUNT,
             g_COARSE_COUNT   => g_COARSE_COUNT,
+            g_EPOCH_COUNT    => g_EPOCH_COUNT,
             g_RO_LENGTH      => g_RO_LENGTH,
             g_FCOUNTER_WIDTH => g_FCOUNTER_WIDTH,
-            g_FTIMER_WIDTH   => g_FTIMER_WIDTH
+            g_FTIMER_WIDTH   => g_FTIMER_WIDTH,
+            g_CONCURRENT_SC  => c_CONCURRENT_SC,
+            g_SCALED_OC      => g_SCALED_OC
         )
         port map(
             clk_i        => clk_i,
@@ -163,6 +188,10 @@ begin
             lut_we_i     => lut_we,
             lut_d_i      => lut_d_w,
             lut_d_o      => lut_d_r,
+            lut_shadow_i => lut_shadow,
+            lut_swap_i   => lut_swap,
+            scale_we_i   => scale_we,
+            scale_d_i    => scale_d,
             
             c_detect_o   => c_detect,
             c_raw_o      => c_raw,
@@ -170,6 +199,9 @@ begin
             his_we_i     => his_we,
             his_d_i      => his_d_w,
             his_d_o      => his_d_r,
+            sc_all_i     => sc_all,
+            sc_book_i    => sc_book,
+            sc_done_o    => sc_done,
 
             oc_start_i   => oc_start,
             oc_ready_o   => oc_ready,
@@ -183,7 +215,9 @@ begin
             g_RAW_COUNT      => g_RAW_COUNT,
             g_FP_COUNT       => g_FP_COUNT,
             g_EXHIS_COUNT    => g_EXHIS_COUNT,
-            g_FCOUNTER_WIDTH => g_FCOUNTER_WIDTH
+            g_FCOUNTER_WIDTH => g_FCOUNTER_WIDTH,
+            g_CONCURRENT_SC  => c_CONCURRENT_SC,
+            g_SCALED_OC      => g_SCALED_OC
         )
         port map(
             clk_i       => clk_i,
@@ -197,6 +231,10 @@ begin
             lut_a_o     => lut_a_c,
             lut_we_o    => lut_we,
             lut_d_o     => lut_d_w,
+            lut_shadow_o => lut_shadow,
+            lut_swap_o  => lut_swap,
+            scale_we_o  => scale_we,
+            scale_d_o   => scale_d,
             
             c_detect_i  => c_detect,
             c_raw_i     => c_raw,
@@ -204,6 +242,9 @@ begin
             his_we_o    => his_we,
             his_d_o     => his_d_w,
             his_d_i     => his_d_r,
+            sc_all_o    => sc_all,
+            sc_book_o   => sc_book,
+            sc_done_i   => sc_done,
 
             oc_start_o  => oc_start_c,
             oc_ready_i  => oc_ready,
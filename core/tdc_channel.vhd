@@ -12,6 +12,9 @@
 --
 -------------------------------------------------------------------------------
 -- last changes:
+-- 2026-10-18 agent Added scaled online calibration
+-- 2026-10-18 agent Double-buffered LUT
+-- 2026-10-18 agent Per-channel tap ordering
 -- 2011-11-07 SB Pre-inversion
 -- 2011-10-25 SB Disable ring oscillator on reset
 -- 2011-08-03 SB Created file
@@ -32,9 +35,20 @@
 -- This contains the elements needed for each channel:
 --  * Delay line
 --  * Encoder
---  * LUT
+--  * LUT (double-buffered)
 --  * Deskew stage
 --  * Online calibration ring oscillator
+--
+-- The LUT memory holds two banks. Hits are converted with the active bank.
+-- The LUT access port reaches the active bank, or the shadow bank when
+-- lut_shadow_i is asserted, and lut_swap_i exchanges the two banks. Because
+-- each conversion reads the LUT once, it sees either the old or the new
+-- contents, never a mix of both.
+--
+-- With g_SCALED_OC, the LUT output is multiplied by the value R of a scale
+-- register, loaded through scale_we_i and scale_d_i, and divided by 2^K with
+-- K = g_FP_COUNT+g_FCOUNTER_WIDTH before being used. The result saturates at
+-- 2^g_FP_COUNT-1. This adds one cycle of latency to all the outputs.
 
 library ieee;
 use ieee.std_logic_1164.all;
@@ -47,15 +61,21 @@ use work.genram_pkg.all;
 entity tdc_channel is
     generic(
         -- Number of CARRY4 elements.
-        g_CARRY4_COUNT : positive;
+        g_CARRY4_COUNT   : positive;
         -- Number of raw output bits.
-        g_RAW_COUNT    : positive;
+        g_RAW_COUNT      : positive;
         -- Number of fractional part bits.
-        g_FP_COUNT     : positive;
+        g_FP_COUNT       : positive;
         -- Number of coarse counter bits.
-        g_COARSE_COUNT : positive;
+        g_COARSE_COUNT   : positive;
         -- Length of the ring oscillator.
-        g_RO_LENGTH    : positive
+        g_RO_LENGTH      : positive;
+        -- Frequency counter width.
+        g_FCOUNTER_WIDTH : positive;
+        -- Scale the LUT output.
+        g_SCALED_OC      : boolean;
+        -- Channel number, selects the tap ordering.
+        g_CHANNEL        : natural := 0
     );
     port(
         clk_i        : in std_logic;
@@ -81,6 +101,12 @@ entity tdc_channel is
         lut_we_i    : in std_logic;
         lut_d_i     : in std_logic_vector(g_FP_COUNT-1 downto 0);
         lut_d_o     : out std_logic_vector(g_FP_COUNT-1 downto 0);
+        lut_shadow_i : in std_logic;
+        lut_swap_i  : in std_logic;
+        
+        -- LUT scale.
+        scale_we_i  : in std_logic;
+        scale_d_i   : in std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
 
         -- Calibration ring oscillator.
         ro_en_i     : in std_logic;
@@ -102,6 +128,13 @@ signal raw          : std_logic_vector(g_RAW_COUNT-1 downto 0);
 signal raw_d1       : std_logic_vector(g_RAW_COUNT-1 downto 0);
 signal raw_d2       : std_logic_vector(g_RAW_COUNT-1 downto 0);
 signal lut          : std_logic_vector(g_FP_COUNT-1 downto 0);
+signal lut_bank     : std_logic;
+signal lut_ra       : std_logic_vector(g_RAW_COUNT downto 0);
+signal lut_wa       : std_logic_vector(g_RAW_COUNT downto 0);
+signal detect       : std_logic;
+signal conv_detect  : std_logic;
+signal conv_coarse  : std_logic_vector(g_COARSE_COUNT-1 downto 0);
+signal conv_lut     : std_logic_vector(g_FP_COUNT-1 downto 0);
 signal ro_en        : std_logic;
 begin
     -- register calibration select signal to avoid glitches
@@ -117,7 +150,8 @@ begin
     
     cmp_delayline: tdc_delayline
         generic map(
-            g_WIDTH => g_CARRY4_COUNT
+            g_WIDTH   => g_CARRY4_COUNT,
+            g_CHANNEL => g_CHANNEL
         )
         port map(
              clk_i        => clk_i,
@@ -141,10 +175,23 @@ begin
              count_o      => raw
         );
     
+    process(clk_i)
+    begin
+        if rising_edge(clk_i) then
+            if reset_i = '1' then
+                lut_bank <= '0';
+            elsif lut_swap_i = '1' then
+                lut_bank <= not lut_bank;
+            end if;
+        end if;
+    end process;
+    lut_ra <= lut_bank & raw;
+    lut_wa <= (lut_bank xor lut_shadow_i) & lut_a_i;
+    
     cmp_lut: generic_dpram
         generic map(
             g_data_width               => g_FP_COUNT,
-            g_size                     => 2**g_RAW_COUNT,
+            g_size                     => 2**(g_RAW_COUNT+1),
             g_with_byte_enable         => false,
             g_addr_conflict_resolution => "read_first",
             g_init_file                => "",
@@ -156,13 +203,13 @@ begin
             
             wea_i  => '0',
             bwea_i => (others => '0'),
-            aa_i   => raw,
+            aa_i   => lut_ra,
             da_i   => (others => '0'),
             qa_o   => lut,
             
             web_i  => lut_we_i,
             bweb_i => (others => '0'),
-            ab_i   => lut_a_i,
+            ab_i   => lut_wa,
             db_i   => lut_d_i,
             qb_o   => lut_d_o
         );
@@ -183,13 +230,13 @@ begin
     begin
         if rising_edge(clk_i) then
             if reset_i = '1' then
-                detect_o <= '0';
+                detect <= '0';
                 polarity_d1 <= '1';
                 polarity_d2 <= '1';
                 raw_d1 <= (others => '0');
                 raw_d2 <= (others => '0');
             else
-                detect_o <= detect_d1;
+                detect <= detect_d1;
                 polarity_d1 <= polarity;
                 raw_d1 <= raw;
                 if detect_d1 = '1' then
@@ -199,8 +246,54 @@ begin
             end if;
         end if;
     end process;
-    polarity_o <= polarity_d2;
-    raw_o <= raw_d2;
+    
+    g_unscaled: if not g_SCALED_OC generate
+        detect_o <= detect;
+        polarity_o <= polarity_d2;
+        raw_o <= raw_d2;
+        conv_detect <= detect_d1;
+        conv_coarse <= coarse_i;
+        conv_lut <= lut;
+    end generate;
+    
+    g_scaled: if g_SCALED_OC generate
+        constant c_K     : positive := g_FP_COUNT+g_FCOUNTER_WIDTH;
+        signal scale     : std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
+        signal mul       : std_logic_vector(2*g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
+        signal mul_q     : std_logic_vector(g_FP_COUNT+g_FCOUNTER_WIDTH-1 downto 0);
+    begin
+        process(clk_i)
+        begin
+            if rising_edge(clk_i) then
+                if reset_i = '1' then
+                    scale <= std_logic_vector(shift_left(to_unsigned(1, scale'length), c_K));
+                    conv_detect <= '0';
+                    detect_o <= '0';
+                    polarity_o <= '1';
+                    raw_o <= (others => '0');
+                else
+                    if scale_we_i = '1' then
+                        scale <= scale_d_i;
+                    end if;
+                    conv_detect <= detect_d1;
+                    detect_o <= detect;
+                    polarity_o <= polarity_d2;
+                    raw_o <= raw_d2;
+                end if;
+                conv_coarse <= coarse_i;
+                mul <= std_logic_vector(unsigned(lut) * unsigned(scale));
+            end if;
+        end process;
+        mul_q <= mul(mul'high downto c_K);
+        process(mul_q)
+        begin
+            if mul_q(mul_q'high downto g_FP_COUNT) = (mul_q'high downto g_FP_COUNT => '0') then
+                conv_lut <= mul_q(g_FP_COUNT-1 downto 0);
+            else -- saturate
+                conv_lut <= (conv_lut'range => '1');
+            end if;
+        end process;
+    end generate;
     
     -- Combine coarse counter value and deskew.
     process(clk_i)
@@ -209,10 +302,10 @@ begin
             if reset_i = '1' then
                 fp_o <= (others => '0');
             else
-                if detect_d1 = '1' then
+                if conv_detect = '1' then
                     fp_o <= std_logic_vector(
-                        unsigned(coarse_i & (lut'range => '0'))
-                        - unsigned(lut)
+                        unsigned(conv_coarse & (conv_lut'range => '0'))
+                        - unsigned(conv_lut)
                         + unsigned(deskew_i));
                 end if;
             end if;
@@ -12,6 +12,10 @@
 --
 -------------------------------------------------------------------------------
 -- last changes:
+-- 2026-10-18 agent Added epoch counter
+-- 2026-10-18 agent Added scaled online calibration
+-- 2026-10-18 agent Double-buffered LUT
+-- 2026-10-18 agent Added concurrent startup calibration
 -- 2011-11-05 SB Added extra histogram bits support
 -- 2011-10-25 SB Created file
 -------------------------------------------------------------------------------
@@ -52,12 +56,20 @@ entity tdc_channelbank is
         g_EXHIS_COUNT    : positive;
         -- Number of coarse counter bits.
         g_COARSE_COUNT   : positive;
+        -- Number of epoch counter bits, extending the coarse counter.
+        g_EPOCH_COUNT    : natural;
         -- Length of each ring oscillator.
         g_RO_LENGTH      : positive;
         -- Frequency counter width.
         g_FCOUNTER_WIDTH : positive;
         -- Frequency counter timer width.
-        g_FTIMER_WIDTH   : positive
+        g_FTIMER_WIDTH   : positive;
+        -- Book the startup calibration histograms of all channels at once.
+        -- Only supported with several channels.
+        g_CONCURRENT_SC  : boolean;
+        -- Scale the LUT outputs instead of rewriting the LUTs during online
+        -- calibration.
+        g_SCALED_OC      : boolean
     );
     port(
         clk_i       : in std_logic;
@@ -71,7 +83,7 @@ entity tdc_channelbank is
         calib_sel_i : in std_logic;
         
         -- Per-channel deskew inputs.
-        deskew_i    : in std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+        deskew_i    : in std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
         
         -- Per-channel signal inputs.
         signal_i    : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
@@ -81,13 +93,17 @@ entity tdc_channelbank is
         detect_o    : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         polarity_o  : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         raw_o       : out std_logic_vector(g_CHANNEL_COUNT*g_RAW_COUNT-1 downto 0);
-        fp_o        : out std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+        fp_o        : out std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
          
         -- LUT access.
         lut_a_i     : in std_logic_vector(g_RAW_COUNT-1 downto 0);
         lut_we_i    : in std_logic;
         lut_d_i     : in std_logic_vector(g_FP_COUNT-1 downto 0);
         lut_d_o     : out std_logic_vector(g_FP_COUNT-1 downto 0);
+        lut_shadow_i : in std_logic;
+        lut_swap_i  : in std_logic;
+        scale_we_i  : in std_logic;
+        scale_d_i   : in std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
         
         -- Histogram.
         c_detect_o  : out std_logic;
@@ -96,6 +112,9 @@ entity tdc_channelbank is
         his_we_i    : in std_logic;
         his_d_i     : in std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
         his_d_o     : out std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+        sc_all_i    : in std_logic;
+        sc_book_i   : in std_logic;
+        sc_done_o   : out std_logic;
         
         -- Online calibration.
         oc_start_i  : in std_logic;
@@ -116,9 +135,11 @@ begin
                 g_FP_COUNT       => g_FP_COUNT,
                 g_EXHIS_COUNT    => g_EXHIS_COUNT,
                 g_COARSE_COUNT   => g_COARSE_COUNT,
+                g_EPOCH_COUNT    => g_EPOCH_COUNT,
                 g_RO_LENGTH      => g_RO_LENGTH,
                 g_FCOUNTER_WIDTH => g_FCOUNTER_WIDTH,
-                g_FTIMER_WIDTH   => g_FTIMER_WIDTH
+                g_FTIMER_WIDTH   => g_FTIMER_WIDTH,
+                g_SCALED_OC      => g_SCALED_OC
             )
             port map(
                 clk_i        => clk_i,
@@ -144,6 +165,10 @@ begin
                 lut_we_i     => lut_we_i,
                 lut_d_i      => lut_d_i,
                 lut_d_o      => lut_d_o,
+                lut_shadow_i => lut_shadow_i,
+                lut_swap_i   => lut_swap_i,
+                scale_we_i   => scale_we_i,
+                scale_d_i    => scale_d_i,
                 
                 c_detect_o   => c_detect_o,
                 c_raw_o      => c_raw_o,
@@ -158,6 +183,7 @@ begin
                 oc_store_i   => oc_store_i,
                 oc_sfreq_o   => oc_sfreq_o
             );
+        sc_done_o <= '0';
     end generate;
     g_multi: if g_CHANNEL_COUNT > 1 generate
         cmp_channelbank: tdc_channelbank_multi
@@ -168,9 +194,12 @@ begin
                 g_FP_COUNT       => g_FP_COUNT,
                 g_EXHIS_COUNT    => g_EXHIS_COUNT,
                 g_COARSE_COUNT   => g_COARSE_COUNT,
+                g_EPOCH_COUNT    => g_EPOCH_COUNT,
                 g_RO_LENGTH      => g_RO_LENGTH,
                 g_FCOUNTER_WIDTH => g_FCOUNTER_WIDTH,
-                g_FTIMER_WIDTH   => g_FTIMER_WIDTH
+                g_FTIMER_WIDTH   => g_FTIMER_WIDTH,
+                g_CONCURRENT_SC  => g_CONCURRENT_SC,
+                g_SCALED_OC      => g_SCALED_OC
             )
             port map(
                 clk_i        => clk_i,
@@ -196,6 +225,10 @@ begin
                 lut_we_i     => lut_we_i,
                 lut_d_i      => lut_d_i,
                 lut_d_o      => lut_d_o,
+                lut_shadow_i => lut_shadow_i,
+                lut_swap_i   => lut_swap_i,
+                scale_we_i   => scale_we_i,
+                scale_d_i    => scale_d_i,
                 
                 c_detect_o   => c_detect_o,
                 c_raw_o      => c_raw_o,
@@ -203,6 +236,9 @@ begin
                 his_we_i     => his_we_i,
                 his_d_i      => his_d_i,
                 his_d_o      => his_d_o,
+                sc_all_i     => sc_all_i,
+                sc_book_i    => sc_book_i,
+                sc_done_o    => sc_done_o,
 
                 oc_start_i   => oc_start_i,
                 oc_ready_o   => oc_ready_o,
@@ -12,6 +12,11 @@
 --
 -------------------------------------------------------------------------------
 -- last changes:
+-- 2026-10-18 agent Added epoch counter
+-- 2026-10-18 agent Added scaled online calibration
+-- 2026-10-18 agent Double-buffered LUT
+-- 2026-10-18 agent Added concurrent startup calibration
+-- 2026-10-18 agent Per-channel tap ordering
 -- 2011-11-05 SB Added extra histogram bits support
 -- 2011-10-25 SB Renamed to channelbank_multi
 -- 2011-08-18 SB Added histogram
@@ -42,9 +47,17 @@
 --
 -- To save resources:
 --  * the histogram is implemented as one large block RAM common to all
---    channels
+--    channels (unless g_CONCURRENT_SC is set)
 --  * the frequency counter logic is shared among all channels, each channel
 --    only implements a ring oscillator.
+--
+-- With g_CONCURRENT_SC, the histogram memory is instead partitioned into one
+-- block RAM per channel, each driven by a tdc_hisbook engine. When sc_all_i
+-- is asserted, all channels select their calibration input and histogram
+-- writes from the controller go to all partitions, so that they can be
+-- cleared at once. When sc_book_i is asserted, each engine books the
+-- histogram of its channel, and sc_done_o is asserted once all of them are
+-- complete. The total histogram memory size is unchanged.
 
 library ieee;
 use ieee.std_logic_1164.all;
@@ -62,9 +75,12 @@ entity tdc_channelbank_multi is
         g_FP_COUNT       : positive;
         g_EXHIS_COUNT    : positive;
         g_COARSE_COUNT   : positive;
+        g_EPOCH_COUNT    : natural;
         g_RO_LENGTH      : positive;
         g_FCOUNTER_WIDTH : positive;
-        g_FTIMER_WIDTH   : positive
+        g_FTIMER_WIDTH   : positive;
+        g_CONCURRENT_SC  : boolean;
+        g_SCALED_OC      : boolean
     );
     port(
         clk_i       : in std_logic;
@@ -78,7 +94,7 @@ entity tdc_channelbank_multi is
         calib_sel_i : in std_logic;
         
         -- Per-channel deskew inputs.
-        deskew_i    : in std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+        deskew_i    : in std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
         
         -- Per-channel signal inputs.
         signal_i    : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
@@ -88,13 +104,17 @@ entity tdc_channelbank_multi is
         detect_o    : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         polarity_o  : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         raw_o       : out std_logic_vector(g_CHANNEL_COUNT*g_RAW_COUNT-1 downto 0);
-        fp_o        : out std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+        fp_o        : out std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
          
         -- LUT access.
         lut_a_i     : in std_logic_vector(g_RAW_COUNT-1 downto 0);
         lut_we_i    : in std_logic;
         lut_d_i     : in std_logic_vector(g_FP_COUNT-1 downto 0);
         lut_d_o     : out std_logic_vector(g_FP_COUNT-1 downto 0);
+        lut_shadow_i : in std_logic;
+        lut_swap_i  : in std_logic;
+        scale_we_i  : in std_logic;
+        scale_d_i   : in std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
         
         -- Histogram.
         c_detect_o  : out std_logic;
@@ -103,6 +123,9 @@ entity tdc_channelbank_multi is
         his_we_i    : in std_logic;
         his_d_i     : in std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
         his_d_o     : out std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+        sc_all_i    : in std_logic;
+        sc_book_i   : in std_logic;
+        sc_done_o   : out std_logic;
         
         -- Online calibration.
         oc_start_i  : in std_logic;
@@ -117,10 +140,13 @@ architecture rtl of tdc_channelbank_multi is
 signal detect                 : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
 signal raw                    : std_logic_vector(g_CHANNEL_COUNT*g_RAW_COUNT-1 downto 0);
 signal coarse_counter         : std_logic_vector(g_COARSE_COUNT-1 downto 0);
+signal timebase               : std_logic_vector(g_EPOCH_COUNT+g_COARSE_COUNT-1 downto 0);
 signal current_channel_onehot : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
 signal current_channel        : std_logic_vector(f_log2_size(g_CHANNEL_COUNT)-1 downto 0);
 signal lut_d_o_s              : std_logic_vector(g_CHANNEL_COUNT*g_FP_COUNT-1 downto 0);
 signal his_full_a             : std_logic_vector(f_log2_size(g_CHANNEL_COUNT)+g_RAW_COUNT-1 downto 0);
+signal his_d_o_s              : std_logic_vector(g_CHANNEL_COUNT*(g_FP_COUNT+g_EXHIS_COUNT)-1 downto 0);
+signal his_done               : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
 signal ro_clk_s               : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
 signal ro_clk                 : std_logic;
 signal freq                   : std_logic_vector(g_FCOUNTER_WIDTH-1 downto 0);
@@ -130,24 +156,31 @@ begin
     g_channels: for i in 0 to g_CHANNEL_COUNT-1 generate
     signal this_calib_sel : std_logic;
     signal this_lut_we    : std_logic;
+    signal this_lut_swap  : std_logic;
+    signal this_scale_we  : std_logic;
     begin
-        this_calib_sel <= current_channel_onehot(i) and calib_sel_i;
+        this_calib_sel <= (current_channel_onehot(i) or sc_all_i) and calib_sel_i;
         this_lut_we <= current_channel_onehot(i) and lut_we_i;
+        this_lut_swap <= current_channel_onehot(i) and lut_swap_i;
+        this_scale_we <= current_channel_onehot(i) and scale_we_i;
         cmp_channel: tdc_channel
             generic map(
-                g_CARRY4_COUNT => g_CARRY4_COUNT,
-                g_RAW_COUNT    => g_RAW_COUNT,
-                g_FP_COUNT     => g_FP_COUNT,
-                g_COARSE_COUNT => g_COARSE_COUNT,
-                g_RO_LENGTH    => g_RO_LENGTH
+                g_CARRY4_COUNT   => g_CARRY4_COUNT,
+                g_RAW_COUNT      => g_RAW_COUNT,
+                g_FP_COUNT       => g_FP_COUNT,
+                g_COARSE_COUNT   => g_EPOCH_COUNT+g_COARSE_COUNT,
+                g_RO_LENGTH      => g_RO_LENGTH,
+                g_FCOUNTER_WIDTH => g_FCOUNTER_WIDTH,
+                g_SCALED_OC      => g_SCALED_OC,
+                g_CHANNEL        => i
             )
             port map(
                 clk_i       => clk_i,
                 reset_i     => reset_i,
             
-                coarse_i    => coarse_counter,
+                coarse_i    => timebase,
                 deskew_i    =>
-                    deskew_i((i+1)*(g_COARSE_COUNT+g_FP_COUNT)-1 downto i*(g_COARSE_COUNT+g_FP_COUNT)),
+                    deskew_i((i+1)*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto i*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)),
     
                 signal_i    => signal_i(i),
                 calib_i     => calib_i(i),
@@ -157,12 +190,16 @@ begin
                 polarity_o  => polarity_o(i),
                 raw_o       => raw((i+1)*g_RAW_COUNT-1 downto i*g_RAW_COUNT),
                 fp_o        =>
-                    fp_o((i+1)*(g_COARSE_COUNT+g_FP_COUNT)-1 downto i*(g_COARSE_COUNT+g_FP_COUNT)),
+                    fp_o((i+1)*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto i*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)),
 
                 lut_a_i     => lut_a_i,
                 lut_we_i    => this_lut_we,
                 lut_d_i     => lut_d_i,
                 lut_d_o     => lut_d_o_s((i+1)*g_FP_COUNT-1 downto i*g_FP_COUNT),
+                lut_shadow_i => lut_shadow_i,
+                lut_swap_i  => this_lut_swap,
+                scale_we_i  => this_scale_we,
+                scale_d_i   => scale_d_i,
 
                 ro_en_i     => current_channel_onehot(i),
                 ro_clk_o    => ro_clk_s(i)
@@ -172,24 +209,96 @@ begin
     raw_o <= raw;
     
     -- Histogram memory.
-    cmp_histogram: generic_spram
-        generic map(
-            g_data_width               => g_FP_COUNT+g_EXHIS_COUNT,
-            g_size                     => g_CHANNEL_COUNT*2**g_RAW_COUNT,
-            g_with_byte_enable         => false,
-            g_init_file                => "",
-            g_addr_conflict_resolution => "read_first"
-        )
-        port map(
-            rst_n_i => '1',
-            clk_i   => clk_i,
-            bwe_i   => (others => '0'),
-            we_i    => his_we_i,
-            a_i     => his_full_a,
-            d_i     => his_d_i,
-            q_o     => his_d_o
-        );
-    his_full_a <= current_channel & his_a_i;
+    g_his_shared: if not g_CONCURRENT_SC generate
+        cmp_histogram: generic_spram
+            generic map(
+                g_data_width               => g_FP_COUNT+g_EXHIS_COUNT,
+                g_size                     => g_CHANNEL_COUNT*2**g_RAW_COUNT,
+                g_with_byte_enable         => false,
+                g_init_file                => "",
+                g_addr_conflict_resolution => "read_first"
+            )
+            port map(
+                rst_n_i => '1',
+                clk_i   => clk_i,
+                bwe_i   => (others => '0'),
+                we_i    => his_we_i,
+                a_i     => his_full_a,
+                d_i     => his_d_i,
+                q_o     => his_d_o
+            );
+        his_full_a <= current_channel & his_a_i;
+        sc_done_o <= '0';
+    end generate;
+    g_his_partitioned: if g_CONCURRENT_SC generate
+        g_partitions: for i in 0 to g_CHANNEL_COUNT-1 generate
+        signal this_his_sel : std_logic;
+        signal ram_a        : std_logic_vector(g_RAW_COUNT-1 downto 0);
+        signal ram_we       : std_logic;
+        signal ram_d_w      : std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+        signal ram_d_r      : std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+        begin
+            this_his_sel <= current_channel_onehot(i) or sc_all_i;
+            cmp_hisbook: tdc_hisbook
+                generic map(
+                    g_RAW_COUNT   => g_RAW_COUNT,
+                    g_FP_COUNT    => g_FP_COUNT,
+                    g_EXHIS_COUNT => g_EXHIS_COUNT
+                )
+                port map(
+                    clk_i    => clk_i,
+                    reset_i  => reset_i,
+                    
+                    book_i   => sc_book_i,
+                    done_o   => his_done(i),
+                    
+                    sel_i    => this_his_sel,
+                    his_a_i  => his_a_i,
+                    his_we_i => his_we_i,
+                    his_d_i  => his_d_i,
+                    
+                    detect_i => detect(i),
+                    raw_i    => raw((i+1)*g_RAW_COUNT-1 downto i*g_RAW_COUNT),
+                    
+                    ram_a_o  => ram_a,
+                    ram_we_o => ram_we,
+                    ram_d_o  => ram_d_w,
+                    ram_d_i  => ram_d_r
+                );
+            cmp_histogram: generic_spram
+                generic map(
+                    g_data_width               => g_FP_COUNT+g_EXHIS_COUNT,
+                    g_size                     => 2**g_RAW_COUNT,
+                    g_with_byte_enable         => false,
+                    g_init_file                => "",
+                    g_addr_conflict_resolution => "read_first"
+                )
+                port map(
+                    rst_n_i => '1',
+                    clk_i   => clk_i,
+                    bwe_i   => (others => '0'),
+                    we_i    => ram_we,
+                    a_i     => ram_a,
+                    d_i     => ram_d_w,
+                    q_o     => ram_d_r
+                );
+            his_d_o_s((i+1)*(g_FP_COUNT+g_EXHIS_COUNT)-1 downto i*(g_FP_COUNT+g_EXHIS_COUNT)) <= ram_d_r;
+        end generate;
+        sc_done_o <= '1' when (his_done = (his_done'range => '1')) else '0';
+        
+        process(his_d_o_s, current_channel_onehot)
+        variable v_his_d_o: std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+        begin
+            v_his_d_o := (v_his_d_o'range => '0');
+            for i in 0 to g_CHANNEL_COUNT-1 loop
+                if current_channel_onehot(i) = '1' then
+                    v_his_d_o := v_his_d_o
+                        or his_d_o_s((i+1)*(g_FP_COUNT+g_EXHIS_COUNT)-1 downto i*(g_FP_COUNT+g_EXHIS_COUNT));
+                end if;
+            end loop;
+            his_d_o <= v_his_d_o;
+        end process;
+    end generate;
     
     -- Frequency counter.
     cmp_freqc: tdc_freqc
@@ -226,6 +335,28 @@ begin
         end if;
     end process;
     
+    -- Epoch counter. It counts the coarse counter overflows and extends the
+    -- time stamps, so that they are monotonic since the last coarse counter
+    -- reset.
+    g_epoch: if g_EPOCH_COUNT > 0 generate
+        signal epoch_counter : std_logic_vector(g_EPOCH_COUNT-1 downto 0);
+    begin
+        process(clk_i)
+        begin
+            if rising_edge(clk_i) then
+                if (reset_i = '1') or (cc_rst_i = '1') then
+                    epoch_counter <= (epoch_counter'range => '0');
+                elsif coarse_counter = (coarse_counter'range => '1') then
+                    epoch_counter <= std_logic_vector(unsigned(epoch_counter) + 1);
+                end if;
+            end if;
+        end process;
+        timebase <= epoch_counter & coarse_counter;
+    end generate;
+    g_noepoch: if g_EPOCH_COUNT = 0 generate
+        timebase <= coarse_counter;
+    end generate;
+    
     -- Combine LUT outputs.
     process(lut_d_o_s, current_channel_onehot)
     variable v_lut_d_o: std_logic_vector(g_FP_COUNT-1 downto 0);
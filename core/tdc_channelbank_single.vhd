@@ -12,6 +12,9 @@
 --
 -------------------------------------------------------------------------------
 -- last changes:
+-- 2026-10-18 agent Added epoch counter
+-- 2026-10-18 agent Added scaled online calibration
+-- 2026-10-18 agent Double-buffered LUT
 -- 2011-11-05 SB Added extra histogram bits support
 -- 2011-10-25 SB Created file
 -------------------------------------------------------------------------------
@@ -45,9 +48,11 @@ entity tdc_channelbank_single is
         g_FP_COUNT       : positive;
         g_EXHIS_COUNT    : positive;
         g_COARSE_COUNT   : positive;
+        g_EPOCH_COUNT    : natural;
         g_RO_LENGTH      : positive;
         g_FCOUNTER_WIDTH : positive;
-        g_FTIMER_WIDTH   : positive
+        g_FTIMER_WIDTH   : positive;
+        g_SCALED_OC      : boolean
     );
     port(
         clk_i       : in std_logic;
@@ -61,7 +66,7 @@ entity tdc_channelbank_single is
         calib_sel_i : in std_logic;
         
         -- Per-channel deskew inputs.
-        deskew_i    : in std_logic_vector(g_COARSE_COUNT+g_FP_COUNT-1 downto 0);
+        deskew_i    : in std_logic_vector(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT-1 downto 0);
         
         -- Per-channel signal inputs.
         signal_i    : in std_logic;
@@ -71,13 +76,17 @@ entity tdc_channelbank_single is
         detect_o    : out std_logic;
         polarity_o  : out std_logic;
         raw_o       : out std_logic_vector(g_RAW_COUNT-1 downto 0);
-        fp_o        : out std_logic_vector(g_COARSE_COUNT+g_FP_COUNT-1 downto 0);
+        fp_o        : out std_logic_vector(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT-1 downto 0);
          
         -- LUT access.
         lut_a_i     : in std_logic_vector(g_RAW_COUNT-1 downto 0);
         lut_we_i    : in std_logic;
         lut_d_i     : in std_logic_vector(g_FP_COUNT-1 downto 0);
         lut_d_o     : out std_logic_vector(g_FP_COUNT-1 downto 0);
+        lut_shadow_i : in std_logic;
+        lut_swap_i  : in std_logic;
+        scale_we_i  : in std_logic;
+        scale_d_i   : in std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
         
         -- Histogram.
         c_detect_o  : out std_logic;
@@ -100,6 +109,7 @@ architecture rtl of tdc_channelbank_single is
 signal detect                 : std_logic;
 signal raw                    : std_logic_vector(g_RAW_COUNT-1 downto 0);
 signal coarse_counter         : std_logic_vector(g_COARSE_COUNT-1 downto 0);
+signal timebase               : std_logic_vector(g_EPOCH_COUNT+g_COARSE_COUNT-1 downto 0);
 signal ro_clk                 : std_logic;
 signal freq                   : std_logic_vector(g_FCOUNTER_WIDTH-1 downto 0);
 signal sfreq_s                : std_logic_vector(g_FCOUNTER_WIDTH-1 downto 0);
@@ -107,17 +117,19 @@ begin
     -- Per-channel processing.
     cmp_channel: tdc_channel
         generic map(
-            g_CARRY4_COUNT => g_CARRY4_COUNT,
-            g_RAW_COUNT    => g_RAW_COUNT,
-            g_FP_COUNT     => g_FP_COUNT,
-            g_COARSE_COUNT => g_COARSE_COUNT,
-            g_RO_LENGTH    => g_RO_LENGTH
+            g_CARRY4_COUNT   => g_CARRY4_COUNT,
+            g_RAW_COUNT      => g_RAW_COUNT,
+            g_FP_COUNT       => g_FP_COUNT,
+            g_COARSE_COUNT   => g_EPOCH_COUNT+g_COARSE_COUNT,
+            g_RO_LENGTH      => g_RO_LENGTH,
+            g_FCOUNTER_WIDTH => g_FCOUNTER_WIDTH,
+            g_SCALED_OC      => g_SCALED_OC
         )
         port map(
             clk_i       => clk_i,
             reset_i     => reset_i,
         
-            coarse_i    => coarse_counter,
+            coarse_i    => timebase,
             deskew_i    => deskew_i,
 
             signal_i    => signal_i,
@@ -133,6 +145,10 @@ begin
             lut_we_i    => lut_we_i,
             lut_d_i     => lut_d_i,
             lut_d_o     => lut_d_o,
+            lut_shadow_i => lut_shadow_i,
+            lut_swap_i  => lut_swap_i,
+            scale_we_i  => scale_we_i,
+            scale_d_i   => scale_d_i,
 
             ro_en_i     => '1',
             ro_clk_o    => ro_clk
@@ -196,6 +212,28 @@ begin
         end if;
     end process;
     
+    -- Epoch counter. It counts the coarse counter overflows and extends the
+    -- time stamps, so that they are monotonic since the last coarse counter
+    -- reset.
+    g_epoch: if g_EPOCH_COUNT > 0 generate
+        signal epoch_counter : std_logic_vector(g_EPOCH_COUNT-1 downto 0);
+    begin
+        process(clk_i)
+        begin
+            if rising_edge(clk_i) then
+                if (reset_i = '1') or (cc_rst_i = '1') then
+                    epoch_counter <= (epoch_counter'range => '0');
+                elsif coarse_counter = (coarse_counter'range => '1') then
+                    epoch_counter <= std_logic_vector(unsigned(epoch_counter) + 1);
+                end if;
+            end if;
+        end process;
+        timebase <= epoch_counter & coarse_counter;
+    end generate;
+    g_noepoch: if g_EPOCH_COUNT = 0 generate
+        timebase <= coarse_counter;
+    end generate;
+    
     -- Store and retrieve per-channel ring oscillator frequencies.
     process(clk_i)
     begin
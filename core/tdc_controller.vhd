@@ -12,6 +12,11 @@
 --
 -------------------------------------------------------------------------------
 -- last changes:
+-- 2026-10-18 agent Saturate the LUT when the frequency is 0
+-- 2026-10-18 agent Added scaled online calibration
+-- 2026-10-18 agent Double-buffered LUT
+-- 2026-10-18 agent Write one LUT entry per cycle in online calibration
+-- 2026-10-18 agent Added concurrent startup calibration
 -- 2011-11-05 SB Added extra histogram bits support
 -- 2011-10-27 SB Fix accumulator overflow
 -- 2011-10-27 SB Fix LUT address offset
@@ -33,6 +38,42 @@
 -- This is the controller for the channel bank. It is in charge of sequencing
 -- and performing the startup and online calibrations for all channels.
 -- It books the histograms and computes and loads the LUTs of the channels.
+--
+-- By default, startup calibration is performed one channel after the other,
+-- and the controller books the histogram of each channel itself.
+-- With g_CONCURRENT_SC, the controller clears the histograms of all channels
+-- at once (asserting sc_all_o), then lets the channel bank book them all in
+-- parallel (asserting sc_book_o) until sc_done_i is asserted. It then only
+-- steps through the channels to measure the ring oscillator frequencies.
+--
+-- Online calibration computes each LUT entry as
+--   floor(floor(S/2^g_EXHIS_COUNT)*f0/f)
+-- where S is the sum of the histogram bins below the entry, f0 the stored
+-- and f the current ring oscillator frequency. Instead of performing one
+-- division per entry, the divider computes once per channel the scaled
+-- reciprocal
+--   R = ceil(f0*2^K/f), with K = g_FP_COUNT+g_FCOUNTER_WIDTH
+-- and each entry is then obtained as floor(floor(S/2^g_EXHIS_COUNT)*R/2^K)
+-- by a pipelined multiplier, at a rate of one entry per clock cycle.
+-- Since floor(S/2^g_EXHIS_COUNT) < 2^g_FP_COUNT and f < 2^g_FCOUNTER_WIDTH,
+-- the rounding error of R is below 1/f after multiplication, and this gives
+-- exactly the same result as the division. When f is 0, the division
+-- saturated every entry, so the pipeline forces saturation instead of using
+-- the all-ones quotient returned by the divider.
+--
+-- The LUT of each channel is double-buffered. While lut_shadow_o is asserted,
+-- LUT accesses go to the shadow bank of the current channel, which the
+-- controller fills with the new values while the active bank keeps
+-- converting hits. Once the shadow bank is complete, the controller asserts
+-- lut_swap_o for one cycle to exchange the two banks of the current channel.
+--
+-- With g_SCALED_OC, the channels convert hits with their LUT output multiplied
+-- by a per-channel scale register, which takes the value R. The LUT is then
+-- only built once, after startup calibration, with R = 2^K (unity scale), and
+-- later rounds of online calibration only write R to the scale register of
+-- the channel (asserting scale_we_o). Since the channel computes
+-- floor(LUT*R/2^K), the results are the same as with a LUT rebuild, except
+-- when f is 0, where the zero entries of the LUT are not saturated.
 
 library ieee;
 use ieee.std_logic_1164.all;
@@ -46,7 +87,9 @@ entity tdc_controller is
         g_RAW_COUNT      : positive;
         g_FP_COUNT       : positive;
         g_EXHIS_COUNT    : positive;
-        g_FCOUNTER_WIDTH : positive
+        g_FCOUNTER_WIDTH : positive;
+        g_CONCURRENT_SC  : boolean;
+        g_SCALED_OC      : boolean
     );
     port(
         clk_i        : in std_logic;
@@ -60,6 +103,10 @@ entity tdc_controller is
         lut_a_o      : out std_logic_vector(g_RAW_COUNT-1 downto 0);
         lut_we_o     : out std_logic;
         lut_d_o      : out std_logic_vector(g_FP_COUNT-1 downto 0);
+        lut_shadow_o : out std_logic;
+        lut_swap_o   : out std_logic;
+        scale_we_o   : out std_logic;
+        scale_d_o    : out std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
         
         c_detect_i   : in std_logic;
         c_raw_i      : in std_logic_vector(g_RAW_COUNT-1 downto 0);
@@ -67,6 +114,9 @@ entity tdc_controller is
         his_we_o     : out std_logic;
         his_d_o      : out std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
         his_d_i      : in std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+        sc_all_o     : out std_logic;
+        sc_book_o    : out std_logic;
+        sc_done_i    : in std_logic;
 
         oc_start_o   : out std_logic;
         oc_ready_i   : in std_logic;
@@ -82,6 +132,7 @@ end entity;
 architecture rtl of tdc_controller is
 
 signal ready_p: std_logic;
+signal ready  : std_logic;
 
 signal hc_count : std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
 signal hc_reset : std_logic;
@@ -96,22 +147,38 @@ signal ha_sel   : std_logic;
 
 signal acc       : std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
 signal acc_reset : std_logic;
-signal acc_en    : std_logic;
-
-signal mul       : std_logic_vector(g_FP_COUNT+g_FCOUNTER_WIDTH-1 downto 0);
-signal mul_d1    : std_logic_vector(g_FP_COUNT+g_FCOUNTER_WIDTH-1 downto 0);
 
+-- scaled reciprocal
+constant c_K        : positive := g_FP_COUNT+g_FCOUNTER_WIDTH;
+constant c_RWIDTH   : positive := g_FP_COUNT+2*g_FCOUNTER_WIDTH;
 signal div_start    : std_logic;
 signal div_ready    : std_logic;
-signal div_divisor  : std_logic_vector(g_FP_COUNT+g_FCOUNTER_WIDTH-1 downto 0);
-signal div_quotient : std_logic_vector(g_FP_COUNT+g_FCOUNTER_WIDTH-1 downto 0);
-signal div_qsat     : std_logic_vector(g_FP_COUNT-1 downto 0);
+signal div_dividend : std_logic_vector(c_RWIDTH-1 downto 0);
+signal div_divisor  : std_logic_vector(c_RWIDTH-1 downto 0);
+signal div_quotient : std_logic_vector(c_RWIDTH-1 downto 0);
+constant c_UNITY    : std_logic_vector(c_RWIDTH-1 downto 0) :=
+    std_logic_vector(shift_left(to_unsigned(1, c_RWIDTH), c_K));
+
+-- LUT pipeline
+signal lp_busy   : std_logic;
+signal lp_v0     : std_logic;
+signal lp_a0     : std_logic_vector(g_RAW_COUNT-1 downto 0);
+signal lp_r      : std_logic_vector(c_RWIDTH-1 downto 0);
+signal lp_v1     : std_logic;
+signal lp_a1     : std_logic_vector(g_RAW_COUNT-1 downto 0);
+signal lp_mul    : std_logic_vector(g_FP_COUNT+c_RWIDTH-1 downto 0);
+signal lp_v2     : std_logic;
+signal lp_a2     : std_logic_vector(g_RAW_COUNT-1 downto 0);
+signal lp_mul_d1 : std_logic_vector(g_FP_COUNT+c_RWIDTH-1 downto 0);
+signal lp_q      : std_logic_vector(c_RWIDTH-c_K+g_FP_COUNT-1 downto 0);
+signal lp_qsat   : std_logic_vector(g_FP_COUNT-1 downto 0);
+signal lp_fzero  : std_logic;
 
 type t_state is (
         -- startup calibration
-        SC_NEWCHANNEL, SC_CLEARHIST, SC_READ, SC_UPDATE, SC_STOREF0,
+        SC_NEWCHANNEL, SC_CLEARHIST, SC_READ, SC_UPDATE, SC_BOOK, SC_STARTF0, SC_STOREF0,
         -- online calibration
-        OC_STARTM, OC_WAITM, OC_WAITMUL1, OC_WAITMUL2, OC_STARTDIV, OC_WAITDIV, OC_WRITELUT, OC_NEXTCHANNEL,
+        OC_STARTM, OC_WAITM, OC_STARTDIV, OC_WAITDIV, OC_WRITELUT, OC_FLUSH, OC_NEXTCHANNEL,
         -- freeze state (transfer control to debug interface)
         FREEZE
     );
@@ -123,14 +190,15 @@ begin
     begin
         if rising_edge(clk_i) then
             if reset_i = '1' then
-                ready_o <= '0';
+                ready <= '0';
             else
                 if ready_p = '1' then
-                    ready_o <= '1';
+                    ready <= '1';
                 end if;
             end if;
         end if;
     end process;
+    ready_o <= ready;
     
     -- count histogram entries when recording
     process(clk_i)
@@ -161,60 +229,95 @@ begin
     his_d_o <= (his_d_o'range => '0') when (ha_sel = '1')
         else std_logic_vector(unsigned(his_d_i) + 1);
     
-    -- accumulator
-    process(clk_i)
-    begin
-        if rising_edge(clk_i) then
-            if acc_reset = '1' then
-                acc <= (acc'range => '0');
-            elsif acc_en = '1' then
-                acc <= std_logic_vector(unsigned(acc) + unsigned(his_d_i));
-            end if;
-        end if;
-    end process;
-    
-    -- multiplier
-    process(clk_i)
-    begin
-        if rising_edge(clk_i) then
-            mul <= std_logic_vector(
-                unsigned(acc(g_FP_COUNT+g_EXHIS_COUNT-1 downto g_EXHIS_COUNT))
-                * unsigned(oc_sfreq_i));
-            mul_d1 <= mul;
-        end if;
-    end process;
-    
-    -- divider
+    -- divider, computes R = ceil(oc_sfreq_i*2^K/oc_freq_i)
     cmp_divider: tdc_divider
         generic map(
-            g_WIDTH => g_FP_COUNT+g_FCOUNTER_WIDTH
+            g_WIDTH => c_RWIDTH
         )
         port map(
             clk_i       => clk_i,
             reset_i     => reset_i,
             
             start_i     => div_start,
-            dividend_i  => mul_d1,
+            dividend_i  => div_dividend,
             divisor_i   => div_divisor,
             
             ready_o     => div_ready,
             quotient_o  => div_quotient,
             remainder_o => open
         );
-    div_divisor <= (g_FP_COUNT-1 downto 0 => '0') & oc_freq_i;
-    process(div_quotient)
+    div_dividend <= std_logic_vector(
+        shift_left(resize(unsigned(oc_sfreq_i), c_RWIDTH), c_K)
+        + resize(unsigned(oc_freq_i), c_RWIDTH) - 1);
+    div_divisor <= (c_RWIDTH-1 downto g_FCOUNTER_WIDTH => '0') & oc_freq_i;
+    scale_d_o <= div_quotient;
+    
+    -- LUT pipeline. Reads one histogram bin per cycle while lp_busy is
+    -- asserted, and writes the corresponding LUT entry three cycles later.
+    -- In scaled mode, the LUT is built with unity scale.
+    --  stage 0: histogram memory read
+    --  stage 1: accumulation and multiplication
+    --  stage 2: multiplier output register
+    --  then: division by 2^K, saturation and LUT write
+    process(clk_i)
     begin
-        if div_quotient(g_FP_COUNT+g_FCOUNTER_WIDTH-1 downto g_FP_COUNT)
-            = (g_FCOUNTER_WIDTH-1 downto 0 => '0') then
-            div_qsat <= div_quotient(g_FP_COUNT-1 downto 0);
+        if rising_edge(clk_i) then
+            if (reset_i = '1') or (acc_reset = '1') then
+                acc <= (acc'range => '0');
+                lp_v0 <= '0';
+                lp_v1 <= '0';
+                lp_v2 <= '0';
+            else
+                lp_v0 <= lp_busy;
+                lp_a0 <= ha_count;
+                
+                lp_v1 <= lp_v0;
+                lp_a1 <= lp_a0;
+                if lp_v0 = '1' then
+                    acc <= std_logic_vector(unsigned(acc) + unsigned(his_d_i));
+                end if;
+                lp_mul <= std_logic_vector(
+                    unsigned(acc(g_FP_COUNT+g_EXHIS_COUNT-1 downto g_EXHIS_COUNT))
+                    * unsigned(lp_r));
+                
+                lp_v2 <= lp_v1;
+                lp_a2 <= lp_a1;
+                lp_mul_d1 <= lp_mul;
+            end if;
+        end if;
+    end process;
+    lp_r <= c_UNITY when g_SCALED_OC else div_quotient;
+    lp_q <= lp_mul_d1(lp_mul_d1'high downto c_K);
+    
+    -- detect a zero frequency when the division starts
+    process(clk_i)
+    begin
+        if rising_edge(clk_i) then
+            if reset_i = '1' then
+                lp_fzero <= '0';
+            elsif div_start = '1' then
+                if (not g_SCALED_OC) and (oc_freq_i = (oc_freq_i'range => '0')) then
+                    lp_fzero <= '1';
+                else
+                    lp_fzero <= '0';
+                end if;
+            end if;
+        end if;
+    end process;
+    
+    process(lp_q, lp_fzero)
+    begin
+        if (lp_fzero = '0') and (lp_q(lp_q'high downto g_FP_COUNT) = (lp_q'high downto g_FP_COUNT => '0')) then
+            lp_qsat <= lp_q(g_FP_COUNT-1 downto 0);
         else -- saturate
-            div_qsat <= (div_qsat'range => '1');
+            lp_qsat <= (lp_qsat'range => '1');
         end if;
     end process;
     
     -- generate LUT address and write data
-    lut_a_o <= ha_count;
-    lut_d_o <= div_qsat;
+    lut_a_o <= lp_a2;
+    lut_we_o <= lp_v2;
+    lut_d_o <= lp_qsat;
     
     -- main FSM
     process(clk_i)
@@ -232,7 +335,11 @@ begin
                         state <= SC_CLEARHIST;
                     when SC_CLEARHIST =>
                         if ha_last = '1' then
-                            state <= SC_READ;
+                            if g_CONCURRENT_SC then
+                                state <= SC_BOOK;
+                            else
+                                state <= SC_READ;
+                            end if;
                         end if;
                     when SC_READ =>
                         if c_detect_i = '1' then
@@ -244,10 +351,18 @@ begin
                         else
                             state <= SC_READ;
                         end if;
+                    when SC_BOOK =>
+                        if sc_done_i = '1' then
+                            state <= SC_STARTF0;
+                        end if;
+                    when SC_STARTF0 =>
+                        state <= SC_STOREF0;
                     when SC_STOREF0 =>
                         if oc_ready_i = '1' then
                             if last_i = '1' then
                                 state <= OC_STARTM;
+                            elsif g_CONCURRENT_SC then
+                                state <= SC_STARTF0;
                             else
                                 state <= SC_NEWCHANNEL;
                             end if;
@@ -257,23 +372,25 @@ begin
                         state <= OC_WAITM;
                     when OC_WAITM =>
                         if oc_ready_i = '1' then
-                            state <= OC_WAITMUL1;
+                            state <= OC_STARTDIV;
                         end if;
-                    when OC_WAITMUL1 =>
-                        state <= OC_WAITMUL2;
-                    when OC_WAITMUL2 =>
-                        state <= OC_STARTDIV;
                     when OC_STARTDIV =>
                         state <= OC_WAITDIV;
                     when OC_WAITDIV =>
                         if div_ready = '1' then
-                            state <= OC_WRITELUT;
+                            if g_SCALED_OC and (ready = '1') then
+                                state <= OC_NEXTCHANNEL;
+                            else
+                                state <= OC_WRITELUT;
+                            end if;
                         end if;
                     when OC_WRITELUT =>
                         if ha_last = '1' then
+                            state <= OC_FLUSH;
+                        end if;
+                    when OC_FLUSH =>
+                        if (lp_v0 = '0') and (lp_v1 = '0') and (lp_v2 = '0') then
                             state <= OC_NEXTCHANNEL;
-                        else
-                            state <= OC_WAITMUL1;
                         end if;
                     when OC_NEXTCHANNEL =>
                         if freeze_req_i = '1' then
@@ -291,7 +408,7 @@ begin
         end if;
     end process;
     
-    process(state, hc_zero, oc_ready_i, last_i, c_detect_i)
+    process(state, hc_zero, oc_ready_i, last_i, c_detect_i, ready)
     begin
         ready_p <= '0';
         
@@ -303,14 +420,18 @@ begin
         ha_sel <= '0';
         
         acc_reset <= '0';
-        acc_en <= '0';
+        lp_busy <= '0';
         
         div_start <= '0';
         
         next_o <= '0';
         calib_sel_o <= '0';
-        lut_we_o <= '0';
+        lut_shadow_o <= '0';
+        lut_swap_o <= '0';
+        scale_we_o <= '0';
         his_we_o <= '0';
+        sc_all_o <= '0';
+        sc_book_o <= '0';
         oc_start_o <= '0';
         oc_store_o <= '0';
         freeze_ack_o <= '0';
@@ -324,6 +445,9 @@ begin
                 ha_inc <= '1';
                 ha_sel <= '1';
                 his_we_o <= '1';
+                if g_CONCURRENT_SC then
+                    sc_all_o <= '1';
+                end if;
             when SC_READ =>
                 calib_sel_o <= '1';
                 if c_detect_i = '1' then
@@ -335,6 +459,12 @@ begin
                 if hc_zero = '1' then
                     oc_start_o <= '1';
                 end if;
+            when SC_BOOK =>
+                calib_sel_o <= '1';
+                sc_all_o <= '1';
+                sc_book_o <= '1';
+            when SC_STARTF0 =>
+                oc_start_o <= '1';
             when SC_STOREF0 =>
                 if oc_ready_i = '1' then
                     oc_store_o <= '1';
@@ -348,22 +478,29 @@ begin
                 ha_sel <= '1';
             when OC_WAITM =>
                 ha_sel <= '1';
-            when OC_WAITMUL1 =>
-                ha_sel <= '1';
-            when OC_WAITMUL2 =>
-                ha_sel <= '1';
             when OC_STARTDIV =>
                 div_start <= '1';
                 ha_sel <= '1';
             when OC_WAITDIV =>
                 ha_sel <= '1';
             when OC_WRITELUT =>
-                lut_we_o <= '1';
-                acc_en <= '1';
+                lp_busy <= '1';
                 ha_inc <= '1';
                 ha_sel <= '1';
+                lut_shadow_o <= '1';
+            when OC_FLUSH =>
+                ha_sel <= '1';
+                lut_shadow_o <= '1';
             when OC_NEXTCHANNEL =>
                 next_o <= '1';
+                if g_SCALED_OC then
+                    scale_we_o <= '1';
+                    if ready = '0' then
+                        lut_swap_o <= '1';
+                    end if;
+                else
+                    lut_swap_o <= '1';
+                end if;
                 if last_i = '1' then
                     ready_p <= '1';
                 end if;
@@ -12,6 +12,7 @@
 --
 -------------------------------------------------------------------------------
 -- last changes:
+-- 2026-10-18 agent Per-channel tap ordering
 -- 2011-10-27 SB MSB first
 -- 2011-08-01 SB Created file
 -------------------------------------------------------------------------------
@@ -50,7 +51,9 @@ use work.tdc_package.all;
 entity tdc_delayline is
     generic(
         -- Number of CARRY4 elements.
-        g_WIDTH: positive
+        g_WIDTH   : positive;
+        -- Channel number, selects the tap ordering.
+        g_CHANNEL : natural := 0
     );
     port(
          clk_i        : in std_logic;
@@ -125,7 +128,8 @@ begin
     -- sort taps by increasing delays, according to static timing model
     cmp_ordertaps: tdc_ordertaps
         generic map(
-            g_WIDTH => g_WIDTH
+            g_WIDTH   => g_WIDTH,
+            g_CHANNEL => g_CHANNEL
         )
         port map(
             unsorted_i => taps_rev,
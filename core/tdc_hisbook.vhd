@@ -0,0 +1,113 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tdc_hisbook
+--
+-- author: agent, agent@local
+--
+-- description: Histogram booking engine for concurrent startup calibration
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- Drives the histogram memory partition of one channel.
+-- When book_i is deasserted, the partition is accessed through the his_*
+-- port of the controller, and writes only take place when sel_i is
+-- asserted.
+-- When book_i is asserted, the engine books the histogram of the channel
+-- itself, in the same way as the SC_READ and SC_UPDATE states of the
+-- controller: each hit is counted with a read-modify-write cycle at the
+-- address given by its raw value. Once 2^(g_FP_COUNT+g_EXHIS_COUNT)-1 hits
+-- have been booked, done_o is asserted and further hits are ignored until
+-- book_i is deasserted.
+--
+-- The memory must have one cycle of read latency and read-first behaviour.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.tdc_package.all;
+
+entity tdc_hisbook is
+    generic(
+        -- Number of raw output bits.
+        g_RAW_COUNT   : positive;
+        -- Number of fractional part bits.
+        g_FP_COUNT    : positive;
+        -- Number of extra histogram bits.
+        g_EXHIS_COUNT : positive
+    );
+    port(
+        clk_i    : in std_logic;
+        reset_i  : in std_logic;
+        
+        book_i   : in std_logic;
+        done_o   : out std_logic;
+        
+        -- Controller port.
+        sel_i    : in std_logic;
+        his_a_i  : in std_logic_vector(g_RAW_COUNT-1 downto 0);
+        his_we_i : in std_logic;
+        his_d_i  : in std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+        
+        -- Channel.
+        detect_i : in std_logic;
+        raw_i    : in std_logic_vector(g_RAW_COUNT-1 downto 0);
+        
+        -- Memory partition.
+        ram_a_o  : out std_logic_vector(g_RAW_COUNT-1 downto 0);
+        ram_we_o : out std_logic;
+        ram_d_o  : out std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+        ram_d_i  : in std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0)
+    );
+end entity;
+
+architecture rtl of tdc_hisbook is
+signal count  : std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+signal update : std_logic;
+signal done   : std_logic;
+begin
+    process(clk_i)
+    begin
+        if rising_edge(clk_i) then
+            if (reset_i = '1') or (book_i = '0') then
+                count <= (count'range => '1');
+                update <= '0';
+                done <= '0';
+            else
+                update <= '0';
+                if (update = '0') and (done = '0') and (detect_i = '1') then
+                    update <= '1';
+                    count <= std_logic_vector(unsigned(count) - 1);
+                end if;
+                if (update = '1') and (count = (count'range => '0')) then
+                    done <= '1';
+                end if;
+            end if;
+        end if;
+    end process;
+    done_o <= done;
+    
+    ram_a_o <= raw_i when (book_i = '1') else his_a_i;
+    ram_we_o <= update when (book_i = '1') else (his_we_i and sel_i);
+    ram_d_o <= std_logic_vector(unsigned(ram_d_i) + 1) when (book_i = '1') else his_d_i;
+end architecture;
@@ -9,7 +9,8 @@ use work.tdc_package.all;
 
 entity tdc_ordertaps is
     generic(
-        g_WIDTH: positive
+        g_WIDTH   : positive;
+        g_CHANNEL : natural := 0
     );
     port(
         unsorted_i : in std_logic_vector(4*g_WIDTH-1 downto 0);
@@ -12,6 +12,11 @@
 --
 -------------------------------------------------------------------------------
 -- last changes:
+-- 2026-10-18 agent Added epoch counter
+-- 2026-10-18 agent Added scaled online calibration
+-- 2026-10-18 agent Double-buffered LUT
+-- 2026-10-18 agent Added concurrent startup calibration
+-- 2026-10-18 agent Per-channel tap ordering
 -- 2011-11-07 SB Pre-inversion
 -- 2011-11-05 SB Added extra histogram bits support
 -- 2011-10-25 SB Added single/multi channel bank components
@@ -47,9 +52,12 @@ component tdc is
         g_FP_COUNT       : positive := 13;
         g_EXHIS_COUNT    : positive := 4;
         g_COARSE_COUNT   : positive := 25;
+        g_EPOCH_COUNT    : natural := 0;
         g_RO_LENGTH      : positive := 20;
         g_FCOUNTER_WIDTH : positive := 13;
-        g_FTIMER_WIDTH   : positive := 10
+        g_FTIMER_WIDTH   : positive := 10;
+        g_CONCURRENT_SC  : boolean := false;
+        g_SCALED_OC      : boolean := false
     );
     port(
         clk_i        : in std_logic;
@@ -59,7 +67,7 @@ component tdc is
         cc_rst_i     : in std_logic;
         cc_cy_o      : out std_logic;
         
-        deskew_i     : in std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+        deskew_i     : in std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
         
         signal_i     : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         calib_i      : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
@@ -67,7 +75,7 @@ component tdc is
         detect_o     : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         polarity_o   : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         raw_o        : out std_logic_vector(g_CHANNEL_COUNT*g_RAW_COUNT-1 downto 0);
-        fp_o         : out std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+        fp_o         : out std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
         
         freeze_req_i : in std_logic;
         freeze_ack_o : out std_logic;
@@ -90,7 +98,9 @@ component tdc_controller is
         g_RAW_COUNT      : positive;
         g_FP_COUNT       : positive;
         g_EXHIS_COUNT    : positive;
-        g_FCOUNTER_WIDTH : positive
+        g_FCOUNTER_WIDTH : positive;
+        g_CONCURRENT_SC  : boolean;
+        g_SCALED_OC      : boolean
     );
     port(
         clk_i        : in std_logic;
@@ -104,6 +114,10 @@ component tdc_controller is
         lut_a_o      : out std_logic_vector(g_RAW_COUNT-1 downto 0);
         lut_we_o     : out std_logic;
         lut_d_o      : out std_logic_vector(g_FP_COUNT-1 downto 0);
+        lut_shadow_o : out std_logic;
+        lut_swap_o   : out std_logic;
+        scale_we_o   : out std_logic;
+        scale_d_o    : out std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
         
         c_detect_i   : in std_logic;
         c_raw_i      : in std_logic_vector(g_RAW_COUNT-1 downto 0);
@@ -111,6 +125,9 @@ component tdc_controller is
         his_we_o     : out std_logic;
         his_d_o      : out std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
         his_d_i      : in std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+        sc_all_o     : out std_logic;
+        sc_book_o    : out std_logic;
+        sc_done_i    : in std_logic;
 
         oc_start_o   : out std_logic;
         oc_ready_i   : in std_logic;
@@ -131,9 +148,12 @@ component tdc_channelbank is
         g_FP_COUNT       : positive;
         g_EXHIS_COUNT    : positive;
         g_COARSE_COUNT   : positive;
+        g_EPOCH_COUNT    : natural;
         g_RO_LENGTH      : positive;
         g_FCOUNTER_WIDTH : positive;
-        g_FTIMER_WIDTH   : positive
+        g_FTIMER_WIDTH   : positive;
+        g_CONCURRENT_SC  : boolean;
+        g_SCALED_OC      : boolean
     );
     port(
         clk_i       : in std_logic;
@@ -145,7 +165,7 @@ component tdc_channelbank is
         last_o      : out std_logic;
         calib_sel_i : in std_logic;
         
-        deskew_i    : in std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+        deskew_i    : in std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
          
         signal_i    : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         calib_i     : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
@@ -153,12 +173,16 @@ component tdc_channelbank is
         detect_o    : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         polarity_o  : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         raw_o       : out std_logic_vector(g_CHANNEL_COUNT*g_RAW_COUNT-1 downto 0);
-        fp_o        : out std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+        fp_o        : out std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
          
         lut_a_i     : in std_logic_vector(g_RAW_COUNT-1 downto 0);
         lut_we_i    : in std_logic;
         lut_d_i     : in std_logic_vector(g_FP_COUNT-1 downto 0);
         lut_d_o     : out std_logic_vector(g_FP_COUNT-1 downto 0);
+        lut_shadow_i : in std_logic;
+        lut_swap_i  : in std_logic;
+        scale_we_i  : in std_logic;
+        scale_d_i   : in std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
         
         c_detect_o  : out std_logic;
         c_raw_o     : out std_logic_vector(g_RAW_COUNT-1 downto 0);
@@ -166,6 +190,9 @@ component tdc_channelbank is
         his_we_i    : in std_logic;
         his_d_i     : in std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
         his_d_o     : out std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+        sc_all_i    : in std_logic;
+        sc_book_i   : in std_logic;
+        sc_done_o   : out std_logic;
 
         oc_start_i  : in std_logic;
         oc_ready_o  : out std_logic;
@@ -182,9 +209,11 @@ component tdc_channelbank_single is
         g_FP_COUNT       : positive;
         g_EXHIS_COUNT    : positive;
         g_COARSE_COUNT   : positive;
+        g_EPOCH_COUNT    : natural;
         g_RO_LENGTH      : positive;
         g_FCOUNTER_WIDTH : positive;
-        g_FTIMER_WIDTH   : positive
+        g_FTIMER_WIDTH   : positive;
+        g_SCALED_OC      : boolean
     );
     port(
         clk_i       : in std_logic;
@@ -196,7 +225,7 @@ component tdc_channelbank_single is
         last_o      : out std_logic;
         calib_sel_i : in std_logic;
         
-        deskew_i    : in std_logic_vector(g_COARSE_COUNT+g_FP_COUNT-1 downto 0);
+        deskew_i    : in std_logic_vector(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT-1 downto 0);
         
         signal_i    : in std_logic;
         calib_i     : in std_logic;
@@ -204,12 +233,16 @@ component tdc_channelbank_single is
         detect_o    : out std_logic;
         polarity_o  : out std_logic;
         raw_o       : out std_logic_vector(g_RAW_COUNT-1 downto 0);
-        fp_o        : out std_logic_vector(g_COARSE_COUNT+g_FP_COUNT-1 downto 0);
+        fp_o        : out std_logic_vector(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT-1 downto 0);
          
         lut_a_i     : in std_logic_vector(g_RAW_COUNT-1 downto 0);
         lut_we_i    : in std_logic;
         lut_d_i     : in std_logic_vector(g_FP_COUNT-1 downto 0);
         lut_d_o     : out std_logic_vector(g_FP_COUNT-1 downto 0);
+        lut_shadow_i : in std_logic;
+        lut_swap_i  : in std_logic;
+        scale_we_i  : in std_logic;
+        scale_d_i   : in std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
         
         c_detect_o  : out std_logic;
         c_raw_o     : out std_logic_vector(g_RAW_COUNT-1 downto 0);
@@ -234,9 +267,12 @@ component tdc_channelbank_multi is
         g_FP_COUNT       : positive;
         g_EXHIS_COUNT    : positive;
         g_COARSE_COUNT   : positive;
+        g_EPOCH_COUNT    : natural;
         g_RO_LENGTH      : positive;
         g_FCOUNTER_WIDTH : positive;
-        g_FTIMER_WIDTH   : positive
+        g_FTIMER_WIDTH   : positive;
+        g_CONCURRENT_SC  : boolean;
+        g_SCALED_OC      : boolean
     );
     port(
         clk_i       : in std_logic;
@@ -248,7 +284,7 @@ component tdc_channelbank_multi is
         last_o      : out std_logic;
         calib_sel_i : in std_logic;
         
-        deskew_i    : in std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+        deskew_i    : in std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
          
         signal_i    : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         calib_i     : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
@@ -256,12 +292,16 @@ component tdc_channelbank_multi is
         detect_o    : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         polarity_o  : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
         raw_o       : out std_logic_vector(g_CHANNEL_COUNT*g_RAW_COUNT-1 downto 0);
-        fp_o        : out std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+        fp_o        : out std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
          
         lut_a_i     : in std_logic_vector(g_RAW_COUNT-1 downto 0);
         lut_we_i    : in std_logic;
         lut_d_i     : in std_logic_vector(g_FP_COUNT-1 downto 0);
         lut_d_o     : out std_logic_vector(g_FP_COUNT-1 downto 0);
+        lut_shadow_i : in std_logic;
+        lut_swap_i  : in std_logic;
+        scale_we_i  : in std_logic;
+        scale_d_i   : in std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
         
         c_detect_o  : out std_logic;
         c_raw_o     : out std_logic_vector(g_RAW_COUNT-1 downto 0);
@@ -269,6 +309,9 @@ component tdc_channelbank_multi is
         his_we_i    : in std_logic;
         his_d_i     : in std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
         his_d_o     : out std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+        sc_all_i    : in std_logic;
+        sc_book_i   : in std_logic;
+        sc_done_o   : out std_logic;
 
         oc_start_i  : in std_logic;
         oc_ready_o  : out std_logic;
@@ -278,6 +321,34 @@ component tdc_channelbank_multi is
     );
 end component;
 
+component tdc_hisbook is
+    generic(
+        g_RAW_COUNT   : positive;
+        g_FP_COUNT    : positive;
+        g_EXHIS_COUNT : positive
+    );
+    port(
+        clk_i    : in std_logic;
+        reset_i  : in std_logic;
+        
+        book_i   : in std_logic;
+        done_o   : out std_logic;
+        
+        sel_i    : in std_logic;
+        his_a_i  : in std_logic_vector(g_RAW_COUNT-1 downto 0);
+        his_we_i : in std_logic;
+        his_d_i  : in std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+        
+        detect_i : in std_logic;
+        raw_i    : in std_logic_vector(g_RAW_COUNT-1 downto 0);
+        
+        ram_a_o  : out std_logic_vector(g_RAW_COUNT-1 downto 0);
+        ram_we_o : out std_logic;
+        ram_d_o  : out std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+        ram_d_i  : in std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0)
+    );
+end component;
+
 component tdc_freqc is
     generic(
         g_COUNTER_WIDTH : positive;
@@ -296,11 +367,14 @@ end component;
 
 component tdc_channel is
     generic(
-        g_CARRY4_COUNT : positive;
-        g_RAW_COUNT    : positive;
-        g_FP_COUNT     : positive;
-        g_COARSE_COUNT : positive;
-        g_RO_LENGTH    : positive
+        g_CARRY4_COUNT   : positive;
+        g_RAW_COUNT      : positive;
+        g_FP_COUNT       : positive;
+        g_COARSE_COUNT   : positive;
+        g_RO_LENGTH      : positive;
+        g_FCOUNTER_WIDTH : positive;
+        g_SCALED_OC      : boolean;
+        g_CHANNEL        : natural := 0
     );
     port(
         clk_i       : in std_logic;
@@ -322,6 +396,10 @@ component tdc_channel is
         lut_we_i    : in std_logic;
         lut_d_i     : in std_logic_vector(g_FP_COUNT-1 downto 0);
         lut_d_o     : out std_logic_vector(g_FP_COUNT-1 downto 0);
+        lut_shadow_i : in std_logic;
+        lut_swap_i  : in std_logic;
+        scale_we_i  : in std_logic;
+        scale_d_i   : in std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
 
         ro_en_i     : in std_logic;
         ro_clk_o    : out std_logic
@@ -356,7 +434,8 @@ end component;
 
 component tdc_delayline is
     generic(
-        g_WIDTH: positive
+        g_WIDTH   : positive;
+        g_CHANNEL : natural := 0
     );
     port(
          clk_i        : in std_logic;
@@ -368,7 +447,8 @@ end component;
 
 component tdc_ordertaps is
     generic(
-        g_WIDTH: positive
+        g_WIDTH   : positive;
+        g_CHANNEL : natural := 0
     );
     port(
         unsorted_i : in std_logic_vector(4*g_WIDTH-1 downto 0);
@@ -121,7 +121,8 @@ wire [31:0]	brg_adr,
 
 wire [2:0]	brg_cti,
 		bram_cti,
-		sram_cti;
+		sram_cti,
+		tdc_cti;
 
 wire [31:0]	bram_dat_r,
 		sram_dat_r,
@@ -268,6 +269,7 @@ conbus #(
 	.s4_dat_i(tdc_dat_r),
 	.s4_dat_o(tdc_dat_w),
 	.s4_adr_o(tdc_adr),
+	.s4_cti_o(tdc_cti),
 	.s4_we_o(tdc_we),
 	.s4_cyc_o(tdc_cyc),
 	.s4_stb_o(tdc_stb),
@@ -480,20 +482,24 @@ tdc_hostif #(
 	.g_FP_COUNT(13),
 	.g_EXHIS_COUNT(5),
 	.g_COARSE_COUNT(25),
+	.g_EPOCH_COUNT(26),
 	.g_RO_LENGTH(31),
 	.g_FCOUNTER_WIDTH(13),
-	.g_FTIMER_WIDTH(14)
+	.g_FTIMER_WIDTH(14),
+	.g_FIFO_DEPTH(256),
+	.g_MERGE_DELAY(16)
 ) tdc (
 	.rst_n_i(~sys_rst),
 	.wb_clk_i(sys_clk),
 
-	.wb_addr_i(tdc_adr[7:2]),
+	.wb_addr_i(tdc_adr[12:2]),
 	.wb_data_i(tdc_dat_w),
 	.wb_data_o(tdc_dat_r),
 	.wb_cyc_i(tdc_cyc),
 	.wb_sel_i(tdc_sel),
 	.wb_stb_i(tdc_stb),
 	.wb_we_i(tdc_we),
+	.wb_cti_i(tdc_cti),
 	.wb_ack_o(tdc_ack),
 	.wb_irq_o(tdc_irq),
 
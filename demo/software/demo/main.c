@@ -245,6 +245,9 @@ static void do_command(char *c)
 	else if(strcmp(token, "daclevel") == 0) daclevel(get_token(&c));
 	else if(strcmp(token, "mraw") == 0) mraw();
 	else if(strcmp(token, "diff") == 0) diff();
+	else if(strcmp(token, "hdiff") == 0) hdiff();
+	else if(strcmp(token, "dhist") == 0) dhist();
+	else if(strcmp(token, "stats") == 0) stats();
 	
 	else if(strcmp(token, "") != 0)
 		printf("Command not found\n");
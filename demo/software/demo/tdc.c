@@ -19,11 +19,14 @@
 #include <stdio.h>
 #include <uart.h>
 #include <hw/tdc.h>
+#include <hw/tdc_channel.h>
 
 #include "temperature.h"
 #include "tdc.h"
 
 static volatile struct TDC_WB *tdc = (void *)0xa0000000;
+static volatile struct TDC_CHANNEL *tdc_ch = (void *)(0xa0000000 + TDC_CHANNEL_OFFSET(0));
+static volatile unsigned int *tdc_evp0 = (void *)(0xa0000000 + TDC_EVP0_OFFSET);
 
 void tdc_reset()
 {
@@ -43,7 +46,7 @@ void rofreq()
     
     while(!readchar_nonblock()) {
         t = gettemp();
-        printf("%d.%04d", t/16, (t%16)*625);
+        printtemp(t);
         do {
             tdc->FCC = TDC_FCC_ST;
             while(!(tdc->FCC & TDC_FCC_RDY));
@@ -66,11 +69,16 @@ void calinfo()
     int channel;
     int i;
     int last;
+    int t;
     
     if(!(tdc->CS & TDC_CS_RDY)) {
         printf("Startup calibration not done\n");
         return;
     }
+    t = gettemp();
+    printf("TEMP: ");
+    printtemp(t);
+    printf("\n");
     tdc->DCTL = TDC_DCTL_REQ;
     while(!(tdc->DCTL & TDC_DCTL_ACK));
     
@@ -108,14 +116,18 @@ void mraw()
         printf("Startup calibration not done\n");
         return;
     }
-    tdc->EIC_IER = TDC_EIC_IER_IE0;
+    tdc_ch[0].CTL = TDC_CTL_IE;
+    *tdc_evp0 = 0x01;
     
     while(1) {
-        while(!(tdc->EIC_ISR & TDC_EIC_ISR_IE0)) {
-            if(readchar_nonblock()) return;
+        while(!(*tdc_evp0 & 0x01)) {
+            if(readchar_nonblock()) {
+                tdc_ch[0].CTL = 0;
+                return;
+            }
         }
-        printf("%d[%d]\n", tdc->RAW0, tdc->POL & 0x01);
-        tdc->EIC_ISR = TDC_EIC_ISR_IE0;
+        printf("%d[%d]\n", TDC_MPR_RAW_R(tdc_ch[0].MPR), !!(tdc_ch[0].MPR & TDC_MPR_POL));
+        *tdc_evp0 = 0x01;
     }
 }
 
@@ -135,18 +147,23 @@ void diff()
         printf("Startup calibration not done\n");
         return;
     }
-    tdc->EIC_IER = TDC_EIC_IER_IE0|TDC_EIC_IER_IE1;
+    tdc_ch[0].CTL = TDC_CTL_IE;
+    tdc_ch[1].CTL = TDC_CTL_IE;
+    *tdc_evp0 = 0x03;
     while(1) {
-        while((tdc->EIC_ISR & (TDC_EIC_ISR_IE0|TDC_EIC_IER_IE1)) != (TDC_EIC_ISR_IE0|TDC_EIC_IER_IE1)) {
-            if(readchar_nonblock()) return;
+        while((*tdc_evp0 & 0x03) != 0x03) {
+            if(readchar_nonblock()) {
+                tdc_ch[0].CTL = 0;
+                tdc_ch[1].CTL = 0;
+                return;
+            }
         }
-        pol0 = pol1 = tdc->POL;
-        pol0 = !!(pol0 & 0x01);
-        pol1 = !!(pol1 & 0x02);
-        ts0 = tdc->MESL0;
-        ts1 = tdc->MESL1;
-        rts0 = tdc->RAW0;
-        rts1 = tdc->RAW1;
+        pol0 = !!(tdc_ch[0].MPR & TDC_MPR_POL);
+        pol1 = !!(tdc_ch[1].MPR & TDC_MPR_POL);
+        ts0 = tdc_ch[0].MESL;
+        ts1 = tdc_ch[1].MESL;
+        rts0 = TDC_MPR_RAW_R(tdc_ch[0].MPR);
+        rts1 = TDC_MPR_RAW_R(tdc_ch[1].MPR);
         #ifdef CSV
         printf("%u,%u,%u,%u,%u,%u\n", pol0, rts0, ts0, pol1, rts1, ts1);
         #else
@@ -163,6 +180,75 @@ void diff()
         #endif
         if(pol0 != pol1)
             printf("Inconsistent polarities!\n");
-        tdc->EIC_ISR = TDC_EIC_ISR_IE0|TDC_EIC_ISR_IE1;
+        *tdc_evp0 = 0x03;
+    }
+}
+
+void hdiff()
+{
+    if(!(tdc->CS & TDC_CS_RDY)) {
+        printf("Startup calibration not done\n");
+        return;
+    }
+    /* requires the time difference unit (g_DIFF) */
+    tdc->DFGL = 0x80000000;
+    tdc->DFGH = 0x7fffffff;
+    tdc_ch[1].CTL = TDC_CTL_STOP;
+    tdc->DFC = TDC_DFC_EN|TDC_DFC_START_W(0);
+    while(!readchar_nonblock()) {
+        if(TDC_DFS_LVL_R(tdc->DFS))
+            printf("%d\n", (int)tdc->DFV);
+    }
+    printf("lost: %u\n", TDC_DFS_LOST_R(tdc->DFS));
+    tdc->DFC = 0;
+    tdc_ch[1].CTL = 0;
+}
+
+#define TDC_DHIST_DEPTH 1024
+#define TDC_DHIST_SHIFT 2
+
+void dhist()
+{
+    int i;
+    unsigned int count;
+    
+    if(!(tdc->CS & TDC_CS_RDY)) {
+        printf("Startup calibration not done\n");
+        return;
+    }
+    /* requires the time difference histogram (g_DIFF and g_DHIST) */
+    tdc->DFGL = 0x80000000;
+    tdc->DFGH = 0x7fffffff;
+    tdc_ch[1].CTL = TDC_CTL_STOP;
+    tdc->DFC = TDC_DFC_EN|TDC_DFC_START_W(0);
+    tdc->DHO = -((TDC_DHIST_DEPTH/2) << TDC_DHIST_SHIFT);
+    tdc->DHC = TDC_DHC_EN|TDC_DHC_CLR|TDC_DHC_SHIFT_W(TDC_DHIST_SHIFT);
+    while(!readchar_nonblock());
+    tdc->DHC = TDC_DHC_EN|TDC_DHC_FRZ|TDC_DHC_SHIFT_W(TDC_DHIST_SHIFT);
+    for(i=0;i<TDC_DHIST_DEPTH;i++) {
+        tdc->DHA = i;
+        count = tdc->DHD;
+        if(count)
+            printf("%d,%u\n", (i - TDC_DHIST_DEPTH/2)*(1 << TDC_DHIST_SHIFT), count);
+    }
+    printf("outside: %u\n", (unsigned int)tdc->DHX);
+    tdc->DHC = 0;
+    tdc->DFC = 0;
+    tdc_ch[1].CTL = 0;
+}
+
+#define TDC_CHANNEL_COUNT 2
+
+void stats()
+{
+    int i;
+    
+    /* one second gate at 125MHz */
+    if(tdc->RGATE != 125000000) {
+        tdc->RGATE = 125000000;
+        printf("Rate meter started, rates are valid after one second\n");
     }
+    for(i=0;i<TDC_CHANNEL_COUNT;i++)
+        printf("%d: hits %u, lost %u, rate %u/s\n", i,
+            (unsigned int)tdc_ch[i].CNTH, (unsigned int)tdc_ch[i].CNTL, (unsigned int)tdc_ch[i].CNTR);
 }
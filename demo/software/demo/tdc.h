@@ -24,5 +24,8 @@ void rofreq();
 void calinfo();
 void mraw();
 void diff();
+void hdiff();
+void dhist();
+void stats();
 
 #endif /* __TDC_H */
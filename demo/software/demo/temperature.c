@@ -104,10 +104,19 @@ int gettemp()
     return (((short)sp[1]) << 8) | ((short)sp[0]);
 }
 
+/* t is in 1/16 degC, the sign is printed separately so that the
+ * fraction of negative temperatures is correct */
+void printtemp(int t)
+{
+    if(t < 0) {
+        printf("-");
+        t = -t;
+    }
+    printf("%d.%04d", t/16, (t%16)*625);
+}
+
 void temp()
 {
-    int t;
-    
-    t = gettemp();
-    printf("%d.%04dC\n", t/16, (t%16)*625);
+    printtemp(gettemp());
+    printf("C\n");
 }
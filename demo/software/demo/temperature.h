@@ -20,6 +20,7 @@
 #define __TEMPERATURE_H
 
 int gettemp();
+void printtemp(int t);
 void temp();
 
 #endif /* __TEMPERATURE_H */
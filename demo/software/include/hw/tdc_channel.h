@@ -0,0 +1,154 @@
+/*
+  Register definitions for the register blocks of: TDC channel
+
+  * File           : tdc_channel.h
+  * Author         : auto-generated by genregs.py from channel.wb
+  * Standard       : ANSI C
+
+    THIS FILE WAS GENERATED BY genregs.py FROM SOURCE FILE channel.wb
+    DO NOT HAND-EDIT: CHANGE genwb.py AND REGENERATE IT
+
+*/
+
+#ifndef __WBGEN2_REGDEFS_CHANNEL_WB
+#define __WBGEN2_REGDEFS_CHANNEL_WB
+
+#include <inttypes.h>
+
+#if defined( __GNUC__)
+#define PACKED __attribute__ ((packed))
+#else
+#error "Unsupported compiler?"
+#endif
+
+#ifndef __WBGEN2_MACROS_DEFINED__
+#define __WBGEN2_MACROS_DEFINED__
+#define WBGEN2_GEN_MASK(offset, size) (((1<<(size))-1) << (offset))
+#define WBGEN2_GEN_WRITE(value, offset, size) (((value) & ((1<<(size))-1)) << (offset))
+#define WBGEN2_GEN_READ(reg, offset, size) (((reg) >> (offset)) & ((1<<(size))-1))
+#define WBGEN2_SIGN_EXTEND(value, bits) (((value) & (1<<bits) ? ~((1<<(bits))-1): 0 ) | (value))
+#endif
+
+/* byte offsets from the base of the core */
+#define TDC_EVP0_OFFSET                       0x100
+#define TDC_EVP1_OFFSET                       0x104
+#define TDC_CHANNEL_OFFSET(n)                 (0x1000 + 0x40*(n))
+#define TDC_MAX_CHANNELS                      64
+
+
+/* definitions for register: Deskew value, high word */
+
+/* definitions for register: Deskew value, low word */
+
+/* definitions for register: Channel control */
+
+/* definitions for field: Drop rising edges in reg: Channel control */
+#define TDC_CTL_RIS                           WBGEN2_GEN_MASK(0, 1)
+
+/* definitions for field: Drop falling edges in reg: Channel control */
+#define TDC_CTL_FAL                           WBGEN2_GEN_MASK(1, 1)
+
+/* definitions for field: Stop channel in reg: Channel control */
+#define TDC_CTL_STOP                          WBGEN2_GEN_MASK(2, 1)
+
+/* definitions for field: Interrupt enable in reg: Channel control */
+#define TDC_CTL_IE                            WBGEN2_GEN_MASK(3, 1)
+
+/* definitions for register: Hit filter */
+
+/* definitions for field: Dead time in reg: Hit filter */
+#define TDC_HF_DT_MASK                        WBGEN2_GEN_MASK(0, 16)
+#define TDC_HF_DT_SHIFT                       0
+#define TDC_HF_DT_W(value)                    WBGEN2_GEN_WRITE(value, 0, 16)
+#define TDC_HF_DT_R(reg)                      WBGEN2_GEN_READ(reg, 0, 16)
+
+/* definitions for field: Prescaler in reg: Hit filter */
+#define TDC_HF_PSC_MASK                       WBGEN2_GEN_MASK(16, 16)
+#define TDC_HF_PSC_SHIFT                      16
+#define TDC_HF_PSC_W(value)                   WBGEN2_GEN_WRITE(value, 16, 16)
+#define TDC_HF_PSC_R(reg)                     WBGEN2_GEN_READ(reg, 16, 16)
+
+/* definitions for register: Latest measurement polarity and raw value */
+
+/* definitions for field: Raw value in reg: Latest measurement polarity and raw value */
+#define TDC_MPR_RAW_MASK                      WBGEN2_GEN_MASK(0, 16)
+#define TDC_MPR_RAW_SHIFT                     0
+#define TDC_MPR_RAW_W(value)                  WBGEN2_GEN_WRITE(value, 0, 16)
+#define TDC_MPR_RAW_R(reg)                    WBGEN2_GEN_READ(reg, 0, 16)
+
+/* definitions for field: Polarity in reg: Latest measurement polarity and raw value */
+#define TDC_MPR_POL                           WBGEN2_GEN_MASK(16, 1)
+
+/* definitions for register: Latest measurement, high word */
+
+/* definitions for register: Latest measurement, low word */
+
+/* definitions for register: FIFO status */
+
+/* definitions for field: Fill level in reg: FIFO status */
+#define TDC_FST_LVL_MASK                      WBGEN2_GEN_MASK(0, 16)
+#define TDC_FST_LVL_SHIFT                     0
+#define TDC_FST_LVL_W(value)                  WBGEN2_GEN_WRITE(value, 0, 16)
+#define TDC_FST_LVL_R(reg)                    WBGEN2_GEN_READ(reg, 0, 16)
+
+/* definitions for field: Overflow count in reg: FIFO status */
+#define TDC_FST_OVF_MASK                      WBGEN2_GEN_MASK(16, 16)
+#define TDC_FST_OVF_SHIFT                     16
+#define TDC_FST_OVF_W(value)                  WBGEN2_GEN_WRITE(value, 16, 16)
+#define TDC_FST_OVF_R(reg)                    WBGEN2_GEN_READ(reg, 16, 16)
+
+/* definitions for register: FIFO head polarity and raw value */
+
+/* definitions for field: Raw value in reg: FIFO head polarity and raw value */
+#define TDC_FPR_RAW_MASK                      WBGEN2_GEN_MASK(0, 16)
+#define TDC_FPR_RAW_SHIFT                     0
+#define TDC_FPR_RAW_W(value)                  WBGEN2_GEN_WRITE(value, 0, 16)
+#define TDC_FPR_RAW_R(reg)                    WBGEN2_GEN_READ(reg, 0, 16)
+
+/* definitions for field: Polarity in reg: FIFO head polarity and raw value */
+#define TDC_FPR_POL                           WBGEN2_GEN_MASK(16, 1)
+
+/* definitions for register: FIFO head measurement, high word */
+
+/* definitions for register: FIFO head measurement, low word */
+
+/* definitions for register: Hit counter */
+
+/* definitions for register: Lost event counter */
+
+/* definitions for register: Rate meter */
+
+PACKED struct TDC_CHANNEL {
+  /* [0x0]: REG Deskew value, high word */
+  uint32_t DESH;
+  /* [0x4]: REG Deskew value, low word */
+  uint32_t DESL;
+  /* [0x8]: REG Channel control */
+  uint32_t CTL;
+  /* [0xc]: REG Hit filter */
+  uint32_t HF;
+  /* [0x10]: REG Latest measurement polarity and raw value */
+  uint32_t MPR;
+  /* [0x14]: REG Latest measurement, high word */
+  uint32_t MESH;
+  /* [0x18]: REG Latest measurement, low word */
+  uint32_t MESL;
+  /* [0x1c]: REG FIFO status */
+  uint32_t FST;
+  /* [0x20]: REG FIFO head polarity and raw value */
+  uint32_t FPR;
+  /* [0x24]: REG FIFO head measurement, high word */
+  uint32_t FMH;
+  /* [0x28]: REG FIFO head measurement, low word */
+  uint32_t FML;
+  /* [0x2c]: REG Hit counter */
+  uint32_t CNTH;
+  /* [0x30]: REG Lost event counter */
+  uint32_t CNTL;
+  /* [0x34]: REG Rate meter */
+  uint32_t CNTR;
+  /* padding to: 16 words */
+  uint32_t __padding_0[2];
+};
+
+#endif
@@ -0,0 +1,596 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Computes the overlapping Allan deviation, the modified Allan deviation
+ * and the time deviation of a series of timestamps, for logarithmically
+ * spaced averaging times.
+ *
+ * The timestamps are the MESH:MESL fixed-point values of the events of one
+ * channel, taken as the phase samples of a periodic signal. Inputs:
+ *   CSV, one timestamp per line
+ *   CSV, output of the "diff" command (pol0,raw0,ts0,pol1,raw1,ts1)
+ *   CSV, tdcconv events format (channel,polarity,raw,timestamp)
+ *   TDCF files written by tdcconv
+ *   raw binary, little endian 64-bit timestamps (-b)
+ * Timestamps that wrap around (such as the 32-bit MESL values printed by
+ * "diff") are unwrapped with -W.
+ *
+ * The series is processed in blocks as it is read. For an averaging
+ * factor m, the ADEV and MDEV terms ending at each new sample only need
+ * the last 3m phase values and their prefix sums. Up to m = -M, they are
+ * taken from the full rate series. Larger factors are rounded to a
+ * multiple of 2^L and use the series decimated by 2^L, i.e. the terms
+ * whose start index is a multiple of 2^L, so that every history buffer
+ * holds at most 3*M entries and memory does not depend on the length of
+ * the capture. Each averaging time costs O(n); they are distributed
+ * among threads.
+ *
+ * Phase values are exact integers and the prefix sums are 128-bit, so
+ * the second differences do not lose precision on long captures.
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "tdcfile.h"
+
+#define MAX_TAUS	(1024)
+#define MAX_LEVELS	(48)
+#define MAX_THREADS	(64)
+#define BLOCK		(1 << 20)
+
+typedef __int128 int128_t;
+
+struct level {
+	int64_t *x;		/* phase, relative to the first sample */
+	int128_t *p;		/* sum of the phase values before each entry */
+	size_t keep;		/* history kept between blocks */
+	size_t capacity;
+	size_t count;		/* valid entries */
+	size_t fresh;		/* first entry of the current block */
+	uint64_t total;		/* entries appended since the start */
+};
+
+struct tau {
+	uint64_t m;
+	int level;
+	uint64_t mm;		/* m at the decimated rate */
+	long double adev_sum, mdev_sum;
+	uint64_t adev_n, mdev_n;
+};
+
+static struct level levels[MAX_LEVELS];
+static int nlevels;
+static struct tau taus[MAX_TAUS];
+static int ntaus;
+static int nthreads;
+
+static uint64_t nsamples;
+static int64_t first_ts, last_ts;
+static int128_t prefix;
+static uint64_t nonmonotonic;
+static int closing;
+
+static int build_taus(int per_decade, uint64_t dense)
+{
+	uint64_t m, prev;
+	double e;
+	int k, l;
+	
+	prev = 0;
+	for(k=0;;k++) {
+		e = pow(10.0, (double)k/per_decade);
+		if(e > 1e15)
+			break;
+		m = llround(e);
+		l = 0;
+		while((m >> l) > dense)
+			l++;
+		if(l >= MAX_LEVELS)
+			break;
+		if(l > 0)
+			m = ((m + (1ULL << (l-1))) >> l) << l;
+		if(m <= prev)
+			continue;
+		if(ntaus == MAX_TAUS)
+			break;
+		taus[ntaus].m = m;
+		taus[ntaus].level = l;
+		taus[ntaus].mm = m >> l;
+		ntaus++;
+		prev = m;
+		if(l + 1 > nlevels)
+			nlevels = l + 1;
+	}
+	for(l=0;l<nlevels;l++) {
+		for(k=0;k<ntaus;k++)
+			if((taus[k].level == l) && (3*taus[k].mm > levels[l].keep))
+				levels[l].keep = 3*taus[k].mm;
+		levels[l].capacity = levels[l].keep + (BLOCK >> l) + 1;
+		levels[l].x = malloc(levels[l].capacity*sizeof(int64_t));
+		levels[l].p = malloc(levels[l].capacity*sizeof(int128_t));
+		if((levels[l].x == NULL) || (levels[l].p == NULL)) {
+			perror("malloc");
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void update_tau(struct tau *t)
+{
+	struct level *l = &levels[t->level];
+	const int64_t *x = l->x;
+	const int128_t *p = l->p;
+	uint64_t g0, mm;
+	size_t i, start;
+	double sa, sm, s;
+	int64_t d;
+	int128_t q;
+	
+	mm = t->mm;
+	/* global index of the first buffered entry */
+	g0 = l->total - l->count;
+	
+	/* ADEV: second differences of the phase */
+	sa = 0.0;
+	start = l->fresh;
+	if(g0 + start < 2*mm)
+		start = 2*mm - g0;
+	if(closing)
+		start = l->count;
+	for(i=start;i<l->count;i++) {
+		d = x[i] - 2*x[i-mm] + x[i-2*mm];
+		sa += (double)d*(double)d;
+	}
+	if(start < l->count) {
+		t->adev_sum += sa;
+		t->adev_n += l->count - start;
+	}
+	
+	/* MDEV: second differences of the phase averaged over m samples */
+	sm = 0.0;
+	start = l->fresh;
+	if(g0 + start < 3*mm)
+		start = 3*mm - g0;
+	for(i=start;i<l->count;i++) {
+		q = p[i] - 3*p[i-mm] + 3*p[i-2*mm] - p[i-3*mm];
+		s = (double)q;
+		sm += s*s;
+	}
+	if(start < l->count) {
+		t->mdev_sum += sm;
+		t->mdev_n += l->count - start;
+	}
+}
+
+static void *worker(void *arg)
+{
+	int k;
+	
+	for(k=(long)arg;k<ntaus;k+=nthreads)
+		update_tau(&taus[k]);
+	return NULL;
+}
+
+static void process_block()
+{
+	pthread_t threads[MAX_THREADS];
+	struct level *l;
+	long i;
+	int j;
+	
+	for(i=1;i<nthreads;i++)
+		if(pthread_create(&threads[i], NULL, worker, (void *)i) != 0) {
+			perror("pthread_create");
+			exit(1);
+		}
+	worker((void *)0);
+	for(i=1;i<nthreads;i++)
+		pthread_join(threads[i], NULL);
+	
+	/* keep the history needed by the next block */
+	for(j=0;j<nlevels;j++) {
+		l = &levels[j];
+		if(l->count > l->keep) {
+			memmove(l->x, l->x + l->count - l->keep, l->keep*sizeof(int64_t));
+			memmove(l->p, l->p + l->count - l->keep, l->keep*sizeof(int128_t));
+			l->count = l->keep;
+		}
+		l->fresh = l->count;
+	}
+}
+
+static void add_sample(int64_t ts)
+{
+	struct level *l;
+	int64_t x;
+	int j;
+	
+	if(nsamples == 0)
+		first_ts = ts;
+	else if(ts <= last_ts)
+		nonmonotonic++;
+	last_ts = ts;
+	x = ts - first_ts;
+	
+	for(j=0;j<nlevels;j++) {
+		if(nsamples & ((1ULL << j) - 1))
+			break;
+		l = &levels[j];
+		l->x[l->count] = x;
+		l->p[l->count] = prefix;
+		l->count++;
+		l->total++;
+	}
+	prefix += x;
+	nsamples++;
+	if(levels[0].count - levels[0].fresh == BLOCK)
+		process_block();
+}
+
+/*
+ * The last MDEV term of each averaging time ends with the last sample and
+ * needs the sum of all phase values, which no entry holds yet. Append it
+ * to the levels it falls on, without a phase value.
+ */
+static void finish()
+{
+	struct level *l;
+	int j;
+	
+	if(levels[0].count > levels[0].fresh)
+		process_block();
+	for(j=0;j<nlevels;j++) {
+		if(nsamples & ((1ULL << j) - 1))
+			break;
+		l = &levels[j];
+		l->x[l->count] = 0;
+		l->p[l->count] = prefix;
+		l->count++;
+		l->total++;
+	}
+	closing = 1;
+	process_block();
+}
+
+/*
+ * Input
+ */
+static int channel;
+static int polarity = -1;
+static int wrap_bits = -1;
+static int64_t wrap_prev;
+static int wrap_started;
+
+static void add_timestamp(int64_t ts)
+{
+	uint64_t mask;
+	
+	if(wrap_bits > 0) {
+		mask = (wrap_bits < 64) ? (1ULL << wrap_bits) - 1 : ~0ULL;
+		if(!wrap_started) {
+			wrap_prev = ts & mask;
+			wrap_started = 1;
+		} else
+			wrap_prev += (uint64_t)(ts - wrap_prev) & mask;
+		ts = wrap_prev;
+	}
+	add_sample(ts);
+}
+
+enum {
+	CSV_SINGLE,
+	CSV_DIFF,
+	CSV_EVENTS
+};
+
+static int split(const char *line, int64_t *v, int max)
+{
+	char *end;
+	int n;
+	
+	n = 0;
+	while(n < max) {
+		while(*line == ' ') line++;
+		v[n] = strtoll(line, &end, 10);
+		if(end == line)
+			return 0;
+		n++;
+		line = end;
+		while(*line == ' ') line++;
+		if(*line != ',')
+			break;
+		line++;
+	}
+	while(isspace(*line)) line++;
+	return *line == 0 ? n : 0;
+}
+
+static int read_csv(FILE *fd)
+{
+	char *line;
+	size_t size;
+	int64_t v[8];
+	int n, format, fields;
+	
+	line = NULL;
+	size = 0;
+	format = -1;
+	fields = 0;
+	while(getline(&line, &size, fd) != -1) {
+		n = split(line, v, 8);
+		if(n == 0)
+			continue;
+		if(format < 0) {
+			fields = n;
+			switch(n) {
+				case 1: format = CSV_SINGLE; break;
+				case 6: format = CSV_DIFF; break;
+				case 4: format = CSV_EVENTS; break;
+				default:
+					fprintf(stderr, "Unrecognized CSV format (%d columns)\n", n);
+					free(line);
+					return 0;
+			}
+			if((format == CSV_DIFF) && (wrap_bits < 0))
+				wrap_bits = 32;
+			if((format == CSV_DIFF) && (channel > 1)) {
+				fprintf(stderr, "The diff format has 2 channels\n");
+				free(line);
+				return 0;
+			}
+		}
+		if(n != fields)
+			continue;
+		switch(format) {
+			case CSV_SINGLE:
+				add_timestamp(v[0]);
+				break;
+			case CSV_DIFF:
+				if((polarity < 0) || (v[3*channel] == polarity))
+					add_timestamp(v[3*channel+2]);
+				break;
+			case CSV_EVENTS:
+				if((v[0] == channel) && ((polarity < 0) || (v[1] == polarity)))
+					add_timestamp(v[3]);
+				break;
+		}
+	}
+	free(line);
+	return 1;
+}
+
+static int read_raw(FILE *fd)
+{
+	static uint8_t buf[65536];
+	size_t n, i;
+	int64_t ts;
+	int j;
+	
+	while((n = fread(buf, 8, sizeof(buf)/8, fd)) > 0) {
+		for(i=0;i<n;i++) {
+			ts = 0;
+			for(j=7;j>=0;j--)
+				ts = (ts << 8) | buf[8*i+j];
+			add_timestamp(ts);
+		}
+	}
+	return !ferror(fd);
+}
+
+static int read_tdcf(const char *filename)
+{
+	struct tdcf_reader *r;
+	uint64_t *ts;
+	uint8_t *pol;
+	int chunk, n, i, max, ok;
+	
+	r = tdcf_open(filename);
+	if(r == NULL)
+		return 0;
+	if(channel >= tdcf_channels(r)) {
+		fprintf(stderr, "%s has %d channel(s)\n", filename, tdcf_channels(r));
+		tdcf_close(r);
+		return 0;
+	}
+	max = 0;
+	for(chunk=0;chunk<tdcf_chunks(r);chunk++)
+		if(tdcf_count(r, chunk, channel) > max)
+			max = tdcf_count(r, chunk, channel);
+	ts = malloc((max + 1)*sizeof(uint64_t));
+	pol = malloc(max + 1);
+	if((ts == NULL) || (pol == NULL)) {
+		perror("malloc");
+		exit(1);
+	}
+	ok = 1;
+	for(chunk=0;chunk<tdcf_chunks(r);chunk++) {
+		n = tdcf_read_timestamps(r, chunk, channel, ts);
+		if((n >= 0) && (polarity >= 0) && (tdcf_read_polarities(r, chunk, channel, pol) != n))
+			n = -1;
+		if(n < 0) {
+			fprintf(stderr, "%s: chunk %d is corrupted\n", filename, chunk);
+			ok = 0;
+			break;
+		}
+		for(i=0;i<n;i++)
+			if((polarity < 0) || (pol[i] == polarity))
+				add_timestamp(ts[i]);
+	}
+	free(pol);
+	free(ts);
+	tdcf_close(r);
+	return ok;
+}
+
+static int is_tdcf(const char *filename)
+{
+	char magic[4];
+	FILE *fd;
+	int r;
+	
+	fd = fopen(filename, "rb");
+	if(fd == NULL)
+		return 0;
+	r = (fread(magic, 1, 4, fd) == 4) && (memcmp(magic, "TDCF", 4) == 0);
+	fclose(fd);
+	return r;
+}
+
+static void usage()
+{
+	fprintf(stderr, "Usage: adev [options] [<file>]\n");
+	fprintf(stderr, "  -c <n>        channel (default 0)\n");
+	fprintf(stderr, "  -e <0|1>      only use events of this polarity\n");
+	fprintf(stderr, "  -b            raw binary input (little endian 64-bit)\n");
+	fprintf(stderr, "  -W <bits>     unwrap timestamps of this width (default 32 for diff CSV)\n");
+	fprintf(stderr, "  -P <ps>       clock period (default 8000)\n");
+	fprintf(stderr, "  -F <n>        g_FP_COUNT (default 13)\n");
+	fprintf(stderr, "  -u <s>        timestamp unit, overrides -P and -F\n");
+	fprintf(stderr, "  -T <s>        nominal event period (default: mean)\n");
+	fprintf(stderr, "  -d <n>        averaging times per decade (default 10)\n");
+	fprintf(stderr, "  -M <n>        largest undecimated averaging factor (default 4096)\n");
+	fprintf(stderr, "  -t <threads>  number of threads\n");
+	fprintf(stderr, "Reads the standard input if no file is given.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *filename;
+	double period_ps, unit, tau0, tau, a, m, td;
+	int fp_count, per_decade, binary;
+	uint64_t dense;
+	FILE *fd;
+	int opt, k, ok;
+	
+	period_ps = 8000.0;
+	fp_count = 13;
+	unit = 0.0;
+	tau0 = 0.0;
+	per_decade = 10;
+	dense = 4096;
+	binary = 0;
+	nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	while((opt = getopt(argc, argv, "c:e:bW:P:F:u:T:d:M:t:")) != -1) {
+		switch(opt) {
+			case 'c':
+				channel = atoi(optarg);
+				break;
+			case 'e':
+				polarity = atoi(optarg);
+				break;
+			case 'b':
+				binary = 1;
+				break;
+			case 'W':
+				wrap_bits = atoi(optarg);
+				break;
+			case 'P':
+				period_ps = atof(optarg);
+				break;
+			case 'F':
+				fp_count = atoi(optarg);
+				break;
+			case 'u':
+				unit = atof(optarg);
+				break;
+			case 'T':
+				tau0 = atof(optarg);
+				break;
+			case 'd':
+				per_decade = atoi(optarg);
+				break;
+			case 'M':
+				dense = strtoull(optarg, NULL, 0);
+				break;
+			case 't':
+				nthreads = atoi(optarg);
+				break;
+			default:
+				usage();
+				return 1;
+		}
+	}
+	if((argc - optind > 1) || (channel < 0) || (polarity > 1) || (wrap_bits > 64)
+	  || (per_decade < 1) || (dense < 1) || (period_ps <= 0.0) || (fp_count < 0)) {
+		usage();
+		return 1;
+	}
+	if(nthreads < 1) nthreads = 1;
+	if(nthreads > MAX_THREADS) nthreads = MAX_THREADS;
+	if(unit <= 0.0)
+		unit = period_ps*1e-12/ldexp(1.0, fp_count);
+	
+	if(!build_taus(per_decade, dense))
+		return 1;
+	
+	filename = optind < argc ? argv[optind] : "-";
+	if((strcmp(filename, "-") != 0) && is_tdcf(filename))
+		ok = read_tdcf(filename);
+	else {
+		if(strcmp(filename, "-") == 0)
+			fd = stdin;
+		else {
+			fd = fopen(filename, binary ? "rb" : "r");
+			if(fd == NULL) {
+				perror("Unable to open input file");
+				return 1;
+			}
+		}
+		ok = binary ? read_raw(fd) : read_csv(fd);
+		if(fd != stdin)
+			fclose(fd);
+	}
+	if(!ok)
+		return 1;
+	if(nsamples < 3) {
+		fprintf(stderr, "Not enough samples\n");
+		return 1;
+	}
+	finish();
+	if(tau0 <= 0.0)
+		tau0 = (double)(last_ts - first_ts)*unit/(nsamples - 1);
+	fprintf(stderr, "%llu samples, tau0=%.6g s", (unsigned long long)nsamples, tau0);
+	if(nonmonotonic)
+		fprintf(stderr, ", %llu non-increasing timestamp(s)", (unsigned long long)nonmonotonic);
+	fprintf(stderr, "\n");
+	
+	printf("tau,m,adev,adev_terms,mdev,mdev_terms,tdev\n");
+	for(k=0;k<ntaus;k++) {
+		if(taus[k].adev_n == 0)
+			break;
+		tau = taus[k].m*tau0;
+		a = sqrtl(taus[k].adev_sum/(2.0L*taus[k].adev_n))*unit/tau;
+		printf("%.6e,%llu,%.6e,%llu", tau, (unsigned long long)taus[k].m,
+			a, (unsigned long long)taus[k].adev_n);
+		if(taus[k].mdev_n > 0) {
+			m = sqrtl(taus[k].mdev_sum/(2.0L*taus[k].mdev_n))*unit/(taus[k].m*tau);
+			td = tau*m/sqrt(3.0);
+			printf(",%.6e,%llu,%.6e\n", m, (unsigned long long)taus[k].mdev_n, td);
+		} else
+			printf(",,,\n");
+	}
+	return 0;
+}
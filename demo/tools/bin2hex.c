@@ -16,56 +16,198 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+#define LANES 4
+
+static const char hexdigits[16] = "0123456789abcdef";
+
+static void usage()
+{
+	fprintf(stderr, "Usage: bin2hex <infile> <outfile> <size> <pos>\n");
+	fprintf(stderr, "       bin2hex [-m <memfile>] <infile> <outprefix> <size>\n");
+	fprintf(stderr, "The second form writes all byte lanes at once to <outprefix>.h0\n");
+	fprintf(stderr, "(LSB) to <outprefix>.h3 (MSB), and optionally the 32-bit words\n");
+	fprintf(stderr, "to <memfile>.\n");
+}
+
+static int write_file(const char *name, const char *data, size_t length)
+{
+	int fd;
+	ssize_t r;
+	
+	fd = open(name, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+	if(fd == -1) {
+		perror("Unable to open output file");
+		return 0;
+	}
+	while(length > 0) {
+		r = write(fd, data, length);
+		if(r <= 0) {
+			perror("Unable to write output file");
+			close(fd);
+			return 0;
+		}
+		data += r;
+		length -= r;
+	}
+	if(close(fd) != 0) {
+		perror("Unable to close output file");
+		return 0;
+	}
+	return 1;
+}
 
 int main(int argc, char *argv[])
 {
-	int i;
-	int pad;
+	const char *memfile;
+	const char *infile, *outname;
+	int opt;
+	long arg;
+	char *end;
+	size_t size;
 	int pos;
-	FILE *fdi, *fdo;
-	unsigned char w[4];
+	int fd;
+	struct stat st;
+	const unsigned char *image;
+	size_t words, lines;
+	size_t i;
+	int lane;
+	char *lanebuf[LANES];
+	char *membuf;
+	char *o;
+	char name[1024];
+	int ret;
 	
-	if(argc != 5) {
-		fprintf(stderr, "Usage: bin2hex <infile> <outfile> <size> <pos>\n");
+	memfile = NULL;
+	while((opt = getopt(argc, argv, "m:")) != -1) {
+		switch(opt) {
+			case 'm':
+				memfile = optarg;
+				break;
+			default:
+				usage();
+				return 1;
+		}
+	}
+	argc -= optind;
+	argv += optind;
+	if((argc != 3) && ((argc != 4) || (memfile != NULL))) {
+		usage();
 		return 1;
 	}
-	pad = atoi(argv[3]);
-	if(pad <= 0) {
+	infile = argv[0];
+	outname = argv[1];
+	arg = strtol(argv[2], &end, 10);
+	if((*end != 0) || (arg <= 0)) {
 		fprintf(stderr, "Incorrect size\n");
 		return 1;
 	}
-	pos = atoi(argv[4]);
-	if((pos <= 0)||(pos > 4)) {
-		fprintf(stderr, "Incorrect position\n");
-		return 1;
+	size = arg;
+	pos = 0;
+	if(argc == 4) {
+		pos = atoi(argv[3]);
+		if((pos <= 0)||(pos > 4)) {
+			fprintf(stderr, "Incorrect position\n");
+			return 1;
+		}
 	}
-	pos--;
-	fdi = fopen(argv[1], "rb");
-	if(!fdi) {
+	
+	fd = open(infile, O_RDONLY);
+	if(fd == -1) {
 		perror("Unable to open input file");
 		return 1;
 	}
-	fdo = fopen(argv[2], "w");
-	if(!fdo) {
-		perror("Unable to open output file");
-		fclose(fdi);
+	if(fstat(fd, &st) == -1) {
+		perror("Unable to stat input file");
+		close(fd);
 		return 1;
 	}
-	while(1) {
-		if(fread(w, 4, 1, fdi) <= 0) break;
-		fprintf(fdo, "%02hhx\n", w[pos]);
-		pad--;
+	/* Trailing bytes that do not make a complete word are ignored */
+	words = st.st_size/4;
+	image = NULL;
+	if(words > 0) {
+		image = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(image == MAP_FAILED) {
+			perror("Unable to map input file");
+			close(fd);
+			return 1;
+		}
 	}
-	fclose(fdi);
-	if(pad < 0)
+	close(fd);
+	
+	if(words > size)
 		fprintf(stderr, "Warning: Input binary is larger than specified size\n");
-	for(i=0;i<pad;i++)
-		fprintf(fdo, "00\n");
-	if(fclose(fdo) != 0) {
-		perror("Unable to close output file");
-		return 1;
+	lines = words > size ? words : size;
+	
+	/* Format everything in memory: "xx\n" per byte, "xxxxxxxx\n" per word */
+	for(lane=0;lane<LANES;lane++) {
+		lanebuf[lane] = malloc(3*lines);
+		if(lanebuf[lane] == NULL) {
+			perror("Unable to allocate memory");
+			return 1;
+		}
+	}
+	membuf = NULL;
+	if(memfile != NULL) {
+		membuf = malloc(9*lines);
+		if(membuf == NULL) {
+			perror("Unable to allocate memory");
+			return 1;
+		}
+	}
+	for(i=0;i<words;i++) {
+		const unsigned char *w = &image[4*i];
+		
+		/* Words are big endian: lane 0 holds the LSB */
+		for(lane=0;lane<LANES;lane++) {
+			o = &lanebuf[lane][3*i];
+			o[0] = hexdigits[w[LANES-1-lane] >> 4];
+			o[1] = hexdigits[w[LANES-1-lane] & 0x0f];
+			o[2] = '\n';
+		}
+		if(membuf != NULL) {
+			o = &membuf[9*i];
+			for(lane=0;lane<LANES;lane++) {
+				o[2*lane] = hexdigits[w[lane] >> 4];
+				o[2*lane+1] = hexdigits[w[lane] & 0x0f];
+			}
+			o[8] = '\n';
+		}
+	}
+	for(;i<lines;i++) {
+		for(lane=0;lane<LANES;lane++)
+			memcpy(&lanebuf[lane][3*i], "00\n", 3);
+		if(membuf != NULL)
+			memcpy(&membuf[9*i], "00000000\n", 9);
 	}
-	return 0;
+	if(image != NULL)
+		munmap((void *)image, st.st_size);
+	
+	ret = 0;
+	if(pos != 0) {
+		/* Legacy single lane mode, pos selects the byte within the word */
+		if(!write_file(outname, lanebuf[LANES-pos], 3*lines))
+			ret = 1;
+	} else {
+		for(lane=0;lane<LANES;lane++) {
+			snprintf(name, sizeof(name), "%s.h%d", outname, lane);
+			if(!write_file(name, lanebuf[lane], 3*lines))
+				ret = 1;
+		}
+		if((memfile != NULL) && !write_file(memfile, membuf, 9*lines))
+			ret = 1;
+	}
+	
+	for(lane=0;lane<LANES;lane++)
+		free(lanebuf[lane]);
+	free(membuf);
+	return ret;
 }
@@ -0,0 +1,263 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cross-checks the calibration model against the "HIS WR" and "LUT WR"
+ * reports of the tb_controller test bench, or measures the speed of
+ * the model.
+ */
+
+#include <sys/time.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "tdccal.h"
+
+static void usage()
+{
+	fprintf(stderr, "Usage: calcheck [options] [<ghdl output>]\n");
+	fprintf(stderr, "       calcheck [options] -b <LUT builds>\n");
+	fprintf(stderr, "Options (defaults match tb_controller):\n");
+	fprintf(stderr, "  --raw <n>      g_RAW_COUNT (3)\n");
+	fprintf(stderr, "  --fp <n>       g_FP_COUNT (5)\n");
+	fprintf(stderr, "  --exhis <n>    g_EXHIS_COUNT (2)\n");
+	fprintf(stderr, "  --fcw <n>      g_FCOUNTER_WIDTH (3)\n");
+	fprintf(stderr, "  --freq <n>     current ring oscillator frequency (2)\n");
+	fprintf(stderr, "  --sfreq <n>    stored ring oscillator frequency (1)\n");
+	fprintf(stderr, "The GHDL output is read from the standard input if no file is given.\n");
+}
+
+static const struct option options[] = {
+	{ .name = "raw", .has_arg = 1, .val = 'r' },
+	{ .name = "fp", .has_arg = 1, .val = 'f' },
+	{ .name = "exhis", .has_arg = 1, .val = 'e' },
+	{ .name = "fcw", .has_arg = 1, .val = 'w' },
+	{ .name = "freq", .has_arg = 1, .val = 'q' },
+	{ .name = "sfreq", .has_arg = 1, .val = 's' },
+	{ .name = "bench", .has_arg = 1, .val = 'b' },
+	{ .name = NULL }
+};
+
+static int parse_write(const char *line, const char *tag, unsigned long *addr, unsigned long *data)
+{
+	const char *p;
+	
+	p = strstr(line, tag);
+	if(p == NULL) return 0;
+	return sscanf(p + strlen(tag), " addr=%lu data=%lu", addr, data) == 2;
+}
+
+static int check(const struct tdccal_config *c, FILE *fd, uint32_t freq, uint32_t sfreq)
+{
+	char line[512];
+	uint32_t entries;
+	uint32_t *his, *snapshot, *lut;
+	unsigned long addr, data;
+	unsigned long lineno;
+	uint64_t hits;
+	int errors;
+	int builds;
+	uint32_t expected_addr;
+	
+	entries = 1 << c->raw_count;
+	his = calloc(entries, sizeof(uint32_t));
+	snapshot = calloc(entries, sizeof(uint32_t));
+	lut = calloc(entries, sizeof(uint32_t));
+	if((his == NULL) || (snapshot == NULL) || (lut == NULL)) {
+		perror("Unable to allocate memory");
+		return 1;
+	}
+	
+	errors = 0;
+	builds = 0;
+	hits = 0;
+	lineno = 0;
+	expected_addr = 0;
+	while(fgets(line, sizeof(line), fd) != NULL) {
+		lineno++;
+		if(parse_write(line, "HIS WR:", &addr, &data)) {
+			if(addr >= entries) {
+				fprintf(stderr, "%lu: histogram address %lu out of range\n", lineno, addr);
+				errors++;
+				continue;
+			}
+			if(data == 0) {
+				/* Histogram clear */
+				if(addr == 0) hits = 0;
+			} else {
+				/* Booking increments the bin */
+				if(data != his[addr] + 1) {
+					fprintf(stderr, "%lu: HIS(%lu) written %lu, model %u\n",
+						lineno, addr, data, his[addr] + 1);
+					errors++;
+				}
+				hits++;
+			}
+			his[addr] = data;
+		} else if(parse_write(line, "LUT WR:", &addr, &data)) {
+			if(addr != expected_addr) {
+				fprintf(stderr, "%lu: LUT written at %lu, expected %u\n", lineno, addr, expected_addr);
+				errors++;
+				expected_addr = addr;
+			}
+			if(addr == 0) {
+				/* New LUT build: the histogram is complete */
+				if(hits != tdccal_hits(c)) {
+					fprintf(stderr, "%lu: %llu hits booked, model %llu\n", lineno,
+						(unsigned long long)hits, (unsigned long long)tdccal_hits(c));
+					errors++;
+				}
+				memcpy(snapshot, his, entries*sizeof(uint32_t));
+				tdccal_lut(c, snapshot, freq, sfreq, lut);
+				builds++;
+			}
+			if(addr < entries && data != lut[addr]) {
+				fprintf(stderr, "%lu: LUT(%lu) written %lu, model %u\n",
+					lineno, addr, data, lut[addr]);
+				errors++;
+			}
+			expected_addr = (addr + 1) % entries;
+		}
+	}
+	free(his);
+	free(snapshot);
+	free(lut);
+	
+	if(builds == 0) {
+		fprintf(stderr, "No LUT writes found\n");
+		return 1;
+	}
+	if(expected_addr != 0) {
+		fprintf(stderr, "Incomplete LUT build\n");
+		errors++;
+	}
+	printf("%d LUT build(s) checked, %d mismatch(es)\n", builds, errors);
+	return errors != 0;
+}
+
+static int bench(const struct tdccal_config *c, long count, uint32_t freq, uint32_t sfreq)
+{
+	uint32_t entries;
+	uint32_t *raw, *his, *lut;
+	uint64_t hits, i;
+	long n;
+	struct timeval t0, t1;
+	double seconds;
+	uint32_t checksum;
+	
+	entries = 1 << c->raw_count;
+	hits = tdccal_hits(c);
+	raw = malloc(hits*sizeof(uint32_t));
+	his = malloc(entries*sizeof(uint32_t));
+	lut = malloc(entries*sizeof(uint32_t));
+	if((raw == NULL) || (his == NULL) || (lut == NULL)) {
+		perror("Unable to allocate memory");
+		return 1;
+	}
+	/* Uneven, delay line like histogram */
+	srand(1);
+	for(i=0;i<hits;i++)
+		raw[i] = (rand() % entries)*(rand() % 4 != 0) % entries;
+	tdccal_book(c, raw, hits, his);
+	
+	checksum = 0;
+	gettimeofday(&t0, NULL);
+	for(n=0;n<count;n++) {
+		tdccal_lut(c, his, freq + (n & 7), sfreq, lut);
+		checksum += lut[entries/2];
+	}
+	gettimeofday(&t1, NULL);
+	seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_usec - t0.tv_usec)/1e6;
+	printf("%ld LUT builds of %u entries in %.3fs (%.0f builds/s, checksum %u)\n",
+		count, entries, seconds, (double)count/seconds, checksum);
+	free(raw);
+	free(his);
+	free(lut);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct tdccal_config c;
+	uint32_t freq, sfreq;
+	long builds;
+	int opt;
+	FILE *fd;
+	int r;
+	
+	c.raw_count = 3;
+	c.fp_count = 5;
+	c.exhis_count = 2;
+	c.fcounter_width = 3;
+	freq = 2;
+	sfreq = 1;
+	builds = 0;
+	while((opt = getopt_long(argc, argv, "b:", options, NULL)) != -1) {
+		switch(opt) {
+			case 'r':
+				c.raw_count = atoi(optarg);
+				break;
+			case 'f':
+				c.fp_count = atoi(optarg);
+				break;
+			case 'e':
+				c.exhis_count = atoi(optarg);
+				break;
+			case 'w':
+				c.fcounter_width = atoi(optarg);
+				break;
+			case 'q':
+				freq = strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				sfreq = strtoul(optarg, NULL, 0);
+				break;
+			case 'b':
+				builds = atol(optarg);
+				break;
+			default:
+				usage();
+				return 1;
+		}
+	}
+	if(!tdccal_check_config(&c)) {
+		fprintf(stderr, "Unsupported generics\n");
+		return 1;
+	}
+	if(builds > 0)
+		return bench(&c, builds, freq, sfreq);
+	
+	if(argc - optind > 1) {
+		usage();
+		return 1;
+	}
+	fd = stdin;
+	if(argc - optind == 1) {
+		fd = fopen(argv[optind], "r");
+		if(fd == NULL) {
+			perror("Unable to open input file");
+			return 1;
+		}
+	}
+	r = check(&c, fd, freq, sfreq);
+	if(fd != stdin)
+		fclose(fd);
+	return r;
+}
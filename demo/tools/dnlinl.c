@@ -0,0 +1,254 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Computes DNL, INL, bin width statistics, RMS quantization error and
+ * LUT-induced error from startup calibration histograms.
+ *
+ * Input is either calinfo output ("CHANNEL n", "HIST:" and "LUT:" lines),
+ * which can be streamed continuously on the standard input, or CSV files
+ * with one histogram per line and channel (e.g. doc/series3a_his.csv),
+ * optionally with the matching LUT file (-l).
+ */
+
+#define _GNU_SOURCE
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+
+#include "tdclin.h"
+
+#define MAX_BINS	(4096)
+#define MAX_CHANNELS	(64)
+
+static double period_ps = 8000.0;
+static int fp_count = 13;
+static FILE *fbins;
+static int snapshot;
+
+static int parse_values(const char *p, uint32_t *v)
+{
+	int n;
+	char *end;
+	
+	n = 0;
+	while(1) {
+		while((*p == ' ') || (*p == ',')) p++;
+		if(!isdigit(*p) || (n == MAX_BINS)) break;
+		v[n++] = strtoul(p, &end, 10);
+		p = end;
+	}
+	return n;
+}
+
+static void report(const char *source, int channel, const uint32_t *his, const uint32_t *lut, int n)
+{
+	static double dnl[MAX_BINS], inl[MAX_BINS], lut_err[MAX_BINS];
+	struct tdclin_result r;
+	int i;
+	
+	if(!tdclin_analyze(his, lut, n, period_ps, fp_count,
+	  dnl, inl, lut != NULL ? lut_err : NULL, &r)) {
+		printf("%s CHANNEL %d: empty histogram\n", source, channel);
+		return;
+	}
+	printf("%s CHANNEL %d: hits=%llu used=%d..%d zero=%d LSB=%.3fps width=%.3f..%.3fps std=%.3fps "
+		"DNL=%.3f..%.3f INL=%.3f..%.3f RMS=%.3fps",
+		source, channel, (unsigned long long)r.hits, r.first, r.last, r.zero,
+		r.lsb, r.width_min, r.width_max, r.width_std,
+		r.dnl_min, r.dnl_max, r.inl_min, r.inl_max, r.rms);
+	if(r.has_lut)
+		printf(" LUT=%.3fps(rms) %.3fps(max)", r.lut_rms, r.lut_max);
+	printf("\n");
+	fflush(stdout);
+	
+	if(fbins != NULL) {
+		for(i=0;i<n;i++) {
+			fprintf(fbins, "%d,%d,%d,%u,%f,%f,%f", snapshot, channel, i, his[i],
+				his[i]*period_ps/r.hits, dnl[i], inl[i]);
+			if(lut != NULL)
+				fprintf(fbins, ",%f", lut_err[i]);
+			fprintf(fbins, "\n");
+		}
+		fflush(fbins);
+	}
+	snapshot++;
+}
+
+/* calinfo captures, possibly a continuous stream */
+static void process_calinfo(const char *source, FILE *fd)
+{
+	static uint32_t his[MAX_BINS], lut[MAX_BINS];
+	char *line;
+	size_t size;
+	char *p;
+	int channel;
+	int nhis, nlut;
+	
+	line = NULL;
+	size = 0;
+	channel = 0;
+	nhis = 0;
+	while(getline(&line, &size, fd) != -1) {
+		if((p = strstr(line, "CHANNEL")) != NULL) {
+			if(nhis > 0) report(source, channel, his, NULL, nhis);
+			nhis = 0;
+			channel = atoi(p + 7);
+		} else if((p = strstr(line, "HIST:")) != NULL) {
+			if(nhis > 0) report(source, channel, his, NULL, nhis);
+			nhis = parse_values(p + 5, his);
+		} else if((p = strstr(line, "LUT:")) != NULL) {
+			nlut = parse_values(p + 4, lut);
+			if(nhis > 0) {
+				if(nlut == nhis)
+					report(source, channel, his, lut, nhis);
+				else {
+					fprintf(stderr, "%s: channel %d: LUT and histogram sizes differ\n", source, channel);
+					report(source, channel, his, NULL, nhis);
+				}
+			}
+			nhis = 0;
+		}
+	}
+	if(nhis > 0) report(source, channel, his, NULL, nhis);
+	free(line);
+}
+
+/* One histogram per line, and optionally one LUT per line in another file */
+static void process_csv(const char *source, FILE *fd, FILE *flut)
+{
+	static uint32_t his[MAX_BINS], lut[MAX_BINS];
+	char *line;
+	size_t size;
+	int channel;
+	int nhis, nlut;
+	
+	line = NULL;
+	size = 0;
+	channel = 0;
+	while(getline(&line, &size, fd) != -1) {
+		nhis = parse_values(line, his);
+		if(nhis == 0) continue;
+		nlut = 0;
+		if(flut != NULL) {
+			while((nlut == 0) && (getline(&line, &size, flut) != -1))
+				nlut = parse_values(line, lut);
+			if(nlut != nhis) {
+				fprintf(stderr, "%s: channel %d: no matching LUT\n", source, channel);
+				nlut = 0;
+			}
+		}
+		report(source, channel, his, nlut ? lut : NULL, nhis);
+		channel++;
+	}
+	free(line);
+}
+
+static int is_calinfo(FILE *fd)
+{
+	int c;
+	
+	/* CSV files start with a digit */
+	while(isspace(c = getc(fd)));
+	if(c != EOF) ungetc(c, fd);
+	return !isdigit(c);
+}
+
+static void usage()
+{
+	fprintf(stderr, "Usage: dnlinl [options] [<file>...]\n");
+	fprintf(stderr, "  -P <ps>     clock period (default 8000)\n");
+	fprintf(stderr, "  -F <n>      g_FP_COUNT, for the LUT values (default 13)\n");
+	fprintf(stderr, "  -l <file>   LUT CSV matching a histogram CSV\n");
+	fprintf(stderr, "  -v <file>   write per-bin results (CSV)\n");
+	fprintf(stderr, "Reads the standard input if no file is given.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	int opt;
+	const char *lutfile;
+	FILE *fd, *flut;
+	int i;
+	
+	lutfile = NULL;
+	while((opt = getopt(argc, argv, "P:F:l:v:")) != -1) {
+		switch(opt) {
+			case 'P':
+				period_ps = atof(optarg);
+				break;
+			case 'F':
+				fp_count = atoi(optarg);
+				break;
+			case 'l':
+				lutfile = optarg;
+				break;
+			case 'v':
+				fbins = fopen(optarg, "w");
+				if(fbins == NULL) {
+					perror("Unable to open output file");
+					return 1;
+				}
+				fprintf(fbins, "snapshot,channel,bin,hits,width_ps,dnl,inl,lut_err_ps\n");
+				break;
+			default:
+				usage();
+				return 1;
+		}
+	}
+	if((period_ps <= 0.0) || (fp_count < 1) || (fp_count > 30)) {
+		usage();
+		return 1;
+	}
+	
+	for(i=optind;(i<argc)||(i==optind);i++) {
+		const char *name = (i < argc) ? argv[i] : "-";
+		
+		if(strcmp(name, "-") == 0)
+			fd = stdin;
+		else {
+			fd = fopen(name, "r");
+			if(fd == NULL) {
+				perror(name);
+				return 1;
+			}
+		}
+		if(fd == stdin) name = "stdin";
+		if(is_calinfo(fd))
+			process_calinfo(name, fd);
+		else {
+			flut = NULL;
+			if(lutfile != NULL) {
+				flut = fopen(lutfile, "r");
+				if(flut == NULL) {
+					perror(lutfile);
+					return 1;
+				}
+			}
+			process_csv(name, fd, flut);
+			if(flut != NULL) fclose(flut);
+		}
+		if(fd != stdin) fclose(fd);
+		if(i >= argc) break;
+	}
+	if(fbins != NULL) fclose(fbins);
+	return 0;
+}
@@ -21,14 +21,17 @@
 #include <sys/stat.h>
 #include <sys/ioctl.h>
 #include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
 #include <string.h>
 #include <termios.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <poll.h>
-#include <fcntl.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <errno.h>
 #include <getopt.h>
 #include <sfl.h>
 
@@ -36,6 +39,15 @@
 #define DEFAULT_CMDLINEADR	(0x41000000)
 #define DEFAULT_INITRDADR	(0x41002000)
 
+#define MAX_PORTS		(32)
+#define TXBUF_SIZE		(1024)
+#define RXBUF_SIZE		(4096)
+#define TICK_MS			(100)
+#define REPLY_TIMEOUT_MS	(5000)
+#define STATUS_PERIOD_MS	(1000)
+
+#define ESCAPE_CHAR		(0x01) /* Ctrl-A */
+
 unsigned int crc16_table[256] = {
 	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
 	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
@@ -83,230 +95,612 @@ static unsigned short crc16(const void *_buffer, int len)
 	return crc;
 }
 
-static int write_exact(int fd, const char *data, unsigned int length)
+
+struct boot_config {
+	const char *kernel_image;
+	unsigned int kernel_address;
+	const char *cmdline;
+	unsigned int cmdline_address;
+	const char *initrd_image;
+	unsigned int initrd_address;
+};
+
+enum {
+	PORT_TERMINAL,
+	PORT_UPLOAD,
+	PORT_DEAD
+};
+
+/* Upload steps, in the order they are performed */
+enum {
+	STEP_KERNEL,
+	STEP_CMDLINE_LOAD,
+	STEP_CMDLINE_SET,
+	STEP_INITRD,
+	STEP_INITRD_START,
+	STEP_INITRD_END,
+	STEP_JUMP,
+	STEP_DONE
+};
+
+struct port {
+	int index;
+	const char *name;
+	int fd;
+	int state;
+	int recognized;
+	FILE *capture;
+	
+	/* Pending output to the device, drained with EPOLLOUT */
+	char txbuf[TXBUF_SIZE];
+	unsigned int txlen;
+	int want_out;
+	
+	/* Upload state */
+	int step;
+	int kernelfd;
+	int initrdfd;
+	int imagefd;
+	const char *image_name;
+	unsigned int image_address;
+	int image_length;
+	int image_position;
+	int initrd_length;
+	struct timeval image_t0;
+	struct sfl_frame frame;
+	int reply_wait_ms;
+};
+
+static const char sfl_magic_req[SFL_MAGIC_LEN] = SFL_MAGIC_REQ;
+static const char sfl_magic_ack[SFL_MAGIC_LEN] = SFL_MAGIC_ACK;
+
+static struct port ports[MAX_PORTS];
+static int nports;
+static int active_port;
+static int epollfd;
+static const struct boot_config *boot;
+
+/* Index of the port whose line is partially displayed, -1 at start of line */
+static int out_port = -1;
+
+static void start_line()
+{
+	if(out_port != -1) {
+		putchar('\n');
+		out_port = -1;
+	}
+}
+
+static void port_message(struct port *p, const char *fmt, ...)
+{
+	va_list args;
+	
+	start_line();
+	if(nports > 1)
+		printf("[FLTERM] [%d] ", p->index);
+	else
+		printf("[FLTERM] ");
+	va_start(args, fmt);
+	vprintf(fmt, args);
+	va_end(args);
+	fflush(stdout);
+}
+
+static void port_error(struct port *p, const char *what)
+{
+	int e;
+	
+	e = errno;
+	start_line();
+	fflush(stdout);
+	if(nports > 1)
+		fprintf(stderr, "[FLTERM] [%d] %s: %s\n", p->index, what, strerror(e));
+	else
+		fprintf(stderr, "[FLTERM] %s: %s\n", what, strerror(e));
+}
+
+static void port_update_events(struct port *p)
+{
+	struct epoll_event ev;
+	int want_out;
+	
+	want_out = p->txlen > 0;
+	if(want_out == p->want_out) return;
+	ev.events = EPOLLIN | (want_out ? EPOLLOUT : 0);
+	ev.data.u32 = p->index;
+	epoll_ctl(epollfd, EPOLL_CTL_MOD, p->fd, &ev);
+	p->want_out = want_out;
+}
+
+static void port_close(struct port *p)
+{
+	if(p->state == PORT_DEAD) return;
+	epoll_ctl(epollfd, EPOLL_CTL_DEL, p->fd, NULL);
+	close(p->fd);
+	if(p->kernelfd != -1) close(p->kernelfd);
+	if(p->initrdfd != -1) close(p->initrdfd);
+	p->kernelfd = -1;
+	p->initrdfd = -1;
+	p->state = PORT_DEAD;
+	port_message(p, "Port %s closed.\n", p->name);
+}
+
+static void port_flush(struct port *p)
 {
 	int r;
 	
-	while(length > 0) {
-		r = write(fd, data, length);
-		if(r <= 0) return 0;
-		length -= r;
-		data += r;
+	while(p->txlen > 0) {
+		r = write(p->fd, p->txbuf, p->txlen);
+		if(r < 0) {
+			if((errno == EAGAIN) || (errno == EINTR)) break;
+			port_error(p, "Unable to write to serial port");
+			port_close(p);
+			return;
+		}
+		p->txlen -= r;
+		memmove(p->txbuf, p->txbuf + r, p->txlen);
 	}
+	port_update_events(p);
+}
+
+/* Returns 0 if the port is closed or the data does not fit in the transmit
+ * buffer, in which case nothing is queued.
+ */
+static int port_queue(struct port *p, const char *data, unsigned int length)
+{
+	if(p->state == PORT_DEAD) return 0;
+	if(p->txlen + length > TXBUF_SIZE) return 0;
+	memcpy(p->txbuf + p->txlen, data, length);
+	p->txlen += length;
+	port_flush(p);
 	return 1;
 }
 
-/* length, cmd and payload must be filled in */
-static int send_frame(int serialfd, struct sfl_frame *frame)
+static void set_address(unsigned char *payload, unsigned int address)
+{
+	payload[0] = (address & 0xff000000) >> 24;
+	payload[1] = (address & 0x00ff0000) >> 16;
+	payload[2] = (address & 0x0000ff00) >> 8;
+	payload[3] = (address & 0x000000ff);
+}
+
+static void upload_end(struct port *p)
+{
+	if(p->kernelfd != -1) close(p->kernelfd);
+	if(p->initrdfd != -1) close(p->initrdfd);
+	p->kernelfd = -1;
+	p->initrdfd = -1;
+	p->state = PORT_TERMINAL;
+	p->recognized = 0;
+}
+
+/* length, cmd and payload of p->frame must be filled in */
+static void send_frame(struct port *p)
 {
 	unsigned short int crc;
-	int retry;
-	char reply;
 	
-	crc = crc16(&frame->cmd, frame->length+1);
-	frame->crc[0] = (crc & 0xff00) >> 8;
-	frame->crc[1] = (crc & 0x00ff);
+	crc = crc16(&p->frame.cmd, p->frame.length+1);
+	p->frame.crc[0] = (crc & 0xff00) >> 8;
+	p->frame.crc[1] = (crc & 0x00ff);
 	
-	retry = 0;
-	do {
-		if(!write_exact(serialfd, (char *)frame, frame->length+4)) {
-			perror("[FLTERM] Unable to write to serial port.");
-			return 0;
-		}
-		/* Get the reply from the device */
-		read(serialfd, &reply, 1); /* TODO: timeout */
-		switch(reply) {
-			case SFL_ACK_SUCCESS:
-				retry = 0;
-				break;
-			case SFL_ACK_CRCERROR:
-				retry = 1;
-				break;
-			default:
-				fprintf(stderr, "[FLTERM] Got unknown reply '%c' from the device, aborting.\n", reply);
-				return 0;
-		}
-	} while(retry);
-	return 1;
+	p->reply_wait_ms = 0;
+	if(!port_queue(p, (char *)&p->frame, p->frame.length+4)) {
+		if(p->state != PORT_DEAD)
+			port_message(p, "Transmit buffer full, aborting upload.\n");
+		upload_end(p);
+	}
 }
 
-static int upload_fd(int serialfd, const char *name, int firmwarefd, unsigned int load_address)
+static void image_begin(struct port *p, const char *name, int fd, unsigned int load_address)
+{
+	p->imagefd = fd;
+	p->image_name = name;
+	p->image_address = load_address;
+	p->image_length = lseek(fd, 0, SEEK_END);
+	p->image_position = 0;
+	lseek(fd, 0, SEEK_SET);
+	
+	port_message(p, "Uploading %s (%d bytes)...\n", name, p->image_length);
+	gettimeofday(&p->image_t0, NULL);
+}
+
+static int image_percent(struct port *p)
+{
+	if(p->image_length <= 0) return 100;
+	return 100*p->image_position/p->image_length;
+}
+
+/* Returns 1 if a load frame was sent, 0 at the end of the image, -1 on error */
+static int image_next(struct port *p)
 {
-	struct sfl_frame frame;
 	int readbytes;
-	int length;
-	int position;
-	unsigned int current_address;
-	struct timeval t0;
 	struct timeval t1;
 	int millisecs;
 	
-	length = lseek(firmwarefd, 0, SEEK_END);
-	lseek(firmwarefd, 0, SEEK_SET);
+	if(nports == 1) {
+		printf("%d%%\r", image_percent(p));
+		fflush(stdout);
+	}
 	
-	printf("[FLTERM] Uploading %s (%d bytes)...\n", name, length);
+	readbytes = read(p->imagefd, &p->frame.payload[4], sizeof(p->frame.payload) - 4);
+	if(readbytes < 0) {
+		port_error(p, "Unable to read image");
+		return -1;
+	}
+	if(readbytes > 0) {
+		p->frame.length = readbytes+4;
+		p->frame.cmd = SFL_CMD_LOAD;
+		set_address(p->frame.payload, p->image_address + p->image_position);
+		p->image_position += readbytes;
+		send_frame(p);
+		return 1;
+	}
 	
-	gettimeofday(&t0, NULL);
+	gettimeofday(&t1, NULL);
+	millisecs = (t1.tv_sec - p->image_t0.tv_sec)*1000 + (t1.tv_usec - p->image_t0.tv_usec)/1000;
+	if(millisecs <= 0) millisecs = 1;
+	port_message(p, "Upload complete (%.1fKB/s).\n", 1000.0*(double)p->image_length/((double)millisecs*1024.0));
+	return 0;
+}
+
+/* Sends the frame for the current step and moves to the next one */
+static void upload_next(struct port *p)
+{
+	int r;
 	
-	current_address = load_address;
-	position = 0;
 	while(1) {
-		printf("%d%%\r", 100*position/length);
-		fflush(stdout);
-	
-		readbytes = read(firmwarefd, &frame.payload[4], sizeof(frame.payload) - 4);
-		if(readbytes < 0) {
-			perror("[FLTERM] Unable to read image.");
-			return -1;
+		switch(p->step) {
+			case STEP_KERNEL:
+				r = image_next(p);
+				if(r < 0) {
+					upload_end(p);
+					return;
+				}
+				if(r > 0) return;
+				if(boot->cmdline != NULL)
+					p->step = STEP_CMDLINE_LOAD;
+				else if(p->initrdfd != -1) {
+					p->step = STEP_INITRD;
+					image_begin(p, "initrd", p->initrdfd, boot->initrd_address);
+				} else
+					p->step = STEP_JUMP;
+				break;
+			case STEP_CMDLINE_LOAD:
+				port_message(p, "Setting kernel command line: '%s'.\n", boot->cmdline);
+				p->frame.length = strlen(boot->cmdline)+1+4;
+				p->frame.cmd = SFL_CMD_LOAD;
+				set_address(p->frame.payload, boot->cmdline_address);
+				strcpy((char *)&p->frame.payload[4], boot->cmdline);
+				p->step = STEP_CMDLINE_SET;
+				send_frame(p);
+				return;
+			case STEP_CMDLINE_SET:
+				p->frame.length = 4;
+				p->frame.cmd = SFL_CMD_CMDLINE;
+				set_address(p->frame.payload, boot->cmdline_address);
+				if(p->initrdfd != -1) {
+					p->step = STEP_INITRD;
+					image_begin(p, "initrd", p->initrdfd, boot->initrd_address);
+				} else
+					p->step = STEP_JUMP;
+				send_frame(p);
+				return;
+			case STEP_INITRD:
+				r = image_next(p);
+				if(r > 0) return;
+				if((r < 0) || (p->image_length <= 0)) {
+					upload_end(p);
+					return;
+				}
+				p->initrd_length = p->image_length;
+				p->step = STEP_INITRD_START;
+				break;
+			case STEP_INITRD_START:
+				p->frame.length = 4;
+				p->frame.cmd = SFL_CMD_INITRDSTART;
+				set_address(p->frame.payload, boot->initrd_address);
+				p->step = STEP_INITRD_END;
+				send_frame(p);
+				return;
+			case STEP_INITRD_END:
+				p->frame.length = 4;
+				p->frame.cmd = SFL_CMD_INITRDEND;
+				set_address(p->frame.payload, boot->initrd_address + p->initrd_length - 1);
+				p->step = STEP_JUMP;
+				send_frame(p);
+				return;
+			case STEP_JUMP:
+				/* Send the jump command */
+				port_message(p, "Booting the device.\n");
+				p->frame.length = 4;
+				p->frame.cmd = SFL_CMD_JUMP;
+				set_address(p->frame.payload, boot->kernel_address);
+				p->step = STEP_DONE;
+				send_frame(p);
+				return;
+			case STEP_DONE:
+				port_message(p, "Done.\n");
+				upload_end(p);
+				return;
 		}
-		if(readbytes == 0) break;
-		
-		frame.length = readbytes+4;
-		frame.cmd = SFL_CMD_LOAD;
-		frame.payload[0] = (current_address & 0xff000000) >> 24;
-		frame.payload[1] = (current_address & 0x00ff0000) >> 16;
-		frame.payload[2] = (current_address & 0x0000ff00) >> 8;
-		frame.payload[3] = (current_address & 0x000000ff);
-		
-		if(!send_frame(serialfd, &frame)) return -1;
-		
-		current_address += readbytes;
-		position += readbytes;
 	}
+}
+
+static void upload_reply(struct port *p, char reply)
+{
+	switch(reply) {
+		case SFL_ACK_SUCCESS:
+			upload_next(p);
+			break;
+		case SFL_ACK_CRCERROR:
+			send_frame(p);
+			break;
+		default:
+			port_message(p, "Got unknown reply '%c' from the device, aborting.\n", reply);
+			upload_end(p);
+			break;
+	}
+}
+
+static void answer_magic(struct port *p)
+{
+	port_message(p, "Received firmware download request from the device.\n");
 	
-	gettimeofday(&t1, NULL);
+	if((boot->cmdline != NULL) && (strlen(boot->cmdline)+1 > (254-4))) {
+		port_message(p, "Kernel command line too long (request ignored).\n");
+		return;
+	}
+	p->kernelfd = open(boot->kernel_image, O_RDONLY);
+	if(p->kernelfd == -1) {
+		port_error(p, "Unable to open kernel image (request ignored)");
+		return;
+	}
+	p->initrdfd = -1;
+	if(boot->initrd_image != NULL) {
+		p->initrdfd = open(boot->initrd_image, O_RDONLY);
+		if(p->initrdfd == -1) {
+			port_error(p, "Unable to open initrd image (request ignored)");
+			close(p->kernelfd);
+			p->kernelfd = -1;
+			return;
+		}
+	}
 	
-	millisecs = (t1.tv_sec - t0.tv_sec)*1000 + (t1.tv_usec - t0.tv_usec)/1000;
+	if(!port_queue(p, sfl_magic_ack, SFL_MAGIC_LEN)) {
+		if(p->state != PORT_DEAD)
+			port_message(p, "Transmit buffer full (request ignored).\n");
+		upload_end(p);
+		return;
+	}
 	
-	printf("[FLTERM] Upload complete (%.1fKB/s).\n", 1000.0*(double)length/((double)millisecs*1024.0));
-	return length;
+	p->state = PORT_UPLOAD;
+	p->step = STEP_KERNEL;
+	image_begin(p, "kernel", p->kernelfd, boot->kernel_address);
+	upload_next(p);
 }
 
-static const char sfl_magic_req[SFL_MAGIC_LEN] = SFL_MAGIC_REQ;
-static const char sfl_magic_ack[SFL_MAGIC_LEN] = SFL_MAGIC_ACK;
-
-static void answer_magic(int serialfd,
-	const char *kernel_image, unsigned int kernel_address,
-	const char *cmdline, unsigned int cmdline_address,
-	const char *initrd_image, unsigned int initrd_address)
+/* Displays (and captures) data received from the device in terminal mode */
+static void port_output(struct port *p, const char *data, int length)
 {
-	int kernelfd, initrdfd;
-	struct sfl_frame frame;
+	int i;
 	
-	printf("[FLTERM] Received firmware download request from the device.\n");
+	if(p->capture != NULL)
+		fwrite(data, 1, length, p->capture);
+	if(nports == 1) {
+		fwrite(data, 1, length, stdout);
+		return;
+	}
+	for(i=0;i<length;i++) {
+		if(out_port != p->index) {
+			start_line();
+			printf("[%d] ", p->index);
+			out_port = p->index;
+		}
+		putchar(data[i]);
+		if(data[i] == '\n') out_port = -1;
+	}
+}
+
+static void port_input(struct port *p)
+{
+	char buffer[RXBUF_SIZE];
+	int r;
+	int i, start;
 	
-	kernelfd = open(kernel_image, O_RDONLY);
-	if(kernelfd == -1) {
-		perror("[FLTERM] Unable to open kernel image (request ignored).");
+	r = read(p->fd, buffer, sizeof(buffer));
+	if(r < 0) {
+		if((errno == EAGAIN) || (errno == EINTR)) return;
+		port_error(p, "Unable to read from serial port");
+		port_close(p);
 		return;
 	}
-	initrdfd = -1;
-	if(initrd_image != NULL) {
-		initrdfd = open(initrd_image, O_RDONLY);
-		if(initrdfd == -1) {
-			perror("[FLTERM] Unable to open initrd image (request ignored).");
-			close(kernelfd);
-			return;
+	if(r == 0) {
+		port_close(p);
+		return;
+	}
+	
+	start = 0;
+	for(i=0;i<r;i++) {
+		if(p->state == PORT_UPLOAD) {
+			/* Everything the device sends during an upload is a reply */
+			upload_reply(p, buffer[i]);
+			start = i+1;
+			continue;
+		}
+		if(p->state == PORT_DEAD) return;
+		if(buffer[i] == sfl_magic_req[p->recognized]) {
+			p->recognized++;
+			if(p->recognized == SFL_MAGIC_LEN) {
+				/* We've got the magic string ! */
+				p->recognized = 0;
+				port_output(p, &buffer[start], i+1-start);
+				start = i+1;
+				answer_magic(p);
+			}
+		} else {
+			if(buffer[i] == sfl_magic_req[0]) p->recognized = 1; else p->recognized = 0;
 		}
 	}
+	if((start < r) && (p->state == PORT_TERMINAL))
+		port_output(p, &buffer[start], r-start);
+	
+	if(p->capture != NULL)
+		fflush(p->capture);
+	fflush(stdout);
+}
+
+static const char *port_step_name(struct port *p)
+{
+	switch(p->state) {
+		case PORT_TERMINAL:
+			return "terminal";
+		case PORT_DEAD:
+			return "closed";
+	}
+	switch(p->step) {
+		case STEP_KERNEL:
+			return "kernel";
+		case STEP_CMDLINE_LOAD:
+		case STEP_CMDLINE_SET:
+			return "cmdline";
+		case STEP_INITRD:
+			return "initrd";
+		default:
+			return "boot";
+	}
+}
 
-	write_exact(serialfd, sfl_magic_ack, SFL_MAGIC_LEN);
+static void print_status()
+{
+	int i;
+	struct port *p;
 	
-	upload_fd(serialfd, "kernel", kernelfd, kernel_address);
-	if(cmdline != NULL) {
-		int len;
+	start_line();
+	printf("[FLTERM]");
+	for(i=0;i<nports;i++) {
+		p = &ports[i];
+		printf(" %c%d:%s %s", i == active_port ? '*' : ' ', i, p->name, port_step_name(p));
+		if((p->state == PORT_UPLOAD) && ((p->step == STEP_KERNEL) || (p->step == STEP_INITRD)))
+			printf(" %d%%", image_percent(p));
+	}
+	printf("\n");
+	fflush(stdout);
+}
 
-		printf("[FLTERM] Setting kernel command line: '%s'.\n", cmdline);
+static void select_port(int index)
+{
+	if((index < 0) || (index >= nports)) return;
+	active_port = index;
+	start_line();
+	printf("[FLTERM] Keyboard input goes to port %d (%s).\n", index, ports[index].name);
+	fflush(stdout);
+}
 
-		len = strlen(cmdline)+1;
-		if(len > (254-4)) {
-			fprintf(stderr, "[FLTERM] Kernel command line too long, load aborted.\n");
-			close(initrdfd);
-			close(kernelfd);
-			return;
+static void send_key(struct port *p, char c)
+{
+	if(!port_queue(p, &c, 1) && (p->state != PORT_DEAD))
+		port_message(p, "Transmit buffer full, keystroke dropped.\n");
+}
+
+/* Returns 0 when the user asked to quit */
+static int keyboard_input(int *escape)
+{
+	char buffer[256];
+	int r, i;
+	struct port *p;
+	
+	r = read(0, buffer, sizeof(buffer));
+	if(r <= 0) {
+		/* Keep monitoring the devices without keyboard input */
+		epoll_ctl(epollfd, EPOLL_CTL_DEL, 0, NULL);
+		return 1;
+	}
+	for(i=0;i<r;i++) {
+		p = &ports[active_port];
+		if(*escape) {
+			*escape = 0;
+			if((buffer[i] >= '0') && (buffer[i] <= '9'))
+				select_port(buffer[i] - '0');
+			else switch(buffer[i]) {
+				case 'n':
+					select_port((active_port + 1) % nports);
+					break;
+				case 'p':
+					select_port((active_port + nports - 1) % nports);
+					break;
+				case 's':
+					print_status();
+					break;
+				case 'q':
+					return 0;
+				case ESCAPE_CHAR:
+					if(p->state == PORT_TERMINAL)
+						send_key(p, buffer[i]);
+					break;
+			}
+			continue;
+		}
+		if((nports > 1) && (buffer[i] == ESCAPE_CHAR)) {
+			*escape = 1;
+			continue;
+		}
+		/* Keystrokes would corrupt an ongoing upload */
+		if(p->state == PORT_TERMINAL)
+			send_key(p, buffer[i]);
+	}
+	return 1;
+}
+
+/* Called every TICK_MS. Returns 0 when all ports are closed. */
+static int tick(int *status_ms)
+{
+	int i;
+	int alive, uploading;
+	struct port *p;
+	
+	alive = 0;
+	uploading = 0;
+	for(i=0;i<nports;i++) {
+		p = &ports[i];
+		if(p->state == PORT_DEAD) continue;
+		alive = 1;
+		if(p->state != PORT_UPLOAD) continue;
+		uploading = 1;
+		p->reply_wait_ms += TICK_MS;
+		if(p->reply_wait_ms >= REPLY_TIMEOUT_MS) {
+			port_message(p, "No reply from the device, aborting.\n");
+			upload_end(p);
 		}
-		frame.length = len+4;
-		frame.cmd = SFL_CMD_LOAD;
-		frame.payload[0] = (cmdline_address & 0xff000000) >> 24;
-		frame.payload[1] = (cmdline_address & 0x00ff0000) >> 16;
-		frame.payload[2] = (cmdline_address & 0x0000ff00) >> 8;
-		frame.payload[3] = (cmdline_address & 0x000000ff);
-		strcpy((char *)&frame.payload[4], cmdline);
-		send_frame(serialfd, &frame);
-
-		frame.length = 4;
-		frame.cmd = SFL_CMD_CMDLINE;
-		frame.payload[0] = (cmdline_address & 0xff000000) >> 24;
-		frame.payload[1] = (cmdline_address & 0x00ff0000) >> 16;
-		frame.payload[2] = (cmdline_address & 0x0000ff00) >> 8;
-		frame.payload[3] = (cmdline_address & 0x000000ff);
-		send_frame(serialfd, &frame);
-	}
-	if(initrdfd != -1) {
-		int len;
-		
-		len = upload_fd(serialfd, "initrd", initrdfd, initrd_address);
-		if(len <= 0) return;
-		
-		frame.length = 4;
-		frame.cmd = SFL_CMD_INITRDSTART;
-		frame.payload[0] = (initrd_address & 0xff000000) >> 24;
-		frame.payload[1] = (initrd_address & 0x00ff0000) >> 16;
-		frame.payload[2] = (initrd_address & 0x0000ff00) >> 8;
-		frame.payload[3] = (initrd_address & 0x000000ff);
-		send_frame(serialfd, &frame);
-
-		initrd_address += len-1;
-
-		frame.length = 4;
-		frame.cmd = SFL_CMD_INITRDEND;
-		frame.payload[0] = (initrd_address & 0xff000000) >> 24;
-		frame.payload[1] = (initrd_address & 0x00ff0000) >> 16;
-		frame.payload[2] = (initrd_address & 0x0000ff00) >> 8;
-		frame.payload[3] = (initrd_address & 0x000000ff);
-		send_frame(serialfd, &frame);
-	}
-
-	/* Send the jump command */
-	printf("[FLTERM] Booting the device.\n");
-	frame.length = 4;
-	frame.cmd = SFL_CMD_JUMP;
-	frame.payload[0] = (kernel_address & 0xff000000) >> 24;
-	frame.payload[1] = (kernel_address & 0x00ff0000) >> 16;
-	frame.payload[2] = (kernel_address & 0x0000ff00) >> 8;
-	frame.payload[3] = (kernel_address & 0x000000ff);
-	if(!send_frame(serialfd, &frame)) return;
-
-	printf("[FLTERM] Done.\n");
-
-	close(initrdfd);
-	close(kernelfd);
+	}
+	
+	/* Shared progress display while boards are being loaded */
+	if(uploading && (nports > 1)) {
+		*status_ms += TICK_MS;
+		if(*status_ms >= STATUS_PERIOD_MS) {
+			*status_ms = 0;
+			print_status();
+		}
+	} else
+		*status_ms = STATUS_PERIOD_MS;
+	
+	return alive;
 }
 
-static void do_terminal(char *serial_port,
-	int doublerate,
-	const char *kernel_image, unsigned int kernel_address,
-	const char *cmdline, unsigned int cmdline_address,
-	const char *initrd_image, unsigned int initrd_address)
+static int open_port(struct port *p, int doublerate, const char *capture_file)
 {
-	int serialfd;
 	struct termios my_termios;
-	char c;
-	int recognized;
-	struct pollfd fds[2];
-	int flags;
+	struct epoll_event ev;
 	
-	/* Open and configure the serial port */
-	serialfd = open(serial_port, O_RDWR|O_NOCTTY);
-	if(serialfd == -1) {
-		perror("Unable to open serial port");
-		return;
+	p->fd = open(p->name, O_RDWR|O_NOCTTY|O_NONBLOCK);
+	if(p->fd == -1) {
+		port_error(p, "Unable to open serial port");
+		return 0;
 	}
 	
 	/* Thanks to Julien Schmitt (GTKTerm) for figuring out the correct parameters
 	 * to put into that weird struct.
 	 */
-	tcgetattr(serialfd, &my_termios);
+	tcgetattr(p->fd, &my_termios);
 	my_termios.c_cflag = doublerate ? B230400 : B115200;
 	my_termios.c_cflag |= CS8;
 	my_termios.c_cflag |= CREAD;
@@ -316,55 +710,152 @@ static void do_terminal(char *serial_port,
 	my_termios.c_lflag = 0;
 	my_termios.c_cc[VTIME] = 0;
 	my_termios.c_cc[VMIN] = 1;
-	tcsetattr(serialfd, TCSANOW, &my_termios);
-	tcflush(serialfd, TCOFLUSH);
-	tcflush(serialfd, TCIFLUSH);
-	
-	/* Prepare the fdset for poll() */
-	fds[0].fd = 0;
-	fds[0].events = POLLIN;
-	fds[1].fd = serialfd;
-	fds[1].events = POLLIN;
-
-	recognized = 0;
-	flags = fcntl(serialfd, F_GETFL, 0);
+	tcsetattr(p->fd, TCSANOW, &my_termios);
+	tcflush(p->fd, TCOFLUSH);
+	tcflush(p->fd, TCIFLUSH);
+	
+	p->capture = NULL;
+	if(capture_file != NULL) {
+		p->capture = fopen(capture_file, "a");
+		if(p->capture == NULL) {
+			port_error(p, "Unable to open capture file");
+			close(p->fd);
+			return 0;
+		}
+	}
+	
+	p->state = PORT_TERMINAL;
+	p->recognized = 0;
+	p->txlen = 0;
+	p->want_out = 0;
+	p->kernelfd = -1;
+	p->initrdfd = -1;
+	
+	ev.events = EPOLLIN;
+	ev.data.u32 = p->index;
+	epoll_ctl(epollfd, EPOLL_CTL_ADD, p->fd, &ev);
+	return 1;
+}
+
+/* The first "%d" in the template is replaced with the port index.
+ * Otherwise, the index is appended when several ports are used.
+ */
+static char *capture_name(const char *template, int index)
+{
+	const char *d;
+	char *name;
+	
+	if(template == NULL) return NULL;
+	d = strstr(template, "%d");
+	if(d != NULL) {
+		/* The template is not a format string: any other '%' is kept */
+		if(asprintf(&name, "%.*s%d%s", (int)(d - template), template, index, d + 2) < 0)
+			return NULL;
+	} else if(nports > 1) {
+		if(asprintf(&name, "%s.%d", template, index) < 0)
+			return NULL;
+	} else
+		name = strdup(template);
+	return name;
+}
+
+#define EV_STDIN	(MAX_PORTS)
+#define EV_TIMER	(MAX_PORTS+1)
+
+static void do_terminal(char **serial_ports, int doublerate, const char *capture_template)
+{
+	struct epoll_event ev;
+	struct epoll_event events[MAX_PORTS+2];
+	struct itimerspec period;
+	int timerfd;
+	int i, n;
+	int opened;
+	char *capture_file;
+	int escape;
+	int status_ms;
+	uint64_t expirations;
+	
+	epollfd = epoll_create1(0);
+	if(epollfd == -1) {
+		perror("[FLTERM] Unable to create epoll instance");
+		return;
+	}
+	
+	opened = 0;
+	for(i=0;i<nports;i++) {
+		ports[i].index = i;
+		ports[i].name = serial_ports[i];
+		ports[i].state = PORT_DEAD;
+		capture_file = capture_name(capture_template, i);
+		if((capture_template != NULL) && (capture_file == NULL)) {
+			port_error(&ports[i], "Unable to build capture file name");
+			continue;
+		}
+		if(open_port(&ports[i], doublerate, capture_file))
+			opened++;
+		free(capture_file);
+	}
+	if(opened == 0) {
+		close(epollfd);
+		return;
+	}
+	active_port = 0;
+	while(ports[active_port].state == PORT_DEAD) active_port++;
+	
+	ev.events = EPOLLIN;
+	ev.data.u32 = EV_STDIN;
+	epoll_ctl(epollfd, EPOLL_CTL_ADD, 0, &ev);
+	
+	timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+	period.it_interval.tv_sec = 0;
+	period.it_interval.tv_nsec = TICK_MS*1000000;
+	period.it_value = period.it_interval;
+	timerfd_settime(timerfd, 0, &period, NULL);
+	ev.events = EPOLLIN;
+	ev.data.u32 = EV_TIMER;
+	epoll_ctl(epollfd, EPOLL_CTL_ADD, timerfd, &ev);
+	
+	if(nports > 1) {
+		print_status();
+		printf("[FLTERM] Ctrl-A then 0-9/n/p selects the port, s shows status, q quits.\n");
+		fflush(stdout);
+	}
+	
+	escape = 0;
+	status_ms = STATUS_PERIOD_MS;
 	while(1) {
-		fds[0].revents = 0;
-		fds[1].revents = 0;
-		
-		/* poll() behaves strangely when the serial port descriptor is in
-		 * blocking mode. So work around this.
-		 */
-		fcntl(serialfd, F_SETFL, flags|O_NONBLOCK);
-		if(poll(&fds[0], 2, -1) < 0) break;
-		fcntl(serialfd, F_SETFL, flags);
-		
-		if(fds[0].revents & POLLIN) {
-			read(0, &c, 1);
-			if(write(serialfd, &c, 1) <= 0) break;
+		n = epoll_wait(epollfd, events, MAX_PORTS+2, -1);
+		if(n < 0) {
+			if(errno == EINTR) continue;
+			break;
 		}
-		
-		if(fds[1].revents & POLLIN) {
-			if(read(serialfd, &c, 1) <= 0) break;
-			write(0, &c, 1);
-			
-			if(c == sfl_magic_req[recognized]) {
-				recognized++;
-				if(recognized == SFL_MAGIC_LEN) {
-					/* We've got the magic string ! */
-					recognized = 0;
-					answer_magic(serialfd,
-						kernel_image, kernel_address,
-						cmdline, cmdline_address,
-						initrd_image, initrd_address);
-				}
+		for(i=0;i<n;i++) {
+			if(events[i].data.u32 == EV_STDIN) {
+				if(!keyboard_input(&escape)) goto out;
+			} else if(events[i].data.u32 == EV_TIMER) {
+				read(timerfd, &expirations, sizeof(expirations));
+				if(!tick(&status_ms)) goto out;
 			} else {
-				if(c == sfl_magic_req[0]) recognized = 1; else recognized = 0;
+				struct port *p = &ports[events[i].data.u32];
+				
+				if(p->state == PORT_DEAD) continue;
+				if(events[i].events & EPOLLOUT)
+					port_flush(p);
+				if(events[i].events & (EPOLLIN|EPOLLERR|EPOLLHUP))
+					port_input(p);
 			}
 		}
 	}
-	
-	close(serialfd);
+out:
+	for(i=0;i<nports;i++) {
+		if(ports[i].state != PORT_DEAD) {
+			upload_end(&ports[i]);
+			close(ports[i].fd);
+		}
+		if(ports[i].capture != NULL) fclose(ports[i].capture);
+	}
+	close(timerfd);
+	close(epollfd);
 }
 
 enum {
@@ -375,7 +866,8 @@ enum {
 	OPTION_CMDLINE,
 	OPTION_CMDLINEADR,
 	OPTION_INITRD,
-	OPTION_INITRDADR
+	OPTION_INITRDADR,
+	OPTION_CAPTURE
 };
 
 static const struct option options[] = {
@@ -419,6 +911,11 @@ static const struct option options[] = {
 		.has_arg = 1,
 		.val = OPTION_INITRDADR
 	},
+	{
+		.name = "capture",
+		.has_arg = 1,
+		.val = OPTION_CAPTURE
+	},
 	{
 		.name = NULL
 	}
@@ -426,18 +923,23 @@ static const struct option options[] = {
 
 static void print_usage()
 {
-	fprintf(stderr, "Serial boot program for the Milkymist SoC - v. 1.1\n");
+	fprintf(stderr, "Serial boot program for the Milkymist SoC - v. 1.2\n");
 	fprintf(stderr, "Copyright (C) 2007, 2008, 2009 Sebastien Bourdeauducq\n\n");
 
 	fprintf(stderr, "This program is free software: you can redistribute it and/or modify\n");
 	fprintf(stderr, "it under the terms of the GNU General Public License as published by\n");
 	fprintf(stderr, "the Free Software Foundation, version 3 of the License.\n\n");
 
-	fprintf(stderr, "Usage: flterm --port <port> [--double-rate]\n");
+	fprintf(stderr, "Usage: flterm --port <port> [--port <port> ...] [--double-rate]\n");
 	fprintf(stderr, "              --kernel <kernel_image> [--kernel-adr <address>]\n");
 	fprintf(stderr, "              [--cmdline <cmdline> [--cmdline-adr <address>]]\n");
-	fprintf(stderr, "              [--initrd <initrd_image> [--initrd-adr <address>]]\n\n");
-	printf("Default load addresses:\n");
+	fprintf(stderr, "              [--initrd <initrd_image> [--initrd-adr <address>]]\n");
+	fprintf(stderr, "              [--capture <file>]\n\n");
+	fprintf(stderr, "Up to %d ports can be given. Each device is served independently.\n", MAX_PORTS);
+	fprintf(stderr, "With several ports, '%%d' in the capture file name is replaced\n");
+	fprintf(stderr, "with the port index (otherwise '.<index>' is appended), and\n");
+	fprintf(stderr, "Ctrl-A 0-9/n/p/s/q selects the port, shows status or quits.\n\n");
+	fprintf(stderr, "Default load addresses:\n");
 	fprintf(stderr, "  kernel:  0x%08x\n", DEFAULT_KERNELADR);
 	fprintf(stderr, "  cmdline: 0x%08x\n", DEFAULT_CMDLINEADR);
 	fprintf(stderr, "  initrd:  0x%08x\n", DEFAULT_INITRDADR);
@@ -446,26 +948,23 @@ static void print_usage()
 int main(int argc, char *argv[])
 {
 	int opt;
-	char *serial_port;
+	char *serial_ports[MAX_PORTS];
 	int doublerate;
-	char *kernel_image;
-	unsigned int kernel_address;
-	char *cmdline;
-	unsigned int cmdline_address;
-	char *initrd_image;
-	unsigned int initrd_address;
+	struct boot_config config;
+	char *capture_template;
 	char *endptr;
 	struct termios otty, ntty;
 	
 	/* Fetch command line arguments */
-	serial_port = NULL;
+	nports = 0;
 	doublerate = 0;
-	kernel_image = NULL;
-	kernel_address = DEFAULT_KERNELADR;
-	cmdline = NULL;
-	cmdline_address = DEFAULT_CMDLINEADR;
-	initrd_image = NULL;
-	initrd_address = DEFAULT_INITRDADR;
+	config.kernel_image = NULL;
+	config.kernel_address = DEFAULT_KERNELADR;
+	config.cmdline = NULL;
+	config.cmdline_address = DEFAULT_CMDLINEADR;
+	config.initrd_image = NULL;
+	config.initrd_address = DEFAULT_INITRDADR;
+	capture_template = NULL;
 	while((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
 		if(opt == '?') {
 			print_usage();
@@ -473,43 +972,47 @@ int main(int argc, char *argv[])
 		}
 		switch(opt) {
 			case OPTION_PORT:
-				free(serial_port);
-				serial_port = strdup(optarg);
+				if(nports == MAX_PORTS) {
+					fprintf(stderr, "Too many ports (max. %d)\n", MAX_PORTS);
+					return 1;
+				}
+				serial_ports[nports++] = strdup(optarg);
 				break;
 			case OPTION_DOUBLERATE:
 				doublerate = 1;
 				break;
 			case OPTION_KERNEL:
-				free(kernel_image);
-				kernel_image = strdup(optarg);
+				config.kernel_image = optarg;
 				break;
 			case OPTION_KERNELADR:
-				kernel_address = strtoul(optarg, &endptr, 0);
-				if(*endptr != 0) kernel_address = 0;
+				config.kernel_address = strtoul(optarg, &endptr, 0);
+				if(*endptr != 0) config.kernel_address = 0;
 				break;
 			case OPTION_CMDLINE:
-				free(cmdline);
-				cmdline = strdup(optarg);
+				config.cmdline = optarg;
 				break;
 			case OPTION_CMDLINEADR:
-				cmdline_address = strtoul(optarg, &endptr, 0);
-				if(*endptr != 0) cmdline_address = 0;
+				config.cmdline_address = strtoul(optarg, &endptr, 0);
+				if(*endptr != 0) config.cmdline_address = 0;
 				break;
 			case OPTION_INITRD:
-				free(initrd_image);
-				initrd_image = strdup(optarg);
+				config.initrd_image = optarg;
 				break;
 			case OPTION_INITRDADR:
-				initrd_address = strtoul(optarg, &endptr, 0);
-				if(*endptr != 0) initrd_address = 0;
+				config.initrd_address = strtoul(optarg, &endptr, 0);
+				if(*endptr != 0) config.initrd_address = 0;
+				break;
+			case OPTION_CAPTURE:
+				capture_template = optarg;
 				break;
 		}
 	}
 
-	if((serial_port == NULL) || (kernel_image == NULL)) {
+	if((nports == 0) || (config.kernel_image == NULL)) {
 		print_usage();
 		return 1;
 	}
+	boot = &config;
 
 	/* Banner */
 	printf("[FLTERM] Starting...\n");
@@ -521,10 +1024,7 @@ int main(int argc, char *argv[])
 	tcsetattr(0, TCSANOW, &ntty);
 	
 	/* Do the bulk of the work */
-	do_terminal(serial_port, doublerate,
-		kernel_image, kernel_address,
-		cmdline, cmdline_address,
-		initrd_image, initrd_address);
+	do_terminal(serial_ports, doublerate, capture_template);
 	
 	/* Restore stdin/out into their previous state */
 	tcsetattr(0, TCSANOW, &otty);
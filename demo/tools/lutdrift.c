@@ -0,0 +1,624 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compares many LUT dumps, like doc/lutdiff.py does for two of them.
+ *
+ * Accepted inputs (files, or directories that are scanned recursively):
+ *  - single or multi-line CSV files with one LUT per line (channel = line),
+ *  - captures of the calinfo command ("TEMP:", "CHANNEL n" and "LUT:" lines).
+ * The temperature is taken from the "TEMP:" line, or from a number followed
+ * by "C" in the file name (e.g. cal_36.9375C.txt).
+ */
+
+#define _GNU_SOURCE
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <math.h>
+#include <pthread.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define MAX_THREADS	(64)
+#define MAX_TAPS	(4096)
+
+/* LUT values are in units of 2^-13 clock periods of 8ns */
+#define PS_PER_LSB	(8000.0/8192.0)
+
+struct lut {
+	char *source;
+	int channel;
+	double temp;
+	int16_t *v;	/* padded to a multiple of 8 entries */
+};
+
+static struct lut *luts;
+static int nluts;
+static int luts_size;
+static int ntaps;	/* LUT length, taken from the first LUT */
+static int ntaps_padded;
+
+static double temp_from_name(const char *name)
+{
+	const char *p, *q;
+	char *end;
+	double t;
+	
+	p = strrchr(name, '/');
+	p = p ? p+1 : name;
+	for(q=p;*q;q++) {
+		if(!isdigit(*q) || ((q > p) && (isdigit(q[-1]) || (q[-1] == '.'))))
+			continue;
+		t = strtod(q, &end);
+		if((end != q) && (*end == 'C') && !isalpha(end[1]))
+			return (q > p) && (q[-1] == '-') ? -t : t;
+	}
+	return NAN;
+}
+
+static void add_lut(const char *source, int channel, double temp, const char *values)
+{
+	int16_t v[MAX_TAPS];
+	int n;
+	char *end;
+	long x;
+	struct lut *l;
+	
+	n = 0;
+	while(1) {
+		while((*values == ' ') || (*values == ',')) values++;
+		if(!isdigit(*values)) break;
+		x = strtol(values, &end, 10);
+		if(n == MAX_TAPS) break;
+		if((x < 0) || (x > 32767)) {
+			fprintf(stderr, "%s: value %ld out of range, LUT ignored\n", source, x);
+			return;
+		}
+		v[n++] = x;
+		values = end;
+	}
+	if(n == 0) return;
+	if(ntaps == 0) {
+		ntaps = n;
+		ntaps_padded = (n + 7) & ~7;
+	}
+	if(n != ntaps) {
+		fprintf(stderr, "%s: channel %d has %d entries instead of %d, LUT ignored\n",
+			source, channel, n, ntaps);
+		return;
+	}
+	if(nluts == luts_size) {
+		luts_size = luts_size ? 2*luts_size : 256;
+		luts = realloc(luts, luts_size*sizeof(struct lut));
+		if(luts == NULL) {
+			perror("Unable to allocate memory");
+			exit(1);
+		}
+	}
+	l = &luts[nluts++];
+	l->source = strdup(source);
+	l->channel = channel;
+	l->temp = temp;
+	l->v = calloc(ntaps_padded, sizeof(int16_t));
+	if((l->source == NULL) || (l->v == NULL)) {
+		perror("Unable to allocate memory");
+		exit(1);
+	}
+	memcpy(l->v, v, n*sizeof(int16_t));
+}
+
+static void load_file(const char *filename)
+{
+	FILE *fd;
+	char *line;
+	size_t size;
+	int first, line_channel, channel;
+	double temp;
+	char *p;
+	
+	fd = fopen(filename, "r");
+	if(fd == NULL) {
+		perror(filename);
+		return;
+	}
+	first = nluts;
+	temp = temp_from_name(filename);
+	line = NULL;
+	size = 0;
+	line_channel = 0;
+	channel = -1;
+	while(getline(&line, &size, fd) != -1) {
+		if((p = strstr(line, "TEMP:")) != NULL) {
+			/* calinfo prints the temperature before the channels */
+			temp = strtod(p + 5, NULL);
+		} else if((p = strstr(line, "CHANNEL")) != NULL) {
+			channel = atoi(p + 7);
+		} else if((p = strstr(line, "LUT:")) != NULL) {
+			add_lut(filename, channel < 0 ? 0 : channel, temp, p + 4);
+		} else if((channel < 0) && (strstr(line, "HIST:") == NULL)) {
+			/* plain CSV, one channel per line */
+			for(p=line;isspace(*p);p++);
+			if(isdigit(*p))
+				add_lut(filename, line_channel++, temp, p);
+		}
+	}
+	free(line);
+	fclose(fd);
+	/* A TEMP: line applies to all LUTs of the file */
+	for(;first<nluts;first++)
+		if(isnan(luts[first].temp))
+			luts[first].temp = temp;
+}
+
+static int compare_names(const void *a, const void *b)
+{
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+static void load(const char *path)
+{
+	struct stat st;
+	DIR *d;
+	struct dirent *e;
+	char **names;
+	int n, size, i;
+	char *full;
+	
+	if(stat(path, &st) == -1) {
+		perror(path);
+		return;
+	}
+	if(!S_ISDIR(st.st_mode)) {
+		load_file(path);
+		return;
+	}
+	d = opendir(path);
+	if(d == NULL) {
+		perror(path);
+		return;
+	}
+	/* Sorted, so that the LUT order does not depend on the file system */
+	names = NULL;
+	n = size = 0;
+	while((e = readdir(d)) != NULL) {
+		if(e->d_name[0] == '.') continue;
+		if(n == size) {
+			size = size ? 2*size : 64;
+			names = realloc(names, size*sizeof(char *));
+		}
+		names[n++] = strdup(e->d_name);
+	}
+	closedir(d);
+	qsort(names, n, sizeof(char *), compare_names);
+	for(i=0;i<n;i++) {
+		if(asprintf(&full, "%s/%s", path, names[i]) != -1) {
+			load(full);
+			free(full);
+		}
+		free(names[i]);
+	}
+	free(names);
+}
+
+/* Sum of squared differences and peak absolute difference, in LSBs */
+static void compare(const int16_t *a, const int16_t *b, uint64_t *ssd, int *peak)
+{
+	int i;
+#ifdef __SSE2__
+	__m128i acc32, acc64, vpeak, d, zero;
+	int j;
+	uint64_t s[2];
+	int16_t p[8];
+	
+	zero = _mm_setzero_si128();
+	acc64 = zero;
+	vpeak = zero;
+	for(i=0;i<ntaps_padded;) {
+		/* Each 32-bit lane takes at most 2*32767^2 per step: flush after 8 steps */
+		acc32 = zero;
+		for(j=0;(j<8)&&(i<ntaps_padded);j++,i+=8) {
+			d = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)&a[i]),
+				_mm_loadu_si128((const __m128i *)&b[i]));
+			acc32 = _mm_add_epi32(acc32, _mm_madd_epi16(d, d));
+			vpeak = _mm_max_epi16(vpeak, _mm_max_epi16(d, _mm_sub_epi16(zero, d)));
+		}
+		/* squares are positive: zero extend to 64 bits */
+		acc64 = _mm_add_epi64(acc64, _mm_unpacklo_epi32(acc32, zero));
+		acc64 = _mm_add_epi64(acc64, _mm_unpackhi_epi32(acc32, zero));
+	}
+	_mm_storeu_si128((__m128i *)s, acc64);
+	_mm_storeu_si128((__m128i *)p, vpeak);
+	*ssd = s[0] + s[1];
+	*peak = 0;
+	for(i=0;i<8;i++)
+		if(p[i] > *peak) *peak = p[i];
+#else
+	int d;
+	
+	*ssd = 0;
+	*peak = 0;
+	for(i=0;i<ntaps;i++) {
+		d = a[i] - b[i];
+		*ssd += d*d;
+		if(abs(d) > *peak) *peak = abs(d);
+	}
+#endif
+}
+
+struct pair_result {
+	uint64_t ssd;
+	int peak;
+};
+
+struct pairs_worker {
+	pthread_t thread;
+	int index;
+	int nthreads;
+	int *members;	/* LUT indices */
+	int n;
+	struct pair_result *results;	/* n*n, upper triangle */
+};
+
+static void *pairs_thread(void *arg)
+{
+	struct pairs_worker *w = arg;
+	int i, j;
+	
+	/* Rows are interleaved between threads to balance the triangle */
+	for(i=w->index;i<w->n;i+=w->nthreads)
+		for(j=i+1;j<w->n;j++)
+			compare(luts[w->members[i]].v, luts[w->members[j]].v,
+				&w->results[(size_t)i*w->n+j].ssd, &w->results[(size_t)i*w->n+j].peak);
+	return NULL;
+}
+
+static double ssd_ps2(uint64_t ssd)
+{
+	return (double)ssd*PS_PER_LSB*PS_PER_LSB;
+}
+
+/* Writes num/2^shift with 6 decimals. printf("%f") is too slow for
+ * millions of pairs, and LUT differences in ps are exact binary fractions.
+ */
+static char *format_fixed(char *p, uint64_t num, int shift)
+{
+	uint64_t ip, frac;
+	char tmp[24];
+	int i;
+	
+	ip = num >> shift;
+	frac = ((num & ((1ULL << shift) - 1))*1000000ULL + (1ULL << (shift-1))) >> shift;
+	if(frac == 1000000) {
+		ip++;
+		frac = 0;
+	}
+	i = 0;
+	do {
+		tmp[i++] = '0' + ip % 10;
+		ip /= 10;
+	} while(ip != 0);
+	while(i > 0)
+		*p++ = tmp[--i];
+	*p++ = '.';
+	for(i=5;i>=0;i--) {
+		p[i] = '0' + frac % 10;
+		frac /= 10;
+	}
+	return p + 6;
+}
+
+static void all_pairs(FILE *fo, int *members, int n, int nthreads)
+{
+	struct pairs_worker workers[MAX_THREADS];
+	struct pair_result *results;
+	char **labels;
+	int *label_lengths;
+	int i, j;
+	
+	results = malloc((size_t)n*n*sizeof(struct pair_result));
+	if(results == NULL) {
+		perror("Unable to allocate memory");
+		exit(1);
+	}
+	if(nthreads > n) nthreads = n > 0 ? n : 1;
+	for(i=0;i<nthreads;i++) {
+		workers[i].index = i;
+		workers[i].nthreads = nthreads;
+		workers[i].members = members;
+		workers[i].n = n;
+		workers[i].results = results;
+		pthread_create(&workers[i].thread, NULL, pairs_thread, &workers[i]);
+	}
+	for(i=0;i<nthreads;i++)
+		pthread_join(workers[i].thread, NULL);
+	labels = malloc(n*sizeof(char *));
+	label_lengths = malloc(n*sizeof(int));
+	if((labels == NULL) || (label_lengths == NULL)) {
+		perror("Unable to allocate memory");
+		exit(1);
+	}
+	for(i=0;i<n;i++) {
+		label_lengths[i] = asprintf(&labels[i], "%s,%f,", luts[members[i]].source, luts[members[i]].temp);
+		if(label_lengths[i] < 0) {
+			perror("Unable to allocate memory");
+			exit(1);
+		}
+	}
+	for(i=0;i<n;i++) {
+		for(j=i+1;j<n;j++) {
+			char line[64];
+			char *p;
+			
+			fprintf(fo, "%d,", luts[members[i]].channel);
+			fwrite(labels[i], 1, label_lengths[i], fo);
+			fwrite(labels[j], 1, label_lengths[j], fo);
+			/* (8000/8192)^2 = 15625/2^14, 8000/8192 = 125/2^7 */
+			p = format_fixed(line, results[(size_t)i*n+j].ssd*15625ULL, 14);
+			*p++ = ',';
+			p = format_fixed(p, results[(size_t)i*n+j].peak*125ULL, 7);
+			*p++ = '\n';
+			fwrite(line, 1, p - line, fo);
+		}
+	}
+	for(i=0;i<n;i++)
+		free(labels[i]);
+	free(labels);
+	free(label_lengths);
+	free(results);
+}
+
+struct cluster {
+	double temp;	/* mean temperature */
+	int n;
+	double *mean;	/* per tap, in LSBs */
+};
+
+static int compare_temp(const void *a, const void *b)
+{
+	double ta = luts[*(const int *)a].temp;
+	double tb = luts[*(const int *)b].temp;
+	
+	if(isnan(ta)) return isnan(tb) ? 0 : 1;
+	if(isnan(tb)) return -1;
+	return (ta > tb) - (ta < tb);
+}
+
+/* Groups the LUTs (sorted by temperature) into clusters no wider than step */
+static int make_clusters(int *members, int n, double step, struct cluster *clusters)
+{
+	int i, j, k, c;
+	
+	c = 0;
+	for(i=0;i<n;i=j) {
+		if(isnan(luts[members[i]].temp)) break;
+		for(j=i;(j<n) && !isnan(luts[members[j]].temp)
+		  && (luts[members[j]].temp - luts[members[i]].temp <= step);j++);
+		clusters[c].n = j - i;
+		clusters[c].temp = 0.0;
+		clusters[c].mean = calloc(ntaps, sizeof(double));
+		for(k=i;k<j;k++) {
+			int t;
+			
+			clusters[c].temp += luts[members[k]].temp;
+			for(t=0;t<ntaps;t++)
+				clusters[c].mean[t] += luts[members[k]].v[t];
+		}
+		clusters[c].temp /= clusters[c].n;
+		for(k=0;k<ntaps;k++)
+			clusters[c].mean[k] /= clusters[c].n;
+		c++;
+	}
+	return c;
+}
+
+static void usage()
+{
+	fprintf(stderr, "Usage: lutdrift [options] <file or directory>...\n");
+	fprintf(stderr, "  -r <file>   reference LUTs (default: coldest LUT of each channel)\n");
+	fprintf(stderr, "  -p <file>   write all-pairs differences (CSV)\n");
+	fprintf(stderr, "  -d <file>   write per-tap drift (ps/degC) and cluster means (CSV)\n");
+	fprintf(stderr, "  -s <step>   temperature cluster width in degC (default 1)\n");
+	fprintf(stderr, "  -t <n>      number of threads\n");
+}
+
+int main(int argc, char *argv[])
+{
+	int opt;
+	const char *reffile, *pairsfile, *driftfile;
+	double step;
+	int nthreads;
+	int i, j, ch, nch;
+	int *members;
+	int n;
+	FILE *fpairs, *fdrift;
+	struct timeval t0, t1;
+	int ref_first;
+	
+	reffile = pairsfile = driftfile = NULL;
+	step = 1.0;
+	nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	while((opt = getopt(argc, argv, "r:p:d:s:t:")) != -1) {
+		switch(opt) {
+			case 'r': reffile = optarg; break;
+			case 'p': pairsfile = optarg; break;
+			case 'd': driftfile = optarg; break;
+			case 's': step = atof(optarg); break;
+			case 't': nthreads = atoi(optarg); break;
+			default:
+				usage();
+				return 1;
+		}
+	}
+	if((optind == argc) || (step <= 0.0)) {
+		usage();
+		return 1;
+	}
+	if(nthreads < 1) nthreads = 1;
+	if(nthreads > MAX_THREADS) nthreads = MAX_THREADS;
+	
+	gettimeofday(&t0, NULL);
+	ref_first = 0;
+	if(reffile != NULL) {
+		load(reffile);
+		ref_first = nluts;
+		if(ref_first == 0) {
+			fprintf(stderr, "No reference LUT found\n");
+			return 1;
+		}
+	}
+	for(i=optind;i<argc;i++)
+		load(argv[i]);
+	if(nluts == ref_first) {
+		fprintf(stderr, "No LUT found\n");
+		return 1;
+	}
+	nch = 0;
+	for(i=0;i<nluts;i++)
+		if(luts[i].channel >= nch) nch = luts[i].channel + 1;
+	printf("%d LUTs of %d entries, %d channel(s)\n", nluts - ref_first, ntaps, nch);
+	
+	fpairs = fdrift = NULL;
+	if(pairsfile != NULL) {
+		fpairs = fopen(pairsfile, "w");
+		if(fpairs == NULL) {
+			perror("Unable to open pairs file");
+			return 1;
+		}
+		fprintf(fpairs, "channel,lut1,temp1,lut2,temp2,ssd_ps2,peak_ps\n");
+	}
+	if(driftfile != NULL) {
+		fdrift = fopen(driftfile, "w");
+		if(fdrift == NULL) {
+			perror("Unable to open drift file");
+			return 1;
+		}
+	}
+	
+	members = malloc(nluts*sizeof(int));
+	for(ch=0;ch<nch;ch++) {
+		struct lut *ref;
+		struct cluster *clusters;
+		int nclusters;
+		uint64_t ssd;
+		int peak;
+		
+		n = 0;
+		for(i=ref_first;i<nluts;i++)
+			if(luts[i].channel == ch)
+				members[n++] = i;
+		if(n == 0) continue;
+		qsort(members, n, sizeof(int), compare_temp);
+		
+		/* Against reference */
+		ref = &luts[members[0]];
+		for(i=0;i<ref_first;i++)
+			if(luts[i].channel == ch) {
+				ref = &luts[i];
+				break;
+			}
+		printf("\nCHANNEL %d: %d LUTs, reference %s", ch, n, ref->source);
+		if(!isnan(ref->temp))
+			printf(" (%.4fC)", ref->temp);
+		printf("\n");
+		for(i=0;i<n;i++) {
+			struct lut *l = &luts[members[i]];
+			
+			compare(l->v, ref->v, &ssd, &peak);
+			printf("%s", l->source);
+			if(!isnan(l->temp))
+				printf(" (%.4fC)", l->temp);
+			printf(": Sum of squares: %f Peak absolute: %f\n", ssd_ps2(ssd), peak*PS_PER_LSB);
+		}
+		
+		if(fpairs != NULL)
+			all_pairs(fpairs, members, n, nthreads);
+		
+		/* Temperature clusters and per-tap drift (least squares slope) */
+		clusters = calloc(n, sizeof(struct cluster));
+		nclusters = make_clusters(members, n, step, clusters);
+		for(i=0;i<nclusters;i++)
+			printf("Cluster %d: %.4fC, %d LUT(s)\n", i, clusters[i].temp, clusters[i].n);
+		if(nclusters >= 2) {
+			double tmean, stt;
+			double slope, maxslope;
+			int maxtap;
+			double sumslope;
+			
+			tmean = 0.0;
+			for(i=0;i<nclusters;i++)
+				tmean += clusters[i].temp;
+			tmean /= nclusters;
+			stt = 0.0;
+			for(i=0;i<nclusters;i++)
+				stt += (clusters[i].temp - tmean)*(clusters[i].temp - tmean);
+			if(fdrift != NULL) {
+				fprintf(fdrift, "channel,tap,drift_ps_per_degc");
+				for(i=0;i<nclusters;i++)
+					fprintf(fdrift, ",%.4fC", clusters[i].temp);
+				fprintf(fdrift, "\n");
+			}
+			maxslope = 0.0;
+			maxtap = 0;
+			sumslope = 0.0;
+			for(j=0;j<ntaps;j++) {
+				double vmean, stv;
+				
+				vmean = 0.0;
+				for(i=0;i<nclusters;i++)
+					vmean += clusters[i].mean[j];
+				vmean /= nclusters;
+				stv = 0.0;
+				for(i=0;i<nclusters;i++)
+					stv += (clusters[i].temp - tmean)*(clusters[i].mean[j] - vmean);
+				slope = stt > 0.0 ? stv/stt*PS_PER_LSB : 0.0;
+				sumslope += slope;
+				if(fabs(slope) > fabs(maxslope)) {
+					maxslope = slope;
+					maxtap = j;
+				}
+				if(fdrift != NULL) {
+					fprintf(fdrift, "%d,%d,%f", ch, j, slope);
+					for(i=0;i<nclusters;i++)
+						fprintf(fdrift, ",%f", clusters[i].mean[j]*PS_PER_LSB);
+					fprintf(fdrift, "\n");
+				}
+			}
+			printf("Drift: mean %f ps/degC, largest %f ps/degC at tap %d\n",
+				sumslope/ntaps, maxslope, maxtap);
+		}
+		for(i=0;i<nclusters;i++)
+			free(clusters[i].mean);
+		free(clusters);
+	}
+	free(members);
+	
+	if(fpairs != NULL) fclose(fpairs);
+	if(fdrift != NULL) fclose(fdrift);
+	gettimeofday(&t1, NULL);
+	fprintf(stderr, "Processed in %.3fs\n", (t1.tv_sec - t0.tv_sec) + (t1.tv_usec - t0.tv_usec)/1e6);
+	return 0;
+}
@@ -0,0 +1,465 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Computes the time difference statistics of a "diff" capture
+ * (pol0,raw0,ts0,pol1,raw1,ts1 per line), like doc/mhist.py, but in a
+ * single parallel pass over a memory mapped file.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <math.h>
+
+#define MAX_THREADS	(64)
+#define DEFAULT_BINS	(40)
+/* Largest span (in ticks) of the dense per-thread histogram */
+#define MAX_SPAN	(1 << 24)
+
+/* Same arithmetic as the script: (ts1-ts0)*8000/2^13 */
+#define TICKS_TO_PS(d)	((double)(d)*8000.0/8192.0)
+
+struct worker {
+	pthread_t thread;
+	const char *start;
+	const char *end;
+	const char *polarity;
+	
+	/* Results */
+	uint64_t n;
+	double mean;
+	double m2;
+	int64_t min;
+	int64_t max;
+	int64_t lo;		/* tick value of counts[0] */
+	uint64_t span;
+	uint64_t *counts;
+	int overflow;
+	int bad_lines;
+	
+	/* Second pass */
+	int nbins;
+	double first_edge;
+	double last_edge;
+	uint64_t *bins;
+};
+
+/* Returns a mask with the high bit set in each byte that is not an ASCII digit */
+static inline uint64_t nondigit_mask(uint64_t w)
+{
+	uint64_t t;
+	
+	t = w ^ 0x3030303030303030ULL;
+	/* bytes >= 10 after subtracting '0', or that underflowed */
+	return ((t + 0x7676767676767676ULL) | t) & 0x8080808080808080ULL;
+}
+
+/* Converts 8 ASCII digits (first digit in the lowest byte) */
+static inline uint64_t swar_8digits(uint64_t w)
+{
+	w -= 0x3030303030303030ULL;
+	w = (w * 10) + (w >> 8);
+	w = (((w & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)))
+		+ (((w >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+	return w;
+}
+
+/* Parses an unsigned decimal number. Returns the position after it, or NULL. */
+static const char *parse_uint(const char *p, const char *end, uint64_t *value)
+{
+	uint64_t v;
+	uint64_t w, m;
+	int len;
+	
+	v = 0;
+	len = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	while(end - p >= 8) {
+		memcpy(&w, p, 8);
+		m = nondigit_mask(w);
+		if(m == 0) {
+			v = v*100000000ULL + swar_8digits(w);
+			p += 8;
+			len += 8;
+			continue;
+		}
+		/* Fewer than 8 digits left: shift them to the top bytes */
+		len += __builtin_ctzll(m) >> 3;
+		if(m & 0xff) break;
+		{
+			int nd = __builtin_ctzll(m) >> 3;
+			uint64_t pow10 = 1;
+			int i;
+			
+			w <<= 8*(8 - nd);
+			w |= 0x3030303030303030ULL >> (8*nd);
+			for(i=0;i<nd;i++) pow10 *= 10;
+			v = v*pow10 + swar_8digits(w);
+			p += nd;
+		}
+		break;
+	}
+#endif
+	while((p < end) && (*p >= '0') && (*p <= '9')) {
+		v = v*10 + (*p - '0');
+		p++;
+		len++;
+	}
+	if(len == 0) return NULL;
+	*value = v;
+	return p;
+}
+
+/* Parses one line. Returns the start of the next line. */
+static const char *parse_line(const char *p, const char *end, uint64_t *fields, int *ok)
+{
+	int i;
+	const char *q;
+	
+	*ok = 1;
+	for(i=0;i<6;i++) {
+		q = parse_uint(p, end, &fields[i]);
+		if(q == NULL) {
+			*ok = 0;
+			break;
+		}
+		p = q;
+		if(i < 5) {
+			if((p == end) || (*p != ',')) {
+				*ok = 0;
+				break;
+			}
+			p++;
+		}
+	}
+	q = memchr(p, '\n', end - p);
+	if(q == NULL) return end;
+	if(*ok && (q != p) && !((q == p+1) && (*p == '\r'))) *ok = 0;
+	return q+1;
+}
+
+static int accept_polarity(const char *polarity, uint64_t pol)
+{
+	return (pol < 10) && (strchr(polarity, '0' + pol) != NULL);
+}
+
+static int grow(struct worker *w, int64_t d)
+{
+	int64_t lo, hi;
+	uint64_t span;
+	uint64_t *counts;
+	
+	if(w->counts == NULL) {
+		lo = d - 512;
+		hi = d + 512;
+	} else {
+		lo = w->lo;
+		hi = w->lo + w->span;
+		if(d < lo) lo = d - (int64_t)w->span;
+		if(d >= hi) hi = d + (int64_t)w->span;
+	}
+	span = hi - lo;
+	if(span > MAX_SPAN) {
+		/* Histogram will be computed in a second pass */
+		free(w->counts);
+		w->counts = NULL;
+		w->overflow = 1;
+		return 0;
+	}
+	counts = calloc(span, sizeof(uint64_t));
+	if(counts == NULL) {
+		free(w->counts);
+		w->counts = NULL;
+		w->overflow = 1;
+		return 0;
+	}
+	if(w->counts != NULL) {
+		memcpy(&counts[w->lo - lo], w->counts, w->span*sizeof(uint64_t));
+		free(w->counts);
+	}
+	w->counts = counts;
+	w->lo = lo;
+	w->span = span;
+	return 1;
+}
+
+static void *first_pass(void *arg)
+{
+	struct worker *w = arg;
+	const char *p;
+	uint64_t f[6];
+	int ok;
+	int64_t d;
+	double delta;
+	
+	p = w->start;
+	while(p < w->end) {
+		p = parse_line(p, w->end, f, &ok);
+		if(!ok) {
+			w->bad_lines++;
+			continue;
+		}
+		if(!accept_polarity(w->polarity, f[0])) continue;
+		d = (int64_t)f[5] - (int64_t)f[2];
+		
+		w->n++;
+		delta = (double)d - w->mean;
+		w->mean += delta/(double)w->n;
+		w->m2 += delta*((double)d - w->mean);
+		if((w->n == 1) || (d < w->min)) w->min = d;
+		if((w->n == 1) || (d > w->max)) w->max = d;
+		
+		if(!w->overflow) {
+			if((w->counts == NULL) || (d < w->lo) || (d >= w->lo + (int64_t)w->span))
+				grow(w, d);
+			if(!w->overflow)
+				w->counts[d - w->lo]++;
+		}
+	}
+	return NULL;
+}
+
+/* Same binning as numpy.histogram with uniform bins */
+static int bin_index(double x, int nbins, double first_edge, double last_edge)
+{
+	double norm;
+	int i;
+	
+	norm = nbins/(last_edge - first_edge);
+	i = (int)((x - first_edge)*norm);
+	if(i == nbins) i--;
+	if(x < first_edge + (last_edge - first_edge)*i/nbins) i--;
+	else if((i != nbins-1) && (x >= first_edge + (last_edge - first_edge)*(i+1)/nbins)) i++;
+	return i;
+}
+
+static void *second_pass(void *arg)
+{
+	struct worker *w = arg;
+	const char *p;
+	uint64_t f[6];
+	int ok;
+	
+	p = w->start;
+	while(p < w->end) {
+		p = parse_line(p, w->end, f, &ok);
+		if(!ok || !accept_polarity(w->polarity, f[0])) continue;
+		w->bins[bin_index(TICKS_TO_PS((int64_t)f[5] - (int64_t)f[2]), w->nbins, w->first_edge, w->last_edge)]++;
+	}
+	return NULL;
+}
+
+static void usage()
+{
+	fprintf(stderr, "Usage: mhist [-b <bins>] [-t <threads>] <capture.csv> <polarity>\n");
+	fprintf(stderr, "<polarity> lists the accepted polarities of channel 0, e.g. 0, 1 or 01.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	int opt;
+	int nbins;
+	int nthreads;
+	const char *filename;
+	const char *polarity;
+	int fd;
+	struct stat st;
+	const char *data;
+	struct worker workers[MAX_THREADS];
+	const char *p, *q;
+	int i;
+	uint64_t n;
+	double mean, m2, delta;
+	int64_t min, max;
+	int overflow;
+	int bad_lines;
+	double first_edge, last_edge;
+	uint64_t *bins;
+	
+	nbins = DEFAULT_BINS;
+	nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	while((opt = getopt(argc, argv, "b:t:")) != -1) {
+		switch(opt) {
+			case 'b':
+				nbins = atoi(optarg);
+				break;
+			case 't':
+				nthreads = atoi(optarg);
+				break;
+			default:
+				usage();
+				return 1;
+		}
+	}
+	if((argc - optind != 2) || (nbins <= 0)) {
+		usage();
+		return 1;
+	}
+	if(nthreads < 1) nthreads = 1;
+	if(nthreads > MAX_THREADS) nthreads = MAX_THREADS;
+	filename = argv[optind];
+	polarity = argv[optind+1];
+	
+	fd = open(filename, O_RDONLY);
+	if(fd == -1) {
+		perror("Unable to open input file");
+		return 1;
+	}
+	if(fstat(fd, &st) == -1) {
+		perror("Unable to stat input file");
+		return 1;
+	}
+	if(st.st_size == 0) {
+		fprintf(stderr, "Input file is empty\n");
+		return 1;
+	}
+	data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(data == MAP_FAILED) {
+		perror("Unable to map input file");
+		return 1;
+	}
+	close(fd);
+	madvise((void *)data, st.st_size, MADV_SEQUENTIAL);
+	
+	/* Split the file into chunks at line boundaries */
+	p = data;
+	for(i=0;i<nthreads;i++) {
+		memset(&workers[i], 0, sizeof(struct worker));
+		workers[i].polarity = polarity;
+		workers[i].start = p;
+		if(i == nthreads-1)
+			q = data + st.st_size;
+		else {
+			q = data + st.st_size*(i+1)/nthreads;
+			if(q < p) q = p;
+			q = memchr(q, '\n', data + st.st_size - q);
+			q = (q == NULL) ? data + st.st_size : q+1;
+		}
+		workers[i].end = q;
+		p = q;
+	}
+	for(i=0;i<nthreads;i++)
+		pthread_create(&workers[i].thread, NULL, first_pass, &workers[i]);
+	for(i=0;i<nthreads;i++)
+		pthread_join(workers[i].thread, NULL);
+	
+	/* Merge the moments (Chan et al.) */
+	n = 0;
+	mean = 0.0;
+	m2 = 0.0;
+	min = max = 0;
+	overflow = 0;
+	bad_lines = 0;
+	for(i=0;i<nthreads;i++) {
+		struct worker *w = &workers[i];
+		
+		bad_lines += w->bad_lines;
+		overflow |= w->overflow;
+		if(w->n == 0) continue;
+		if(n == 0) {
+			min = w->min;
+			max = w->max;
+		} else {
+			if(w->min < min) min = w->min;
+			if(w->max > max) max = w->max;
+		}
+		delta = w->mean - mean;
+		m2 += w->m2 + delta*delta*(double)n*(double)w->n/(double)(n + w->n);
+		mean += delta*(double)w->n/(double)(n + w->n);
+		n += w->n;
+	}
+	if(bad_lines > 0)
+		fprintf(stderr, "Warning: %d malformed line(s) ignored\n", bad_lines);
+	if(n == 0) {
+		fprintf(stderr, "No samples with polarity %s\n", polarity);
+		return 1;
+	}
+	
+	printf("%s Polarity: %s Samples: %llu\nMean: %f Std: %f P/p: %f\n",
+		filename, polarity, (unsigned long long)n,
+		TICKS_TO_PS(mean), TICKS_TO_PS(sqrt(m2/(double)n)), TICKS_TO_PS(max - min));
+	
+	first_edge = TICKS_TO_PS(min);
+	last_edge = TICKS_TO_PS(max);
+	if(first_edge == last_edge) {
+		first_edge -= 0.5;
+		last_edge += 0.5;
+	}
+	bins = calloc(nbins, sizeof(uint64_t));
+	if(bins == NULL) {
+		perror("Unable to allocate memory");
+		return 1;
+	}
+	if(!overflow) {
+		int64_t d;
+		
+		/* Rebin the per-tick counts */
+		for(i=0;i<nthreads;i++) {
+			struct worker *w = &workers[i];
+			uint64_t j;
+			
+			for(j=0;j<w->span;j++) {
+				if(w->counts[j] == 0) continue;
+				d = w->lo + (int64_t)j;
+				bins[bin_index(TICKS_TO_PS(d), nbins, first_edge, last_edge)] += w->counts[j];
+			}
+			free(w->counts);
+		}
+	} else {
+		for(i=0;i<nthreads;i++) {
+			free(workers[i].counts);
+			workers[i].nbins = nbins;
+			workers[i].first_edge = first_edge;
+			workers[i].last_edge = last_edge;
+			workers[i].bins = calloc(nbins, sizeof(uint64_t));
+			if(workers[i].bins == NULL) {
+				perror("Unable to allocate memory");
+				return 1;
+			}
+			pthread_create(&workers[i].thread, NULL, second_pass, &workers[i]);
+		}
+		for(i=0;i<nthreads;i++) {
+			int j;
+			
+			pthread_join(workers[i].thread, NULL);
+			for(j=0;j<nbins;j++)
+				bins[j] += workers[i].bins[j];
+			free(workers[i].bins);
+		}
+	}
+	
+	/* Bin edges (ps), count and normalized density */
+	for(i=0;i<nbins;i++) {
+		double lo = first_edge + (last_edge - first_edge)*i/nbins;
+		double hi = first_edge + (last_edge - first_edge)*(i+1)/nbins;
+		
+		printf("%f,%f,%llu,%f\n", lo, hi, (unsigned long long)bins[i],
+			(double)bins[i]/((double)n*(hi - lo)));
+	}
+	
+	free(bins);
+	munmap((void *)data, st.st_size);
+	return 0;
+}
@@ -0,0 +1,634 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * This program creates a VHDL entity that sorts the taps of the delay lines
+ * by increasing delays, according to the Xilinx static timing model.
+ *
+ * 1. Create a design in ISE with the delay lines only, for the targeted FPGA.
+ * If you run out of I/Os, connect some dummy logic to the taps to prevent
+ * optimizations. Use this Verilog source for example:
+ *
+ * module top(
+ * 	input clk_i,
+ * 	input reset_i,
+ * 	input [15:0] signal_i,
+ * 	output xtap
+ * );
+ *
+ * wire [16*124*4-1:0] taps;
+ *
+ * genvar i;
+ * generate for(i=0;i<16;i=i+1) begin: ch
+ * tdc_delayline #(
+ * 	.g_WIDTH(124)
+ * ) dl (
+ * 	.clk_i(clk_i),
+ * 	.reset_i(reset_i),
+ * 	.signal_i(signal_i[i]),
+ * 	.taps_o(taps[(i+1)*124*4-1:i*124*4])
+ * );
+ * end
+ * endgenerate
+ *
+ * assign xtap = |taps;
+ *
+ * endmodule
+ *
+ * Place each delay line where the corresponding channel will be placed
+ * in the real design. A single delay line (without the generate loop)
+ * gives one ordering that is used for all channels.
+ * 2. Apply this UCF constraint:
+ * NET "signal_i*" OFFSET=IN 20 ns BEFORE "clk_i";
+ * 3. Implement the design.
+ * 4. Generate the XML timing report (.twx): trce -v 100000 top.ncd
+ * 5. Process it with this program:
+ * ordertaps -o tdc_ordertaps.vhd -d taps.csv top.twx
+ *
+ * The report is parsed as a stream, so its size does not matter. The tap
+ * number is the last bracketed index in the path destination, and the
+ * channel number the first one, if there are several (see -c and -t).
+ * The generated entity has a g_CHANNEL generic selecting the ordering
+ * of each channel; channels missing from the report use the ordering of
+ * the lowest channel.
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MAX_DEPTH	(64)
+#define MAX_TEXT	(512)
+#define MAX_FIELDS	(8)
+#define MAX_CHANNELS	(1024)
+
+enum {
+	EL_OTHER,
+	EL_TWBODY,
+	EL_TWVERBOSERPT,
+	EL_TWCONST,
+	EL_TWPATHRPT,
+	EL_TWCONSTOFFIN,
+	EL_TWDEST,
+	EL_TWSLACK
+};
+
+/* twBody/twVerboseRpt/twConst/twPathRpt/twConstOffIn/{twDest,twSlack},
+ * relative to the root element. */
+#define DEPTH_PATHRPT	(5)
+#define DEPTH_FIELD	(7)
+
+static const int expected[DEPTH_FIELD] = {
+	EL_OTHER, EL_TWBODY, EL_TWVERBOSERPT, EL_TWCONST,
+	EL_TWPATHRPT, EL_TWCONSTOFFIN, EL_OTHER
+};
+
+struct tap {
+	int channel;
+	int tap;
+	int seq;
+	double delay;
+};
+
+static double ucftime = 20.0;
+static int channel_field = 0;
+static int tap_field = -1;
+
+static struct tap *taps;
+static int ntaps, maxtaps;
+static int npaths, nignored;
+
+/*
+ * Parser state
+ */
+static int depth;
+static int stack[MAX_DEPTH];
+static int matched;		/* number of stack levels on the path */
+static char dest[MAX_TEXT], slack[MAX_TEXT];
+static int destlen, slacklen;
+static int have_dest, have_slack;
+static int *text;		/* collects into dest/slack when non-NULL */
+
+static int element_id(const char *name)
+{
+	if(strcmp(name, "twBody") == 0) return EL_TWBODY;
+	if(strcmp(name, "twVerboseRpt") == 0) return EL_TWVERBOSERPT;
+	if(strcmp(name, "twConst") == 0) return EL_TWCONST;
+	if(strcmp(name, "twPathRpt") == 0) return EL_TWPATHRPT;
+	if(strcmp(name, "twConstOffIn") == 0) return EL_TWCONSTOFFIN;
+	if(strcmp(name, "twDest") == 0) return EL_TWDEST;
+	if(strcmp(name, "twSlack") == 0) return EL_TWSLACK;
+	return EL_OTHER;
+}
+
+/* Decode the few entities that can appear in net names, in place. */
+static void decode_entities(char *s)
+{
+	static const char *names[] = { "&lt;", "&gt;", "&amp;", "&quot;", "&apos;" };
+	static const char chars[] = "<>&\"'";
+	char *d;
+	int i;
+	
+	d = s;
+	while(*s) {
+		if(*s == '&') {
+			for(i=0;i<5;i++)
+				if(strncmp(s, names[i], strlen(names[i])) == 0)
+					break;
+			if(i < 5) {
+				*d++ = chars[i];
+				s += strlen(names[i]);
+				continue;
+			}
+		}
+		*d++ = *s++;
+	}
+	*d = 0;
+}
+
+/* Extracts the numeric bus indices of a net name: "ch[3].dl/reg<5>". */
+static int bus_indices(const char *s, int *fields)
+{
+	char *end;
+	long v;
+	int n;
+	
+	n = 0;
+	while(*s && (n < MAX_FIELDS)) {
+		if(((*s == '[') || (*s == '<')) && isdigit(s[1])) {
+			v = strtol(s + 1, &end, 10);
+			if((*end == ']') || (*end == '>')) {
+				fields[n++] = v;
+				s = end;
+			}
+		}
+		s++;
+	}
+	return n;
+}
+
+static int pick_field(const int *fields, int n, int index)
+{
+	if(index < 0)
+		index += n;
+	if((index < 0) || (index >= n))
+		return -1;
+	return fields[index];
+}
+
+static void add_path()
+{
+	int fields[MAX_FIELDS];
+	int n, channel, tap;
+	char *end;
+	double s;
+	
+	npaths++;
+	decode_entities(dest);
+	n = bus_indices(dest, fields);
+	tap = pick_field(fields, n, tap_field);
+	if(n > 1)
+		channel = pick_field(fields, n, channel_field);
+	else
+		channel = 0;
+	s = strtod(slack, &end);
+	if((tap < 0) || (channel < 0) || (channel >= MAX_CHANNELS) || (end == slack)) {
+		if(nignored++ < 10)
+			fprintf(stderr, "Ignoring path to '%s' (slack '%s')\n", dest, slack);
+		return;
+	}
+	if(ntaps == maxtaps) {
+		maxtaps = maxtaps ? 2*maxtaps : 4096;
+		taps = realloc(taps, maxtaps*sizeof(struct tap));
+		if(taps == NULL) {
+			perror("realloc");
+			exit(1);
+		}
+	}
+	taps[ntaps].channel = channel;
+	taps[ntaps].tap = tap;
+	taps[ntaps].seq = ntaps;
+	taps[ntaps].delay = ucftime - s;
+	ntaps++;
+}
+
+static void open_element(const char *name)
+{
+	int id;
+	
+	id = element_id(name);
+	if(depth < MAX_DEPTH)
+		stack[depth] = id;
+	if((matched == depth) && (depth < DEPTH_FIELD)) {
+		if((depth == 0) || (id == expected[depth])
+		  || ((depth == DEPTH_FIELD-1) && ((id == EL_TWDEST) || (id == EL_TWSLACK))))
+			matched++;
+	}
+	depth++;
+	
+	if((matched == DEPTH_PATHRPT) && (depth == DEPTH_PATHRPT)) {
+		have_dest = have_slack = 0;
+		destlen = slacklen = 0;
+	}
+	if((matched == DEPTH_FIELD) && (depth == DEPTH_FIELD)) {
+		/* only the first twConstOffIn of a path is used */
+		if((id == EL_TWDEST) && !have_dest) {
+			destlen = 0;
+			text = &destlen;
+		} else if((id == EL_TWSLACK) && !have_slack) {
+			slacklen = 0;
+			text = &slacklen;
+		}
+	}
+}
+
+static void close_element()
+{
+	if(depth == 0)
+		return;
+	if((matched == DEPTH_FIELD) && (depth == DEPTH_FIELD) && (text != NULL)) {
+		if(text == &destlen) {
+			dest[destlen] = 0;
+			have_dest = 1;
+		} else {
+			slack[slacklen] = 0;
+			have_slack = 1;
+		}
+		text = NULL;
+	}
+	if((matched == DEPTH_PATHRPT) && (depth == DEPTH_PATHRPT)) {
+		if(have_dest && have_slack)
+			add_path();
+		have_dest = have_slack = 0;
+	}
+	if(matched == depth)
+		matched--;
+	depth--;
+}
+
+static void add_text(char c)
+{
+	if(text == &destlen) {
+		if(destlen < MAX_TEXT-1)
+			dest[destlen++] = c;
+	} else {
+		if(slacklen < MAX_TEXT-1)
+			slack[slacklen++] = c;
+	}
+}
+
+enum {
+	S_TEXT,		/* character data */
+	S_OPEN,		/* after '<' */
+	S_NAME,		/* element name */
+	S_ATTRS,	/* attributes, until '>' */
+	S_CLOSE,	/* end tag, until '>' */
+	S_MARKUP,	/* <!...>, <?...?> */
+	S_COMMENT	/* <!-- ... --> */
+};
+
+static int parse(FILE *fd)
+{
+	static char buf[65536];
+	char name[64];
+	int namelen;
+	int state, quote, dashes, slash;
+	size_t len, i;
+	char c;
+	
+	state = S_TEXT;
+	namelen = quote = dashes = slash = 0;
+	while((len = fread(buf, 1, sizeof(buf), fd)) > 0) {
+		for(i=0;i<len;i++) {
+			c = buf[i];
+			switch(state) {
+				case S_TEXT:
+					if(c == '<')
+						state = S_OPEN;
+					else if(text != NULL)
+						add_text(c);
+					break;
+				case S_OPEN:
+					if(c == '/') {
+						state = S_CLOSE;
+					} else if((c == '!') || (c == '?')) {
+						state = S_MARKUP;
+						dashes = 0;
+					} else {
+						name[0] = c;
+						namelen = 1;
+						state = S_NAME;
+					}
+					break;
+				case S_NAME:
+					if(isspace((unsigned char)c) || (c == '/') || (c == '>')) {
+						name[namelen] = 0;
+						open_element(name);
+						slash = 0;
+						quote = 0;
+						state = S_ATTRS;
+						i--;
+					} else if(namelen < (int)sizeof(name)-1)
+						name[namelen++] = c;
+					break;
+				case S_ATTRS:
+					if(quote) {
+						if(c == quote)
+							quote = 0;
+					} else if((c == '"') || (c == '\'')) {
+						quote = c;
+					} else if(c == '>') {
+						if(slash)
+							close_element();
+						state = S_TEXT;
+					} else
+						slash = (c == '/');
+					break;
+				case S_CLOSE:
+					if(c == '>') {
+						close_element();
+						state = S_TEXT;
+					}
+					break;
+				case S_MARKUP:
+					if((c == '-') && (dashes < 2)) {
+						if(++dashes == 2) {
+							state = S_COMMENT;
+							dashes = 0;
+						}
+					} else if(c == '>')
+						state = S_TEXT;
+					else
+						dashes = 3;
+					break;
+				case S_COMMENT:
+					if(c == '-')
+						dashes++;
+					else if((c == '>') && (dashes >= 2))
+						state = S_TEXT;
+					else
+						dashes = 0;
+					break;
+			}
+		}
+	}
+	if(ferror(fd)) {
+		perror("Unable to read input file");
+		return 0;
+	}
+	return 1;
+}
+
+static int cmp_tap(const void *a, const void *b)
+{
+	const struct tap *ta = a, *tb = b;
+	
+	if(ta->channel != tb->channel) return ta->channel - tb->channel;
+	if(ta->tap != tb->tap) return ta->tap - tb->tap;
+	return ta->seq - tb->seq;
+}
+
+static int cmp_delay(const void *a, const void *b)
+{
+	const struct tap *ta = a, *tb = b;
+	
+	if(ta->channel != tb->channel) return ta->channel - tb->channel;
+	if(ta->delay < tb->delay) return -1;
+	if(ta->delay > tb->delay) return 1;
+	return ta->seq - tb->seq;
+}
+
+/*
+ * Removes duplicate paths and checks that each channel has a complete
+ * set of taps, the same number for all channels.
+ * Fills the first index of each channel in the taps array.
+ */
+static int check_taps(int *first, int *channels, int *count)
+{
+	int i, j, n, nchannels, width, ok;
+	
+	qsort(taps, ntaps, sizeof(struct tap), cmp_tap);
+	j = 0;
+	for(i=0;i<ntaps;i++) {
+		if((j > 0) && (taps[j-1].channel == taps[i].channel) && (taps[j-1].tap == taps[i].tap))
+			continue;
+		taps[j++] = taps[i];
+	}
+	if(j != ntaps)
+		fprintf(stderr, "Ignored %d duplicate path(s)\n", ntaps - j);
+	ntaps = j;
+	
+	ok = 1;
+	nchannels = 0;
+	width = -1;
+	i = 0;
+	while(i < ntaps) {
+		first[nchannels] = i;
+		channels[nchannels] = taps[i].channel;
+		n = 0;
+		while((i < ntaps) && (taps[i].channel == channels[nchannels])) {
+			if(taps[i].tap != n) {
+				fprintf(stderr, "Channel %d: tap %d missing from timing report\n",
+					channels[nchannels], n);
+				ok = 0;
+				break;
+			}
+			n++;
+			i++;
+		}
+		while((i < ntaps) && (taps[i].channel == channels[nchannels])) {
+			n++;
+			i++;
+		}
+		if(width < 0)
+			width = n;
+		else if(n != width) {
+			fprintf(stderr, "Channel %d has %d taps, channel %d has %d\n",
+				channels[0], width, channels[nchannels], n);
+			ok = 0;
+		}
+		nchannels++;
+	}
+	first[nchannels] = ntaps;
+	*count = nchannels;
+	return ok;
+}
+
+static void write_assignments(FILE *fd, const char *indent, int start, int end)
+{
+	int i;
+	
+	for(i=start;i<end;i++)
+		fprintf(fd, "%ssorted_o(%d) <= unsorted_i(%d); -- %.3f ns\n",
+			indent, i - start, taps[i].tap, taps[i].delay);
+}
+
+static void write_vhdl(FILE *fd, const int *first, const int *channels, int nchannels)
+{
+	int i, contiguous;
+	
+	fprintf(fd, "\n-- This file was autogenerated by ordertaps\n\n");
+	fprintf(fd, "library ieee;\nuse ieee.std_logic_1164.all;\n\n");
+	fprintf(fd, "library work;\nuse work.tdc_package.all;\n\n");
+	fprintf(fd, "entity tdc_ordertaps is\n");
+	fprintf(fd, "    generic(\n");
+	fprintf(fd, "        g_WIDTH   : positive;\n");
+	fprintf(fd, "        g_CHANNEL : natural := 0\n");
+	fprintf(fd, "    );\n");
+	fprintf(fd, "    port(\n");
+	fprintf(fd, "        unsorted_i : in std_logic_vector(4*g_WIDTH-1 downto 0);\n");
+	fprintf(fd, "        sorted_o   : out std_logic_vector(4*g_WIDTH-1 downto 0)\n");
+	fprintf(fd, "    );\n");
+	fprintf(fd, "end entity;\n\n");
+	fprintf(fd, "architecture rtl of tdc_ordertaps is\n");
+	fprintf(fd, "begin\n\n");
+	
+	if(nchannels == 1) {
+		write_assignments(fd, "    ", first[0], first[1]);
+	} else {
+		for(i=0;i<nchannels;i++) {
+			fprintf(fd, "    g_channel%d: if g_CHANNEL = %d generate\n", channels[i], channels[i]);
+			write_assignments(fd, "        ", first[i], first[i+1]);
+			fprintf(fd, "    end generate;\n\n");
+		}
+		contiguous = (channels[0] == 0) && (channels[nchannels-1] == nchannels-1);
+		fprintf(fd, "    -- channels not in the timing report use the ordering of channel %d\n", channels[0]);
+		fprintf(fd, "    g_default: if ");
+		if(contiguous)
+			fprintf(fd, "g_CHANNEL > %d", nchannels-1);
+		else {
+			for(i=0;i<nchannels;i++)
+				fprintf(fd, "%s(g_CHANNEL /= %d)", i ? " and " : "", channels[i]);
+		}
+		fprintf(fd, " generate\n");
+		write_assignments(fd, "        ", first[0], first[1]);
+		fprintf(fd, "    end generate;\n");
+	}
+	fprintf(fd, "\nend architecture;\n");
+}
+
+static void write_csv(FILE *fd, const int *first, const int *channels, int nchannels)
+{
+	int i, j;
+	
+	fprintf(fd, "channel,position,tap,delay_ns\n");
+	for(i=0;i<nchannels;i++)
+		for(j=first[i];j<first[i+1];j++)
+			fprintf(fd, "%d,%d,%d,%.3f\n", channels[i], j - first[i], taps[j].tap, taps[j].delay);
+}
+
+static void usage()
+{
+	fprintf(stderr, "Usage: ordertaps [options] [<file.twx>]\n");
+	fprintf(stderr, "  -u <ns>     OFFSET=IN constraint of the report (default 20)\n");
+	fprintf(stderr, "  -o <file>   write the VHDL entity to a file (default stdout)\n");
+	fprintf(stderr, "  -d <file>   write the tap delays (CSV)\n");
+	fprintf(stderr, "  -c <n>      bus index giving the channel number (default 0)\n");
+	fprintf(stderr, "  -t <n>      bus index giving the tap number (default -1)\n");
+	fprintf(stderr, "Negative indices count from the last one. The default input\n");
+	fprintf(stderr, "file is top.twx, use - for the standard input.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *filename = "top.twx";
+	const char *vhdl_name = NULL;
+	const char *csv_name = NULL;
+	int first[MAX_CHANNELS+1], channels[MAX_CHANNELS];
+	int nchannels;
+	FILE *fd;
+	int opt;
+	
+	while((opt = getopt(argc, argv, "u:o:d:c:t:")) != -1) {
+		switch(opt) {
+			case 'u':
+				ucftime = atof(optarg);
+				break;
+			case 'o':
+				vhdl_name = optarg;
+				break;
+			case 'd':
+				csv_name = optarg;
+				break;
+			case 'c':
+				channel_field = atoi(optarg);
+				break;
+			case 't':
+				tap_field = atoi(optarg);
+				break;
+			default:
+				usage();
+				return 1;
+		}
+	}
+	if(argc - optind > 1) {
+		usage();
+		return 1;
+	}
+	if(optind < argc)
+		filename = argv[optind];
+	
+	if(strcmp(filename, "-") == 0)
+		fd = stdin;
+	else {
+		fd = fopen(filename, "r");
+		if(fd == NULL) {
+			perror("Unable to open input file");
+			return 1;
+		}
+	}
+	if(!parse(fd))
+		return 1;
+	if(fd != stdin)
+		fclose(fd);
+	
+	if(ntaps == 0) {
+		fprintf(stderr, "No usable paths found in the timing report\n");
+		return 1;
+	}
+	if(!check_taps(first, channels, &nchannels))
+		return 1;
+	qsort(taps, ntaps, sizeof(struct tap), cmp_delay);
+	fprintf(stderr, "%d paths, %d channel(s), %d taps per channel\n",
+		npaths, nchannels, first[1]);
+	
+	if(vhdl_name != NULL) {
+		fd = fopen(vhdl_name, "w");
+		if(fd == NULL) {
+			perror("Unable to open VHDL output file");
+			return 1;
+		}
+		write_vhdl(fd, first, channels, nchannels);
+		fclose(fd);
+	} else
+		write_vhdl(stdout, first, channels, nchannels);
+	
+	if(csv_name != NULL) {
+		fd = fopen(csv_name, "w");
+		if(fd == NULL) {
+			perror("Unable to open CSV output file");
+			return 1;
+		}
+		write_csv(fd, first, channels, nchannels);
+		fclose(fd);
+	}
+	
+	free(taps);
+	return 0;
+}
@@ -0,0 +1,583 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Computes the time difference statistics and histograms of every pair
+ * of channels of a multi-channel capture, like mhist does for the two
+ * channels of a "diff" capture.
+ *
+ * The events must be in time order. A sweep over them groups the events
+ * that fall within a window (-w) of the first one into coincidences. For
+ * each pair of channels present in a coincidence, the difference between
+ * their timestamps (second channel minus first) is accumulated. Only the
+ * first event of a channel in a coincidence is used.
+ *
+ * Inputs:
+ *   CSV, tdcconv events format (channel,polarity,raw,timestamp)
+ *   CSV, output of the "diff" command (pol0,raw0,ts0,pol1,raw1,ts1)
+ *   TDCF files written by tdcconv
+ *
+ * Events are read in blocks. The coincidences of a block are split among
+ * threads, each with its own statistics and histograms, which are merged
+ * at the end.
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "tdcfile.h"
+
+#define MAX_CHANNELS	(64)
+#define MAX_PAIRS	(MAX_CHANNELS*(MAX_CHANNELS-1)/2)
+#define MAX_THREADS	(64)
+#define BLOCK		(1 << 20)
+
+struct event {
+	int64_t ts;
+	int channel;
+};
+
+struct pairstat {
+	uint64_t n;
+	double mean;
+	double m2;
+	int64_t min;
+	int64_t max;
+	uint32_t *bins;		/* allocated on first use */
+};
+
+struct worker {
+	pthread_t thread;
+	int first;		/* coincidence range */
+	int last;
+
+	/* Results */
+	struct pairstat pairs[MAX_PAIRS];
+	uint64_t coincidences;
+	uint64_t duplicates;
+};
+
+static struct event *events;
+static int nevents;
+static int *starts;		/* first event of each coincidence, plus end */
+static int nstarts;
+
+static struct worker workers[MAX_THREADS];
+static int nthreads;
+
+static int64_t window;		/* in timestamp units */
+static double bin_width;	/* in timestamp units */
+static int nbins;
+static int max_channel = -1;
+
+static uint64_t total_events, unsorted;
+
+static int pair_index(int a, int b)
+{
+	return a*(2*MAX_CHANNELS - a - 1)/2 + (b - a - 1);
+}
+
+static void add_difference(struct worker *w, int a, int b, int64_t d)
+{
+	struct pairstat *s = &w->pairs[pair_index(a, b)];
+	double delta;
+	int i;
+	
+	s->n++;
+	delta = (double)d - s->mean;
+	s->mean += delta/(double)s->n;
+	s->m2 += delta*((double)d - s->mean);
+	if((s->n == 1) || (d < s->min)) s->min = d;
+	if((s->n == 1) || (d > s->max)) s->max = d;
+	
+	if(s->bins == NULL) {
+		s->bins = calloc(nbins, sizeof(uint32_t));
+		if(s->bins == NULL) {
+			perror("calloc");
+			exit(1);
+		}
+	}
+	/* differences are within [-window, window] */
+	i = (int)((double)(d + window)/bin_width);
+	if(i >= nbins) i = nbins - 1;
+	s->bins[i]++;
+}
+
+static void *process(void *arg)
+{
+	struct worker *w = arg;
+	int chan[MAX_CHANNELS];
+	int64_t ts[MAX_CHANNELS];
+	uint64_t seen;
+	int c, i, j, k, n;
+	
+	for(c=w->first;c<w->last;c++) {
+		seen = 0;
+		n = 0;
+		for(k=starts[c];k<starts[c+1];k++) {
+			if(seen & (1ULL << events[k].channel)) {
+				w->duplicates++;
+				continue;
+			}
+			seen |= 1ULL << events[k].channel;
+			chan[n] = events[k].channel;
+			ts[n] = events[k].ts;
+			n++;
+		}
+		if(n < 2)
+			continue;
+		w->coincidences++;
+		for(i=0;i<n;i++)
+			for(j=i+1;j<n;j++) {
+				if(chan[i] < chan[j])
+					add_difference(w, chan[i], chan[j], ts[j] - ts[i]);
+				else
+					add_difference(w, chan[j], chan[i], ts[i] - ts[j]);
+			}
+	}
+	return NULL;
+}
+
+/*
+ * Groups the buffered events into coincidences and processes them,
+ * except the last one if more events may still join it.
+ */
+static void process_block(int final)
+{
+	int i, k, consumed;
+	
+	nstarts = 0;
+	i = 0;
+	while(i < nevents) {
+		starts[nstarts++] = i;
+		for(k=i+1;(k<nevents)&&(events[k].ts - events[i].ts <= window);k++);
+		if((k == nevents) && !final) {
+			/* the window extends beyond the buffered events */
+			nstarts--;
+			break;
+		}
+		i = k;
+	}
+	if((nstarts == 0) && (nevents == 2*BLOCK)) {
+		/* a single window covers the whole buffer: close it */
+		starts[nstarts++] = 0;
+		i = nevents;
+	}
+	consumed = i;
+	starts[nstarts] = consumed;
+	
+	for(i=0;i<nthreads;i++) {
+		workers[i].first = (long long)nstarts*i/nthreads;
+		workers[i].last = (long long)nstarts*(i+1)/nthreads;
+		if(i > 0)
+			pthread_create(&workers[i].thread, NULL, process, &workers[i]);
+	}
+	process(&workers[0]);
+	for(i=1;i<nthreads;i++)
+		pthread_join(workers[i].thread, NULL);
+	
+	memmove(events, events + consumed, (nevents - consumed)*sizeof(struct event));
+	nevents -= consumed;
+}
+
+static void add_event(int channel, int64_t ts)
+{
+	if((channel < 0) || (channel >= MAX_CHANNELS))
+		return;
+	if((nevents > 0) && (ts < events[nevents-1].ts))
+		unsorted++;
+	if(channel > max_channel)
+		max_channel = channel;
+	events[nevents].ts = ts;
+	events[nevents].channel = channel;
+	nevents++;
+	total_events++;
+	/* leave room for a coincidence carried over from the previous block */
+	if(nevents == 2*BLOCK)
+		process_block(0);
+}
+
+/*
+ * Input
+ */
+static int polarity = -1;
+static int wrap_bits = -1;
+
+static int split(const char *line, int64_t *v, int max)
+{
+	char *end;
+	int n;
+	
+	n = 0;
+	while(n < max) {
+		while(*line == ' ') line++;
+		v[n] = strtoll(line, &end, 10);
+		if(end == line)
+			return 0;
+		n++;
+		line = end;
+		while(*line == ' ') line++;
+		if(*line != ',')
+			break;
+		line++;
+	}
+	while(isspace(*line)) line++;
+	return *line == 0 ? n : 0;
+}
+
+static int read_csv(FILE *fd)
+{
+	char *line;
+	size_t size;
+	int64_t v[8];
+	int64_t prev, t0, t1;
+	uint64_t mask;
+	int n, fields, started;
+	
+	line = NULL;
+	size = 0;
+	fields = 0;
+	started = 0;
+	prev = 0;
+	mask = 0;
+	while(getline(&line, &size, fd) != -1) {
+		n = split(line, v, 8);
+		if(n == 0)
+			continue;
+		if(fields == 0) {
+			fields = n;
+			if((n != 4) && (n != 6)) {
+				fprintf(stderr, "Unrecognized CSV format (%d columns)\n", n);
+				free(line);
+				return 0;
+			}
+			if((n == 6) && (wrap_bits < 0))
+				wrap_bits = 32;
+			if(wrap_bits > 0)
+				mask = (wrap_bits < 64) ? (1ULL << wrap_bits) - 1 : ~0ULL;
+		}
+		if(n != fields)
+			continue;
+		if(n == 4) {
+			if((polarity >= 0) && (v[1] != polarity))
+				continue;
+			t0 = v[3];
+			if(wrap_bits > 0) {
+				t0 = started ? prev + (int64_t)((uint64_t)(t0 - prev) & mask) : (int64_t)(t0 & mask);
+				prev = t0;
+				started = 1;
+			}
+			add_event(v[0], t0);
+		} else {
+			/* one line per pair of events: unwrap channel 0, place
+			 * channel 1 relative to it */
+			t0 = v[2];
+			t1 = v[5];
+			if(wrap_bits > 0) {
+				t0 = started ? prev + (int64_t)((uint64_t)(t0 - prev) & mask) : (int64_t)(t0 & mask);
+				prev = t0;
+				started = 1;
+				t1 = (uint64_t)(v[5] - v[2]) & mask;
+				if(t1 > (int64_t)(mask >> 1))
+					t1 -= (int64_t)mask + 1;
+				t1 += t0;
+			}
+			if(t1 < t0) {
+				if((polarity < 0) || (v[3] == polarity)) add_event(1, t1);
+				if((polarity < 0) || (v[0] == polarity)) add_event(0, t0);
+			} else {
+				if((polarity < 0) || (v[0] == polarity)) add_event(0, t0);
+				if((polarity < 0) || (v[3] == polarity)) add_event(1, t1);
+			}
+		}
+	}
+	free(line);
+	return 1;
+}
+
+static int read_tdcf(const char *filename)
+{
+	struct tdcf_reader *r;
+	uint64_t *ts[TDCF_MAX_CHANNELS];
+	uint8_t *pol[TDCF_MAX_CHANNELS];
+	int count[TDCF_MAX_CHANNELS], pos[TDCF_MAX_CHANNELS];
+	int channels, chunk, c, best, max, ok;
+	
+	r = tdcf_open(filename);
+	if(r == NULL)
+		return 0;
+	channels = tdcf_channels(r);
+	if(channels > MAX_CHANNELS)
+		channels = MAX_CHANNELS;
+	max = 0;
+	for(chunk=0;chunk<tdcf_chunks(r);chunk++)
+		for(c=0;c<channels;c++)
+			if(tdcf_count(r, chunk, c) > max)
+				max = tdcf_count(r, chunk, c);
+	for(c=0;c<channels;c++) {
+		ts[c] = malloc((max + 1)*sizeof(uint64_t));
+		pol[c] = malloc(max + 1);
+		if((ts[c] == NULL) || (pol[c] == NULL)) {
+			perror("malloc");
+			exit(1);
+		}
+	}
+	ok = 1;
+	for(chunk=0;(chunk<tdcf_chunks(r))&&ok;chunk++) {
+		for(c=0;c<channels;c++) {
+			count[c] = tdcf_read_timestamps(r, chunk, c, ts[c]);
+			if((count[c] >= 0) && (tdcf_read_polarities(r, chunk, c, pol[c]) != count[c]))
+				count[c] = -1;
+			if(count[c] < 0) {
+				fprintf(stderr, "%s: chunk %d is corrupted\n", filename, chunk);
+				ok = 0;
+				break;
+			}
+			pos[c] = 0;
+		}
+		/* merge the channels of the chunk in time order */
+		while(ok) {
+			best = -1;
+			for(c=0;c<channels;c++)
+				if((pos[c] < count[c]) && ((best < 0) || (ts[c][pos[c]] < ts[best][pos[best]])))
+					best = c;
+			if(best < 0)
+				break;
+			if((polarity < 0) || (pol[best][pos[best]] == polarity))
+				add_event(best, ts[best][pos[best]]);
+			pos[best]++;
+		}
+	}
+	for(c=0;c<channels;c++) {
+		free(pol[c]);
+		free(ts[c]);
+	}
+	tdcf_close(r);
+	return ok;
+}
+
+static int is_tdcf(const char *filename)
+{
+	char magic[4];
+	FILE *fd;
+	int r;
+	
+	fd = fopen(filename, "rb");
+	if(fd == NULL)
+		return 0;
+	r = (fread(magic, 1, 4, fd) == 4) && (memcmp(magic, "TDCF", 4) == 0);
+	fclose(fd);
+	return r;
+}
+
+/* Chan et al. parallel combination of the worker statistics */
+static void merge(struct pairstat *dst, const struct pairstat *src)
+{
+	double delta;
+	uint64_t n;
+	int i;
+	
+	if(src->n == 0)
+		return;
+	if(dst->n == 0) {
+		dst->n = src->n;
+		dst->mean = src->mean;
+		dst->m2 = src->m2;
+		dst->min = src->min;
+		dst->max = src->max;
+	} else {
+		n = dst->n + src->n;
+		delta = src->mean - dst->mean;
+		dst->mean += delta*src->n/n;
+		dst->m2 += src->m2 + delta*delta*((double)dst->n*src->n/n);
+		dst->n = n;
+		if(src->min < dst->min) dst->min = src->min;
+		if(src->max > dst->max) dst->max = src->max;
+	}
+	if(dst->bins == NULL) {
+		dst->bins = calloc(nbins, sizeof(uint32_t));
+		if(dst->bins == NULL) {
+			perror("calloc");
+			exit(1);
+		}
+	}
+	for(i=0;i<nbins;i++)
+		dst->bins[i] += src->bins[i];
+}
+
+static void usage()
+{
+	fprintf(stderr, "Usage: pairhist [options] [<file>]\n");
+	fprintf(stderr, "  -w <ps>       coincidence window (default 10000)\n");
+	fprintf(stderr, "  -B <ps>       histogram bin width (default 10)\n");
+	fprintf(stderr, "  -e <0|1>      only use events of this polarity\n");
+	fprintf(stderr, "  -W <bits>     unwrap timestamps of this width (default 32 for diff CSV)\n");
+	fprintf(stderr, "  -P <ps>       clock period (default 8000)\n");
+	fprintf(stderr, "  -F <n>        g_FP_COUNT (default 13)\n");
+	fprintf(stderr, "  -o <file>     write the histograms (CSV)\n");
+	fprintf(stderr, "  -t <threads>  number of threads\n");
+	fprintf(stderr, "Reads the standard input if no file is given.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *filename;
+	const char *histname;
+	double period_ps, unit, window_ps, bin_ps, sigma;
+	int fp_count;
+	struct pairstat *s;
+	uint64_t coincidences, duplicates;
+	FILE *fd;
+	int opt, ok, a, b, i, lo, hi;
+	
+	period_ps = 8000.0;
+	fp_count = 13;
+	window_ps = 10000.0;
+	bin_ps = 10.0;
+	histname = NULL;
+	nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	while((opt = getopt(argc, argv, "w:B:e:W:P:F:o:t:")) != -1) {
+		switch(opt) {
+			case 'w':
+				window_ps = atof(optarg);
+				break;
+			case 'B':
+				bin_ps = atof(optarg);
+				break;
+			case 'e':
+				polarity = atoi(optarg);
+				break;
+			case 'W':
+				wrap_bits = atoi(optarg);
+				break;
+			case 'P':
+				period_ps = atof(optarg);
+				break;
+			case 'F':
+				fp_count = atoi(optarg);
+				break;
+			case 'o':
+				histname = optarg;
+				break;
+			case 't':
+				nthreads = atoi(optarg);
+				break;
+			default:
+				usage();
+				return 1;
+		}
+	}
+	if((argc - optind > 1) || (window_ps <= 0.0) || (bin_ps <= 0.0) || (polarity > 1)
+	  || (wrap_bits > 64) || (period_ps <= 0.0) || (fp_count < 0)) {
+		usage();
+		return 1;
+	}
+	if(nthreads < 1) nthreads = 1;
+	if(nthreads > MAX_THREADS) nthreads = MAX_THREADS;
+	
+	unit = period_ps/ldexp(1.0, fp_count);
+	window = floor(window_ps/unit);
+	bin_width = bin_ps/unit;
+	nbins = (int)ceil((2*window + 1)/bin_width);
+	if(nbins > (1 << 24)) {
+		fprintf(stderr, "Too many histogram bins\n");
+		return 1;
+	}
+	
+	events = malloc(2*BLOCK*sizeof(struct event));
+	starts = malloc((2*BLOCK + 1)*sizeof(int));
+	if((events == NULL) || (starts == NULL)) {
+		perror("malloc");
+		return 1;
+	}
+	
+	filename = optind < argc ? argv[optind] : "-";
+	if((strcmp(filename, "-") != 0) && is_tdcf(filename))
+		ok = read_tdcf(filename);
+	else {
+		if(strcmp(filename, "-") == 0)
+			fd = stdin;
+		else {
+			fd = fopen(filename, "r");
+			if(fd == NULL) {
+				perror("Unable to open input file");
+				return 1;
+			}
+		}
+		ok = read_csv(fd);
+		if(fd != stdin)
+			fclose(fd);
+	}
+	if(!ok)
+		return 1;
+	process_block(1);
+	
+	coincidences = duplicates = 0;
+	for(i=0;i<nthreads;i++) {
+		coincidences += workers[i].coincidences;
+		duplicates += workers[i].duplicates;
+	}
+	fprintf(stderr, "%llu events, %d channel(s), %llu coincidences",
+		(unsigned long long)total_events, max_channel + 1, (unsigned long long)coincidences);
+	if(duplicates)
+		fprintf(stderr, ", %llu duplicate event(s) ignored", (unsigned long long)duplicates);
+	if(unsorted)
+		fprintf(stderr, ", %llu event(s) out of time order", (unsigned long long)unsorted);
+	fprintf(stderr, "\n");
+	
+	for(i=1;i<nthreads;i++)
+		for(a=0;a<MAX_PAIRS;a++)
+			merge(&workers[0].pairs[a], &workers[i].pairs[a]);
+	
+	fd = NULL;
+	if(histname != NULL) {
+		fd = fopen(histname, "w");
+		if(fd == NULL) {
+			perror("Unable to open histogram file");
+			return 1;
+		}
+		fprintf(fd, "a,b,diff_ps,count\n");
+	}
+	for(a=0;a<=max_channel;a++)
+		for(b=a+1;b<=max_channel;b++) {
+			s = &workers[0].pairs[pair_index(a, b)];
+			if(s->n == 0)
+				continue;
+			sigma = sqrt(s->m2/(double)s->n);
+			printf("%d-%d: n=%llu mean=%.3fps sigma=%.3fps min=%.3fps max=%.3fps p2p=%.3fps\n",
+				a, b, (unsigned long long)s->n, s->mean*unit, sigma*unit,
+				s->min*unit, s->max*unit, (s->max - s->min)*unit);
+			if(fd != NULL) {
+				/* bins spanning the observed range */
+				lo = (int)((double)(s->min + window)/bin_width);
+				hi = (int)((double)(s->max + window)/bin_width);
+				if(hi >= nbins) hi = nbins - 1;
+				for(i=lo;i<=hi;i++)
+					fprintf(fd, "%d,%d,%.3f,%u\n", a, b,
+						((i + 0.5)*bin_width - window)*unit, s->bins[i]);
+			}
+		}
+	if(fd != NULL)
+		fclose(fd);
+	return 0;
+}
@@ -0,0 +1,643 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Fits a temperature model of the ring oscillator frequencies.
+ *
+ * The input is the output of the "rofreq" command (temperature followed by
+ * the frequency counts of each channel, e.g. doc/rofreq.csv), read from
+ * files or streamed on the standard input. For each channel, a polynomial
+ * of the frequency versus temperature is fitted with iteratively
+ * reweighted least squares and Huber weights, so that glitches in the
+ * capture do not bias the model.
+ *
+ * Samples are accumulated as (temperature, count) pairs with a
+ * multiplicity. The sensor has a 1/16 degree resolution and the counts
+ * are integers, so the number of distinct pairs stays small however long
+ * the capture is, and refitting (-i) is cheap enough to follow a live
+ * stream.
+ *
+ * The model can be exported as coefficients (-c) and as a table of the
+ * frequency and of the frequency ratio to a reference temperature in Q16
+ * (-s). The ratio f(Tref)/f(T) is the oc_sfreq/oc_freq factor that the
+ * online calibration applies to a LUT built at Tref.
+ *
+ * The reported RMS residual excludes the outliers (beyond 3 sigma).
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#define MAX_CHANNELS	(64)
+#define MAX_DEGREE	(6)
+
+/* Huber tuning constant, 95% efficiency with Gaussian noise */
+#define HUBER_K		(1.345)
+/* RMS of the quantization noise of integer counts, floor for the scale */
+#define MIN_SIGMA	(0.2887)
+#define MAX_ITER	(50)
+
+struct point {
+	int32_t t16;		/* temperature, 1/16 degree */
+	int32_t count;
+	uint64_t n;		/* 0 for empty hash slots */
+};
+
+struct channel {
+	struct point *points;
+	unsigned int size;	/* power of two */
+	unsigned int used;
+	uint64_t samples;
+	int32_t t16_min, t16_max;
+	/* model: sum of coef[k]*(T - center)^k */
+	int degree;
+	double center;
+	double coef[MAX_DEGREE+1];
+	double sigma;
+	double rms;
+	uint64_t outliers;
+};
+
+static struct channel channels[MAX_CHANNELS];
+static int nchannels;
+static int degree = 2;
+static uint64_t nsamples, nskipped;
+static int32_t first_t16;
+
+static unsigned int hash(int32_t t16, int32_t count)
+{
+	uint32_t h;
+	
+	h = (uint32_t)t16*0x9e3779b1u ^ (uint32_t)count*0x85ebca6bu;
+	h ^= h >> 15;
+	return h;
+}
+
+static void insert(struct channel *ch, int32_t t16, int32_t count, uint64_t n);
+
+static void grow(struct channel *ch)
+{
+	struct point *old;
+	unsigned int i, oldsize;
+	
+	old = ch->points;
+	oldsize = ch->size;
+	ch->size = oldsize ? 2*oldsize : 1024;
+	ch->points = calloc(ch->size, sizeof(struct point));
+	if(ch->points == NULL) {
+		perror("calloc");
+		exit(1);
+	}
+	ch->used = 0;
+	for(i=0;i<oldsize;i++)
+		if(old[i].n)
+			insert(ch, old[i].t16, old[i].count, old[i].n);
+	free(old);
+}
+
+static void insert(struct channel *ch, int32_t t16, int32_t count, uint64_t n)
+{
+	unsigned int i;
+	
+	if(2*(ch->used + 1) > ch->size)
+		grow(ch);
+	i = hash(t16, count) & (ch->size - 1);
+	while(ch->points[i].n) {
+		if((ch->points[i].t16 == t16) && (ch->points[i].count == count)) {
+			ch->points[i].n += n;
+			return;
+		}
+		i = (i + 1) & (ch->size - 1);
+	}
+	ch->points[i].t16 = t16;
+	ch->points[i].count = count;
+	ch->points[i].n = n;
+	ch->used++;
+}
+
+static void add_sample(int channel, int32_t t16, int32_t count)
+{
+	struct channel *ch = &channels[channel];
+	
+	if(ch->samples == 0)
+		ch->t16_min = ch->t16_max = t16;
+	else {
+		if(t16 < ch->t16_min) ch->t16_min = t16;
+		if(t16 > ch->t16_max) ch->t16_max = t16;
+	}
+	ch->samples++;
+	insert(ch, t16, count, 1);
+}
+
+/* Parses a rofreq line. Returns 0 if the line is not a sample. */
+static int parse_line(const char *line)
+{
+	int32_t counts[MAX_CHANNELS];
+	int32_t t16;
+	double t;
+	char *end;
+	int i, n;
+	
+	t = strtod(line, &end);
+	if((end == line) || (*end != ','))
+		return 0;
+	t16 = lround(t*16.0);
+	n = 0;
+	while((*end == ',') && (n < MAX_CHANNELS)) {
+		line = end + 1;
+		counts[n] = strtol(line, &end, 10);
+		if(end == line)
+			return 0;
+		n++;
+	}
+	while((*end == ' ') || (*end == '\r') || (*end == '\n')) end++;
+	if(*end != 0)
+		return 0;
+	if(nchannels == 0)
+		nchannels = n;
+	else if(n != nchannels)
+		return 0;
+	if(nsamples == 0)
+		first_t16 = t16;
+	for(i=0;i<n;i++)
+		add_sample(i, t16, counts[i]);
+	nsamples++;
+	return 1;
+}
+
+/* Solves the symmetric positive definite system a.x = b (Cholesky). */
+static int solve(long double a[MAX_DEGREE+1][MAX_DEGREE+1], long double *b, int n, double *x)
+{
+	long double l[MAX_DEGREE+1][MAX_DEGREE+1];
+	long double y[MAX_DEGREE+1];
+	long double s;
+	int i, j, k;
+	
+	for(i=0;i<n;i++) {
+		for(j=0;j<=i;j++) {
+			s = a[i][j];
+			for(k=0;k<j;k++)
+				s -= l[i][k]*l[j][k];
+			if(i == j) {
+				if(s <= 0.0L)
+					return 0;
+				l[i][i] = sqrtl(s);
+			} else
+				l[i][j] = s/l[j][j];
+		}
+	}
+	for(i=0;i<n;i++) {
+		s = b[i];
+		for(k=0;k<i;k++)
+			s -= l[i][k]*y[k];
+		y[i] = s/l[i][i];
+	}
+	for(i=n-1;i>=0;i--) {
+		s = y[i];
+		for(k=i+1;k<n;k++)
+			s -= l[k][i]*x[k];
+		x[i] = s/l[i][i];
+	}
+	return 1;
+}
+
+static double poly(const double *c, int degree, double x)
+{
+	double r;
+	int k;
+	
+	r = c[degree];
+	for(k=degree-1;k>=0;k--)
+		r = r*x + c[k];
+	return r;
+}
+
+struct residual {
+	double r;
+	uint64_t n;
+};
+
+static int cmp_residual(const void *a, const void *b)
+{
+	const struct residual *ra = a, *rb = b;
+	
+	if(ra->r < rb->r) return -1;
+	if(ra->r > rb->r) return 1;
+	return 0;
+}
+
+/* Median of the absolute residuals, with multiplicities. */
+static double median_abs(struct residual *res, int n, uint64_t total)
+{
+	uint64_t acc;
+	int i;
+	
+	qsort(res, n, sizeof(struct residual), cmp_residual);
+	acc = 0;
+	for(i=0;i<n;i++) {
+		acc += res[i].n;
+		if(2*acc >= total)
+			return res[i].r;
+	}
+	return 0.0;
+}
+
+static void fit(struct channel *ch)
+{
+	struct point *pts;
+	struct residual *res;
+	double *x, *w;
+	double c[MAX_DEGREE+1], prev[MAX_DEGREE+1];
+	long double a[MAX_DEGREE+1][MAX_DEGREE+1], b[MAX_DEGREE+1];
+	long double p[2*MAX_DEGREE+1];
+	double center, halfspan, r, u, change, ss, scale;
+	int i, j, k, m, d, nt, iter;
+	uint64_t sw;
+	
+	if(ch->samples == 0)
+		return;
+	
+	/* compact the hash table */
+	pts = malloc(ch->used*sizeof(struct point));
+	res = malloc(ch->used*sizeof(struct residual));
+	x = malloc(ch->used*sizeof(double));
+	w = malloc(ch->used*sizeof(double));
+	if((pts == NULL) || (res == NULL) || (x == NULL) || (w == NULL)) {
+		perror("malloc");
+		exit(1);
+	}
+	m = 0;
+	for(i=0;i<ch->size;i++)
+		if(ch->points[i].n)
+			pts[m++] = ch->points[i];
+	
+	/* fit in [-1, 1] for conditioning */
+	center = (ch->t16_min + ch->t16_max)/32.0;
+	halfspan = (ch->t16_max - ch->t16_min)/32.0;
+	if(halfspan == 0.0)
+		halfspan = 1.0;
+	for(i=0;i<m;i++) {
+		x[i] = (pts[i].t16/16.0 - center)/halfspan;
+		w[i] = 1.0;
+	}
+	
+	/* cannot fit more coefficients than distinct temperatures */
+	nt = (ch->t16_max - ch->t16_min) + 1;
+	d = degree;
+	if(d > nt - 1) d = nt - 1;
+	if(d > m - 1) d = m - 1;
+	
+	memset(c, 0, sizeof(c));
+	ch->sigma = MIN_SIGMA;
+	for(iter=0;iter<MAX_ITER;iter++) {
+		/* weighted normal equations */
+		for(k=0;k<=2*d;k++)
+			p[k] = 0.0L;
+		for(k=0;k<=d;k++)
+			b[k] = 0.0L;
+		for(i=0;i<m;i++) {
+			long double wi = w[i]*(long double)pts[i].n;
+			long double xk = 1.0L;
+	
+			for(k=0;k<=2*d;k++) {
+				p[k] += wi*xk;
+				if(k <= d)
+					b[k] += wi*xk*pts[i].count;
+				xk *= x[i];
+			}
+		}
+		for(j=0;j<=d;j++)
+			for(k=0;k<=d;k++)
+				a[j][k] = p[j+k];
+		memcpy(prev, c, sizeof(c));
+		while(!solve(a, b, d+1, c)) {
+			/* singular, drop the highest degree */
+			if(--d == 0) {
+				c[0] = b[0]/p[0];
+				break;
+			}
+		}
+		for(k=d+1;k<=MAX_DEGREE;k++)
+			c[k] = 0.0;
+	
+		/* robust scale from the median absolute residual */
+		for(i=0;i<m;i++) {
+			res[i].r = fabs(pts[i].count - poly(c, d, x[i]));
+			res[i].n = pts[i].n;
+		}
+		ch->sigma = 1.4826*median_abs(res, m, ch->samples);
+		if(ch->sigma < MIN_SIGMA)
+			ch->sigma = MIN_SIGMA;
+	
+		/* Huber weights */
+		for(i=0;i<m;i++) {
+			r = fabs(pts[i].count - poly(c, d, x[i]));
+			u = HUBER_K*ch->sigma;
+			w[i] = r <= u ? 1.0 : u/r;
+		}
+	
+		change = 0.0;
+		for(k=0;k<=d;k++)
+			change += fabs(c[k] - prev[k]);
+		if((iter > 0) && (change < 1e-9*fabs(c[0])))
+			break;
+	}
+	
+	/* residual statistics, outliers excluded */
+	ss = 0.0;
+	sw = 0;
+	ch->outliers = 0;
+	for(i=0;i<m;i++) {
+		r = pts[i].count - poly(c, d, x[i]);
+		if(fabs(r) > 3.0*ch->sigma)
+			ch->outliers += pts[i].n;
+		else {
+			ss += r*r*pts[i].n;
+			sw += pts[i].n;
+		}
+	}
+	ch->rms = sw ? sqrt(ss/sw) : 0.0;
+	
+	/* expand in degrees around the center */
+	ch->degree = d;
+	ch->center = center;
+	scale = 1.0;
+	for(k=0;k<=MAX_DEGREE;k++) {
+		ch->coef[k] = k <= d ? c[k]/scale : 0.0;
+		scale *= halfspan;
+	}
+	
+	free(w);
+	free(x);
+	free(res);
+	free(pts);
+}
+
+static double predict(const struct channel *ch, double t)
+{
+	return poly(ch->coef, ch->degree, t - ch->center);
+}
+
+/* d f / d T */
+static double slope(const struct channel *ch, double t)
+{
+	double r;
+	int k;
+	
+	r = 0.0;
+	for(k=ch->degree;k>=1;k--)
+		r = r*(t - ch->center) + k*ch->coef[k];
+	return r;
+}
+
+static void fit_all()
+{
+	int i;
+	
+	for(i=0;i<nchannels;i++)
+		fit(&channels[i]);
+}
+
+static double tref;
+static int tref_set;
+
+static double reference()
+{
+	return tref_set ? tref : first_t16/16.0;
+}
+
+static void summary()
+{
+	struct channel *ch;
+	double t, f;
+	int i, k;
+	
+	t = reference();
+	for(i=0;i<nchannels;i++) {
+		ch = &channels[i];
+		if(ch->samples == 0)
+			continue;
+		f = predict(ch, t);
+		printf("CHANNEL %d: samples=%llu points=%u T=%.4f..%.4f f(%.4f)=%.3f slope=%.4f/C (%.4f%%/C) "
+			"rms=%.3f sigma=%.3f outliers=%llu coef@%.4f=",
+			i, (unsigned long long)ch->samples, ch->used,
+			ch->t16_min/16.0, ch->t16_max/16.0, t, f, slope(ch, t), 100.0*slope(ch, t)/f,
+			ch->rms, ch->sigma, (unsigned long long)ch->outliers, ch->center);
+		for(k=0;k<=ch->degree;k++)
+			printf("%s%.9g", k ? "," : "", ch->coef[k]);
+		printf("\n");
+	}
+	if(nskipped)
+		printf("%llu line(s) skipped\n", (unsigned long long)nskipped);
+	fflush(stdout);
+}
+
+/* One line per refit, for live streams */
+static void progress(double t)
+{
+	struct channel *ch;
+	double f;
+	int i;
+	
+	printf("%llu %.4f", (unsigned long long)nsamples, t);
+	for(i=0;i<nchannels;i++) {
+		ch = &channels[i];
+		f = predict(ch, t);
+		printf(" %.3f(%+.4f%%/C)", f, 100.0*slope(ch, t)/f);
+	}
+	printf("\n");
+	fflush(stdout);
+}
+
+static int write_coefficients(const char *filename)
+{
+	struct channel *ch;
+	FILE *fd;
+	int i, k;
+	
+	fd = fopen(filename, "w");
+	if(fd == NULL) {
+		perror("Unable to open coefficient file");
+		return 0;
+	}
+	fprintf(fd, "channel,tmin,tmax,center,rms,degree");
+	for(k=0;k<=degree;k++)
+		fprintf(fd, ",c%d", k);
+	fprintf(fd, "\n");
+	for(i=0;i<nchannels;i++) {
+		ch = &channels[i];
+		fprintf(fd, "%d,%.4f,%.4f,%.4f,%.4f,%d", i,
+			ch->t16_min/16.0, ch->t16_max/16.0, ch->center, ch->rms, ch->degree);
+		for(k=0;k<=degree;k++)
+			fprintf(fd, ",%.9g", ch->coef[k]);
+		fprintf(fd, "\n");
+	}
+	fclose(fd);
+	return 1;
+}
+
+static int write_scale(const char *filename, double tmin, double tmax, double step)
+{
+	double fref[MAX_CHANNELS];
+	double t, f;
+	FILE *fd;
+	int i, j, n;
+	
+	fd = fopen(filename, "w");
+	if(fd == NULL) {
+		perror("Unable to open scale table file");
+		return 0;
+	}
+	fprintf(fd, "temp");
+	for(i=0;i<nchannels;i++) {
+		fref[i] = predict(&channels[i], reference());
+		fprintf(fd, ",freq%d,scale%d", i, i);
+	}
+	fprintf(fd, "\n");
+	n = floor((tmax - tmin)/step + 1e-9);
+	for(j=0;j<=n;j++) {
+		t = tmin + j*step;
+		fprintf(fd, "%.4f", t);
+		for(i=0;i<nchannels;i++) {
+			f = predict(&channels[i], t);
+			fprintf(fd, ",%ld,%ld", lround(f), lround(65536.0*fref[i]/f));
+		}
+		fprintf(fd, "\n");
+	}
+	fclose(fd);
+	return 1;
+}
+
+static void usage()
+{
+	fprintf(stderr, "Usage: rofit [options] [<file>...]\n");
+	fprintf(stderr, "  -n <degree>   polynomial degree (default 2, max %d)\n", MAX_DEGREE);
+	fprintf(stderr, "  -r <temp>     reference temperature (default: first sample)\n");
+	fprintf(stderr, "  -c <file>     write the coefficients (CSV)\n");
+	fprintf(stderr, "  -s <file>     write the frequency and Q16 scale table (CSV)\n");
+	fprintf(stderr, "  -T <min:max>  scale table range (default: range of the data)\n");
+	fprintf(stderr, "  -S <step>     scale table step (default 0.25)\n");
+	fprintf(stderr, "  -i <n>        refit and print the model every n samples\n");
+	fprintf(stderr, "Reads the standard input if no file is given.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *coef_name = NULL;
+	const char *scale_name = NULL;
+	double tmin, tmax, step;
+	int range_set;
+	uint64_t interval;
+	char *line;
+	size_t size;
+	FILE *fd;
+	int opt, i;
+	
+	range_set = 0;
+	tmin = tmax = 0.0;
+	step = 0.25;
+	interval = 0;
+	while((opt = getopt(argc, argv, "n:r:c:s:T:S:i:")) != -1) {
+		switch(opt) {
+			case 'n':
+				degree = atoi(optarg);
+				break;
+			case 'r':
+				tref = atof(optarg);
+				tref_set = 1;
+				break;
+			case 'c':
+				coef_name = optarg;
+				break;
+			case 's':
+				scale_name = optarg;
+				break;
+			case 'T':
+				if(sscanf(optarg, "%lf:%lf", &tmin, &tmax) != 2) {
+					usage();
+					return 1;
+				}
+				range_set = 1;
+				break;
+			case 'S':
+				step = atof(optarg);
+				break;
+			case 'i':
+				interval = strtoull(optarg, NULL, 0);
+				break;
+			default:
+				usage();
+				return 1;
+		}
+	}
+	if((degree < 0) || (degree > MAX_DEGREE) || (step <= 0.0) || (range_set && (tmax < tmin))) {
+		usage();
+		return 1;
+	}
+	
+	line = NULL;
+	size = 0;
+	for(i=optind;(i<argc)||(i==optind);i++) {
+		const char *name = (i < argc) ? argv[i] : "-";
+	
+		if(strcmp(name, "-") == 0)
+			fd = stdin;
+		else {
+			fd = fopen(name, "r");
+			if(fd == NULL) {
+				perror(name);
+				return 1;
+			}
+		}
+		while(getline(&line, &size, fd) != -1) {
+			if(!parse_line(line)) {
+				nskipped++;
+				continue;
+			}
+			if(interval && (nsamples % interval) == 0) {
+				fit_all();
+				progress(atof(line));
+			}
+		}
+		if(fd != stdin) fclose(fd);
+		if(i >= argc) break;
+	}
+	free(line);
+	
+	if(nsamples == 0) {
+		fprintf(stderr, "No samples\n");
+		return 1;
+	}
+	fit_all();
+	summary();
+	
+	if((coef_name != NULL) && !write_coefficients(coef_name))
+		return 1;
+	if(scale_name != NULL) {
+		if(!range_set) {
+			tmin = channels[0].t16_min/16.0;
+			tmax = channels[0].t16_max/16.0;
+		}
+		if(!write_scale(scale_name, tmin, tmax, step))
+			return 1;
+	}
+	return 0;
+}
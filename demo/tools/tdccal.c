@@ -0,0 +1,108 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tdccal.h"
+
+#define MASK(n)	((n) >= 64 ? ~0ULL : (1ULL << (n)) - 1)
+
+int tdccal_check_config(const struct tdccal_config *c)
+{
+	return (c->raw_count >= 1) && (c->raw_count <= 24)
+		&& (c->fp_count >= 1) && (c->exhis_count >= 1)
+		&& (c->fp_count + c->exhis_count <= 32)
+		&& (c->fcounter_width >= 1) && (c->fcounter_width <= 32)
+		&& (c->fp_count + c->fcounter_width <= 64);
+}
+
+uint64_t tdccal_hits(const struct tdccal_config *c)
+{
+	return MASK(c->fp_count + c->exhis_count);
+}
+
+uint64_t tdccal_book(const struct tdccal_config *c, const uint32_t *raw, uint64_t n, uint32_t *his)
+{
+	uint64_t i;
+	uint32_t entries, hmask;
+	uint64_t hits;
+	
+	entries = 1 << c->raw_count;
+	hmask = MASK(c->fp_count + c->exhis_count);
+	for(i=0;i<entries;i++)
+		his[i] = 0;
+	hits = tdccal_hits(c);
+	if(n > hits) n = hits;
+	/* The total is 2^(FP+EXHIS)-1, so the counters cannot wrap */
+	for(i=0;i<n;i++) {
+		uint32_t a = raw[i] & (entries - 1);
+		
+		his[a] = (his[a] + 1) & hmask;
+	}
+	return n;
+}
+
+/*
+ * The quotient of the n-bit product by the FCOUNTER_WIDTH bit frequency
+ * is computed with a multiplication by a precomputed reciprocal.
+ * For n, d < 2^32, floor(n/d) = floor(n*m/2^64) with m = ceil(2^64/d)
+ * (Granlund-Montgomery, Lemire), which is exact for all n.
+ */
+static inline uint64_t div_fast(uint64_t n, uint64_t m)
+{
+	return (uint64_t)(((unsigned __int128)n*m) >> 64);
+}
+
+void tdccal_lut(const struct tdccal_config *c, const uint32_t *his,
+	uint32_t freq, uint32_t sfreq, uint32_t *lut)
+{
+	uint32_t entries;
+	uint64_t acc, amask;
+	uint64_t sat, qmax;
+	uint64_t n, q, m;
+	uint32_t a;
+	int exhis;
+	int narrow;
+	
+	entries = 1 << c->raw_count;
+	exhis = c->exhis_count;
+	amask = MASK(c->fp_count + c->exhis_count);
+	sat = MASK(c->fp_count);
+	freq &= MASK(c->fcounter_width);
+	sfreq &= MASK(c->fcounter_width);
+	
+	if(freq == 0) {
+		/* tdc_divider returns an all-ones quotient, which saturates */
+		for(a=0;a<entries;a++)
+			lut[a] = sat;
+		return;
+	}
+	
+	/* Largest quotient that is not saturated */
+	qmax = sat;
+	narrow = (c->fp_count + c->fcounter_width <= 32) && (freq > 1);
+	m = narrow ? (~0ULL/freq) + 1 : 0;
+	
+	acc = 0;
+	for(a=0;a<entries;a++) {
+		n = (acc >> exhis)*sfreq;
+		if(narrow)
+			q = div_fast(n, m);
+		else
+			q = n/freq;
+		lut[a] = q > qmax ? sat : q;
+		acc = (acc + his[a]) & amask;
+	}
+}
@@ -0,0 +1,59 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TDCCAL_H
+#define __TDCCAL_H
+
+#include <stdint.h>
+
+/*
+ * Bit-exact model of the calibration datapath of tdc_controller:
+ *  - startup calibration books 2^(FP+EXHIS)-1 hits into a histogram of
+ *    FP+EXHIS bit counters,
+ *  - online calibration accumulates the histogram into a FP+EXHIS bit
+ *    accumulator, multiplies its FP most significant bits by the stored
+ *    frequency (FCOUNTER_WIDTH bits), divides by the current frequency
+ *    with tdc_divider (FP+FCOUNTER_WIDTH bits) and saturates the quotient
+ *    to FP bits. LUT(a) is computed from the sum of the bins below a.
+ */
+
+struct tdccal_config {
+	int raw_count;		/* g_RAW_COUNT */
+	int fp_count;		/* g_FP_COUNT */
+	int exhis_count;	/* g_EXHIS_COUNT */
+	int fcounter_width;	/* g_FCOUNTER_WIDTH */
+};
+
+/* Returns 0 if the generics are outside the range supported by the model */
+int tdccal_check_config(const struct tdccal_config *c);
+
+/* Number of hits booked by the startup calibration */
+uint64_t tdccal_hits(const struct tdccal_config *c);
+
+/* Books hits from a stream of raw codes into his (2^raw_count entries),
+ * which is cleared first. Returns the number of raw codes consumed, which
+ * is less than tdccal_hits() if the stream is too short.
+ */
+uint64_t tdccal_book(const struct tdccal_config *c, const uint32_t *raw, uint64_t n, uint32_t *his);
+
+/* Computes the LUT (2^raw_count entries) from a histogram and the
+ * current (freq) and stored (sfreq) ring oscillator frequencies.
+ */
+void tdccal_lut(const struct tdccal_config *c, const uint32_t *his,
+	uint32_t freq, uint32_t sfreq, uint32_t *lut);
+
+#endif /* __TDCCAL_H */
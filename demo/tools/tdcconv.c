@@ -0,0 +1,478 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Converts event captures between CSV and the columnar TDCF format.
+ *
+ * Two CSV layouts are supported:
+ *   diff:   pol0,raw0,ts0,pol1,raw1,ts1 (output of the "diff" command)
+ *   events: channel,polarity,raw,timestamp
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "tdcfile.h"
+
+enum {
+	FORMAT_DIFF,
+	FORMAT_EVENTS
+};
+
+struct csv {
+	const char *data;
+	size_t size;
+	const char *p;
+	int line;
+};
+
+static int csv_open(struct csv *f, const char *filename)
+{
+	int fd;
+	struct stat st;
+	
+	fd = open(filename, O_RDONLY);
+	if(fd == -1) {
+		perror("Unable to open input file");
+		return 0;
+	}
+	if(fstat(fd, &st) == -1) {
+		perror("Unable to stat input file");
+		close(fd);
+		return 0;
+	}
+	f->size = st.st_size;
+	f->data = NULL;
+	if(f->size > 0) {
+		f->data = mmap(NULL, f->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(f->data == MAP_FAILED) {
+			perror("Unable to map input file");
+			close(fd);
+			return 0;
+		}
+		madvise((void *)f->data, f->size, MADV_SEQUENTIAL);
+	}
+	close(fd);
+	f->p = f->data;
+	f->line = 0;
+	return 1;
+}
+
+static void csv_close(struct csv *f)
+{
+	if(f->data != NULL)
+		munmap((void *)f->data, f->size);
+}
+
+/* Parses the next non-empty line into at most n unsigned integers.
+ * Returns the number of fields, 0 at the end of the file, -1 on error.
+ */
+static int csv_next(struct csv *f, uint64_t *fields, int n)
+{
+	const char *end = f->data + f->size;
+	int count;
+	uint64_t v;
+	int digits;
+	
+	while(1) {
+		if(f->p >= end) return 0;
+		f->line++;
+		if((*f->p == '\n') || (*f->p == '\r')) {
+			while((f->p < end) && ((*f->p == '\n') || (*f->p == '\r'))) f->p++;
+			continue;
+		}
+		break;
+	}
+	count = 0;
+	while(1) {
+		while((f->p < end) && (*f->p == ' ')) f->p++;
+		v = 0;
+		digits = 0;
+		while((f->p < end) && (*f->p >= '0') && (*f->p <= '9')) {
+			if(v > (UINT64_MAX - (*f->p - '0'))/10) {
+				digits = 0;
+				break;
+			}
+			v = v*10 + (*f->p - '0');
+			f->p++;
+			digits++;
+		}
+		if((digits == 0) || (count == n)) break;
+		fields[count++] = v;
+		while((f->p < end) && (*f->p == ' ')) f->p++;
+		if((f->p < end) && (*f->p == ',')) {
+			f->p++;
+			continue;
+		}
+		if((f->p == end) || (*f->p == '\n') || (*f->p == '\r')) {
+			while((f->p < end) && (*f->p != '\n')) f->p++;
+			if(f->p < end) f->p++;
+			return count;
+		}
+		break;
+	}
+	/* Skip the rest of the malformed line */
+	while((f->p < end) && (*f->p != '\n')) f->p++;
+	if(f->p < end) f->p++;
+	return -1;
+}
+
+static int csv_to_tdcf(const char *infile, const char *outfile, int format, int chunk_events)
+{
+	struct csv f;
+	struct tdcf_writer *w;
+	uint64_t fields[6];
+	int n;
+	int channels;
+	int errors;
+	uint64_t events;
+	
+	if(!csv_open(&f, infile)) return 1;
+	
+	channels = 2;
+	if(format == FORMAT_EVENTS) {
+		/* Find the channel count first */
+		channels = 0;
+		while((n = csv_next(&f, fields, 4)) != 0) {
+			if((n == 4) && (fields[0] < TDCF_MAX_CHANNELS)
+			  && (fields[0] >= channels))
+				channels = fields[0] + 1;
+		}
+		if(channels == 0) {
+			fprintf(stderr, "No events found\n");
+			csv_close(&f);
+			return 1;
+		}
+		f.p = f.data;
+		f.line = 0;
+	}
+	
+	w = tdcf_create(outfile, channels, chunk_events);
+	if(w == NULL) {
+		csv_close(&f);
+		return 1;
+	}
+	errors = 0;
+	events = 0;
+	while((n = csv_next(&f, fields, 6)) != 0) {
+		if(format == FORMAT_DIFF) {
+			if(n != 6) {
+				fprintf(stderr, "%s:%d: expected 6 fields, line ignored\n", infile, f.line);
+				errors++;
+				continue;
+			}
+			if(!tdcf_write(w, 0, fields[0], fields[1], fields[2])
+			  || !tdcf_write(w, 1, fields[3], fields[4], fields[5]))
+				break;
+			events += 2;
+		} else {
+			if((n != 4) || (fields[0] >= (uint64_t)channels)) {
+				fprintf(stderr, "%s:%d: expected channel,polarity,raw,timestamp, line ignored\n", infile, f.line);
+				errors++;
+				continue;
+			}
+			if(!tdcf_write(w, fields[0], fields[1], fields[2], fields[3]))
+				break;
+			events++;
+		}
+	}
+	csv_close(&f);
+	if(!tdcf_close_writer(w) || (n != 0))
+		return 1;
+	fprintf(stderr, "%" PRIu64 " events in %d channel(s) written", events, channels);
+	if(errors > 0)
+		fprintf(stderr, ", %d line(s) ignored", errors);
+	fprintf(stderr, "\n");
+	return 0;
+}
+
+/* Decoded columns of one channel within the current chunk */
+struct column {
+	int chunk;
+	int count;
+	int pos;
+	int capacity;
+	uint64_t *timestamps;
+	uint16_t *raw;
+	uint8_t *polarities;
+};
+
+static int column_load(struct tdcf_reader *r, struct column *c, int chunk, int channel)
+{
+	int n;
+	
+	n = tdcf_count(r, chunk, channel);
+	if(n < 0) return 0;
+	if(n > c->capacity) {
+		free(c->timestamps);
+		free(c->raw);
+		free(c->polarities);
+		c->timestamps = malloc(n*sizeof(uint64_t));
+		c->raw = malloc(n*sizeof(uint16_t));
+		c->polarities = malloc(n);
+		if((c->timestamps == NULL) || (c->raw == NULL) || (c->polarities == NULL)) return 0;
+		c->capacity = n;
+	}
+	if((tdcf_read_timestamps(r, chunk, channel, c->timestamps) != n)
+	  || (tdcf_read_raw(r, chunk, channel, c->raw) != n)
+	  || (tdcf_read_polarities(r, chunk, channel, c->polarities) != n)) {
+		fprintf(stderr, "Corrupted chunk %d\n", chunk);
+		return 0;
+	}
+	c->chunk = chunk;
+	c->count = n;
+	c->pos = 0;
+	return 1;
+}
+
+/* Moves to the next available event of the channel. Returns 0 at the end. */
+static int column_next(struct tdcf_reader *r, struct column *c, int channel)
+{
+	while(c->pos == c->count) {
+		if(c->chunk + 1 >= tdcf_chunks(r)) return 0;
+		if(!column_load(r, c, c->chunk + 1, channel)) return -1;
+	}
+	return 1;
+}
+
+static void column_free(struct column *c)
+{
+	free(c->timestamps);
+	free(c->raw);
+	free(c->polarities);
+}
+
+static int in_range(uint64_t t, uint64_t start, uint64_t end)
+{
+	return (t >= start) && (t <= end);
+}
+
+static int tdcf_to_csv(const char *infile, const char *outfile, int format, uint64_t start, uint64_t end)
+{
+	struct tdcf_reader *r;
+	FILE *fo;
+	struct column columns[TDCF_MAX_CHANNELS];
+	int channels;
+	int first;
+	int ch;
+	int i, n;
+	int ret;
+	
+	r = tdcf_open(infile);
+	if(r == NULL) return 1;
+	channels = tdcf_channels(r);
+	if((format == FORMAT_DIFF) && (channels != 2)) {
+		fprintf(stderr, "The diff format requires 2 channels (file has %d)\n", channels);
+		tdcf_close(r);
+		return 1;
+	}
+	if(strcmp(outfile, "-") == 0)
+		fo = stdout;
+	else {
+		fo = fopen(outfile, "w");
+		if(fo == NULL) {
+			perror("Unable to open output file");
+			tdcf_close(r);
+			return 1;
+		}
+	}
+	
+	ret = 0;
+	memset(columns, 0, sizeof(columns));
+	first = tdcf_seek(r, start);
+	if(format == FORMAT_DIFF) {
+		/* Events of both channels are paired in order, so skipped chunks
+		 * must hold as many events of each channel.
+		 */
+		n = 0;
+		for(i=0;i<first;i++)
+			n += tdcf_count(r, i, 0) - tdcf_count(r, i, 1);
+		if(n != 0)
+			first = 0;
+		for(ch=0;ch<2;ch++) {
+			columns[ch].chunk = first - 1;
+			columns[ch].count = columns[ch].pos = 0;
+		}
+		while(1) {
+			struct column *c0 = &columns[0];
+			struct column *c1 = &columns[1];
+			int r0, r1;
+			
+			r0 = column_next(r, c0, 0);
+			r1 = column_next(r, c1, 1);
+			if((r0 < 0) || (r1 < 0)) {
+				ret = 1;
+				break;
+			}
+			if(!r0 || !r1) break;
+			if(in_range(c0->timestamps[c0->pos], start, end))
+				fprintf(fo, "%d,%d,%" PRIu64 ",%d,%d,%" PRIu64 "\n",
+					c0->polarities[c0->pos], c0->raw[c0->pos], c0->timestamps[c0->pos],
+					c1->polarities[c1->pos], c1->raw[c1->pos], c1->timestamps[c1->pos]);
+			c0->pos++;
+			c1->pos++;
+		}
+	} else {
+		for(i=first;i<tdcf_chunks(r);i++) {
+			if((tdcf_flags(r) & TDCF_FLAG_SORTED) && (tdcf_chunk(r, i)->min_ts > end))
+				break;
+			for(ch=0;ch<channels;ch++)
+				if(!column_load(r, &columns[ch], i, ch)) {
+					ret = 1;
+					goto out;
+				}
+			/* Merge the channels by time */
+			while(1) {
+				n = -1;
+				for(ch=0;ch<channels;ch++) {
+					struct column *c = &columns[ch];
+					
+					if(c->pos == c->count) continue;
+					if((n == -1) || (c->timestamps[c->pos] < columns[n].timestamps[columns[n].pos]))
+						n = ch;
+				}
+				if(n == -1) break;
+				if(in_range(columns[n].timestamps[columns[n].pos], start, end))
+					fprintf(fo, "%d,%d,%d,%" PRIu64 "\n", n,
+						columns[n].polarities[columns[n].pos],
+						columns[n].raw[columns[n].pos],
+						columns[n].timestamps[columns[n].pos]);
+				columns[n].pos++;
+			}
+		}
+	}
+out:
+	for(ch=0;ch<channels;ch++)
+		column_free(&columns[ch]);
+	if((fo != stdout) && (fclose(fo) != 0)) {
+		perror("Unable to close output file");
+		ret = 1;
+	}
+	tdcf_close(r);
+	return ret;
+}
+
+static int list(const char *infile)
+{
+	struct tdcf_reader *r;
+	const struct tdcf_chunk_info *info;
+	int i, ch;
+	
+	r = tdcf_open(infile);
+	if(r == NULL) return 1;
+	printf("Channels: %d Chunks: %d Sorted: %s\n", tdcf_channels(r), tdcf_chunks(r),
+		(tdcf_flags(r) & TDCF_FLAG_SORTED) ? "yes" : "no");
+	for(i=0;i<tdcf_chunks(r);i++) {
+		info = tdcf_chunk(r, i);
+		printf("%d: offset=%" PRIu64 " events=%u ts=%" PRIu64 "..%" PRIu64 " per channel:",
+			i, info->offset, info->events, info->min_ts, info->max_ts);
+		for(ch=0;ch<tdcf_channels(r);ch++)
+			printf(" %d", tdcf_count(r, i, ch));
+		printf("\n");
+	}
+	tdcf_close(r);
+	return 0;
+}
+
+static int is_tdcf(const char *filename)
+{
+	FILE *fd;
+	char magic[4];
+	int r;
+	
+	fd = fopen(filename, "rb");
+	if(fd == NULL) return 0;
+	r = (fread(magic, 4, 1, fd) == 1) && (memcmp(magic, "TDCF", 4) == 0);
+	fclose(fd);
+	return r;
+}
+
+static void usage()
+{
+	fprintf(stderr, "Usage: tdcconv [-f diff|events] [-c <chunk events>] <in.csv> <out.tdcf>\n");
+	fprintf(stderr, "       tdcconv [-f diff|events] [-s <start>] [-e <end>] <in.tdcf> <out.csv|->\n");
+	fprintf(stderr, "       tdcconv -l <in.tdcf>\n");
+	fprintf(stderr, "CSV formats: diff (pol0,raw0,ts0,pol1,raw1,ts1, default)\n");
+	fprintf(stderr, "             events (channel,polarity,raw,timestamp)\n");
+}
+
+int main(int argc, char *argv[])
+{
+	int opt;
+	int format;
+	int chunk_events;
+	int do_list;
+	uint64_t start, end;
+	
+	format = FORMAT_DIFF;
+	chunk_events = TDCF_DEFAULT_CHUNK;
+	do_list = 0;
+	start = 0;
+	end = UINT64_MAX;
+	while((opt = getopt(argc, argv, "f:c:s:e:l")) != -1) {
+		switch(opt) {
+			case 'f':
+				if(strcmp(optarg, "diff") == 0)
+					format = FORMAT_DIFF;
+				else if(strcmp(optarg, "events") == 0)
+					format = FORMAT_EVENTS;
+				else {
+					usage();
+					return 1;
+				}
+				break;
+			case 'c':
+				chunk_events = atoi(optarg);
+				break;
+			case 's':
+				start = strtoull(optarg, NULL, 0);
+				break;
+			case 'e':
+				end = strtoull(optarg, NULL, 0);
+				break;
+			case 'l':
+				do_list = 1;
+				break;
+			default:
+				usage();
+				return 1;
+		}
+	}
+	if(do_list) {
+		if(argc - optind != 1) {
+			usage();
+			return 1;
+		}
+		return list(argv[optind]);
+	}
+	if(argc - optind != 2) {
+		usage();
+		return 1;
+	}
+	if(is_tdcf(argv[optind]))
+		return tdcf_to_csv(argv[optind], argv[optind+1], format, start, end);
+	else
+		return csv_to_tdcf(argv[optind], argv[optind+1], format, chunk_events);
+}
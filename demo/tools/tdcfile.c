@@ -0,0 +1,568 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "tdcfile.h"
+
+#define HEADER_SIZE	16
+#define DESC_SIZE	16
+#define INDEX_SIZE	32
+#define FOOTER_SIZE	16
+
+static void put_u16(unsigned char *p, uint16_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+}
+
+static void put_u32(unsigned char *p, uint32_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+static void put_u64(unsigned char *p, uint64_t v)
+{
+	put_u32(p, v);
+	put_u32(p+4, v >> 32);
+}
+
+static uint16_t get_u16(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const unsigned char *p)
+{
+	return get_u32(p) | ((uint64_t)get_u32(p+4) << 32);
+}
+
+static int put_varint(unsigned char *p, uint64_t v)
+{
+	int n;
+	
+	n = 0;
+	while(v >= 0x80) {
+		p[n++] = v | 0x80;
+		v >>= 7;
+	}
+	p[n++] = v;
+	return n;
+}
+
+static uint64_t zigzag(int64_t v)
+{
+	return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v)
+{
+	return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+/*
+ * Writer
+ */
+
+struct channel_buffer {
+	unsigned int count;
+	unsigned int size;
+	uint64_t *timestamps;
+	uint16_t *raw;
+	uint8_t *polarities;
+	uint64_t last_ts;	/* last timestamp of the previous chunk */
+	int has_last;
+};
+
+struct tdcf_writer {
+	FILE *fd;
+	int channels;
+	unsigned int chunk_events;
+	unsigned int pending;
+	uint32_t flags;
+	uint64_t prev_max;
+	struct channel_buffer buffers[TDCF_MAX_CHANNELS];
+	
+	unsigned int nchunks;
+	unsigned int index_size;
+	struct tdcf_chunk_info *index;
+	
+	unsigned char *scratch;
+	unsigned int scratch_size;
+};
+
+struct tdcf_writer *tdcf_create(const char *filename, int channels, int chunk_events)
+{
+	struct tdcf_writer *w;
+	unsigned char header[HEADER_SIZE];
+	
+	if((channels < 1) || (channels > TDCF_MAX_CHANNELS)) {
+		fprintf(stderr, "Incorrect channel count\n");
+		return NULL;
+	}
+	if(chunk_events <= 0) chunk_events = TDCF_DEFAULT_CHUNK;
+	w = calloc(1, sizeof(struct tdcf_writer));
+	if(w == NULL) return NULL;
+	w->fd = fopen(filename, "wb");
+	if(w->fd == NULL) {
+		perror("Unable to open output file");
+		free(w);
+		return NULL;
+	}
+	w->channels = channels;
+	w->chunk_events = chunk_events;
+	w->flags = TDCF_FLAG_SORTED;
+	
+	memcpy(header, "TDCF", 4);
+	put_u16(&header[4], TDCF_VERSION);
+	put_u16(&header[6], channels);
+	put_u32(&header[8], 0);
+	put_u32(&header[12], 0);
+	fwrite(header, HEADER_SIZE, 1, w->fd);
+	return w;
+}
+
+static int flush_chunk(struct tdcf_writer *w)
+{
+	int c;
+	unsigned int i;
+	unsigned int needed;
+	unsigned char *p, *q;
+	unsigned char desc[DESC_SIZE];
+	unsigned int ts_bytes[TDCF_MAX_CHANNELS];
+	struct tdcf_chunk_info info;
+	struct channel_buffer *b;
+	int first;
+	
+	if(w->pending == 0) return 1;
+	
+	/* Worst case: 10 bytes per varint, plus one raw and polarity column */
+	needed = 0;
+	for(c=0;c<w->channels;c++)
+		needed += 13*w->buffers[c].count + 1;
+	if(needed > w->scratch_size) {
+		free(w->scratch);
+		w->scratch = malloc(needed);
+		if(w->scratch == NULL) return 0;
+		w->scratch_size = needed;
+	}
+	
+	info.offset = ftello(w->fd);
+	info.events = w->pending;
+	first = 1;
+	info.min_ts = info.max_ts = 0;
+	for(c=0;c<w->channels;c++) {
+		b = &w->buffers[c];
+		for(i=0;i<b->count;i++) {
+			if(first || (b->timestamps[i] < info.min_ts)) info.min_ts = b->timestamps[i];
+			if(first || (b->timestamps[i] > info.max_ts)) info.max_ts = b->timestamps[i];
+			first = 0;
+		}
+	}
+	if((w->nchunks > 0) && (info.min_ts < w->prev_max))
+		w->flags &= ~TDCF_FLAG_SORTED;
+	w->prev_max = info.max_ts;
+	
+	/* Encode the timestamp columns first to know their size */
+	p = w->scratch;
+	for(c=0;c<w->channels;c++) {
+		b = &w->buffers[c];
+		ts_bytes[c] = 0;
+		for(i=1;i<b->count;i++) {
+			if(b->timestamps[i] < b->timestamps[i-1])
+				w->flags &= ~TDCF_FLAG_SORTED;
+			ts_bytes[c] += put_varint(p + ts_bytes[c],
+				zigzag((int64_t)(b->timestamps[i] - b->timestamps[i-1])));
+		}
+		if((b->count > 0) && b->has_last && (b->timestamps[0] < b->last_ts))
+			w->flags &= ~TDCF_FLAG_SORTED;
+		p += ts_bytes[c];
+	}
+	
+	for(c=0;c<w->channels;c++) {
+		b = &w->buffers[c];
+		put_u32(&desc[0], b->count);
+		put_u32(&desc[4], ts_bytes[c]);
+		put_u64(&desc[8], b->count > 0 ? b->timestamps[0] : 0);
+		fwrite(desc, DESC_SIZE, 1, w->fd);
+	}
+	/* Raw and polarity columns are formatted after the timestamps */
+	q = p;
+	p = w->scratch;
+	for(c=0;c<w->channels;c++) {
+		b = &w->buffers[c];
+		fwrite(p, 1, ts_bytes[c], w->fd);
+		p += ts_bytes[c];
+		
+		for(i=0;i<b->count;i++)
+			put_u16(&q[2*i], b->raw[i]);
+		fwrite(q, 2, b->count, w->fd);
+		
+		memset(q, 0, (b->count+7)/8);
+		for(i=0;i<b->count;i++)
+			if(b->polarities[i])
+				q[i/8] |= 1 << (i % 8);
+		fwrite(q, 1, (b->count+7)/8, w->fd);
+		
+		if(b->count > 0) {
+			b->last_ts = b->timestamps[b->count-1];
+			b->has_last = 1;
+		}
+		b->count = 0;
+	}
+	
+	if(w->nchunks == w->index_size) {
+		struct tdcf_chunk_info *index;
+		
+		w->index_size = w->index_size ? 2*w->index_size : 64;
+		index = realloc(w->index, w->index_size*sizeof(struct tdcf_chunk_info));
+		if(index == NULL) return 0;
+		w->index = index;
+	}
+	w->index[w->nchunks++] = info;
+	w->pending = 0;
+	return !ferror(w->fd);
+}
+
+int tdcf_write(struct tdcf_writer *w, int channel, int polarity, int raw, uint64_t timestamp)
+{
+	struct channel_buffer *b;
+	
+	if((channel < 0) || (channel >= w->channels)) return 0;
+	b = &w->buffers[channel];
+	if(b->count == b->size) {
+		unsigned int size;
+		uint64_t *timestamps;
+		uint16_t *raws;
+		uint8_t *polarities;
+		
+		size = b->size ? 2*b->size : 1024;
+		timestamps = realloc(b->timestamps, size*sizeof(uint64_t));
+		if(timestamps == NULL) return 0;
+		b->timestamps = timestamps;
+		raws = realloc(b->raw, size*sizeof(uint16_t));
+		if(raws == NULL) return 0;
+		b->raw = raws;
+		polarities = realloc(b->polarities, size);
+		if(polarities == NULL) return 0;
+		b->polarities = polarities;
+		b->size = size;
+	}
+	b->timestamps[b->count] = timestamp;
+	b->raw[b->count] = raw;
+	b->polarities[b->count] = polarity != 0;
+	b->count++;
+	w->pending++;
+	if(w->pending >= w->chunk_events)
+		return flush_chunk(w);
+	return 1;
+}
+
+int tdcf_close_writer(struct tdcf_writer *w)
+{
+	int ok;
+	int c;
+	unsigned int i;
+	uint64_t index_offset;
+	unsigned char entry[INDEX_SIZE];
+	unsigned char footer[FOOTER_SIZE];
+	
+	ok = flush_chunk(w);
+	
+	index_offset = ftello(w->fd);
+	for(i=0;i<w->nchunks;i++) {
+		put_u64(&entry[0], w->index[i].offset);
+		put_u64(&entry[8], w->index[i].min_ts);
+		put_u64(&entry[16], w->index[i].max_ts);
+		put_u32(&entry[24], w->index[i].events);
+		put_u32(&entry[28], 0);
+		fwrite(entry, INDEX_SIZE, 1, w->fd);
+	}
+	put_u64(&footer[0], index_offset);
+	put_u32(&footer[8], w->nchunks);
+	memcpy(&footer[12], "TDCI", 4);
+	fwrite(footer, FOOTER_SIZE, 1, w->fd);
+	
+	/* The flags are only known now */
+	put_u32(entry, w->flags);
+	fseeko(w->fd, 8, SEEK_SET);
+	fwrite(entry, 4, 1, w->fd);
+	
+	if(ferror(w->fd)) ok = 0;
+	if(fclose(w->fd) != 0) ok = 0;
+	if(!ok)
+		perror("Unable to write output file");
+	
+	for(c=0;c<w->channels;c++) {
+		free(w->buffers[c].timestamps);
+		free(w->buffers[c].raw);
+		free(w->buffers[c].polarities);
+	}
+	free(w->index);
+	free(w->scratch);
+	free(w);
+	return ok;
+}
+
+/*
+ * Reader
+ */
+
+struct tdcf_reader {
+	const unsigned char *data;
+	size_t size;
+	int channels;
+	uint32_t flags;
+	int nchunks;
+	struct tdcf_chunk_info *index;
+};
+
+struct tdcf_reader *tdcf_open(const char *filename)
+{
+	struct tdcf_reader *r;
+	int fd;
+	struct stat st;
+	uint64_t index_offset;
+	int i;
+	
+	fd = open(filename, O_RDONLY);
+	if(fd == -1) {
+		perror("Unable to open input file");
+		return NULL;
+	}
+	if(fstat(fd, &st) == -1) {
+		perror("Unable to stat input file");
+		close(fd);
+		return NULL;
+	}
+	if(st.st_size < HEADER_SIZE + FOOTER_SIZE) {
+		fprintf(stderr, "Input file is too small\n");
+		close(fd);
+		return NULL;
+	}
+	r = calloc(1, sizeof(struct tdcf_reader));
+	if(r == NULL) {
+		close(fd);
+		return NULL;
+	}
+	r->size = st.st_size;
+	r->data = mmap(NULL, r->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(r->data == MAP_FAILED) {
+		perror("Unable to map input file");
+		free(r);
+		return NULL;
+	}
+	
+	if((memcmp(r->data, "TDCF", 4) != 0)
+	  || (memcmp(&r->data[r->size-4], "TDCI", 4) != 0)) {
+		fprintf(stderr, "Not a TDC capture file\n");
+		goto fail;
+	}
+	if(get_u16(&r->data[4]) != TDCF_VERSION) {
+		fprintf(stderr, "Unsupported file version\n");
+		goto fail;
+	}
+	r->channels = get_u16(&r->data[6]);
+	r->flags = get_u32(&r->data[8]);
+	index_offset = get_u64(&r->data[r->size-FOOTER_SIZE]);
+	r->nchunks = get_u32(&r->data[r->size-8]);
+	if((r->channels < 1) || (r->channels > TDCF_MAX_CHANNELS)
+	  || (index_offset + (uint64_t)r->nchunks*INDEX_SIZE != r->size-FOOTER_SIZE)) {
+		fprintf(stderr, "Corrupted file header or index\n");
+		goto fail;
+	}
+	r->index = malloc((r->nchunks+1)*sizeof(struct tdcf_chunk_info));
+	if(r->index == NULL) goto fail;
+	for(i=0;i<r->nchunks;i++) {
+		const unsigned char *e = &r->data[index_offset + (uint64_t)i*INDEX_SIZE];
+		
+		r->index[i].offset = get_u64(&e[0]);
+		r->index[i].min_ts = get_u64(&e[8]);
+		r->index[i].max_ts = get_u64(&e[16]);
+		r->index[i].events = get_u32(&e[24]);
+		if(r->index[i].offset + (uint64_t)r->channels*DESC_SIZE > index_offset) {
+			fprintf(stderr, "Corrupted chunk index\n");
+			goto fail;
+		}
+	}
+	return r;
+fail:
+	tdcf_close(r);
+	return NULL;
+}
+
+void tdcf_close(struct tdcf_reader *r)
+{
+	munmap((void *)r->data, r->size);
+	free(r->index);
+	free(r);
+}
+
+int tdcf_channels(struct tdcf_reader *r)
+{
+	return r->channels;
+}
+
+int tdcf_chunks(struct tdcf_reader *r)
+{
+	return r->nchunks;
+}
+
+uint32_t tdcf_flags(struct tdcf_reader *r)
+{
+	return r->flags;
+}
+
+const struct tdcf_chunk_info *tdcf_chunk(struct tdcf_reader *r, int chunk)
+{
+	if((chunk < 0) || (chunk >= r->nchunks)) return NULL;
+	return &r->index[chunk];
+}
+
+/* Locates the columns of a channel within a chunk */
+static int locate(struct tdcf_reader *r, int chunk, int channel,
+	uint32_t *count, uint64_t *first_ts,
+	const unsigned char **ts, uint32_t *ts_bytes,
+	const unsigned char **raw, const unsigned char **pol)
+{
+	const unsigned char *desc;
+	const unsigned char *p;
+	uint64_t pos;
+	int c;
+	uint32_t n, tb;
+	
+	if((chunk < 0) || (chunk >= r->nchunks) || (channel < 0) || (channel >= r->channels))
+		return 0;
+	desc = &r->data[r->index[chunk].offset];
+	pos = r->index[chunk].offset + (uint64_t)r->channels*DESC_SIZE;
+	for(c=0;c<=channel;c++) {
+		n = get_u32(&desc[c*DESC_SIZE]);
+		tb = get_u32(&desc[c*DESC_SIZE+4]);
+		p = &r->data[pos];
+		pos += (uint64_t)tb + 2*(uint64_t)n + (n+7)/8;
+		if(pos > r->size - FOOTER_SIZE) return 0;
+	}
+	*count = n;
+	*first_ts = get_u64(&desc[channel*DESC_SIZE+8]);
+	*ts = p;
+	*ts_bytes = tb;
+	*raw = p + tb;
+	*pol = p + tb + 2*n;
+	return 1;
+}
+
+int tdcf_count(struct tdcf_reader *r, int chunk, int channel)
+{
+	uint32_t count, tb;
+	uint64_t first;
+	const unsigned char *ts, *raw, *pol;
+	
+	if(!locate(r, chunk, channel, &count, &first, &ts, &tb, &raw, &pol)) return -1;
+	return count;
+}
+
+int tdcf_read_timestamps(struct tdcf_reader *r, int chunk, int channel, uint64_t *timestamps)
+{
+	uint32_t count, tb;
+	uint64_t t;
+	const unsigned char *ts, *raw, *pol, *end;
+	uint32_t i;
+	uint64_t v;
+	int shift;
+	
+	if(!locate(r, chunk, channel, &count, &t, &ts, &tb, &raw, &pol)) return -1;
+	if(count == 0) return 0;
+	end = ts + tb;
+	timestamps[0] = t;
+	for(i=1;i<count;i++) {
+		v = 0;
+		shift = 0;
+		do {
+			if((ts == end) || (shift > 63)) return -1;
+			v |= (uint64_t)(*ts & 0x7f) << shift;
+			shift += 7;
+		} while(*ts++ & 0x80);
+		t += (uint64_t)unzigzag(v);
+		timestamps[i] = t;
+	}
+	return count;
+}
+
+int tdcf_read_raw(struct tdcf_reader *r, int chunk, int channel, uint16_t *raw)
+{
+	uint32_t count, tb;
+	uint64_t first;
+	const unsigned char *ts, *rawcol, *pol;
+	uint32_t i;
+	
+	if(!locate(r, chunk, channel, &count, &first, &ts, &tb, &rawcol, &pol)) return -1;
+	for(i=0;i<count;i++)
+		raw[i] = get_u16(&rawcol[2*i]);
+	return count;
+}
+
+int tdcf_read_polarities(struct tdcf_reader *r, int chunk, int channel, uint8_t *polarities)
+{
+	uint32_t count, tb;
+	uint64_t first;
+	const unsigned char *ts, *raw, *pol;
+	uint32_t i;
+	
+	if(!locate(r, chunk, channel, &count, &first, &ts, &tb, &raw, &pol)) return -1;
+	for(i=0;i<count;i++)
+		polarities[i] = (pol[i/8] >> (i % 8)) & 1;
+	return count;
+}
+
+int tdcf_seek(struct tdcf_reader *r, uint64_t timestamp)
+{
+	int lo, hi, mid;
+	
+	if(r->flags & TDCF_FLAG_SORTED) {
+		/* First chunk whose last event is not before the given time */
+		lo = 0;
+		hi = r->nchunks;
+		while(lo < hi) {
+			mid = (lo + hi)/2;
+			if(r->index[mid].max_ts < timestamp)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+	for(lo=0;lo<r->nchunks;lo++)
+		if(r->index[lo].max_ts >= timestamp)
+			break;
+	return lo;
+}
@@ -0,0 +1,87 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TDCFILE_H
+#define __TDCFILE_H
+
+#include <stdint.h>
+
+/*
+ * Chunked columnar storage for TDC event captures.
+ *
+ * All integers are little endian.
+ *
+ * File header (16 bytes):
+ *   "TDCF", u16 version, u16 channel count, u32 flags, u32 reserved
+ * Chunks, each made of:
+ *   per channel descriptor: u32 event count, u32 timestamp column size,
+ *                           u64 first timestamp
+ *   per channel columns:    timestamps (zigzag varint deltas from the
+ *                           previous event, count-1 entries),
+ *                           raw codes (u16 each),
+ *                           polarities (bitmap, LSB first)
+ * Chunk index, one 32-byte entry per chunk:
+ *   u64 chunk offset, u64 min timestamp, u64 max timestamp,
+ *   u32 event count, u32 reserved
+ * Footer (16 bytes):
+ *   u64 index offset, u32 chunk count, "TDCI"
+ *
+ * Timestamps are opaque unsigned 64-bit values (e.g. coarse time or the
+ * fixed-point MESH:MESL value). When they never decrease within a
+ * channel and chunks follow each other in time, TDCF_FLAG_SORTED is set
+ * and tdcf_seek() uses a binary search of the index.
+ */
+
+#define TDCF_VERSION		1
+#define TDCF_MAX_CHANNELS	64
+#define TDCF_DEFAULT_CHUNK	65536
+
+#define TDCF_FLAG_SORTED	0x00000001
+
+struct tdcf_chunk_info {
+	uint64_t offset;
+	uint64_t min_ts;
+	uint64_t max_ts;
+	uint32_t events;
+};
+
+struct tdcf_writer;
+struct tdcf_reader;
+
+struct tdcf_writer *tdcf_create(const char *filename, int channels, int chunk_events);
+int tdcf_write(struct tdcf_writer *w, int channel, int polarity, int raw, uint64_t timestamp);
+/* Flushes the last chunk and writes the index. Returns 0 on error. */
+int tdcf_close_writer(struct tdcf_writer *w);
+
+struct tdcf_reader *tdcf_open(const char *filename);
+void tdcf_close(struct tdcf_reader *r);
+int tdcf_channels(struct tdcf_reader *r);
+int tdcf_chunks(struct tdcf_reader *r);
+uint32_t tdcf_flags(struct tdcf_reader *r);
+const struct tdcf_chunk_info *tdcf_chunk(struct tdcf_reader *r, int chunk);
+/* Number of events of a channel in a chunk */
+int tdcf_count(struct tdcf_reader *r, int chunk, int channel);
+/* Column accessors: decode only the requested column. Return the number
+ * of events written to the array, or -1 if the file is corrupted.
+ */
+int tdcf_read_timestamps(struct tdcf_reader *r, int chunk, int channel, uint64_t *timestamps);
+int tdcf_read_raw(struct tdcf_reader *r, int chunk, int channel, uint16_t *raw);
+int tdcf_read_polarities(struct tdcf_reader *r, int chunk, int channel, uint8_t *polarities);
+/* Returns the first chunk that may contain events at or after the given time */
+int tdcf_seek(struct tdcf_reader *r, uint64_t timestamp);
+
+#endif /* __TDCFILE_H */
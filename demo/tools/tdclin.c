@@ -0,0 +1,165 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "tdclin.h"
+
+#define MAX_BINS	(1 << 12)
+
+/* Sums of h, h^2 and h^3 over [first, last], in double precision */
+static void moments(const uint32_t *his, int first, int last, double *s1, double *s2, double *s3)
+{
+	int i;
+#ifdef __SSE2__
+	__m128d a1, a2, a3, h;
+	double t[2];
+	
+	a1 = a2 = a3 = _mm_setzero_pd();
+	i = first;
+	for(;i+1<=last;i+=2) {
+		h = _mm_set_pd((double)his[i+1], (double)his[i]);
+		a1 = _mm_add_pd(a1, h);
+		h = _mm_mul_pd(h, h);
+		a2 = _mm_add_pd(a2, h);
+		a3 = _mm_add_pd(a3, _mm_mul_pd(h, _mm_set_pd((double)his[i+1], (double)his[i])));
+	}
+	_mm_storeu_pd(t, a1);
+	*s1 = t[0] + t[1];
+	_mm_storeu_pd(t, a2);
+	*s2 = t[0] + t[1];
+	_mm_storeu_pd(t, a3);
+	*s3 = t[0] + t[1];
+#else
+	*s1 = *s2 = *s3 = 0.0;
+	i = first;
+#endif
+	for(;i<=last;i++) {
+		double h = his[i];
+		
+		*s1 += h;
+		*s2 += h*h;
+		*s3 += h*h*h;
+	}
+}
+
+/* dnl(i) = his(i)*scale - 1 */
+static void dnl_kernel(const uint32_t *his, int first, int last, double scale, double *dnl)
+{
+	int i;
+#ifdef __SSE2__
+	__m128d vs, one;
+	
+	vs = _mm_set1_pd(scale);
+	one = _mm_set1_pd(1.0);
+	for(i=first;i+1<=last;i+=2)
+		_mm_storeu_pd(&dnl[i], _mm_sub_pd(
+			_mm_mul_pd(_mm_set_pd((double)his[i+1], (double)his[i]), vs), one));
+#else
+	i = first;
+#endif
+	for(;i<=last;i++)
+		dnl[i] = his[i]*scale - 1.0;
+}
+
+int tdclin_analyze(const uint32_t *his, const uint32_t *lut, int n,
+	double period_ps, int fp_count,
+	double *dnl, double *inl, double *lut_err,
+	struct tdclin_result *r)
+{
+	double dnl_local[MAX_BINS];
+	double s1, s2, s3;
+	double width_scale;
+	double acc, edge, e, lut_scale, sq;
+	uint32_t hmin, hmax;
+	int i;
+	
+	memset(r, 0, sizeof(struct tdclin_result));
+	r->bins = n;
+	if((n <= 0) || (n > MAX_BINS)) return 0;
+	if(dnl == NULL) dnl = dnl_local;
+	
+	r->first = -1;
+	r->last = -1;
+	hmin = UINT32_MAX;
+	hmax = 0;
+	for(i=0;i<n;i++) {
+		if(his[i] == 0) continue;
+		if(r->first < 0) r->first = i;
+		r->last = i;
+		if(his[i] < hmin) hmin = his[i];
+		if(his[i] > hmax) hmax = his[i];
+	}
+	if(r->first < 0) return 0;
+	r->used = r->last - r->first + 1;
+	for(i=r->first;i<=r->last;i++)
+		if(his[i] == 0) r->zero++;
+	
+	moments(his, r->first, r->last, &s1, &s2, &s3);
+	r->hits = s1;
+	width_scale = period_ps/s1;
+	r->lsb = period_ps/r->used;
+	r->width_min = hmin*width_scale;
+	r->width_max = hmax*width_scale;
+	r->width_std = sqrt(s2/r->used - (s1/r->used)*(s1/r->used))*width_scale;
+	/* sqrt(sum(w^3)/(12*sum(w))) with w = h*width_scale */
+	r->rms = sqrt(s3/(12.0*s1))*width_scale;
+	
+	/* Bins outside the used range have a DNL of -1 */
+	for(i=0;i<r->first;i++) dnl[i] = -1.0;
+	for(i=r->last+1;i<n;i++) dnl[i] = -1.0;
+	dnl_kernel(his, r->first, r->last, width_scale/r->lsb, dnl);
+	
+	r->dnl_min = r->dnl_max = dnl[r->first];
+	r->inl_min = r->inl_max = 0.0;
+	acc = 0.0;
+	for(i=r->first;i<=r->last;i++) {
+		if(dnl[i] < r->dnl_min) r->dnl_min = dnl[i];
+		if(dnl[i] > r->dnl_max) r->dnl_max = dnl[i];
+		acc += dnl[i];
+		if(inl != NULL) inl[i] = acc;
+		if(acc < r->inl_min) r->inl_min = acc;
+		if(acc > r->inl_max) r->inl_max = acc;
+	}
+	if(inl != NULL) {
+		for(i=0;i<r->first;i++) inl[i] = 0.0;
+		for(i=r->last+1;i<n;i++) inl[i] = acc;
+	}
+	
+	if(lut != NULL) {
+		r->has_lut = 1;
+		lut_scale = period_ps/(double)(1 << fp_count);
+		edge = 0.0;
+		sq = 0.0;
+		for(i=0;i<n;i++) {
+			e = lut[i]*lut_scale - edge;
+			if(lut_err != NULL) lut_err[i] = e;
+			if((i >= r->first) && (i <= r->last)) {
+				sq += e*e;
+				if(fabs(e) > r->lut_max) r->lut_max = fabs(e);
+			}
+			edge += his[i]*width_scale;
+		}
+		r->lut_rms = sqrt(sq/r->used);
+	}
+	return 1;
+}
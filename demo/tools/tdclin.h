@@ -0,0 +1,68 @@
+/*
+ * TDC core demo
+ * Copyright (C) 2011 CERN
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TDCLIN_H
+#define __TDCLIN_H
+
+#include <stdint.h>
+
+/*
+ * Linearity analysis of the startup calibration histograms.
+ *
+ * The histogram is a code density test: the width of bin i is
+ * w(i) = his(i)/sum(his) * period. The used range goes from the first to
+ * the last non-empty bin, and its average bin width is the LSB.
+ *   DNL(i) = w(i)/LSB - 1 (in LSB)
+ *   INL(i) = sum of DNL(k) for k <= i (in LSB)
+ * The RMS quantization error of a TDC with uneven bins, for uniformly
+ * distributed inputs, is sqrt(sum(w^3)/(12*sum(w))).
+ * The LUT-induced error is the difference between the LUT value of a bin
+ * (converted to ps) and the start of the bin given by the histogram.
+ */
+
+struct tdclin_result {
+	int bins;
+	uint64_t hits;
+	int first;		/* first non-empty bin */
+	int last;		/* last non-empty bin */
+	int used;		/* last-first+1 */
+	int zero;		/* empty bins in the used range */
+	double lsb;		/* average bin width in the used range (ps) */
+	double width_min;	/* of the non-empty bins (ps) */
+	double width_max;
+	double width_std;	/* of all bins in the used range (ps) */
+	double dnl_min;
+	double dnl_max;
+	double inl_min;
+	double inl_max;
+	double rms;		/* RMS quantization error (ps) */
+	int has_lut;
+	double lut_rms;		/* over the used range (ps) */
+	double lut_max;		/* largest absolute error (ps) */
+};
+
+/*
+ * Analyzes a histogram of n bins. lut may be NULL. The per-bin arrays
+ * dnl, inl and lut_err (n entries each) may be NULL if not needed.
+ * Returns 0 if the histogram is empty.
+ */
+int tdclin_analyze(const uint32_t *his, const uint32_t *lut, int n,
+	double period_ps, int fp_count,
+	double *dnl, double *inl, double *lut_err,
+	struct tdclin_result *r);
+
+#endif /* __TDCLIN_H */
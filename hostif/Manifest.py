@@ -1,2 +1,2 @@
 modules = { "local" : [ "../core" ] }
-files = [ "tdc_hostif_package.vhd", "tdc_hostif.vhd", "tdc_wb.vhd" ]
+files = [ "tdc_hostif_package.vhd", "tdc_hostif.vhd", "tdc_wb.vhd", "tdc_fifo.vhd", "tdc_merge.vhd", "tdc_evwin.vhd", "tdc_hitflt.vhd", "tdc_diff.vhd", "tdc_dhist.vhd", "tdc_chstat.vhd", "tdc_chregs.vhd" ]
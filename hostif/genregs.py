@@ -0,0 +1,1002 @@
+#!/usr/bin/python
+
+# Generates the register files of the host interface from the wb
+# descriptions printed by genwb.py:
+#
+#   ./genwb.py > hostif.wb
+#   ./genwb.py channel > channel.wb
+#   ./genregs.py vhdl hostif.wb > tdc_wb.vhd
+#   ./genregs.py component hostif.wb     (tdc_wb component, for the package)
+#   ./genregs.py header hostif.wb > ../demo/software/include/hw/tdc.h
+#   ./genregs.py chvhdl channel.wb > tdc_chregs.vhd
+#   ./genregs.py chcomponent channel.wb  (tdc_chregs component, for the package)
+#   ./genregs.py chheader channel.wb > ../demo/software/include/hw/tdc_channel.h
+#
+# The global registers (vhdl, component, header) are generated with the
+# same structure and names as wbgen2, for the subset of the wb language
+# used by genwb.py: MONOSTABLE, BIT and SLV fields, bus read/write or read
+# only access, ack_read strobes and rising edge interrupts handled by
+# wbgen2_eic. The register bank is followed by the interrupt controller,
+# aligned on 8 words.
+#
+# The channel registers (chvhdl, chheader) are described with the same
+# language, for one channel. They are repeated for each channel in blocks
+# of c_BLOCK_WORDS words starting at word c_BLOCK_BASE, which wbgen2
+# cannot do. A field may be marked "shared = true" when the device
+# presents the value of the channel on sel_o one cycle after the address,
+# instead of one value per channel. The interrupt of the description is an
+# input per channel. Each pulse sets the pending bit of the channel in the
+# event pending registers at word c_PENDING_BASE (32 channels per word,
+# writing 1 clears a bit), and pulses wb_irq_o.
+
+import sys
+import textwrap
+
+c_EIC_ALIGN = 8
+
+c_MAX_CHANNELS = 64
+c_BLOCK_WORDS = 16
+c_BLOCK_BASE = 0x400
+c_PENDING_BASE = 0x40
+c_ADDR_WIDTH = 11
+
+# Parser
+
+def tokenize(text):
+    tokens = []
+    i = 0
+    while i < len(text):
+        c = text[i]
+        if c.isspace():
+            i += 1
+        elif text.startswith("--", i) or text.startswith("//", i):
+            while (i < len(text)) and (text[i] != "\n"):
+                i += 1
+        elif c == "\"":
+            j = text.index("\"", i+1)
+            tokens.append(("string", text[i+1:j]))
+            i = j+1
+        elif c in "{}=;":
+            tokens.append((c, c))
+            i += 1
+        else:
+            j = i
+            while (j < len(text)) and (text[j].isalnum() or (text[j] == "_")):
+                j += 1
+            if j == i:
+                raise ValueError("unexpected character '%s'" % c)
+            tokens.append(("word", text[i:j]))
+            i = j
+    return tokens
+
+def parse_block(tokens, pos):
+    # tokens[pos] is the opening brace; returns (attributes, children, pos)
+    attrs = {}
+    children = []
+    pos += 1
+    while tokens[pos][0] != "}":
+        key = tokens[pos][1]
+        if tokens[pos+1][0] == "{":
+            a, c, pos = parse_block(tokens, pos+1)
+            children.append((key, a, c))
+        else:
+            if tokens[pos+1][0] != "=":
+                raise ValueError("expected '=' after %s" % key)
+            attrs[key] = tokens[pos+2][1]
+            pos += 3
+        if tokens[pos][0] != ";":
+            raise ValueError("expected ';' after %s" % key)
+        pos += 1
+    return attrs, children, pos+1
+
+class Field:
+    pass
+
+class Reg:
+    pass
+
+class Irq:
+    pass
+
+def parse(text):
+    tokens = tokenize(text)
+    if tokens[0][1] != "peripheral":
+        raise ValueError("expected a peripheral")
+    attrs, children, pos = parse_block(tokens, 1)
+    periph = Reg()
+    periph.name = attrs["name"]
+    periph.prefix = attrs["prefix"]
+    periph.entity = attrs["hdl_entity"]
+    periph.regs = []
+    periph.irqs = []
+    periph.items = []
+    for kind, a, c in children:
+        if kind == "irq":
+            irq = Irq()
+            irq.name = a["name"]
+            irq.prefix = a["prefix"]
+            if a.get("trigger", "EDGE_RISING") != "EDGE_RISING":
+                raise ValueError("unsupported trigger for irq %s" % irq.prefix)
+            periph.irqs.append(irq)
+            periph.items.append(irq)
+        elif kind == "reg":
+            reg = Reg()
+            reg.name = a["name"]
+            reg.prefix = a["prefix"]
+            reg.fields = []
+            offset = 0
+            for fkind, fa, fc in c:
+                f = Field()
+                f.name = fa["name"]
+                f.prefix = fa.get("prefix")
+                f.type = fa["type"]
+                if f.type == "SLV":
+                    f.size = int(fa["size"])
+                elif f.type in ("BIT", "MONOSTABLE"):
+                    f.size = 1
+                else:
+                    raise ValueError("unsupported field type %s" % f.type)
+                f.access = fa.get("access_bus", "WRITE_ONLY")
+                if (f.type != "MONOSTABLE") and (f.access not in ("READ_WRITE", "READ_ONLY")):
+                    raise ValueError("unsupported access for field %s" % f.name)
+                f.ack = fa.get("ack_read")
+                f.shared = fa.get("shared") == "true"
+                f.offset = offset
+                offset += f.size
+                if offset > 32:
+                    raise ValueError("register %s is too large" % reg.prefix)
+                reg.fields.append(f)
+            periph.regs.append(reg)
+            periph.items.append(reg)
+        else:
+            raise ValueError("unsupported block %s" % kind)
+    return periph
+
+def log2_size(n):
+    i = 0
+    while 2**i < n:
+        i += 1
+    return i
+
+def bits(value, width):
+    return "".join([str((value >> i) & 1) for i in range(width-1, -1, -1)])
+
+def field_base(periph, reg, f):
+    name = periph.prefix + "_" + reg.prefix
+    if f.prefix is not None:
+        name = name + "_" + f.prefix
+    return name
+
+def field_port(periph, reg, f):
+    if (f.type == "MONOSTABLE") or (f.access == "READ_WRITE"):
+        return field_base(periph, reg, f) + "_o"
+    else:
+        return field_base(periph, reg, f) + "_i"
+
+def ack_port(periph, reg, f):
+    return periph.prefix + "_" + reg.prefix + "_" + f.ack + "_o"
+
+def field_type_name(f):
+    if f.type == "SLV":
+        return "std_logic_vector"
+    return f.type
+
+def slv(size):
+    if size == 1:
+        return "std_logic"
+    return "std_logic_vector(%d downto 0)" % (size-1)
+
+def range_str(f):
+    if f.size == 1:
+        return "(%d)" % f.offset
+    return "(%d downto %d)" % (f.offset+f.size-1, f.offset)
+
+def zeros(size):
+    if size == 1:
+        return "'0'"
+    return "\"" + "0"*size + "\""
+
+# Global register bank, wbgen2 style
+
+def eic_regs(periph):
+    n = len(periph.irqs)
+    regs = []
+    for name, prefix in [("Interrupt disable register", "idr"),
+      ("Interrupt enable register", "ier"),
+      ("Interrupt mask register", "imr"),
+      ("Interrupt status register", "isr")]:
+        reg = Reg()
+        reg.name = name
+        reg.prefix = "eic_" + prefix
+        reg.fields = []
+        for i in range(n):
+            f = Field()
+            f.name = periph.irqs[i].name
+            f.prefix = periph.irqs[i].prefix
+            f.type = "BIT"
+            f.size = 1
+            f.offset = i
+            reg.fields.append(f)
+        regs.append(reg)
+    return regs
+
+def layout(periph):
+    n = len(periph.regs)
+    eic = (n + c_EIC_ALIGN - 1)//c_EIC_ALIGN*c_EIC_ALIGN
+    return eic, log2_size(eic + 4)
+
+def port_line(name, direction, type, last=False):
+    if last:
+        end = ""
+    else:
+        end = ";"
+    return "    " + name.ljust(41) + ": " + direction.ljust(7) + type + end
+
+def bank_ports(periph, width):
+    lines = []
+    lines.append(port_line("rst_n_i", "in", "std_logic"))
+    lines.append(port_line("wb_clk_i", "in", "std_logic"))
+    lines.append(port_line("wb_addr_i", "in", slv(width)))
+    lines.append(port_line("wb_data_i", "in", slv(32)))
+    lines.append(port_line("wb_data_o", "out", slv(32)))
+    lines.append(port_line("wb_cyc_i", "in", "std_logic"))
+    lines.append(port_line("wb_sel_i", "in", slv(4)))
+    lines.append(port_line("wb_stb_i", "in", "std_logic"))
+    lines.append(port_line("wb_we_i", "in", "std_logic"))
+    lines.append(port_line("wb_ack_o", "out", "std_logic"))
+    lines.append(port_line("wb_irq_o", "out", "std_logic"))
+    # irqs are declared in the order they appear among the registers
+    ports = []
+    for reg in periph.items:
+        if isinstance(reg, Irq):
+            ports.append((None, "irq_" + reg.prefix + "_i", "in", "std_logic"))
+            continue
+        for f in reg.fields:
+            comment = "-- Port for %s field: '%s' in reg: '%s'" % (field_type_name(f), f.name, reg.name)
+            if (f.type == "MONOSTABLE") or (f.access == "READ_WRITE"):
+                ports.append((comment, field_port(periph, reg, f), "out", slv(f.size)))
+            else:
+                ports.append((comment, field_port(periph, reg, f), "in", slv(f.size)))
+            if f.ack is not None:
+                ports.append((None, ack_port(periph, reg, f), "out", "std_logic"))
+    for i in range(len(ports)):
+        comment, name, direction, type = ports[i]
+        if comment is not None:
+            lines.append(comment)
+        lines.append(port_line(name, direction, type, i == len(ports)-1))
+    return lines
+
+def signal_line(name, type):
+    return "signal " + name.ljust(41) + ": " + type.ljust(15) + ";"
+
+def bank_vhdl(periph, source):
+    eic_base, width = layout(periph)
+    n = len(periph.irqs)
+    o = []
+    o.append("-"*87)
+    o.append("-- Title          : Wishbone slave core for %s" % periph.name)
+    o.append("-"*87)
+    o.append("-- File           : %s.vhd" % periph.entity)
+    o.append("-- Author         : auto-generated by genregs.py from %s" % source)
+    o.append("-- Standard       : VHDL'87")
+    o.append("-"*87)
+    o.append("-- THIS FILE WAS GENERATED BY genregs.py FROM SOURCE FILE %s" % source)
+    o.append("-- DO NOT HAND-EDIT: CHANGE genwb.py AND REGENERATE IT")
+    o.append("-"*87)
+    o.append("")
+    o.append("library ieee;")
+    o.append("use ieee.std_logic_1164.all;")
+    o.append("use ieee.numeric_std.all;")
+    o.append("use work.wbgen2_pkg.all;")
+    o.append("")
+    o.append("entity %s is" % periph.entity)
+    o.append("  port (")
+    o += bank_ports(periph, width)
+    o.append("  );")
+    o.append("end %s;" % periph.entity)
+    o.append("")
+    o.append("architecture syn of %s is" % periph.entity)
+    o.append("")
+    for reg in periph.regs:
+        for f in reg.fields:
+            base = field_base(periph, reg, f)
+            if f.type == "MONOSTABLE":
+                o.append(signal_line(base + "_dly0", "std_logic"))
+                o.append(signal_line(base + "_int", "std_logic"))
+            elif f.access == "READ_WRITE":
+                o.append(signal_line(base + "_int", slv(f.size)))
+    vec = "std_logic_vector(%d downto 0)" % (n-1)
+    o.append(signal_line("eic_idr_int", vec))
+    o.append(signal_line("eic_idr_write_int", "std_logic"))
+    o.append(signal_line("eic_ier_int", vec))
+    o.append(signal_line("eic_ier_write_int", "std_logic"))
+    o.append(signal_line("eic_imr_int", vec))
+    o.append(signal_line("eic_isr_clear_int", vec))
+    o.append(signal_line("eic_isr_status_int", vec))
+    o.append(signal_line("eic_irq_ack_int", vec))
+    o.append(signal_line("eic_isr_write_int", "std_logic"))
+    o.append(signal_line("irq_inputs_vector_int", vec))
+    o.append(signal_line("ack_sreg", slv(10)))
+    o.append(signal_line("rddata_reg", slv(32)))
+    o.append(signal_line("wrdata_reg", slv(32)))
+    o.append(signal_line("bwsel_reg", slv(4)))
+    o.append(signal_line("rwaddr_reg", slv(width)))
+    o.append(signal_line("ack_in_progress", "std_logic"))
+    o.append(signal_line("wr_int", "std_logic"))
+    o.append(signal_line("rd_int", "std_logic"))
+    o.append(signal_line("bus_clock_int", "std_logic"))
+    o.append(signal_line("allones", slv(32)))
+    o.append(signal_line("allzeros", slv(32)))
+    o.append("")
+    o.append("begin")
+    o.append("-- Some internal signals assignments. For (foreseen) compatibility with other bus standards.")
+    o.append("  wrdata_reg <= wb_data_i;")
+    o.append("  bwsel_reg <= wb_sel_i;")
+    o.append("  bus_clock_int <= wb_clk_i;")
+    o.append("  rd_int <= wb_cyc_i and (wb_stb_i and (not wb_we_i));")
+    o.append("  wr_int <= wb_cyc_i and (wb_stb_i and wb_we_i);")
+    o.append("  allones <= (others => '1');")
+    o.append("  allzeros <= (others => '0');")
+    o.append("-- ")
+    o.append("-- Main register bank access process.")
+    o.append("  process (bus_clock_int, rst_n_i)")
+    o.append("  begin")
+    o.append("    if (rst_n_i = '0') then ")
+    o.append("      ack_sreg <= %s;" % zeros(10))
+    o.append("      ack_in_progress <= '0';")
+    o.append("      rddata_reg <= %s;" % zeros(32))
+    for reg in periph.regs:
+        for f in reg.fields:
+            base = field_base(periph, reg, f)
+            if (f.type == "MONOSTABLE") or (f.access == "READ_WRITE"):
+                o.append("      %s_int <= %s;" % (base, zeros(f.size)))
+            if f.ack is not None:
+                o.append("      %s <= '0';" % ack_port(periph, reg, f))
+    o.append("      eic_idr_write_int <= '0';")
+    o.append("      eic_ier_write_int <= '0';")
+    o.append("      eic_isr_write_int <= '0';")
+    o.append("    elsif rising_edge(bus_clock_int) then")
+    o.append("-- advance the ACK generator shift register")
+    o.append("      ack_sreg(8 downto 0) <= ack_sreg(9 downto 1);")
+    o.append("      ack_sreg(9) <= '0';")
+    o.append("      if (ack_in_progress = '1') then")
+    o.append("        if (ack_sreg(0) = '1') then")
+    for reg in periph.regs:
+        for f in reg.fields:
+            if f.type == "MONOSTABLE":
+                o.append("          %s_int <= '0';" % field_base(periph, reg, f))
+            if f.ack is not None:
+                o.append("          %s <= '0';" % ack_port(periph, reg, f))
+    o.append("          eic_idr_write_int <= '0';")
+    o.append("          eic_ier_write_int <= '0';")
+    o.append("          eic_isr_write_int <= '0';")
+    o.append("          ack_in_progress <= '0';")
+    o.append("        else")
+    o.append("        end if;")
+    o.append("      else")
+    o.append("        if ((wb_cyc_i = '1') and (wb_stb_i = '1')) then")
+    o.append("          case rwaddr_reg(%d downto 0) is" % (width-1))
+    for i in range(len(periph.regs)):
+        reg = periph.regs[i]
+        o.append("          when \"%s\" => " % bits(i, width))
+        o.append("            if (wb_we_i = '1') then")
+        for f in reg.fields:
+            base = field_base(periph, reg, f)
+            if f.type == "MONOSTABLE":
+                o.append("              %s_int <= wrdata_reg%s;" % (base, range_str(f)))
+                o.append("              rddata_reg(%d) <= 'X';" % f.offset)
+            elif f.type == "BIT":
+                o.append("              rddata_reg(%d) <= 'X';" % f.offset)
+                if f.access == "READ_WRITE":
+                    o.append("              %s_int <= wrdata_reg%s;" % (base, range_str(f)))
+            elif f.access == "READ_WRITE":
+                o.append("              %s_int <= wrdata_reg%s;" % (base, range_str(f)))
+        o.append("            else")
+        used = 0
+        for f in reg.fields:
+            base = field_base(periph, reg, f)
+            if f.type == "MONOSTABLE":
+                o.append("              rddata_reg(%d) <= 'X';" % f.offset)
+            elif f.access == "READ_WRITE":
+                o.append("              rddata_reg%s <= %s_int;" % (range_str(f), base))
+            else:
+                o.append("              rddata_reg%s <= %s;" % (range_str(f), field_port(periph, reg, f)))
+            if f.ack is not None:
+                o.append("              %s <= '1';" % ack_port(periph, reg, f))
+            used = f.offset + f.size
+        for b in range(used, 32):
+            o.append("              rddata_reg(%d) <= 'X';" % b)
+        o.append("            end if;")
+        if [f for f in reg.fields if f.type == "MONOSTABLE"]:
+            o.append("            ack_sreg(2) <= '1';")
+        else:
+            o.append("            ack_sreg(0) <= '1';")
+        o.append("            ack_in_progress <= '1';")
+    r = "(%d downto 0)" % (n-1)
+    for i, prefix, wr, rd in [(0, "idr", "eic_idr_write_int", None),
+      (1, "ier", "eic_ier_write_int", None),
+      (2, "imr", None, "eic_imr_int"),
+      (3, "isr", "eic_isr_write_int", "eic_isr_status_int")]:
+        o.append("          when \"%s\" => " % bits(eic_base+i, width))
+        o.append("            if (wb_we_i = '1') then")
+        if wr is not None:
+            o.append("              %s <= '1';" % wr)
+        o.append("            else")
+        used = 0
+        if rd is not None:
+            o.append("              rddata_reg%s <= %s%s;" % (r, rd, r))
+            used = n
+        for b in range(used, 32):
+            o.append("              rddata_reg(%d) <= 'X';" % b)
+        o.append("            end if;")
+        o.append("            ack_sreg(0) <= '1';")
+        o.append("            ack_in_progress <= '1';")
+    o.append("          when others =>")
+    o.append("-- prevent the slave from hanging the bus on invalid address")
+    o.append("            ack_in_progress <= '1';")
+    o.append("            ack_sreg(0) <= '1';")
+    o.append("          end case;")
+    o.append("        end if;")
+    o.append("      end if;")
+    o.append("    end if;")
+    o.append("  end process;")
+    o.append("  ")
+    o.append("  ")
+    o.append("-- Drive the data output bus")
+    o.append("  wb_data_o <= rddata_reg;")
+    for reg in periph.regs:
+        for f in reg.fields:
+            base = field_base(periph, reg, f)
+            o.append("-- %s" % f.name)
+            if f.type == "MONOSTABLE":
+                o.append("  process (bus_clock_int, rst_n_i)")
+                o.append("  begin")
+                o.append("    if (rst_n_i = '0') then ")
+                o.append("      %s_dly0 <= '0';" % base)
+                o.append("      %s_o <= '0';" % base)
+                o.append("    elsif rising_edge(bus_clock_int) then")
+                o.append("      %s_dly0 <= %s_int;" % (base, base))
+                o.append("      %s_o <= %s_int and (not %s_dly0);" % (base, base, base))
+                o.append("    end if;")
+                o.append("  end process;")
+                o.append("  ")
+                o.append("  ")
+            elif f.access == "READ_WRITE":
+                o.append("  %s_o <= %s_int;" % (base, base))
+    o.append("-- extra code for reg/fifo/mem: Interrupt disable register")
+    o.append("  eic_idr_int%s <= wrdata_reg%s;" % (r, r))
+    o.append("-- extra code for reg/fifo/mem: Interrupt enable register")
+    o.append("  eic_ier_int%s <= wrdata_reg%s;" % (r, r))
+    o.append("-- extra code for reg/fifo/mem: Interrupt status register")
+    o.append("  eic_isr_clear_int%s <= wrdata_reg%s;" % (r, r))
+    o.append("-- extra code for reg/fifo/mem: IRQ_CONTROLLER")
+    o.append("  eic_irq_controller_inst : wbgen2_eic")
+    o.append("    generic map (")
+    o.append("      g_num_interrupts     => %d," % n)
+    for i in range(32):
+        if i == 31:
+            end = ""
+        else:
+            end = ","
+        o.append("      g_irq%02x_mode         => 0%s" % (i, end))
+    o.append("    )")
+    o.append("    port map (")
+    o.append("      clk_i                => bus_clock_int,")
+    o.append("      rst_n_i              => rst_n_i,")
+    o.append("      irq_i                => irq_inputs_vector_int,")
+    o.append("      irq_ack_o            => eic_irq_ack_int,")
+    o.append("      reg_imr_o            => eic_imr_int,")
+    o.append("      reg_ier_i            => eic_ier_int,")
+    o.append("      reg_ier_wr_stb_i     => eic_ier_write_int,")
+    o.append("      reg_idr_i            => eic_idr_int,")
+    o.append("      reg_idr_wr_stb_i     => eic_idr_write_int,")
+    o.append("      reg_isr_o            => eic_isr_status_int,")
+    o.append("      reg_isr_i            => eic_isr_clear_int,")
+    o.append("      reg_isr_wr_stb_i     => eic_isr_write_int,")
+    o.append("      wb_irq_o             => wb_irq_o")
+    o.append("    );")
+    o.append("  ")
+    for i in range(n):
+        o.append("  irq_inputs_vector_int(%d) <= irq_%s_i;" % (i, periph.irqs[i].prefix))
+    o.append("  rwaddr_reg <= wb_addr_i;")
+    o.append("-- ACK signal generation. Just pass the LSB of ACK counter.")
+    o.append("  wb_ack_o <= ack_sreg(0);")
+    o.append("end syn;")
+    return o
+
+def bank_component(periph):
+    eic_base, width = layout(periph)
+    o = []
+    o.append("component %s is" % periph.entity)
+    o.append("  port (")
+    o += bank_ports(periph, width)
+    o.append("  );")
+    o.append("end component;")
+    return o
+
+def define_line(name, value):
+    return "#define " + name.ljust(38) + value
+
+def field_defines(prefix, reg, f):
+    o = []
+    o.append("/* definitions for field: %s in reg: %s */" % (f.name, reg.name))
+    name = (prefix + "_" + reg.prefix + "_" + f.prefix).upper()
+    if f.size == 1:
+        o.append(define_line(name, "WBGEN2_GEN_MASK(%d, 1)" % f.offset))
+    else:
+        o.append(define_line(name + "_MASK", "WBGEN2_GEN_MASK(%d, %d)" % (f.offset, f.size)))
+        o.append(define_line(name + "_SHIFT", "%d" % f.offset))
+        o.append(define_line(name + "_W(value)", "WBGEN2_GEN_WRITE(value, %d, %d)" % (f.offset, f.size)))
+        o.append(define_line(name + "_R(reg)", "WBGEN2_GEN_READ(reg, %d, %d)" % (f.offset, f.size)))
+    o.append("")
+    return o
+
+def reg_defines(prefix, regs):
+    o = []
+    for reg in regs:
+        o.append("/* definitions for register: %s */" % reg.name)
+        o.append("")
+        for f in reg.fields:
+            if f.prefix is not None:
+                o += field_defines(prefix, reg, f)
+    return o
+
+def bank_header(periph, source):
+    eic_base, width = layout(periph)
+    guard = "__WBGEN2_REGDEFS_" + source.upper().replace(".", "_")
+    o = []
+    o.append("/*")
+    o.append("  Register definitions for slave core: %s" % periph.name)
+    o.append("")
+    o.append("  * File           : %s.h" % periph.prefix)
+    o.append("  * Author         : auto-generated by genregs.py from %s" % source)
+    o.append("  * Standard       : ANSI C")
+    o.append("")
+    o.append("    THIS FILE WAS GENERATED BY genregs.py FROM SOURCE FILE %s" % source)
+    o.append("    DO NOT HAND-EDIT: CHANGE genwb.py AND REGENERATE IT")
+    o.append("")
+    o.append("*/")
+    o.append("")
+    o.append("#ifndef %s" % guard)
+    o.append("#define %s" % guard)
+    o.append("")
+    o.append("#include <inttypes.h>")
+    o.append("")
+    o.append("#if defined( __GNUC__)")
+    o.append("#define PACKED __attribute__ ((packed))")
+    o.append("#else")
+    o.append("#error \"Unsupported compiler?\"")
+    o.append("#endif")
+    o.append("")
+    o.append("#ifndef __WBGEN2_MACROS_DEFINED__")
+    o.append("#define __WBGEN2_MACROS_DEFINED__")
+    o.append("#define WBGEN2_GEN_MASK(offset, size) (((1<<(size))-1) << (offset))")
+    o.append("#define WBGEN2_GEN_WRITE(value, offset, size) (((value) & ((1<<(size))-1)) << (offset))")
+    o.append("#define WBGEN2_GEN_READ(reg, offset, size) (((reg) >> (offset)) & ((1<<(size))-1))")
+    o.append("#define WBGEN2_SIGN_EXTEND(value, bits) (((value) & (1<<bits) ? ~((1<<(bits))-1): 0 ) | (value))")
+    o.append("#endif")
+    o.append("")
+    o.append("")
+    eic = eic_regs(periph)
+    o += reg_defines(periph.prefix, periph.regs + eic)
+    o.append("PACKED struct %s {" % periph.entity.upper())
+    for i in range(len(periph.regs)):
+        o.append("  /* [0x%x]: REG %s */" % (4*i, periph.regs[i].name))
+        o.append("  uint32_t %s;" % periph.regs[i].prefix.upper())
+    if eic_base > len(periph.regs):
+        o.append("  /* padding to: %d words */" % eic_base)
+        o.append("  uint32_t __padding_0[%d];" % (eic_base - len(periph.regs)))
+    for i in range(4):
+        o.append("  /* [0x%x]: REG %s */" % (4*(eic_base+i), eic[i].name))
+        o.append("  uint32_t %s;" % eic[i].prefix.upper())
+    o.append("};")
+    o.append("")
+    o.append("#endif")
+    return o
+
+# Channel register blocks
+
+def channel_layout(periph):
+    if len(periph.irqs) != 1:
+        raise ValueError("channel descriptions must have exactly one irq")
+    if len(periph.regs) > c_BLOCK_WORDS:
+        raise ValueError("too many channel registers")
+    block_bits = log2_size(c_BLOCK_WORDS)
+    chn_bits = log2_size(c_MAX_CHANNELS)
+    evp_bits = log2_size(c_MAX_CHANNELS//32)
+    return block_bits, chn_bits, evp_bits
+
+def channel_width(f):
+    if f.shared:
+        return f.size
+    if f.size == 1:
+        return "g_CHANNEL_COUNT"
+    return "g_CHANNEL_COUNT*%d" % f.size
+
+def channel_slice(f, index):
+    if f.shared:
+        return ""
+    if f.size == 1:
+        return "(%s)" % index
+    return "(%s*%d+%d downto %s*%d)" % (index, f.size, f.size-1, index, f.size)
+
+def vector(width):
+    if isinstance(width, int):
+        return slv(width)
+    return "std_logic_vector(%s-1 downto 0)" % width
+
+def channel_ports(periph):
+    ports = []
+    ports.append(("clk_i", "in", "std_logic"))
+    ports.append(("reset_i", "in", "std_logic"))
+    ports.append(None)
+    ports.append(("wb_addr_i", "in", slv(c_ADDR_WIDTH)))
+    ports.append(("wb_data_i", "in", slv(32)))
+    ports.append(("wb_data_o", "out", slv(32)))
+    ports.append(("wb_cyc_i", "in", "std_logic"))
+    ports.append(("wb_stb_i", "in", "std_logic"))
+    ports.append(("wb_we_i", "in", "std_logic"))
+    ports.append(("wb_ack_o", "out", "std_logic"))
+    ports.append(("wb_irq_o", "out", "std_logic"))
+    ports.append(None)
+    ports.append(("irq_" + periph.irqs[0].prefix + "_i", "in", vector("g_CHANNEL_COUNT")))
+    shared = False
+    for reg in periph.regs:
+        ports.append(None)
+        for f in reg.fields:
+            if (f.type == "MONOSTABLE") or (f.access == "READ_WRITE"):
+                ports.append((field_port(periph, reg, f), "out", vector(channel_width(f))))
+            else:
+                ports.append((field_port(periph, reg, f), "in", vector(channel_width(f))))
+            if f.ack is not None:
+                ports.append((ack_port(periph, reg, f), "out", vector("g_CHANNEL_COUNT")))
+            shared = shared or f.shared
+    if shared:
+        ports.append(None)
+        ports.append(("sel_o", "out", slv(8)))
+    return ports
+
+def channel_port_lines(periph):
+    ports = channel_ports(periph)
+    n = max([len(p[0]) for p in ports if p is not None])
+    o = []
+    for i in range(len(ports)):
+        if ports[i] is None:
+            o.append("        ")
+            continue
+        name, direction, type = ports[i]
+        if i == len(ports)-1:
+            end = ""
+        else:
+            end = ";"
+        o.append("        " + name.ljust(n) + " : " + direction + " " + type + end)
+    return o
+
+def channel_description(periph):
+    block_bits, chn_bits, evp_bits = channel_layout(periph)
+    o = []
+    o.append("-- DESCRIPTION:")
+    o.append("-- Register blocks of g_CHANNEL_COUNT channels (at most %d), with %d words" % (c_MAX_CHANNELS, c_BLOCK_WORDS))
+    o.append("-- per channel starting at word 0x%x:" % c_BLOCK_BASE)
+    for i in range(len(periph.regs)):
+        reg = periph.regs[i]
+        fields = []
+        for f in reg.fields:
+            if f.size == 1:
+                b = "bit %d" % f.offset
+            else:
+                b = "bits %d-%d" % (f.offset+f.size-1, f.offset)
+            if f.access == "READ_WRITE":
+                a = "read/write"
+            elif f.shared:
+                a = "read only, shared"
+            else:
+                a = "read only"
+            if f.ack is not None:
+                a = a + ", reading pulses %s" % ack_port(periph, reg, f)
+            fields.append("%s: %s (%s)" % (b, f.name.lower(), a))
+        o.append("--  %2d. %s: %s" % (i, reg.prefix.upper(), reg.name))
+        o += textwrap.wrap(", ".join(fields), 79, initial_indent="--      ", subsequent_indent="--      ")
+    o.append("-- The other registers, and the blocks of channels above g_CHANNEL_COUNT,")
+    o.append("-- read as 0 and ignore writes. The shared fields are read from the channel")
+    o.append("-- presented on sel_o, which follows the address, one cycle later.")
+    o.append("--")
+    o.append("-- Words 0x%x to 0x%x are the event pending registers, with one bit per" % (c_PENDING_BASE, c_PENDING_BASE + c_MAX_CHANNELS//32 - 1))
+    o.append("-- channel (32 channels per word). Each pulse on the irq_%s_i input of a" % periph.irqs[0].prefix)
+    o.append("-- channel sets its bit, and writing 1 to a bit clears it. wb_irq_o is pulsed")
+    o.append("-- after each event, so that all the channels can share a single edge")
+    o.append("-- triggered interrupt. A write that clears a bit loses against an event of")
+    o.append("-- the same cycle. The other addresses read as 0 and ignore writes.")
+    o.append("--")
+    o.append("-- Accesses are acknowledged two cycles after the strobe.")
+    return o
+
+def channel_vhdl(periph, source):
+    block_bits, chn_bits, evp_bits = channel_layout(periph)
+    irq = "irq_" + periph.irqs[0].prefix + "_i"
+    o = []
+    o.append("-"*79)
+    o.append("-- Title          : Register blocks for %s" % periph.name)
+    o.append("-"*79)
+    o.append("-- File           : %s.vhd" % periph.entity)
+    o.append("-- Author         : auto-generated by genregs.py from %s" % source)
+    o.append("-"*79)
+    o.append("-- THIS FILE WAS GENERATED BY genregs.py FROM SOURCE FILE %s" % source)
+    o.append("-- DO NOT HAND-EDIT: CHANGE genwb.py AND REGENERATE IT")
+    o.append("-"*79)
+    o.append("")
+    o += channel_description(periph)
+    o.append("")
+    o.append("library ieee;")
+    o.append("use ieee.std_logic_1164.all;")
+    o.append("use ieee.numeric_std.all;")
+    o.append("")
+    o.append("entity %s is" % periph.entity)
+    o.append("    generic(")
+    o.append("        -- Number of channels. Must be %d or less." % c_MAX_CHANNELS)
+    o.append("        g_CHANNEL_COUNT : positive")
+    o.append("    );")
+    o.append("    port(")
+    o += channel_port_lines(periph)
+    o.append("    );")
+    o.append("end entity;")
+    o.append("")
+    o.append("architecture rtl of %s is" % periph.entity)
+    signals = []
+    for reg in periph.regs:
+        for f in reg.fields:
+            if f.type == "MONOSTABLE":
+                raise ValueError("MONOSTABLE fields are not supported in channel registers")
+            if (f.access == "READ_WRITE") and f.shared:
+                raise ValueError("shared fields must be read only")
+            if f.access == "READ_WRITE":
+                signals.append((field_base(periph, reg, f) + "_int", vector(channel_width(f))))
+    signals.append(("pending", slv(c_MAX_CHANNELS)))
+    signals.append(("irq", "std_logic"))
+    signals.append(("irq_pend", "std_logic"))
+    signals.append(None)
+    signals.append(("busy", "std_logic"))
+    signals.append(("ack", "std_logic"))
+    signals.append(("a_block", "std_logic"))
+    signals.append(("a_evp", "std_logic"))
+    signals.append(("a_evw", "natural range 0 to %d" % (2**evp_bits-1)))
+    signals.append(("a_chn", "natural range 0 to %d" % (2**chn_bits-1)))
+    signals.append(("a_reg", "natural range 0 to %d" % (2**block_bits-1)))
+    signals.append(("a_we", "std_logic"))
+    signals.append(("a_data", slv(32)))
+    n = max([len(x[0]) for x in signals if x is not None])
+    for x in signals:
+        if x is None:
+            o.append("")
+            o.append("-- access in progress")
+        else:
+            o.append("signal " + x[0].ljust(n) + " : " + x[1] + ";")
+    o.append("begin")
+    ports = channel_ports(periph)
+    if ("sel_o", "out", slv(8)) in ports:
+        sel = "wb_addr_i(%d downto %d)" % (block_bits+chn_bits-1, block_bits)
+        if chn_bits < 8:
+            sel = "\"" + "0"*(8-chn_bits) + "\" & " + sel
+        o.append("    sel_o <= %s;" % sel)
+        o.append("    ")
+    o.append("    process(clk_i)")
+    o.append("    variable v_data  : std_logic_vector(31 downto 0);")
+    o.append("    variable v_event : std_logic;")
+    o.append("    begin")
+    o.append("        if rising_edge(clk_i) then")
+    o.append("            if reset_i = '1' then")
+    for reg in periph.regs:
+        for f in reg.fields:
+            if f.access == "READ_WRITE":
+                o.append("                %s_int <= (others => '0');" % field_base(periph, reg, f))
+    o.append("                pending <= (others => '0');")
+    o.append("                busy <= '0';")
+    o.append("                ack <= '0';")
+    o.append("                irq <= '0';")
+    o.append("                irq_pend <= '0';")
+    acks = []
+    for reg in periph.regs:
+        for f in reg.fields:
+            if f.ack is not None:
+                acks.append(ack_port(periph, reg, f))
+    for a in acks:
+        o.append("                %s <= (others => '0');" % a)
+    o.append("            else")
+    o.append("                ack <= '0';")
+    for a in acks:
+        o.append("                %s <= (others => '0');" % a)
+    o.append("                ")
+    o.append("                -- Pending events. A write that clears a bit loses against")
+    o.append("                -- an event in the same cycle.")
+    o.append("                v_event := '0';")
+    o.append("                if (busy = '1') and (a_evp = '1') and (a_we = '1') then")
+    o.append("                    pending(a_evw*32+31 downto a_evw*32)")
+    o.append("                        <= pending(a_evw*32+31 downto a_evw*32) and not a_data;")
+    o.append("                end if;")
+    o.append("                for i in 0 to g_CHANNEL_COUNT-1 loop")
+    o.append("                    if %s(i) = '1' then" % irq)
+    o.append("                        pending(i) <= '1';")
+    o.append("                        v_event := '1';")
+    o.append("                    end if;")
+    o.append("                end loop;")
+    o.append("                ")
+    o.append("                -- Return wb_irq_o to 0 after each pulse, so that events in")
+    o.append("                -- consecutive cycles still produce an edge.")
+    o.append("                if irq = '1' then")
+    o.append("                    irq <= '0';")
+    o.append("                    irq_pend <= v_event;")
+    o.append("                else")
+    o.append("                    irq <= v_event or irq_pend;")
+    o.append("                    irq_pend <= '0';")
+    o.append("                end if;")
+    o.append("                ")
+    o.append("                if (wb_cyc_i = '1') and (wb_stb_i = '1') and (busy = '0') and (ack = '0') then")
+    o.append("                    busy <= '1';")
+    top = c_ADDR_WIDTH - 1
+    bb = block_bits + chn_bits
+    if top == bb:
+        o.append("                    if wb_addr_i(%d) = '%s' then" % (top, bits(c_BLOCK_BASE >> bb, 1)))
+    else:
+        o.append("                    if wb_addr_i(%d downto %d) = \"%s\" then" % (top, bb, bits(c_BLOCK_BASE >> bb, c_ADDR_WIDTH - bb)))
+    o.append("                        a_block <= '1';")
+    o.append("                    else")
+    o.append("                        a_block <= '0';")
+    o.append("                    end if;")
+    o.append("                    if wb_addr_i(%d downto %d) = \"%s\" then" % (top, evp_bits, bits(c_PENDING_BASE >> evp_bits, c_ADDR_WIDTH - evp_bits)))
+    o.append("                        a_evp <= '1';")
+    o.append("                    else")
+    o.append("                        a_evp <= '0';")
+    o.append("                    end if;")
+    o.append("                    a_evw <= to_integer(unsigned(wb_addr_i(%d downto 0)));" % (evp_bits-1))
+    o.append("                    a_chn <= to_integer(unsigned(wb_addr_i(%d downto %d)));" % (bb-1, block_bits))
+    o.append("                    a_reg <= to_integer(unsigned(wb_addr_i(%d downto 0)));" % (block_bits-1))
+    o.append("                    a_we <= wb_we_i;")
+    o.append("                    a_data <= wb_data_i;")
+    o.append("                end if;")
+    o.append("                ")
+    o.append("                if busy = '1' then")
+    o.append("                    busy <= '0';")
+    o.append("                    ack <= '1';")
+    o.append("                    v_data := (others => '0');")
+    o.append("                    if a_evp = '1' then")
+    o.append("                        v_data := pending(a_evw*32+31 downto a_evw*32);")
+    o.append("                    elsif (a_block = '1') and (a_chn < g_CHANNEL_COUNT) then")
+    o.append("                        if a_we = '1' then")
+    o.append("                            case a_reg is")
+    for i in range(len(periph.regs)):
+        reg = periph.regs[i]
+        rw = [f for f in reg.fields if f.access == "READ_WRITE"]
+        if not rw:
+            continue
+        o.append("                                when %d =>" % i)
+        for f in rw:
+            o.append("                                    %s_int%s <= a_data%s;" % (field_base(periph, reg, f), channel_slice(f, "a_chn"), range_str(f)))
+    o.append("                                when others => null;")
+    o.append("                            end case;")
+    o.append("                        end if;")
+    o.append("                        case a_reg is")
+    for i in range(len(periph.regs)):
+        reg = periph.regs[i]
+        o.append("                            when %d =>" % i)
+        for f in reg.fields:
+            if f.access == "READ_WRITE":
+                src = field_base(periph, reg, f) + "_int"
+            else:
+                src = field_port(periph, reg, f)
+            o.append("                                v_data%s := %s%s;" % (range_str(f), src, channel_slice(f, "a_chn")))
+            if f.ack is not None:
+                o.append("                                %s(a_chn) <= not a_we;" % ack_port(periph, reg, f))
+    o.append("                            when others => null;")
+    o.append("                        end case;")
+    o.append("                    end if;")
+    o.append("                    wb_data_o <= v_data;")
+    o.append("                end if;")
+    o.append("            end if;")
+    o.append("        end if;")
+    o.append("    end process;")
+    o.append("    wb_ack_o <= ack;")
+    o.append("    wb_irq_o <= irq;")
+    o.append("    ")
+    for reg in periph.regs:
+        for f in reg.fields:
+            if f.access == "READ_WRITE":
+                base = field_base(periph, reg, f)
+                o.append("    %s_o <= %s_int;" % (base, base))
+    o.append("end architecture;")
+    return o
+
+def channel_component(periph):
+    o = []
+    o.append("component %s is" % periph.entity)
+    o.append("    generic(")
+    o.append("        g_CHANNEL_COUNT : positive")
+    o.append("    );")
+    o.append("    port(")
+    o += channel_port_lines(periph)
+    o.append("    );")
+    o.append("end component;")
+    return o
+
+def channel_header(periph, source):
+    block_bits, chn_bits, evp_bits = channel_layout(periph)
+    guard = "__WBGEN2_REGDEFS_" + source.upper().replace(".", "_")
+    o = []
+    o.append("/*")
+    o.append("  Register definitions for the register blocks of: %s" % periph.name)
+    o.append("")
+    o.append("  * File           : %s_channel.h" % periph.prefix)
+    o.append("  * Author         : auto-generated by genregs.py from %s" % source)
+    o.append("  * Standard       : ANSI C")
+    o.append("")
+    o.append("    THIS FILE WAS GENERATED BY genregs.py FROM SOURCE FILE %s" % source)
+    o.append("    DO NOT HAND-EDIT: CHANGE genwb.py AND REGENERATE IT")
+    o.append("")
+    o.append("*/")
+    o.append("")
+    o.append("#ifndef %s" % guard)
+    o.append("#define %s" % guard)
+    o.append("")
+    o.append("#include <inttypes.h>")
+    o.append("")
+    o.append("#if defined( __GNUC__)")
+    o.append("#define PACKED __attribute__ ((packed))")
+    o.append("#else")
+    o.append("#error \"Unsupported compiler?\"")
+    o.append("#endif")
+    o.append("")
+    o.append("#ifndef __WBGEN2_MACROS_DEFINED__")
+    o.append("#define __WBGEN2_MACROS_DEFINED__")
+    o.append("#define WBGEN2_GEN_MASK(offset, size) (((1<<(size))-1) << (offset))")
+    o.append("#define WBGEN2_GEN_WRITE(value, offset, size) (((value) & ((1<<(size))-1)) << (offset))")
+    o.append("#define WBGEN2_GEN_READ(reg, offset, size) (((reg) >> (offset)) & ((1<<(size))-1))")
+    o.append("#define WBGEN2_SIGN_EXTEND(value, bits) (((value) & (1<<bits) ? ~((1<<(bits))-1): 0 ) | (value))")
+    o.append("#endif")
+    o.append("")
+    prefix = periph.prefix.upper()
+    o.append("/* byte offsets from the base of the core */")
+    for i in range(c_MAX_CHANNELS//32):
+        o.append(define_line("%s_EVP%d_OFFSET" % (prefix, i), "0x%x" % (4*(c_PENDING_BASE+i))))
+    o.append(define_line("%s_CHANNEL_OFFSET(n)" % prefix, "(0x%x + 0x%x*(n))" % (4*c_BLOCK_BASE, 4*c_BLOCK_WORDS)))
+    o.append(define_line("%s_MAX_CHANNELS" % prefix, "%d" % c_MAX_CHANNELS))
+    o.append("")
+    o.append("")
+    o += reg_defines(periph.prefix, periph.regs)
+    o.append("PACKED struct %s {" % periph.entity.upper().replace("CHREGS", "CHANNEL"))
+    for i in range(len(periph.regs)):
+        o.append("  /* [0x%x]: REG %s */" % (4*i, periph.regs[i].name))
+        o.append("  uint32_t %s;" % periph.regs[i].prefix.upper())
+    if c_BLOCK_WORDS > len(periph.regs):
+        o.append("  /* padding to: %d words */" % c_BLOCK_WORDS)
+        o.append("  uint32_t __padding_0[%d];" % (c_BLOCK_WORDS - len(periph.regs)))
+    o.append("};")
+    o.append("")
+    o.append("#endif")
+    return o
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write("Usage: genregs.py vhdl|component|header|chvhdl|chcomponent|chheader <file.wb>\n")
+        sys.exit(1)
+    mode = sys.argv[1]
+    source = sys.argv[2]
+    periph = parse(open(source).read())
+    source = source.split("/")[-1]
+    if mode == "vhdl":
+        o = bank_vhdl(periph, source)
+    elif mode == "component":
+        o = bank_component(periph)
+    elif mode == "header":
+        o = bank_header(periph, source)
+    elif mode == "chvhdl":
+        o = channel_vhdl(periph, source)
+    elif mode == "chcomponent":
+        o = channel_component(periph)
+    elif mode == "chheader":
+        o = channel_header(periph, source)
+    else:
+        sys.stderr.write("Unknown output: %s\n" % mode)
+        sys.exit(1)
+    sys.stdout.write("\n".join(o) + "\n")
+
+if __name__ == "__main__":
+    main()
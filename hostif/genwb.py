@@ -1,6 +1,278 @@
 #!/usr/bin/python
 
-nchan = 8
+# Prints the description of the global registers, or with the "channel"
+# argument the description of the register block of one channel. See
+# genregs.py for the generation of the VHDL and C files.
+
+import sys
+
+if (len(sys.argv) > 1) and (sys.argv[1] == "channel"):
+    print "peripheral {"
+    print "    name = \"TDC channel\";"
+    print "    description = \"Registers of one channel of the TDC.\";"
+    print "    hdl_entity = \"tdc_chregs\";"
+    print "    prefix = \"tdc\";"
+    print """
+    reg {
+        name = "Deskew value, high word";
+        description = "Bits 63-32 of the value added to the measurements of the channel.";
+        prefix = "desh";
+
+        field {
+            name = "Value";
+            type = SLV;
+            size = 32;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+    };
+
+    reg {
+        name = "Deskew value, low word";
+        description = "Bits 31-0 of the value added to the measurements of the channel.";
+        prefix = "desl";
+
+        field {
+            name = "Value";
+            type = SLV;
+            size = 32;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+    };
+
+    reg {
+        name = "Channel control";
+        description = "Edge filter, time difference stop channel and interrupt enable.";
+        prefix = "ctl";
+
+        field {
+            name = "Drop rising edges";
+            prefix = "ris";
+            type = BIT;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+        field {
+            name = "Drop falling edges";
+            prefix = "fal";
+            type = BIT;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+        field {
+            name = "Stop channel";
+            description = "When set, the channel is a stop channel of the time difference unit.";
+            prefix = "stop";
+            type = BIT;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+        field {
+            name = "Interrupt enable";
+            description = "When set, the transitions of the channel set its event pending bit.";
+            prefix = "ie";
+            type = BIT;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+    };
+
+    reg {
+        name = "Hit filter";
+        description = "Dead time and prescaler of the channel.";
+        prefix = "hf";
+
+        field {
+            name = "Dead time";
+            description = "Number of clock cycles after a hit during which further hits are dropped.";
+            prefix = "dt";
+            type = SLV;
+            size = 16;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+        field {
+            name = "Prescaler";
+            description = "Number of hits dropped after each kept hit.";
+            prefix = "psc";
+            type = SLV;
+            size = 16;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+    };
+
+    reg {
+        name = "Latest measurement polarity and raw value";
+        prefix = "mpr";
+
+        field {
+            name = "Raw value";
+            prefix = "raw";
+            type = SLV;
+            size = 16;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+        field {
+            name = "Polarity";
+            prefix = "pol";
+            type = BIT;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+    };
+
+    reg {
+        name = "Latest measurement, high word";
+        prefix = "mesh";
+
+        field {
+            name = "Value";
+            type = SLV;
+            size = 32;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+    };
+
+    reg {
+        name = "Latest measurement, low word";
+        description = "Reading this register marks the latest measurement as read.";
+        prefix = "mesl";
+
+        field {
+            name = "Value";
+            type = SLV;
+            size = 32;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+            ack_read = "rd";
+        };
+    };
+
+    reg {
+        name = "FIFO status";
+        prefix = "fst";
+
+        field {
+            name = "Fill level";
+            prefix = "lvl";
+            type = SLV;
+            size = 16;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+        field {
+            name = "Overflow count";
+            prefix = "ovf";
+            type = SLV;
+            size = 16;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+    };
+
+    reg {
+        name = "FIFO head polarity and raw value";
+        prefix = "fpr";
+
+        field {
+            name = "Raw value";
+            prefix = "raw";
+            type = SLV;
+            size = 16;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+        field {
+            name = "Polarity";
+            prefix = "pol";
+            type = BIT;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+    };
+
+    reg {
+        name = "FIFO head measurement, high word";
+        prefix = "fmh";
+
+        field {
+            name = "Value";
+            type = SLV;
+            size = 32;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+    };
+
+    reg {
+        name = "FIFO head measurement, low word";
+        description = "Reading this register removes the head measurement from the FIFO.";
+        prefix = "fml";
+
+        field {
+            name = "Value";
+            type = SLV;
+            size = 32;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+            ack_read = "pop";
+        };
+    };
+
+    reg {
+        name = "Hit counter";
+        prefix = "cnth";
+
+        field {
+            name = "Count";
+            type = SLV;
+            size = 32;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+            shared = true;
+        };
+    };
+
+    reg {
+        name = "Lost event counter";
+        prefix = "cntl";
+
+        field {
+            name = "Count";
+            type = SLV;
+            size = 32;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+            shared = true;
+        };
+    };
+
+    reg {
+        name = "Rate meter";
+        prefix = "cntr";
+
+        field {
+            name = "Rate";
+            type = SLV;
+            size = 32;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+            shared = true;
+        };
+    };
+"""
+    print "    irq {"
+    print "        name = \"Event\";"
+    print "        description = \"Sets the event pending bit of the channel.\";"
+    print "        prefix = \"ev\";"
+    print "        trigger = EDGE_RISING;"
+    print "    };"
+    print "};"
+    sys.exit(0)
 
 print "peripheral {"
 print "    name = \"TDC\";"
@@ -31,106 +303,16 @@ print """
     };
 """
 
-for i in range(0,nchan):
-    print "    reg {"
-    print "        name = \"Deskew value for channel %d (high word)\";" % i
-    print "        description = \"A constant value added to all measurements of channel %d.\";" % i
-    print "        prefix = \"desh%d\";" % i
-    print ""
-    print "        field {"
-    print "            name = \"High word value\";"
-    print "            type = SLV;"
-    print "            size = 32;"
-    print "            access_bus = READ_WRITE;"
-    print "            access_dev = READ_ONLY;"
-    print "        };"
-    print "    };"
-    print ""
-    print "    reg {"
-    print "        name = \"Deskew value for channel %d (low word)\";" % i
-    print "        description = \"A constant value added to all measurements of channel %d.\";" % i
-    print "        prefix = \"desl%d\";" % i
-    print ""
-    print "        field {"
-    print "            name = \"Low word value\";"
-    print "            type = SLV;"
-    print "            size = 32;"
-    print "            access_bus = READ_WRITE;"
-    print "            access_dev = READ_ONLY;"
-    print "        };"
-    print "    };"
-    print ""
+# Interrupts
 
-print "    reg {"
-print "        name = \"Detected polarities\";"
-print "        description = \"A bit vector representing the polarities (rising/falling edges) of the detected transitions.\";"
-print "        prefix = \"pol\";"
-print ""
-print "        field {"
-print "            name = \"Value\";"
-print "            type = SLV;"
-print "            size = %d;" % nchan
-print "            access_bus = READ_ONLY;"
-print "            access_dev = WRITE_ONLY;"
-print "        };"
+print "    irq {"
+print "        name = \"Event detection\";"
+print "        description = \"Interrupt triggered when the input signal of a channel whose interrupt enable bit is set changes state. The channels are identified by the event pending registers.\";"
+print "        prefix = \"iev\";"
+print "        trigger = EDGE_RISING;"
 print "    };"
 print ""
 
-for i in range(0,nchan):
-    print "    reg {"
-    print "        name = \"Raw measured value for channel %d\";" % i
-    print "        description = \"Raw encoded value from the fine delay line for channel %d.\";" % i
-    print "        prefix = \"raw%d\";" % i
-    print ""
-    print "        field {"
-    print "            name = \"Value\";"
-    print "            type = SLV;"
-    print "            size = 32;"
-    print "            access_bus = READ_ONLY;"
-    print "            access_dev = WRITE_ONLY;"
-    print "        };"
-    print "    };"
-    print ""
-    print "    reg {"
-    print "        name = \"Fixed point measurement for channel %d (high word)\";" % i
-    print "        description = \"Fully calibrated time stamp for channel %d.\";" % i
-    print "        prefix = \"mesh%d\";" % i
-    print ""
-    print "        field {"
-    print "            name = \"High word value\";"
-    print "            type = SLV;"
-    print "            size = 32;"
-    print "            access_bus = READ_ONLY;"
-    print "            access_dev = WRITE_ONLY;"
-    print "        };"
-    print "    };"
-    print ""
-    print "    reg {"
-    print "        name = \"Fixed point measurement for channel %d (low word)\";" % i
-    print "        description = \"Fully calibrated time stamp for channel %d.\";" % i
-    print "        prefix = \"mesl%d\";" % i
-    print ""
-    print "        field {"
-    print "            name = \"Low word value\";"
-    print "            type = SLV;"
-    print "            size = 32;"
-    print "            access_bus = READ_ONLY;"
-    print "            access_dev = WRITE_ONLY;"
-    print "        };"
-    print "    };"
-    print ""
-
-# Interrupts
-
-for i in range(0,nchan):
-    print "    irq {"
-    print "        name = \"Event detection %d\";" % i
-    print "        description = \"Interrupt triggered when the input signal changes state on channel %d.\";" % i
-    print "        prefix = \"ie%d\";" % i
-    print "        trigger = EDGE_RISING;"
-    print "    };"
-    print ""
-
 print "    irq {"
 print "        name = \"Startup calibration done\";"
 print "        description = \"Interrupt triggered after the startup calibration is completed.\";"
@@ -147,6 +329,14 @@ print "        trigger = EDGE_RISING;"
 print "    };"
 print ""
 
+print "    irq {"
+print "        name = \"FIFO watermark\";"
+print "        description = \"Interrupt triggered when the fill level of a channel FIFO reaches the watermark.\";"
+print "        prefix = \"ifw\";"
+print "        trigger = EDGE_RISING;"
+print "    };"
+print ""
+
 # Debug interface
 
 print """
@@ -307,4 +497,345 @@ print """
     };
 """
 
+# Event FIFOs
+
+print """
+    reg {
+        name = "FIFO watermark";
+        description = "Fill level at which the FIFO watermark interrupt is triggered (0 disables).";
+        prefix = "fwm";
+
+        field {
+            name = "Level";
+            type = SLV;
+            size = 16;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+    };
+"""
+
+# Merged event stream
+
+print """
+    reg {
+        name = "Event merge control";
+        description = "Controls the merging of the channel FIFOs into a single time-ordered event FIFO.";
+        prefix = "mctl";
+
+        field {
+            name = "Merge enable";
+            description = "When set, events are moved from the channel FIFOs to the merged event FIFO.";
+            prefix = "en";
+            type = BIT;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+    };
+
+    reg {
+        name = "Merged FIFO status";
+        description = "Fill level of the merged event FIFO.";
+        prefix = "mst";
+
+        field {
+            name = "Fill level";
+            prefix = "lvl";
+            type = SLV;
+            size = 16;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+    };
+
+    reg {
+        name = "Merged FIFO head channel, polarity and raw value";
+        description = "Channel, polarity and raw encoded value of the oldest event in the merged FIFO.";
+        prefix = "mcr";
+
+        field {
+            name = "Raw value";
+            prefix = "raw";
+            type = SLV;
+            size = 16;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+        field {
+            name = "Polarity";
+            prefix = "pol";
+            type = BIT;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+        field {
+            name = "Channel";
+            prefix = "chn";
+            type = SLV;
+            size = 8;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+    };
+
+    reg {
+        name = "Merged FIFO head measurement (high word)";
+        description = "Fully calibrated time stamp of the oldest event in the merged FIFO.";
+        prefix = "mmh";
+
+        field {
+            name = "High word value";
+            type = SLV;
+            size = 32;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+    };
+
+    reg {
+        name = "Merged FIFO head measurement (low word)";
+        description = "Fully calibrated time stamp of the oldest event in the merged FIFO. Reading this register removes the event from the FIFO.";
+        prefix = "mml";
+
+        field {
+            name = "Low word value";
+            type = SLV;
+            size = 32;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+            ack_read = "pop";
+        };
+    };
+"""
+
+# Time differences
+
+print """
+    reg {
+        name = "Time difference unit control";
+        description = "Selects the start channel of the time difference unit (optional). The stop channels are selected in the channel control registers.";
+        prefix = "dfc";
+
+        field {
+            name = "Enable";
+            description = "When set, the time differences between the start and stop channels are computed. Clearing this bit empties the difference FIFO.";
+            prefix = "en";
+            type = BIT;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+        field {
+            name = "Start channel";
+            prefix = "start";
+            type = SLV;
+            size = 8;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+    };
+
+    reg {
+        name = "Time difference range gate (minimum)";
+        description = "Smallest time difference (signed) that is stored in the difference FIFO.";
+        prefix = "dfgl";
+
+        field {
+            name = "Value";
+            type = SLV;
+            size = 32;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+    };
+
+    reg {
+        name = "Time difference range gate (maximum)";
+        description = "Largest time difference (signed) that is stored in the difference FIFO.";
+        prefix = "dfgh";
+
+        field {
+            name = "Value";
+            type = SLV;
+            size = 32;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+    };
+
+    reg {
+        name = "Difference FIFO status";
+        description = "Fill level of the difference FIFO and number of lost differences.";
+        prefix = "dfs";
+
+        field {
+            name = "Fill level";
+            prefix = "lvl";
+            type = SLV;
+            size = 16;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+        field {
+            name = "Loss count";
+            prefix = "lost";
+            type = SLV;
+            size = 16;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+    };
+
+    reg {
+        name = "Difference FIFO head channel";
+        description = "Stop channel of the oldest time difference in the difference FIFO.";
+        prefix = "dfch";
+
+        field {
+            name = "Channel";
+            type = SLV;
+            size = 8;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+    };
+
+    reg {
+        name = "Difference FIFO head value";
+        description = "Oldest time difference (signed) in the difference FIFO. Reading this register removes it from the FIFO.";
+        prefix = "dfv";
+
+        field {
+            name = "Value";
+            type = SLV;
+            size = 32;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+            ack_read = "pop";
+        };
+    };
+"""
+
+# Time difference histogram
+
+print """
+    reg {
+        name = "Time difference histogram control";
+        description = "Controls the time difference histogram (optional).";
+        prefix = "dhc";
+
+        field {
+            name = "Enable";
+            description = "When set, the differences computed by the time difference unit are binned into the histogram instead of being stored into the difference FIFO.";
+            prefix = "en";
+            type = BIT;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+        field {
+            name = "Freeze";
+            description = "When set, the histogram is not updated and can be read through the DHA and DHD registers.";
+            prefix = "frz";
+            type = BIT;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+        field {
+            name = "Clear";
+            description = "Writing 1 zeroes all the bins and the outside count.";
+            prefix = "clr";
+            type = MONOSTABLE;
+        };
+        field {
+            name = "Clear in progress";
+            prefix = "busy";
+            type = BIT;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+        field {
+            name = "Bin width";
+            description = "Base 2 logarithm of the width of each bin, in fixed point units.";
+            prefix = "shift";
+            type = SLV;
+            size = 5;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+    };
+
+    reg {
+        name = "Time difference histogram offset";
+        description = "Start of the first bin of the histogram (signed, in fixed point units).";
+        prefix = "dho";
+
+        field {
+            name = "Value";
+            type = SLV;
+            size = 32;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+    };
+
+    reg {
+        name = "Time difference histogram read address";
+        description = "Bin to read when the histogram is frozen.";
+        prefix = "dha";
+
+        field {
+            name = "Address";
+            type = SLV;
+            size = 16;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+    };
+
+    reg {
+        name = "Time difference histogram read data";
+        description = "Count of the bin selected by the DHA register.";
+        prefix = "dhd";
+
+        field {
+            name = "Data";
+            type = SLV;
+            size = 32;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+    };
+
+    reg {
+        name = "Time difference histogram outside count";
+        description = "Number of differences that fell outside of the histogram.";
+        prefix = "dhx";
+
+        field {
+            name = "Count";
+            type = SLV;
+            size = 32;
+            access_bus = READ_ONLY;
+            access_dev = WRITE_ONLY;
+        };
+    };
+"""
+
+# Channel statistics
+
+print """
+    reg {
+        name = "Rate meter gate";
+        description = "Gate period of the rate meters, in clock cycles (0 stops the rate meters).";
+        prefix = "rgate";
+
+        field {
+            name = "Period";
+            type = SLV;
+            size = 32;
+            access_bus = READ_WRITE;
+            access_dev = READ_ONLY;
+        };
+    };
+"""
+
 print "};"
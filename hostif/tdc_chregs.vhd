@@ -0,0 +1,299 @@
+-------------------------------------------------------------------------------
+-- Title          : Register blocks for TDC channel
+-------------------------------------------------------------------------------
+-- File           : tdc_chregs.vhd
+-- Author         : auto-generated by genregs.py from channel.wb
+-------------------------------------------------------------------------------
+-- THIS FILE WAS GENERATED BY genregs.py FROM SOURCE FILE channel.wb
+-- DO NOT HAND-EDIT: CHANGE genwb.py AND REGENERATE IT
+-------------------------------------------------------------------------------
+
+-- DESCRIPTION:
+-- Register blocks of g_CHANNEL_COUNT channels (at most 64), with 16 words
+-- per channel starting at word 0x400:
+--   0. DESH: Deskew value, high word
+--      bits 31-0: value (read/write)
+--   1. DESL: Deskew value, low word
+--      bits 31-0: value (read/write)
+--   2. CTL: Channel control
+--      bit 0: drop rising edges (read/write), bit 1: drop falling edges
+--      (read/write), bit 2: stop channel (read/write), bit 3: interrupt enable
+--      (read/write)
+--   3. HF: Hit filter
+--      bits 15-0: dead time (read/write), bits 31-16: prescaler (read/write)
+--   4. MPR: Latest measurement polarity and raw value
+--      bits 15-0: raw value (read only), bit 16: polarity (read only)
+--   5. MESH: Latest measurement, high word
+--      bits 31-0: value (read only)
+--   6. MESL: Latest measurement, low word
+--      bits 31-0: value (read only, reading pulses tdc_mesl_rd_o)
+--   7. FST: FIFO status
+--      bits 15-0: fill level (read only), bits 31-16: overflow count (read
+--      only)
+--   8. FPR: FIFO head polarity and raw value
+--      bits 15-0: raw value (read only), bit 16: polarity (read only)
+--   9. FMH: FIFO head measurement, high word
+--      bits 31-0: value (read only)
+--  10. FML: FIFO head measurement, low word
+--      bits 31-0: value (read only, reading pulses tdc_fml_pop_o)
+--  11. CNTH: Hit counter
+--      bits 31-0: count (read only, shared)
+--  12. CNTL: Lost event counter
+--      bits 31-0: count (read only, shared)
+--  13. CNTR: Rate meter
+--      bits 31-0: rate (read only, shared)
+-- The other registers, and the blocks of channels above g_CHANNEL_COUNT,
+-- read as 0 and ignore writes. The shared fields are read from the channel
+-- presented on sel_o, which follows the address, one cycle later.
+--
+-- Words 0x40 to 0x41 are the event pending registers, with one bit per
+-- channel (32 channels per word). Each pulse on the irq_ev_i input of a
+-- channel sets its bit, and writing 1 to a bit clears it. wb_irq_o is pulsed
+-- after each event, so that all the channels can share a single edge
+-- triggered interrupt. A write that clears a bit loses against an event of
+-- the same cycle. The other addresses read as 0 and ignore writes.
+--
+-- Accesses are acknowledged two cycles after the strobe.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+entity tdc_chregs is
+    generic(
+        -- Number of channels. Must be 64 or less.
+        g_CHANNEL_COUNT : positive
+    );
+    port(
+        clk_i          : in std_logic;
+        reset_i        : in std_logic;
+        
+        wb_addr_i      : in std_logic_vector(10 downto 0);
+        wb_data_i      : in std_logic_vector(31 downto 0);
+        wb_data_o      : out std_logic_vector(31 downto 0);
+        wb_cyc_i       : in std_logic;
+        wb_stb_i       : in std_logic;
+        wb_we_i        : in std_logic;
+        wb_ack_o       : out std_logic;
+        wb_irq_o       : out std_logic;
+        
+        irq_ev_i       : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        tdc_desh_o     : out std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+        
+        tdc_desl_o     : out std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+        
+        tdc_ctl_ris_o  : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        tdc_ctl_fal_o  : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        tdc_ctl_stop_o : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        tdc_ctl_ie_o   : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        tdc_hf_dt_o    : out std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+        tdc_hf_psc_o   : out std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+        
+        tdc_mpr_raw_i  : in std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+        tdc_mpr_pol_i  : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        tdc_mesh_i     : in std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+        
+        tdc_mesl_i     : in std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+        tdc_mesl_rd_o  : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        tdc_fst_lvl_i  : in std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+        tdc_fst_ovf_i  : in std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+        
+        tdc_fpr_raw_i  : in std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+        tdc_fpr_pol_i  : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        tdc_fmh_i      : in std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+        
+        tdc_fml_i      : in std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+        tdc_fml_pop_o  : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        tdc_cnth_i     : in std_logic_vector(31 downto 0);
+        
+        tdc_cntl_i     : in std_logic_vector(31 downto 0);
+        
+        tdc_cntr_i     : in std_logic_vector(31 downto 0);
+        
+        sel_o          : out std_logic_vector(7 downto 0)
+    );
+end entity;
+
+architecture rtl of tdc_chregs is
+signal tdc_desh_int     : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal tdc_desl_int     : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal tdc_ctl_ris_int  : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal tdc_ctl_fal_int  : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal tdc_ctl_stop_int : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal tdc_ctl_ie_int   : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal tdc_hf_dt_int    : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal tdc_hf_psc_int   : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal pending          : std_logic_vector(63 downto 0);
+signal irq              : std_logic;
+signal irq_pend         : std_logic;
+
+-- access in progress
+signal busy             : std_logic;
+signal ack              : std_logic;
+signal a_block          : std_logic;
+signal a_evp            : std_logic;
+signal a_evw            : natural range 0 to 1;
+signal a_chn            : natural range 0 to 63;
+signal a_reg            : natural range 0 to 15;
+signal a_we             : std_logic;
+signal a_data           : std_logic_vector(31 downto 0);
+begin
+    sel_o <= "00" & wb_addr_i(9 downto 4);
+    
+    process(clk_i)
+    variable v_data  : std_logic_vector(31 downto 0);
+    variable v_event : std_logic;
+    begin
+        if rising_edge(clk_i) then
+            if reset_i = '1' then
+                tdc_desh_int <= (others => '0');
+                tdc_desl_int <= (others => '0');
+                tdc_ctl_ris_int <= (others => '0');
+                tdc_ctl_fal_int <= (others => '0');
+                tdc_ctl_stop_int <= (others => '0');
+                tdc_ctl_ie_int <= (others => '0');
+                tdc_hf_dt_int <= (others => '0');
+                tdc_hf_psc_int <= (others => '0');
+                pending <= (others => '0');
+                busy <= '0';
+                ack <= '0';
+                irq <= '0';
+                irq_pend <= '0';
+                tdc_mesl_rd_o <= (others => '0');
+                tdc_fml_pop_o <= (others => '0');
+            else
+                ack <= '0';
+                tdc_mesl_rd_o <= (others => '0');
+                tdc_fml_pop_o <= (others => '0');
+                
+                -- Pending events. A write that clears a bit loses against
+                -- an event in the same cycle.
+                v_event := '0';
+                if (busy = '1') and (a_evp = '1') and (a_we = '1') then
+                    pending(a_evw*32+31 downto a_evw*32)
+                        <= pending(a_evw*32+31 downto a_evw*32) and not a_data;
+                end if;
+                for i in 0 to g_CHANNEL_COUNT-1 loop
+                    if irq_ev_i(i) = '1' then
+                        pending(i) <= '1';
+                        v_event := '1';
+                    end if;
+                end loop;
+                
+                -- Return wb_irq_o to 0 after each pulse, so that events in
+                -- consecutive cycles still produce an edge.
+                if irq = '1' then
+                    irq <= '0';
+                    irq_pend <= v_event;
+                else
+                    irq <= v_event or irq_pend;
+                    irq_pend <= '0';
+                end if;
+                
+                if (wb_cyc_i = '1') and (wb_stb_i = '1') and (busy = '0') and (ack = '0') then
+                    busy <= '1';
+                    if wb_addr_i(10) = '1' then
+                        a_block <= '1';
+                    else
+                        a_block <= '0';
+                    end if;
+                    if wb_addr_i(10 downto 1) = "0000100000" then
+                        a_evp <= '1';
+                    else
+                        a_evp <= '0';
+                    end if;
+                    a_evw <= to_integer(unsigned(wb_addr_i(0 downto 0)));
+                    a_chn <= to_integer(unsigned(wb_addr_i(9 downto 4)));
+                    a_reg <= to_integer(unsigned(wb_addr_i(3 downto 0)));
+                    a_we <= wb_we_i;
+                    a_data <= wb_data_i;
+                end if;
+                
+                if busy = '1' then
+                    busy <= '0';
+                    ack <= '1';
+                    v_data := (others => '0');
+                    if a_evp = '1' then
+                        v_data := pending(a_evw*32+31 downto a_evw*32);
+                    elsif (a_block = '1') and (a_chn < g_CHANNEL_COUNT) then
+                        if a_we = '1' then
+                            case a_reg is
+                                when 0 =>
+                                    tdc_desh_int(a_chn*32+31 downto a_chn*32) <= a_data(31 downto 0);
+                                when 1 =>
+                                    tdc_desl_int(a_chn*32+31 downto a_chn*32) <= a_data(31 downto 0);
+                                when 2 =>
+                                    tdc_ctl_ris_int(a_chn) <= a_data(0);
+                                    tdc_ctl_fal_int(a_chn) <= a_data(1);
+                                    tdc_ctl_stop_int(a_chn) <= a_data(2);
+                                    tdc_ctl_ie_int(a_chn) <= a_data(3);
+                                when 3 =>
+                                    tdc_hf_dt_int(a_chn*16+15 downto a_chn*16) <= a_data(15 downto 0);
+                                    tdc_hf_psc_int(a_chn*16+15 downto a_chn*16) <= a_data(31 downto 16);
+                                when others => null;
+                            end case;
+                        end if;
+                        case a_reg is
+                            when 0 =>
+                                v_data(31 downto 0) := tdc_desh_int(a_chn*32+31 downto a_chn*32);
+                            when 1 =>
+                                v_data(31 downto 0) := tdc_desl_int(a_chn*32+31 downto a_chn*32);
+                            when 2 =>
+                                v_data(0) := tdc_ctl_ris_int(a_chn);
+                                v_data(1) := tdc_ctl_fal_int(a_chn);
+                                v_data(2) := tdc_ctl_stop_int(a_chn);
+                                v_data(3) := tdc_ctl_ie_int(a_chn);
+                            when 3 =>
+                                v_data(15 downto 0) := tdc_hf_dt_int(a_chn*16+15 downto a_chn*16);
+                                v_data(31 downto 16) := tdc_hf_psc_int(a_chn*16+15 downto a_chn*16);
+                            when 4 =>
+                                v_data(15 downto 0) := tdc_mpr_raw_i(a_chn*16+15 downto a_chn*16);
+                                v_data(16) := tdc_mpr_pol_i(a_chn);
+                            when 5 =>
+                                v_data(31 downto 0) := tdc_mesh_i(a_chn*32+31 downto a_chn*32);
+                            when 6 =>
+                                v_data(31 downto 0) := tdc_mesl_i(a_chn*32+31 downto a_chn*32);
+                                tdc_mesl_rd_o(a_chn) <= not a_we;
+                            when 7 =>
+                                v_data(15 downto 0) := tdc_fst_lvl_i(a_chn*16+15 downto a_chn*16);
+                                v_data(31 downto 16) := tdc_fst_ovf_i(a_chn*16+15 downto a_chn*16);
+                            when 8 =>
+                                v_data(15 downto 0) := tdc_fpr_raw_i(a_chn*16+15 downto a_chn*16);
+                                v_data(16) := tdc_fpr_pol_i(a_chn);
+                            when 9 =>
+                                v_data(31 downto 0) := tdc_fmh_i(a_chn*32+31 downto a_chn*32);
+                            when 10 =>
+                                v_data(31 downto 0) := tdc_fml_i(a_chn*32+31 downto a_chn*32);
+                                tdc_fml_pop_o(a_chn) <= not a_we;
+                            when 11 =>
+                                v_data(31 downto 0) := tdc_cnth_i;
+                            when 12 =>
+                                v_data(31 downto 0) := tdc_cntl_i;
+                            when 13 =>
+                                v_data(31 downto 0) := tdc_cntr_i;
+                            when others => null;
+                        end case;
+                    end if;
+                    wb_data_o <= v_data;
+                end if;
+            end if;
+        end if;
+    end process;
+    wb_ack_o <= ack;
+    wb_irq_o <= irq;
+    
+    tdc_desh_o <= tdc_desh_int;
+    tdc_desl_o <= tdc_desl_int;
+    tdc_ctl_ris_o <= tdc_ctl_ris_int;
+    tdc_ctl_fal_o <= tdc_ctl_fal_int;
+    tdc_ctl_stop_o <= tdc_ctl_stop_int;
+    tdc_ctl_ie_o <= tdc_ctl_ie_int;
+    tdc_hf_dt_o <= tdc_hf_dt_int;
+    tdc_hf_psc_o <= tdc_hf_psc_int;
+end architecture;
@@ -0,0 +1,154 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tdc_chstat
+--
+-- author: agent, agent@local
+--
+-- description: Per-channel hit, lost event and rate counters
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- Maintains three 32-bit counters for each channel:
+--  * the hit counter counts the transitions signaled on hit_i;
+--  * the lost event counter counts the transitions that occur while the
+--    previous one has not been read yet, i.e. that overwrite unread data.
+--    A pulse on read_i marks the latest transition of the channel as read;
+--  * the rate meter reports the number of transitions in the latest
+--    complete gate period of gate_i clock cycles. The gate periods of all
+--    channels are aligned. Setting gate_i to 0 stops the rate meter and
+--    clears its results.
+-- The hit and lost event counters are free-running and wrap around.
+--
+-- The counters of the channel selected by sel_i are presented on hits_o,
+-- lost_o and rate_o, one cycle later. An out of range channel reads as 0.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tdc_chstat is
+    generic(
+        -- Number of channels.
+        g_CHANNEL_COUNT : positive
+    );
+    port(
+        clk_i   : in std_logic;
+        reset_i : in std_logic;
+        
+        -- Rate meter gate period, in clock cycles.
+        gate_i  : in std_logic_vector(31 downto 0);
+        
+        -- Transitions and reads, per channel.
+        hit_i   : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        read_i  : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        -- Counters of the selected channel.
+        sel_i   : in std_logic_vector(7 downto 0);
+        hits_o  : out std_logic_vector(31 downto 0);
+        lost_o  : out std_logic_vector(31 downto 0);
+        rate_o  : out std_logic_vector(31 downto 0)
+    );
+end entity;
+
+architecture rtl of tdc_chstat is
+type t_counters is array(0 to g_CHANNEL_COUNT-1) of unsigned(31 downto 0);
+
+signal hits     : t_counters;
+signal lost     : t_counters;
+signal window   : t_counters;
+signal rate     : t_counters;
+signal unread   : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal gate_cnt : unsigned(31 downto 0);
+signal gate_end : std_logic;
+begin
+    -- Rate meter gate.
+    gate_end <= '1' when (gate_i /= x"00000000") and (gate_cnt >= unsigned(gate_i) - 1) else '0';
+    process(clk_i)
+    begin
+        if rising_edge(clk_i) then
+            if (reset_i = '1') or (gate_i = x"00000000") or (gate_end = '1') then
+                gate_cnt <= (others => '0');
+            else
+                gate_cnt <= gate_cnt + 1;
+            end if;
+        end if;
+    end process;
+    
+    g_channel: for i in 0 to g_CHANNEL_COUNT-1 generate
+        process(clk_i)
+        begin
+            if rising_edge(clk_i) then
+                if reset_i = '1' then
+                    hits(i) <= (others => '0');
+                    lost(i) <= (others => '0');
+                    unread(i) <= '0';
+                else
+                    if hit_i(i) = '1' then
+                        hits(i) <= hits(i) + 1;
+                        -- a read in the same cycle got the previous data
+                        if (unread(i) = '1') and (read_i(i) = '0') then
+                            lost(i) <= lost(i) + 1;
+                        end if;
+                        unread(i) <= '1';
+                    elsif read_i(i) = '1' then
+                        unread(i) <= '0';
+                    end if;
+                end if;
+                
+                if (reset_i = '1') or (gate_i = x"00000000") then
+                    window(i) <= (others => '0');
+                    rate(i) <= (others => '0');
+                elsif gate_end = '1' then
+                    if hit_i(i) = '1' then
+                        rate(i) <= window(i) + 1;
+                    else
+                        rate(i) <= window(i);
+                    end if;
+                    window(i) <= (others => '0');
+                elsif hit_i(i) = '1' then
+                    window(i) <= window(i) + 1;
+                end if;
+            end if;
+        end process;
+    end generate;
+    
+    -- Channel selection.
+    process(clk_i)
+    variable v_sel : natural;
+    begin
+        if rising_edge(clk_i) then
+            v_sel := to_integer(unsigned(sel_i));
+            if v_sel < g_CHANNEL_COUNT then
+                hits_o <= std_logic_vector(hits(v_sel));
+                lost_o <= std_logic_vector(lost(v_sel));
+                rate_o <= std_logic_vector(rate(v_sel));
+            else
+                hits_o <= (others => '0');
+                lost_o <= (others => '0');
+                rate_o <= (others => '0');
+            end if;
+        end if;
+    end process;
+end architecture;
@@ -0,0 +1,213 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tdc_dhist
+--
+-- author: agent, agent@local
+--
+-- description: Time difference histogrammer
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- Bins a stream of signed 32-bit values into a histogram of g_DEPTH 32-bit
+-- counters, at a rate of up to one value per clock cycle.
+--
+-- A value v is counted in bin (v - offset_i)/2^shift_i, i.e. the bins are
+-- 2^shift_i units wide and the first one starts at offset_i. Values outside
+-- of the histogram increment the outside_o counter instead. Counters saturate.
+--
+-- The counters are stored in block RAM and incremented with a pipelined
+-- read-modify-write cycle. An increment that follows one to the same bin in
+-- the previous cycle reads a stale value from the RAM, and uses the value
+-- being written instead.
+--
+-- While freeze_i is asserted, incoming values are ignored and the read port
+-- of the RAM is given to the host: rd_d_o presents the counter at address
+-- rd_a_i, one cycle later.
+-- Pulsing clear_i zeroes all the counters and outside_o, which takes g_DEPTH
+-- cycles during which busy_o is asserted and incoming values are ignored.
+--
+-- The histogram is cleared after reset.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tdc_dhist is
+    generic(
+        -- Number of bins. Must be a power of 2, at most 65536.
+        g_DEPTH : positive
+    );
+    port(
+        clk_i     : in std_logic;
+        reset_i   : in std_logic;
+        
+        -- Controls.
+        clear_i   : in std_logic;
+        busy_o    : out std_logic;
+        freeze_i  : in std_logic;
+        offset_i  : in std_logic_vector(31 downto 0);
+        shift_i   : in std_logic_vector(4 downto 0);
+        
+        -- Values.
+        valid_i   : in std_logic;
+        value_i   : in std_logic_vector(31 downto 0);
+        
+        -- Host access.
+        rd_a_i    : in std_logic_vector(15 downto 0);
+        rd_d_o    : out std_logic_vector(31 downto 0);
+        outside_o : out std_logic_vector(31 downto 0)
+    );
+end entity;
+
+architecture rtl of tdc_dhist is
+
+function f_log2_size(a : natural) return natural is
+begin
+    for i in 1 to 64 loop               -- Works for up to 64 bits
+        if 2**i >= a then
+            return i;
+        end if;
+    end loop;
+    return 63;
+end function;
+
+constant c_ORDER : natural := f_log2_size(g_DEPTH);
+
+type t_mem is array(0 to 2**c_ORDER-1) of unsigned(31 downto 0);
+signal mem : t_mem;
+
+signal busy      : std_logic;
+signal clr_a     : unsigned(c_ORDER-1 downto 0);
+signal bin       : unsigned(32 downto 0);
+signal in_range  : std_logic;
+
+-- stage 1: bin address, presented to the RAM
+signal s1_valid  : std_logic;
+signal s1_out    : std_logic;
+signal s1_a      : unsigned(c_ORDER-1 downto 0);
+signal rd_a      : unsigned(c_ORDER-1 downto 0);
+
+-- stage 2: increment
+signal s2_valid  : std_logic;
+signal s2_a      : unsigned(c_ORDER-1 downto 0);
+signal q         : unsigned(31 downto 0);
+signal count     : unsigned(31 downto 0);
+
+-- write port
+signal we        : std_logic;
+signal wa        : unsigned(c_ORDER-1 downto 0);
+signal wd        : unsigned(31 downto 0);
+
+-- last increment, for forwarding
+signal w_valid   : std_logic;
+signal w_a       : unsigned(c_ORDER-1 downto 0);
+signal w_d       : unsigned(31 downto 0);
+
+signal outside   : unsigned(31 downto 0);
+begin
+    bin <= shift_right(unsigned(resize(signed(value_i), 33) - resize(signed(offset_i), 33)),
+        to_integer(unsigned(shift_i)));
+    -- a negative difference has the most significant bit set before the shift
+    in_range <= '1' when (signed(value_i) >= signed(offset_i))
+        and (bin(32 downto c_ORDER) = (32 downto c_ORDER => '0')) else '0';
+    
+    process(clk_i)
+    begin
+        if rising_edge(clk_i) then
+            if reset_i = '1' then
+                busy <= '1';
+                clr_a <= (others => '0');
+                s1_valid <= '0';
+                s1_out <= '0';
+                s2_valid <= '0';
+                w_valid <= '0';
+                outside <= (others => '0');
+            else
+                if clear_i = '1' then
+                    busy <= '1';
+                    clr_a <= (others => '0');
+                elsif busy = '1' then
+                    if clr_a = 2**c_ORDER-1 then
+                        busy <= '0';
+                    end if;
+                    clr_a <= clr_a + 1;
+                end if;
+                
+                s1_valid <= valid_i and in_range and not freeze_i and not busy and not clear_i;
+                s1_out <= valid_i and not in_range and not freeze_i and not busy and not clear_i;
+                s1_a <= bin(c_ORDER-1 downto 0);
+                
+                -- the read port may have been given to the host
+                s2_valid <= s1_valid and not freeze_i;
+                s2_a <= s1_a;
+                
+                w_valid <= s2_valid;
+                w_a <= s2_a;
+                w_d <= count;
+                
+                if (busy = '1') or (clear_i = '1') then
+                    outside <= (others => '0');
+                elsif (s1_out = '1') and (outside /= (outside'range => '1')) then
+                    outside <= outside + 1;
+                end if;
+            end if;
+        end if;
+    end process;
+    
+    -- Increment, with forwarding and saturation.
+    process(q, s2_a, w_valid, w_a, w_d)
+    variable v_old : unsigned(31 downto 0);
+    begin
+        if (w_valid = '1') and (w_a = s2_a) then
+            v_old := w_d;
+        else
+            v_old := q;
+        end if;
+        if v_old = (v_old'range => '1') then
+            count <= v_old;
+        else
+            count <= v_old + 1;
+        end if;
+    end process;
+    
+    -- RAM.
+    rd_a <= unsigned(rd_a_i(c_ORDER-1 downto 0)) when freeze_i = '1' else s1_a;
+    we <= busy or s2_valid;
+    wa <= clr_a when busy = '1' else s2_a;
+    wd <= (others => '0') when busy = '1' else count;
+    process(clk_i)
+    begin
+        if rising_edge(clk_i) then
+            if we = '1' then
+                mem(to_integer(wa)) <= wd;
+            end if;
+            q <= mem(to_integer(rd_a));
+        end if;
+    end process;
+    
+    busy_o <= busy;
+    rd_d_o <= std_logic_vector(q);
+    outside_o <= std_logic_vector(outside);
+end architecture;
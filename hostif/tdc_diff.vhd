@@ -0,0 +1,217 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tdc_diff
+--
+-- author: agent, agent@local
+--
+-- description: Start-stop time difference unit
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- Computes the time differences between a start channel and a set of stop
+-- channels, so that software does not have to read and subtract two full
+-- time stamps for each measurement.
+--
+-- Each transition of the start channel (selected by start_i) records its
+-- time stamp. Each subsequent transition of a stop channel (selected by the
+-- stop_i mask) produces the difference between its time stamp and the latest
+-- start time stamp, computed modulo 2^g_TS_WIDTH and interpreted as a signed
+-- number. It is negative when the stop time stamp is earlier than the start,
+-- e.g. because of deskew. A stop that occurs in the same cycle as a start
+-- uses the new start, except for the start channel itself, which may also be
+-- a stop channel: it then measures the interval between its consecutive
+-- transitions.
+--
+-- Differences outside of the [gmin_i, gmax_i] range gate, and stops that
+-- occur before the first start, are discarded. The remaining ones are output
+-- as 32-bit signed values, along with their stop channel number, at a rate of
+-- up to one per cycle. Each stop channel has a one-entry buffer. When several
+-- channels have a pending difference, the lowest channel number goes first,
+-- and nothing is output while full_i is asserted. A difference that
+-- overwrites a pending one increments the loss counter lost_o, which wraps
+-- around.
+--
+-- The unit is cleared and does nothing when enable_i is low.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tdc_diff is
+    generic(
+        -- Number of channels.
+        g_CHANNEL_COUNT : positive;
+        -- Number of time stamp bits.
+        g_TS_WIDTH      : positive
+    );
+    port(
+        clk_i     : in std_logic;
+        reset_i   : in std_logic;
+        enable_i  : in std_logic;
+        
+        -- Configuration.
+        start_i   : in std_logic_vector(7 downto 0);
+        stop_i    : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        gmin_i    : in std_logic_vector(31 downto 0);
+        gmax_i    : in std_logic_vector(31 downto 0);
+        
+        -- Transitions.
+        detect_i  : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        ts_i      : in std_logic_vector(g_CHANNEL_COUNT*g_TS_WIDTH-1 downto 0);
+        
+        -- Difference stream.
+        full_i    : in std_logic;
+        push_o    : out std_logic;
+        channel_o : out std_logic_vector(7 downto 0);
+        diff_o    : out std_logic_vector(31 downto 0);
+        lost_o    : out std_logic_vector(15 downto 0)
+    );
+end entity;
+
+architecture rtl of tdc_diff is
+
+function f_max(a : natural; b : natural) return natural is
+begin
+    if a > b then
+        return a;
+    else
+        return b;
+    end if;
+end function;
+
+-- width used to compare differences against the range gate
+constant c_CWIDTH : positive := f_max(g_TS_WIDTH, 32);
+
+type t_diff is array(0 to g_CHANNEL_COUNT-1) of signed(g_TS_WIDTH-1 downto 0);
+type t_result is array(0 to g_CHANNEL_COUNT-1) of std_logic_vector(31 downto 0);
+
+signal start_ts  : unsigned(g_TS_WIDTH-1 downto 0);
+signal armed     : std_logic;
+signal new_ts    : unsigned(g_TS_WIDTH-1 downto 0);
+signal new_armed : std_logic;
+
+-- pipeline stage 1: raw differences
+signal d_valid   : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal d         : t_diff;
+
+-- pipeline stage 2: gated differences waiting for output
+signal in_gate   : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal pending   : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal result    : t_result;
+signal sel       : natural range 0 to g_CHANNEL_COUNT-1;
+signal push      : std_logic;
+signal lost      : unsigned(15 downto 0);
+begin
+    -- Start time stamp, forwarded to the stops of the same cycle.
+    process(start_i, detect_i, ts_i, start_ts, armed)
+    begin
+        new_ts <= start_ts;
+        new_armed <= armed;
+        for i in 0 to g_CHANNEL_COUNT-1 loop
+            if (to_integer(unsigned(start_i)) = i) and (detect_i(i) = '1') then
+                new_ts <= unsigned(ts_i((i+1)*g_TS_WIDTH-1 downto i*g_TS_WIDTH));
+                new_armed <= '1';
+            end if;
+        end loop;
+    end process;
+    
+    process(clk_i)
+    variable v_start : unsigned(g_TS_WIDTH-1 downto 0);
+    variable v_armed : std_logic;
+    begin
+        if rising_edge(clk_i) then
+            if (reset_i = '1') or (enable_i = '0') then
+                start_ts <= (others => '0');
+                armed <= '0';
+                d_valid <= (others => '0');
+            else
+                start_ts <= new_ts;
+                armed <= new_armed;
+                for i in 0 to g_CHANNEL_COUNT-1 loop
+                    if to_integer(unsigned(start_i)) = i then
+                        v_start := start_ts;
+                        v_armed := armed;
+                    else
+                        v_start := new_ts;
+                        v_armed := new_armed;
+                    end if;
+                    d_valid(i) <= detect_i(i) and stop_i(i) and v_armed;
+                    d(i) <= signed(unsigned(ts_i((i+1)*g_TS_WIDTH-1 downto i*g_TS_WIDTH)) - v_start);
+                end loop;
+            end if;
+        end if;
+    end process;
+    
+    -- Range gate.
+    g_gate: for i in 0 to g_CHANNEL_COUNT-1 generate
+        in_gate(i) <= '1' when (resize(d(i), c_CWIDTH) >= resize(signed(gmin_i), c_CWIDTH))
+            and (resize(d(i), c_CWIDTH) <= resize(signed(gmax_i), c_CWIDTH)) else '0';
+    end generate;
+    
+    -- Output arbitration.
+    process(pending)
+    begin
+        sel <= 0;
+        for i in g_CHANNEL_COUNT-1 downto 0 loop
+            if pending(i) = '1' then
+                sel <= i;
+            end if;
+        end loop;
+    end process;
+    push <= '1' when (pending /= (pending'range => '0')) and (full_i = '0') else '0';
+    
+    process(clk_i)
+    variable v_lost : unsigned(15 downto 0);
+    begin
+        if rising_edge(clk_i) then
+            if (reset_i = '1') or (enable_i = '0') then
+                pending <= (others => '0');
+                lost <= (others => '0');
+            else
+                for i in 0 to g_CHANNEL_COUNT-1 loop
+                    if (d_valid(i) = '1') and (in_gate(i) = '1') then
+                        pending(i) <= '1';
+                        result(i) <= std_logic_vector(resize(d(i), 32));
+                    elsif (push = '1') and (sel = i) then
+                        pending(i) <= '0';
+                    end if;
+                end loop;
+                v_lost := lost;
+                for i in 0 to g_CHANNEL_COUNT-1 loop
+                    if (d_valid(i) = '1') and (in_gate(i) = '1') and (pending(i) = '1')
+                      and ((push = '0') or (sel /= i)) then
+                        v_lost := v_lost + 1;
+                    end if;
+                end loop;
+                lost <= v_lost;
+            end if;
+        end if;
+    end process;
+    
+    push_o <= push;
+    channel_o <= std_logic_vector(to_unsigned(sel, 8));
+    diff_o <= result(sel);
+    lost_o <= std_logic_vector(lost);
+end architecture;
@@ -0,0 +1,157 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tdc_evwin
+--
+-- author: agent, agent@local
+--
+-- description: Burst-capable Wishbone read window on the merged event FIFO
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- Wishbone slave that returns the events of a FIFO as a stream of 32-bit
+-- words, independently of the address. Each event is made of three words:
+--   0. bit 31: valid, bits 24-17: channel, bit 16: polarity,
+--      bits 15-0: raw value (same layout as the MCR register)
+--   1. high word of the time stamp
+--   2. low word of the time stamp
+-- The event is removed from the FIFO when its last word is read.
+--
+-- When the FIFO is empty, the first word is returned with the valid bit
+-- cleared and the stream does not advance. Once this has happened, the first
+-- word keeps being returned as invalid until the end of the bus cycle, so
+-- that a burst never ends in the middle of an event that arrived during it.
+-- The stream returns to the first word when restart_i is asserted, which
+-- should be done when the FIFO is read by other means.
+--
+-- Classic cycles are acknowledged one cycle after the strobe, like the
+-- register bank. During incrementing bursts (CTI = "010"), the slave assumes
+-- that the next transfer follows immediately and acknowledges it in the next
+-- cycle, so that one word is transferred per clock cycle.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tdc_evwin is
+    generic(
+        -- Number of raw value bits. Must be 16 or less.
+        g_RAW_COUNT : positive;
+        -- Number of time stamp bits. Must be 64 or less.
+        g_TS_WIDTH  : positive
+    );
+    port(
+        clk_i      : in std_logic;
+        reset_i    : in std_logic;
+        
+        wb_cyc_i   : in std_logic;
+        wb_stb_i   : in std_logic;
+        wb_we_i    : in std_logic;
+        wb_cti_i   : in std_logic_vector(2 downto 0);
+        wb_data_o  : out std_logic_vector(31 downto 0);
+        wb_ack_o   : out std_logic;
+        
+        -- Head of the FIFO.
+        valid_i    : in std_logic;
+        channel_i  : in std_logic_vector(7 downto 0);
+        polarity_i : in std_logic;
+        raw_i      : in std_logic_vector(g_RAW_COUNT-1 downto 0);
+        ts_i       : in std_logic_vector(g_TS_WIDTH-1 downto 0);
+        pop_o      : out std_logic;
+        
+        restart_i  : in std_logic
+    );
+end entity;
+
+architecture rtl of tdc_evwin is
+signal ack     : std_logic;
+signal ack_r   : std_logic;
+signal rd      : std_logic;
+signal phase   : unsigned(1 downto 0);
+signal drained : std_logic;
+signal valid   : std_logic;
+signal ts      : std_logic_vector(63 downto 0);
+begin
+    ack <= ack_r and wb_cyc_i and wb_stb_i;
+    wb_ack_o <= ack;
+    rd <= ack and not wb_we_i;
+    
+    process(clk_i)
+    begin
+        if rising_edge(clk_i) then
+            if reset_i = '1' then
+                ack_r <= '0';
+                phase <= (others => '0');
+                drained <= '0';
+            else
+                if (wb_cyc_i = '1') and (wb_stb_i = '1')
+                  and ((ack = '0') or (wb_cti_i = "010")) then
+                    ack_r <= '1';
+                else
+                    ack_r <= '0';
+                end if;
+                
+                if restart_i = '1' then
+                    phase <= (others => '0');
+                elsif rd = '1' then
+                    case phase is
+                        when "00" =>
+                            if valid = '1' then
+                                phase <= "01";
+                            else
+                                drained <= '1';
+                            end if;
+                        when "01" =>
+                            phase <= "10";
+                        when others =>
+                            phase <= "00";
+                    end case;
+                end if;
+                if wb_cyc_i = '0' then
+                    drained <= '0';
+                end if;
+            end if;
+        end if;
+    end process;
+    
+    valid <= valid_i and not drained;
+    pop_o <= rd when phase = "10" else '0';
+    
+    ts <= std_logic_vector(resize(unsigned(ts_i), 64));
+    process(phase, valid, channel_i, polarity_i, raw_i, ts)
+    begin
+        wb_data_o <= (others => '0');
+        case phase is
+            when "00" =>
+                wb_data_o(31) <= valid;
+                wb_data_o(24 downto 17) <= channel_i;
+                wb_data_o(16) <= polarity_i;
+                wb_data_o(g_RAW_COUNT-1 downto 0) <= raw_i;
+            when "01" =>
+                wb_data_o <= ts(63 downto 32);
+            when others =>
+                wb_data_o <= ts(31 downto 0);
+        end case;
+    end process;
+end architecture;
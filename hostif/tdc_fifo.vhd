@@ -0,0 +1,163 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tdc_fifo
+--
+-- author: agent, agent@local
+--
+-- description: Timestamp FIFO with fill level and overflow counter
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Limited the depth to what level_o can count
+-- 2026-10-18 agent Added full flag
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- Synchronous first-word-fall-through FIFO used by the host interface to
+-- buffer detected events until software reads them.
+--
+-- The storage is a simple dual port RAM with a registered read port, so that
+-- it maps to block RAM. The head of the FIFO is always presented on q_o, and
+-- pulsing pop_i for one cycle advances to the next entry.
+-- Because of the read register, a written entry becomes visible on q_o two
+-- cycles after push_i. level_o only counts visible entries; it is what
+-- software sees and what pop_i is checked against.
+--
+-- Pushing into a full FIFO drops the new entry and increments the overflow
+-- counter, which wraps around. Popping an empty FIFO has no effect. Writers
+-- that must not lose entries can check full_o, which takes not-yet-visible
+-- entries into account.
+--
+-- level_o and the register fields it is copied to are 16 bits wide, so the
+-- depth is limited to 32768 entries, which is checked at elaboration.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tdc_fifo is
+    generic(
+        -- Width of each entry.
+        g_WIDTH : positive;
+        -- Number of entries. Must be a power of 2, at most 32768.
+        g_DEPTH : positive
+    );
+    port(
+        clk_i    : in std_logic;
+        reset_i  : in std_logic;
+        
+        push_i   : in std_logic;
+        d_i      : in std_logic_vector(g_WIDTH-1 downto 0);
+        
+        pop_i    : in std_logic;
+        q_o      : out std_logic_vector(g_WIDTH-1 downto 0);
+        
+        level_o  : out std_logic_vector(15 downto 0);
+        ovf_o    : out std_logic_vector(15 downto 0);
+        full_o   : out std_logic
+    );
+end entity;
+
+architecture rtl of tdc_fifo is
+
+function f_log2_size(a : natural) return natural is
+begin
+    for i in 1 to 64 loop               -- Works for up to 64 bits
+        if 2**i >= a then
+            return i;
+        end if;
+    end loop;
+    return 63;
+end function;
+
+constant c_ORDER : natural := f_log2_size(g_DEPTH);
+
+type t_mem is array(0 to 2**c_ORDER-1) of std_logic_vector(g_WIDTH-1 downto 0);
+signal mem : t_mem;
+
+signal wr_ptr   : unsigned(c_ORDER-1 downto 0);
+signal rd_ptr   : unsigned(c_ORDER-1 downto 0);
+signal rd_next  : unsigned(c_ORDER-1 downto 0);
+-- total number of stored entries, used for overflow detection
+signal count    : unsigned(c_ORDER downto 0);
+-- number of entries visible on the read port
+signal visible  : unsigned(c_ORDER downto 0);
+signal push     : std_logic;
+signal push_d   : std_logic;
+signal pop      : std_logic;
+signal ovf      : unsigned(15 downto 0);
+begin
+    assert c_ORDER < 16
+        report "tdc_fifo: g_DEPTH must be at most 32768 for level_o"
+        severity failure;
+    
+    push <= '1' when (push_i = '1') and ((count /= 2**c_ORDER) or (pop = '1')) else '0';
+    pop <= '1' when (pop_i = '1') and (visible /= 0) else '0';
+    rd_next <= rd_ptr + 1 when pop = '1' else rd_ptr;
+    
+    process(clk_i)
+    begin
+        if rising_edge(clk_i) then
+            if push = '1' then
+                mem(to_integer(wr_ptr)) <= d_i;
+            end if;
+            q_o <= mem(to_integer(rd_next));
+        end if;
+    end process;
+    
+    process(clk_i)
+    begin
+        if rising_edge(clk_i) then
+            if reset_i = '1' then
+                wr_ptr <= (others => '0');
+                rd_ptr <= (others => '0');
+                count <= (others => '0');
+                visible <= (others => '0');
+                push_d <= '0';
+                ovf <= (others => '0');
+            else
+                push_d <= push;
+                if push = '1' then
+                    wr_ptr <= wr_ptr + 1;
+                end if;
+                rd_ptr <= rd_next;
+                if (push = '1') and (pop = '0') then
+                    count <= count + 1;
+                elsif (push = '0') and (pop = '1') then
+                    count <= count - 1;
+                end if;
+                if (push_d = '1') and (pop = '0') then
+                    visible <= visible + 1;
+                elsif (push_d = '0') and (pop = '1') then
+                    visible <= visible - 1;
+                end if;
+                if (push_i = '1') and (push = '0') then
+                    ovf <= ovf + 1;
+                end if;
+            end if;
+        end if;
+    end process;
+    
+    level_o <= std_logic_vector(resize(visible, 16));
+    ovf_o <= std_logic_vector(ovf);
+    full_o <= '1' when count = 2**c_ORDER else '0';
+end architecture;
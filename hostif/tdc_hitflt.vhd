@@ -0,0 +1,102 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tdc_hitflt
+--
+-- author: agent, agent@local
+--
+-- description: Per-channel hit filter of the host interface
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- Selects the transitions of a channel that are passed on to the readout
+-- logic. Three filters are applied in sequence:
+--  * Edge filter: rising edges are dropped when drop_rising_i is set, and
+--    falling edges when drop_falling_i is set.
+--  * Dead time: after a transition has passed the edge filter, the following
+--    deadtime_i cycles are ignored. This comes in addition to the fixed dead
+--    time of the encoder.
+--  * Prescaler: of the transitions that remain, one is kept and the next
+--    prescale_i are dropped.
+-- With all controls at 0, every transition is passed on.
+--
+-- The output is combinatorial and has no latency.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tdc_hitflt is
+    port(
+        clk_i          : in std_logic;
+        reset_i        : in std_logic;
+        
+        -- Controls.
+        drop_rising_i  : in std_logic;
+        drop_falling_i : in std_logic;
+        deadtime_i     : in std_logic_vector(15 downto 0);
+        prescale_i     : in std_logic_vector(15 downto 0);
+        
+        -- Transitions from the core.
+        detect_i       : in std_logic;
+        polarity_i     : in std_logic;
+        
+        -- Filtered transitions.
+        detect_o       : out std_logic
+    );
+end entity;
+
+architecture rtl of tdc_hitflt is
+signal edge   : std_logic;
+signal accept : std_logic;
+signal dead   : unsigned(15 downto 0);
+signal skip   : unsigned(15 downto 0);
+begin
+    edge <= detect_i and not drop_rising_i when polarity_i = '1'
+        else detect_i and not drop_falling_i;
+    accept <= edge when dead = 0 else '0';
+    
+    process(clk_i)
+    begin
+        if rising_edge(clk_i) then
+            if reset_i = '1' then
+                dead <= (others => '0');
+                skip <= (others => '0');
+            else
+                if accept = '1' then
+                    dead <= unsigned(deadtime_i);
+                    if skip = 0 then
+                        skip <= unsigned(prescale_i);
+                    else
+                        skip <= skip - 1;
+                    end if;
+                elsif dead /= 0 then
+                    dead <= dead - 1;
+                end if;
+            end if;
+        end if;
+    end process;
+    
+    detect_o <= accept when skip = 0 else '0';
+end architecture;
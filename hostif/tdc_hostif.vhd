@@ -12,6 +12,19 @@
 --
 -------------------------------------------------------------------------------
 -- last changes:
+-- 2026-10-18 agent Connected the generated channel registers
+-- 2026-10-18 agent Moved channel registers to strided blocks, up to 64 channels
+-- 2026-10-18 agent Added epoch counter option
+-- 2026-10-18 agent Added channel statistics counters
+-- 2026-10-18 agent Added time difference histogram
+-- 2026-10-18 agent Added time difference unit
+-- 2026-10-18 agent Added per-channel dead time and prescaler
+-- 2026-10-18 agent Added per-channel edge filter
+-- 2026-10-18 agent Added scaled online calibration option
+-- 2026-10-18 agent Added concurrent startup calibration option
+-- 2026-10-18 agent Added burst event read window
+-- 2026-10-18 agent Added time-ordered event merging
+-- 2026-10-18 agent Added event FIFOs
 -- 2011-11-05 SB Added extra histogram bits support
 -- 2011-08-27 SB Reduced supported channel count to 8
 -- 2011-08-26 SB Created file
@@ -31,9 +44,60 @@
 -- DESCRIPTION:
 -- Top level module of the TDC core, contains all logic including the optional
 -- host interface. It instantiates the basic TDC core and a Wishbone interface.
+--
+-- The fixed point time stamps have g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT
+-- bits, which must not exceed 64. With g_EPOCH_COUNT set so that they have
+-- 64 bits, the MESH:MESL time stamps are monotonic since the last coarse
+-- counter reset and never wrap around in practice.
+--
+-- The global registers are implemented by tdc_wb and occupy the first 64
+-- words of the address space. The registers of each channel are in a block
+-- of 16 words starting at byte offset 0x1000+0x40*n for channel n (see
+-- tdc_chregs), so that up to 64 channels are supported. The event detection
+-- interrupt is shared by all the channels whose CTL.IE bit is set, and the
+-- event pending registers EVP0 and EVP1 at byte offsets 0x100 and 0x104
+-- identify them.
+--
+-- Besides the registers holding the latest measurement of each channel, each
+-- channel has a FIFO of g_FIFO_DEPTH events so that bursts of hits are not
+-- lost while software is busy. Reading the FML register of a channel removes
+-- the head event from its FIFO. The FIFO watermark interrupt is triggered
+-- each time the fill level of a channel reaches the FWM register value.
+--
+-- When the MCTL.EN bit is set, the events are instead moved from the channel
+-- FIFOs into a single time-ordered event FIFO that records the channel number
+-- of each event, and is read through the MCR, MMH and MML registers. The
+-- watermark interrupt then also applies to this FIFO.
+--
+-- Byte offsets 0x200 to 0x3ff are a read window on the time-ordered event
+-- FIFO (see tdc_evwin). It returns three words per event and supports
+-- incrementing bursts, so that a bus master can drain one word per clock
+-- cycle instead of one word every other cycle through the register bank.
+--
+-- The CTL register of each channel selects whether rising and/or falling
+-- edges are dropped, and its HF register sets a dead time and a prescaler
+-- (see tdc_hitflt). Dropped edges do not update the measurement registers,
+-- trigger interrupts or enter the FIFOs. By default, all edges are kept.
+--
+-- With g_DIFF, a time difference unit (see tdc_diff) computes the differences
+-- between the filtered transitions of a start channel and those of the
+-- channels whose CTL.STOP bit is set, and stores them into a FIFO of
+-- g_FIFO_DEPTH entries read through the DFCH and DFV registers. The
+-- watermark interrupt also applies to this FIFO. Without g_DIFF, the DFx
+-- registers read as 0.
+--
+-- With g_DIFF and g_DHIST, the differences can instead be binned into a
+-- histogram of g_DHIST_DEPTH bins (see tdc_dhist), controlled and read
+-- through the DHx registers.
+--
+-- The hit, lost event and rate counters of each channel (see tdc_chstat) are
+-- read through its CNTH, CNTL and CNTR registers. Reading the MESL register
+-- of a channel marks its latest measurement as read for the lost event
+-- counter.
 
 library ieee;
 use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
 
 library work;
 use work.tdc_package.all;
@@ -47,21 +111,30 @@ entity tdc_hostif is
         g_FP_COUNT       : positive := 13;
         g_EXHIS_COUNT    : positive := 4;
         g_COARSE_COUNT   : positive := 25;
+        g_EPOCH_COUNT    : natural := 0;
         g_RO_LENGTH      : positive := 31;
         g_FCOUNTER_WIDTH : positive := 13;
-        g_FTIMER_WIDTH   : positive := 14
+        g_FTIMER_WIDTH   : positive := 14;
+        g_FIFO_DEPTH     : positive := 256;
+        g_MERGE_DELAY    : positive := 16;
+        g_CONCURRENT_SC  : boolean := false;
+        g_SCALED_OC      : boolean := false;
+        g_DIFF           : boolean := false;
+        g_DHIST          : boolean := false;
+        g_DHIST_DEPTH    : positive := 1024
     );
     port(
         rst_n_i   : in std_logic;
         wb_clk_i  : in std_logic;
         
-        wb_addr_i : in std_logic_vector(5 downto 0);
+        wb_addr_i : in std_logic_vector(10 downto 0);
         wb_data_i : in std_logic_vector(31 downto 0);
         wb_data_o : out std_logic_vector(31 downto 0);
         wb_cyc_i  : in std_logic;
         wb_sel_i  : in std_logic_vector(3 downto 0);
         wb_stb_i  : in std_logic;
         wb_we_i   : in std_logic;
+        wb_cti_i  : in std_logic_vector(2 downto 0);
         wb_ack_o  : out std_logic;
         wb_irq_o  : out std_logic;
         
@@ -76,11 +149,11 @@ architecture rtl of tdc_hostif is
 signal reset      : std_logic;
 signal ready      : std_logic;
 signal cc_cy      : std_logic;
-signal deskew     : std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+signal deskew     : std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
 signal detect     : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
 signal polarity   : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
 signal raw        : std_logic_vector(g_CHANNEL_COUNT*g_RAW_COUNT-1 downto 0);
-signal fp         : std_logic_vector(g_CHANNEL_COUNT*(g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+signal fp         : std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
 signal freeze_req : std_logic;
 signal freeze_ack : std_logic;
 signal cs_next    : std_logic;
@@ -101,15 +174,107 @@ signal wbg_hisa : std_logic_vector(15 downto 0);
 signal wbg_hisd : std_logic_vector(31 downto 0);
 signal wbg_fcr  : std_logic_vector(31 downto 0);
 signal wbg_fcsr : std_logic_vector(31 downto 0);
+signal wbg_fwm  : std_logic_vector(15 downto 0);
+
+signal wbg_men    : std_logic;
+signal wbg_mlvl   : std_logic_vector(15 downto 0);
+signal wbg_mraw   : std_logic_vector(15 downto 0);
+signal wbg_mpol   : std_logic;
+signal wbg_mchn   : std_logic_vector(7 downto 0);
+signal wbg_mmes   : std_logic_vector(63 downto 0);
+signal wbg_mpop   : std_logic;
+signal wbg_den    : std_logic;
+signal wbg_dstart : std_logic_vector(7 downto 0);
+signal wbg_dgl    : std_logic_vector(31 downto 0);
+signal wbg_dgh    : std_logic_vector(31 downto 0);
+signal wbg_dlvl   : std_logic_vector(15 downto 0);
+signal wbg_dlost  : std_logic_vector(15 downto 0);
+signal wbg_dchn   : std_logic_vector(7 downto 0);
+signal wbg_dval   : std_logic_vector(31 downto 0);
+signal wbg_dpop   : std_logic;
+signal wbg_hen    : std_logic;
+signal wbg_hfrz   : std_logic;
+signal wbg_hclr   : std_logic;
+signal wbg_hbusy  : std_logic;
+signal wbg_hshift : std_logic_vector(4 downto 0);
+signal wbg_hoff   : std_logic_vector(31 downto 0);
+signal wbg_ha     : std_logic_vector(15 downto 0);
+signal wbg_hd     : std_logic_vector(31 downto 0);
+signal wbg_hx     : std_logic_vector(31 downto 0);
+signal wbg_rgate  : std_logic_vector(31 downto 0);
+
+signal chr_reset  : std_logic;
+signal chr_des    : std_logic_vector(g_CHANNEL_COUNT*64-1 downto 0);
+signal chr_desh   : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal chr_desl   : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal chr_edfr   : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal chr_edff   : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal chr_dstop  : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal chr_hfdt   : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal chr_hfpsc  : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal chr_ie     : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal chr_ev     : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal chr_irq    : std_logic;
+signal chr_pol    : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal chr_raw    : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal chr_mes    : std_logic_vector(g_CHANNEL_COUNT*64-1 downto 0);
+signal chr_mesh   : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal chr_mesl   : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal chr_mrd    : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal chr_flvl   : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal chr_fovf   : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal chr_fraw   : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal chr_fmes   : std_logic_vector(g_CHANNEL_COUNT*64-1 downto 0);
+signal chr_fmh    : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal chr_fml    : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal chr_fpop   : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal chr_cnts   : std_logic_vector(7 downto 0);
+signal chr_cnth   : std_logic_vector(31 downto 0);
+signal chr_cntl   : std_logic_vector(31 downto 0);
+signal chr_cntr   : std_logic_vector(31 downto 0);
+
+-- channel FIFO entry: merge tag, polarity, raw value, fixed point measurement
+constant c_FIFO_WIDTH  : positive := 8+1+g_RAW_COUNT+g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT;
+-- merged FIFO entry: channel, polarity, raw value, fixed point measurement
+constant c_MFIFO_WIDTH : positive := 8+1+g_RAW_COUNT+g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT;
+
+-- detected transitions that pass the hit filter
+signal hit        : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
 
--- maximum number of channels the host interface can support
-constant c_NCHAN: positive := 8;
+signal fifo_reset : std_logic;
+signal fifo_pop   : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal fifo_valid : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal fifo_tag   : std_logic_vector(g_CHANNEL_COUNT*8-1 downto 0);
+signal fifo_pol   : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal fifo_raw   : std_logic_vector(g_CHANNEL_COUNT*g_RAW_COUNT-1 downto 0);
+signal fifo_ts    : std_logic_vector(g_CHANNEL_COUNT*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto 0);
+signal fifo_wm    : std_logic_vector(g_CHANNEL_COUNT+1 downto 0);
+signal fifo_wm_r  : std_logic_vector(g_CHANNEL_COUNT+1 downto 0);
+signal fifo_irq   : std_logic;
 
-signal wbg_des    : std_logic_vector(c_NCHAN*64-1 downto 0);
-signal wbg_pol    : std_logic_vector(c_NCHAN-1 downto 0);
-signal wbg_raw    : std_logic_vector(c_NCHAN*32-1 downto 0);
-signal wbg_mes    : std_logic_vector(c_NCHAN*64-1 downto 0);
-signal wbg_ie     : std_logic_vector(c_NCHAN-1 downto 0);
+signal merge_tag  : std_logic_vector(7 downto 0);
+signal merge_pop  : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal merge_full : std_logic;
+signal merge_push : std_logic;
+signal merge_chn  : std_logic_vector(7 downto 0);
+signal merge_pol  : std_logic;
+signal merge_raw  : std_logic_vector(g_RAW_COUNT-1 downto 0);
+signal merge_ts   : std_logic_vector(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT-1 downto 0);
+signal mfifo_d    : std_logic_vector(c_MFIFO_WIDTH-1 downto 0);
+signal mfifo_q    : std_logic_vector(c_MFIFO_WIDTH-1 downto 0);
+signal mfifo_pop  : std_logic;
+signal mfifo_vld  : std_logic;
+
+signal reg_stb    : std_logic;
+signal reg_data   : std_logic_vector(31 downto 0);
+signal reg_ack    : std_logic;
+signal win_stb    : std_logic;
+signal win_data   : std_logic_vector(31 downto 0);
+signal win_ack    : std_logic;
+signal win_pop    : std_logic;
+signal chr_stb    : std_logic;
+signal chr_data   : std_logic_vector(31 downto 0);
+signal chr_ack    : std_logic;
 begin
     cmp_tdc: tdc
         generic map(
@@ -119,9 +284,12 @@ begin
             g_FP_COUNT       => g_FP_COUNT,
             g_EXHIS_COUNT    => g_EXHIS_COUNT,
             g_COARSE_COUNT   => g_COARSE_COUNT,
+            g_EPOCH_COUNT    => g_EPOCH_COUNT,
             g_RO_LENGTH      => g_RO_LENGTH,
             g_FCOUNTER_WIDTH => g_FCOUNTER_WIDTH,
-            g_FTIMER_WIDTH   => g_FTIMER_WIDTH
+            g_FTIMER_WIDTH   => g_FTIMER_WIDTH,
+            g_CONCURRENT_SC  => g_CONCURRENT_SC,
+            g_SCALED_OC      => g_SCALED_OC
         )
         port map(
             clk_i        => wb_clk_i,
@@ -156,20 +324,22 @@ begin
         port map(
             rst_n_i   => rst_n_i,
             wb_clk_i  => wb_clk_i,
-            wb_addr_i => wb_addr_i,
+            wb_addr_i => wb_addr_i(5 downto 0),
             wb_data_i => wb_data_i,
-            wb_data_o => wb_data_o,
+            wb_data_o => reg_data,
             wb_cyc_i  => wb_cyc_i,
             wb_sel_i  => wb_sel_i,
-            wb_stb_i  => wb_stb_i,
+            wb_stb_i  => reg_stb,
             wb_we_i   => wb_we_i,
-            wb_ack_o  => wb_ack_o,
+            wb_ack_o  => reg_ack,
             wb_irq_o  => wb_irq_o,
             
             tdc_cs_rst_o    => reset,
             tdc_cs_rdy_i    => ready,
+            irq_iev_i       => chr_irq,
             irq_isc_i       => ready,
             irq_icc_i       => cc_cy,
+            irq_ifw_i       => fifo_irq,
             tdc_dctl_req_o  => freeze_req,
             tdc_dctl_ack_i  => freeze_ack,
             tdc_csel_next_o => cs_next,
@@ -184,59 +354,34 @@ begin
             tdc_hisd_i      => wbg_hisd,
             tdc_fcr_i       => wbg_fcr,
             tdc_fcsr_i      => wbg_fcsr,
-            
-            tdc_pol_i       => wbg_pol,
-            
-            -- begin autogenerated connections
-            tdc_desh0_o => wbg_des(63 downto 32),
-            tdc_desl0_o => wbg_des(31 downto 0),
-            tdc_desh1_o => wbg_des(127 downto 96),
-            tdc_desl1_o => wbg_des(95 downto 64),
-            tdc_desh2_o => wbg_des(191 downto 160),
-            tdc_desl2_o => wbg_des(159 downto 128),
-            tdc_desh3_o => wbg_des(255 downto 224),
-            tdc_desl3_o => wbg_des(223 downto 192),
-            tdc_desh4_o => wbg_des(319 downto 288),
-            tdc_desl4_o => wbg_des(287 downto 256),
-            tdc_desh5_o => wbg_des(383 downto 352),
-            tdc_desl5_o => wbg_des(351 downto 320),
-            tdc_desh6_o => wbg_des(447 downto 416),
-            tdc_desl6_o => wbg_des(415 downto 384),
-            tdc_desh7_o => wbg_des(511 downto 480),
-            tdc_desl7_o => wbg_des(479 downto 448),
-            tdc_raw0_i => wbg_raw(31 downto 0),
-            tdc_mesh0_i => wbg_mes(63 downto 32),
-            tdc_mesl0_i => wbg_mes(31 downto 0),
-            tdc_raw1_i => wbg_raw(63 downto 32),
-            tdc_mesh1_i => wbg_mes(127 downto 96),
-            tdc_mesl1_i => wbg_mes(95 downto 64),
-            tdc_raw2_i => wbg_raw(95 downto 64),
-            tdc_mesh2_i => wbg_mes(191 downto 160),
-            tdc_mesl2_i => wbg_mes(159 downto 128),
-            tdc_raw3_i => wbg_raw(127 downto 96),
-            tdc_mesh3_i => wbg_mes(255 downto 224),
-            tdc_mesl3_i => wbg_mes(223 downto 192),
-            tdc_raw4_i => wbg_raw(159 downto 128),
-            tdc_mesh4_i => wbg_mes(319 downto 288),
-            tdc_mesl4_i => wbg_mes(287 downto 256),
-            tdc_raw5_i => wbg_raw(191 downto 160),
-            tdc_mesh5_i => wbg_mes(383 downto 352),
-            tdc_mesl5_i => wbg_mes(351 downto 320),
-            tdc_raw6_i => wbg_raw(223 downto 192),
-            tdc_mesh6_i => wbg_mes(447 downto 416),
-            tdc_mesl6_i => wbg_mes(415 downto 384),
-            tdc_raw7_i => wbg_raw(255 downto 224),
-            tdc_mesh7_i => wbg_mes(511 downto 480),
-            tdc_mesl7_i => wbg_mes(479 downto 448),
-            irq_ie0_i => wbg_ie(0),
-            irq_ie1_i => wbg_ie(1),
-            irq_ie2_i => wbg_ie(2),
-            irq_ie3_i => wbg_ie(3),
-            irq_ie4_i => wbg_ie(4),
-            irq_ie5_i => wbg_ie(5),
-            irq_ie6_i => wbg_ie(6),
-            irq_ie7_i => wbg_ie(7)
-            -- end autogenerated connections
+            tdc_fwm_o       => wbg_fwm,
+            tdc_mctl_en_o   => wbg_men,
+            tdc_mst_lvl_i   => wbg_mlvl,
+            tdc_mcr_raw_i   => wbg_mraw,
+            tdc_mcr_pol_i   => wbg_mpol,
+            tdc_mcr_chn_i   => wbg_mchn,
+            tdc_mmh_i       => wbg_mmes(63 downto 32),
+            tdc_mml_i       => wbg_mmes(31 downto 0),
+            tdc_mml_pop_o   => wbg_mpop,
+            tdc_dfc_en_o    => wbg_den,
+            tdc_dfc_start_o => wbg_dstart,
+            tdc_dfgl_o      => wbg_dgl,
+            tdc_dfgh_o      => wbg_dgh,
+            tdc_dfs_lvl_i   => wbg_dlvl,
+            tdc_dfs_lost_i  => wbg_dlost,
+            tdc_dfch_i      => wbg_dchn,
+            tdc_dfv_i       => wbg_dval,
+            tdc_dfv_pop_o   => wbg_dpop,
+            tdc_dhc_en_o    => wbg_hen,
+            tdc_dhc_frz_o   => wbg_hfrz,
+            tdc_dhc_clr_o   => wbg_hclr,
+            tdc_dhc_busy_i  => wbg_hbusy,
+            tdc_dhc_shift_o => wbg_hshift,
+            tdc_dho_o       => wbg_hoff,
+            tdc_dha_o       => wbg_ha,
+            tdc_dhd_i       => wbg_hd,
+            tdc_dhx_i       => wbg_hx,
+            tdc_rgate_o     => wbg_rgate
         );
     
     -- All synthesizers I know of will set unconnected bits to 0.
@@ -247,15 +392,363 @@ begin
     wbg_fcr(oc_freq'range) <= oc_freq;
     wbg_fcsr(oc_sfreq'range) <= oc_sfreq;
     
+    -- Channel registers. Like the register bank, they keep their values
+    -- when the core is reset.
+    chr_reset <= not rst_n_i;
+    cmp_chregs: tdc_chregs
+        generic map(
+            g_CHANNEL_COUNT => g_CHANNEL_COUNT
+        )
+        port map(
+            clk_i          => wb_clk_i,
+            reset_i        => chr_reset,
+            wb_addr_i      => wb_addr_i,
+            wb_data_i      => wb_data_i,
+            wb_data_o      => chr_data,
+            wb_cyc_i       => wb_cyc_i,
+            wb_stb_i       => chr_stb,
+            wb_we_i        => wb_we_i,
+            wb_ack_o       => chr_ack,
+            wb_irq_o       => chr_irq,
+            irq_ev_i       => chr_ev,
+            tdc_desh_o     => chr_desh,
+            tdc_desl_o     => chr_desl,
+            tdc_ctl_ris_o  => chr_edfr,
+            tdc_ctl_fal_o  => chr_edff,
+            tdc_ctl_stop_o => chr_dstop,
+            tdc_ctl_ie_o   => chr_ie,
+            tdc_hf_dt_o    => chr_hfdt,
+            tdc_hf_psc_o   => chr_hfpsc,
+            tdc_mpr_raw_i  => chr_raw,
+            tdc_mpr_pol_i  => chr_pol,
+            tdc_mesh_i     => chr_mesh,
+            tdc_mesl_i     => chr_mesl,
+            tdc_mesl_rd_o  => chr_mrd,
+            tdc_fst_lvl_i  => chr_flvl,
+            tdc_fst_ovf_i  => chr_fovf,
+            tdc_fpr_raw_i  => chr_fraw,
+            tdc_fpr_pol_i  => fifo_pol,
+            tdc_fmh_i      => chr_fmh,
+            tdc_fml_i      => chr_fml,
+            tdc_fml_pop_o  => chr_fpop,
+            tdc_cnth_i     => chr_cnth,
+            tdc_cntl_i     => chr_cntl,
+            tdc_cntr_i     => chr_cntr,
+            sel_o          => chr_cnts
+        );
+    -- Transitions of the channels with the interrupt enabled set their
+    -- event pending bits.
+    chr_ev <= hit and chr_ie;
+    
     g_connect: for i in 0 to g_CHANNEL_COUNT-1 generate
-        deskew((i+1)*(g_COARSE_COUNT+g_FP_COUNT)-1 downto i*(g_COARSE_COUNT+g_FP_COUNT))
-            <= wbg_des(i*64+g_COARSE_COUNT+g_FP_COUNT-1 downto i*64);
-        wbg_raw(i*32+g_RAW_COUNT-1 downto i*32)
-            <= raw((i+1)*g_RAW_COUNT-1 downto i*g_RAW_COUNT);
-        wbg_mes(i*64+g_COARSE_COUNT+g_FP_COUNT-1 downto i*64)
-            <= fp((i+1)*(g_COARSE_COUNT+g_FP_COUNT)-1 downto i*(g_COARSE_COUNT+g_FP_COUNT));
+        deskew((i+1)*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto i*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT))
+            <= chr_des(i*64+g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT-1 downto i*64);
+        chr_des(i*64+63 downto i*64) <= chr_desh(i*32+31 downto i*32) & chr_desl(i*32+31 downto i*32);
+        chr_mesh(i*32+31 downto i*32) <= chr_mes(i*64+63 downto i*64+32);
+        chr_mesl(i*32+31 downto i*32) <= chr_mes(i*64+31 downto i*64);
+        
+        -- Filtered transitions are dropped before they reach the
+        -- measurement registers, the interrupts and the FIFOs.
+        cmp_hitflt: tdc_hitflt
+            port map(
+                clk_i          => wb_clk_i,
+                reset_i        => reset,
+                drop_rising_i  => chr_edfr(i),
+                drop_falling_i => chr_edff(i),
+                deadtime_i     => chr_hfdt(i*16+15 downto i*16),
+                prescale_i     => chr_hfpsc(i*16+15 downto i*16),
+                detect_i       => detect(i),
+                polarity_i     => polarity(i),
+                detect_o       => hit(i)
+            );
+        
+        -- The core holds its outputs until the next transition, which may
+        -- be filtered: latch the measurement registers.
+        process(wb_clk_i)
+        begin
+            if rising_edge(wb_clk_i) then
+                if reset = '1' then
+                    chr_pol(i) <= '0';
+                    chr_raw(i*16+g_RAW_COUNT-1 downto i*16) <= (others => '0');
+                    chr_mes(i*64+g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT-1 downto i*64) <= (others => '0');
+                elsif hit(i) = '1' then
+                    chr_pol(i) <= polarity(i);
+                    chr_raw(i*16+g_RAW_COUNT-1 downto i*16)
+                        <= raw((i+1)*g_RAW_COUNT-1 downto i*g_RAW_COUNT);
+                    chr_mes(i*64+g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT-1 downto i*64)
+                        <= fp((i+1)*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto i*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT));
+                end if;
+            end if;
+        end process;
+    end generate;
+    
+    -- Channel statistics.
+    cmp_chstat: tdc_chstat
+        generic map(
+            g_CHANNEL_COUNT => g_CHANNEL_COUNT
+        )
+        port map(
+            clk_i   => wb_clk_i,
+            reset_i => fifo_reset,
+            gate_i  => wbg_rgate,
+            hit_i   => hit,
+            read_i  => chr_mrd,
+            sel_i   => chr_cnts,
+            hits_o  => chr_cnth,
+            lost_o  => chr_cntl,
+            rate_o  => chr_cntr
+        );
+    
+    -- Event FIFOs.
+    fifo_reset <= reset or not rst_n_i;
+    g_fifo: for i in 0 to g_CHANNEL_COUNT-1 generate
+        signal fifo_d : std_logic_vector(c_FIFO_WIDTH-1 downto 0);
+        signal fifo_q : std_logic_vector(c_FIFO_WIDTH-1 downto 0);
+        signal level  : std_logic_vector(15 downto 0);
+    begin
+        fifo_d <= merge_tag
+            & polarity(i)
+            & raw((i+1)*g_RAW_COUNT-1 downto i*g_RAW_COUNT)
+            & fp((i+1)*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto i*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT));
+        cmp_fifo: tdc_fifo
+            generic map(
+                g_WIDTH => c_FIFO_WIDTH,
+                g_DEPTH => g_FIFO_DEPTH
+            )
+            port map(
+                clk_i   => wb_clk_i,
+                reset_i => fifo_reset,
+                push_i  => hit(i),
+                d_i     => fifo_d,
+                pop_i   => fifo_pop(i),
+                q_o     => fifo_q,
+                level_o => level,
+                ovf_o   => chr_fovf(i*16+15 downto i*16),
+                full_o  => open
+            );
+        fifo_pop(i) <= merge_pop(i) when wbg_men = '1' else chr_fpop(i);
+        fifo_valid(i) <= '0' when level = x"0000" else '1';
+        fifo_tag(i*8+7 downto i*8) <= fifo_q(c_FIFO_WIDTH-1 downto c_FIFO_WIDTH-8);
+        fifo_pol(i) <= fifo_q(c_FIFO_WIDTH-9);
+        fifo_raw((i+1)*g_RAW_COUNT-1 downto i*g_RAW_COUNT)
+            <= fifo_q(c_FIFO_WIDTH-10 downto g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT);
+        fifo_ts((i+1)*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto i*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT))
+            <= fifo_q(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT-1 downto 0);
+        
+        chr_flvl(i*16+15 downto i*16) <= level;
+        chr_fraw(i*16+g_RAW_COUNT-1 downto i*16)
+            <= fifo_raw((i+1)*g_RAW_COUNT-1 downto i*g_RAW_COUNT);
+        chr_fmes(i*64+g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT-1 downto i*64)
+            <= fifo_ts((i+1)*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT)-1 downto i*(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT));
+        chr_fmh(i*32+31 downto i*32) <= chr_fmes(i*64+63 downto i*64+32);
+        chr_fml(i*32+31 downto i*32) <= chr_fmes(i*64+31 downto i*64);
+        fifo_wm(i) <= '1' when (wbg_fwm /= x"0000") and (unsigned(level) >= unsigned(wbg_fwm)) else '0';
+    end generate;
+    
+    -- Time-ordered merge of the channel FIFOs.
+    cmp_merge: tdc_merge
+        generic map(
+            g_CHANNEL_COUNT => g_CHANNEL_COUNT,
+            g_RAW_COUNT     => g_RAW_COUNT,
+            g_TS_WIDTH      => g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT,
+            g_DELAY         => g_MERGE_DELAY
+        )
+        port map(
+            clk_i      => wb_clk_i,
+            reset_i    => fifo_reset,
+            enable_i   => wbg_men,
+            tag_o      => merge_tag,
+            valid_i    => fifo_valid,
+            tag_i      => fifo_tag,
+            polarity_i => fifo_pol,
+            raw_i      => fifo_raw,
+            ts_i       => fifo_ts,
+            pop_o      => merge_pop,
+            full_i     => merge_full,
+            push_o     => merge_push,
+            channel_o  => merge_chn,
+            polarity_o => merge_pol,
+            raw_o      => merge_raw,
+            ts_o       => merge_ts
+        );
+    mfifo_d <= merge_chn & merge_pol & merge_raw & merge_ts;
+    cmp_mfifo: tdc_fifo
+        generic map(
+            g_WIDTH => c_MFIFO_WIDTH,
+            g_DEPTH => g_FIFO_DEPTH
+        )
+        port map(
+            clk_i   => wb_clk_i,
+            reset_i => fifo_reset,
+            push_i  => merge_push,
+            d_i     => mfifo_d,
+            pop_i   => mfifo_pop,
+            q_o     => mfifo_q,
+            level_o => wbg_mlvl,
+            ovf_o   => open,
+            full_o  => merge_full
+        );
+    wbg_mchn <= mfifo_q(c_MFIFO_WIDTH-1 downto c_MFIFO_WIDTH-8);
+    wbg_mpol <= mfifo_q(c_MFIFO_WIDTH-9);
+    wbg_mraw(g_RAW_COUNT-1 downto 0) <= mfifo_q(c_MFIFO_WIDTH-10 downto g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT);
+    wbg_mmes(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT-1 downto 0) <= mfifo_q(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT-1 downto 0);
+    mfifo_pop <= wbg_mpop or win_pop;
+    mfifo_vld <= '0' when wbg_mlvl = x"0000" else '1';
+    fifo_wm(g_CHANNEL_COUNT) <= '1' when (wbg_fwm /= x"0000") and (unsigned(wbg_mlvl) >= unsigned(wbg_fwm)) else '0';
+    
+    -- Burst read window on the merged FIFO.
+    cmp_evwin: tdc_evwin
+        generic map(
+            g_RAW_COUNT => g_RAW_COUNT,
+            g_TS_WIDTH  => g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT
+        )
+        port map(
+            clk_i      => wb_clk_i,
+            reset_i    => fifo_reset,
+            wb_cyc_i   => wb_cyc_i,
+            wb_stb_i   => win_stb,
+            wb_we_i    => wb_we_i,
+            wb_cti_i   => wb_cti_i,
+            wb_data_o  => win_data,
+            wb_ack_o   => win_ack,
+            valid_i    => mfifo_vld,
+            channel_i  => wbg_mchn,
+            polarity_i => wbg_mpol,
+            raw_i      => wbg_mraw(g_RAW_COUNT-1 downto 0),
+            ts_i       => wbg_mmes(g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT-1 downto 0),
+            pop_o      => win_pop,
+            restart_i  => wbg_mpop
+        );
+    
+    -- Start-stop time differences.
+    g_diff: if g_DIFF generate
+        signal diff_full : std_logic;
+        signal diff_push : std_logic;
+        signal diff_chn  : std_logic_vector(7 downto 0);
+        signal diff_val  : std_logic_vector(31 downto 0);
+        signal dfifo_rst : std_logic;
+        signal dfifo_psh : std_logic;
+        signal dfifo_d   : std_logic_vector(39 downto 0);
+        signal dfifo_q   : std_logic_vector(39 downto 0);
+        signal dfifo_ful : std_logic;
+        signal hist_en   : std_logic;
+        signal hist_psh  : std_logic;
+    begin
+        cmp_diff: tdc_diff
+            generic map(
+                g_CHANNEL_COUNT => g_CHANNEL_COUNT,
+                g_TS_WIDTH      => g_EPOCH_COUNT+g_COARSE_COUNT+g_FP_COUNT
+            )
+            port map(
+                clk_i     => wb_clk_i,
+                reset_i   => fifo_reset,
+                enable_i  => wbg_den,
+                start_i   => wbg_dstart,
+                stop_i    => chr_dstop,
+                gmin_i    => wbg_dgl,
+                gmax_i    => wbg_dgh,
+                detect_i  => hit,
+                ts_i      => fp,
+                full_i    => diff_full,
+                push_o    => diff_push,
+                channel_o => diff_chn,
+                diff_o    => diff_val,
+                lost_o    => wbg_dlost
+            );
+        
+        -- Difference FIFO.
+        dfifo_rst <= fifo_reset or not wbg_den;
+        dfifo_psh <= diff_push and not hist_en;
+        dfifo_d <= diff_chn & diff_val;
+        cmp_dfifo: tdc_fifo
+            generic map(
+                g_WIDTH => 40,
+                g_DEPTH => g_FIFO_DEPTH
+            )
+            port map(
+                clk_i   => wb_clk_i,
+                reset_i => dfifo_rst,
+                push_i  => dfifo_psh,
+                d_i     => dfifo_d,
+                pop_i   => wbg_dpop,
+                q_o     => dfifo_q,
+                level_o => wbg_dlvl,
+                ovf_o   => open,
+                full_o  => dfifo_ful
+            );
+        wbg_dchn <= dfifo_q(39 downto 32);
+        wbg_dval <= dfifo_q(31 downto 0);
+        fifo_wm(g_CHANNEL_COUNT+1) <= '1' when (wbg_fwm /= x"0000") and (unsigned(wbg_dlvl) >= unsigned(wbg_fwm)) else '0';
+        
+        -- Difference histogram. It accepts one difference per cycle, so
+        -- the difference unit never stalls while it is enabled.
+        g_dhist: if g_DHIST generate
+            hist_en <= wbg_hen;
+            hist_psh <= diff_push and wbg_hen;
+            cmp_dhist: tdc_dhist
+                generic map(
+                    g_DEPTH => g_DHIST_DEPTH
+                )
+                port map(
+                    clk_i     => wb_clk_i,
+                    reset_i   => fifo_reset,
+                    clear_i   => wbg_hclr,
+                    busy_o    => wbg_hbusy,
+                    freeze_i  => wbg_hfrz,
+                    offset_i  => wbg_hoff,
+                    shift_i   => wbg_hshift,
+                    valid_i   => hist_psh,
+                    value_i   => diff_val,
+                    rd_a_i    => wbg_ha,
+                    rd_d_o    => wbg_hd,
+                    outside_o => wbg_hx
+                );
+        end generate;
+        g_nodhist: if not g_DHIST generate
+            hist_en <= '0';
+            wbg_hbusy <= '0';
+            wbg_hd <= (others => '0');
+            wbg_hx <= (others => '0');
+        end generate;
+        diff_full <= dfifo_ful and not hist_en;
     end generate;
-    wbg_pol(polarity'range) <= polarity;
-    wbg_ie(detect'range) <= detect;
+    g_nodiff: if not g_DIFF generate
+        wbg_dlvl <= (others => '0');
+        wbg_dlost <= (others => '0');
+        wbg_dchn <= (others => '0');
+        wbg_dval <= (others => '0');
+        wbg_hbusy <= '0';
+        wbg_hd <= (others => '0');
+        wbg_hx <= (others => '0');
+        fifo_wm(g_CHANNEL_COUNT+1) <= '0';
+    end generate;
+    
+    -- Address decoding between the register bank, the read window and the
+    -- channel registers.
+    reg_stb <= wb_stb_i when wb_addr_i(10 downto 6) = "00000" else '0';
+    win_stb <= wb_stb_i when wb_addr_i(10 downto 7) = "0001" else '0';
+    chr_stb <= wb_stb_i and not reg_stb and not win_stb;
+    wb_data_o <= reg_data when wb_addr_i(10 downto 6) = "00000"
+        else win_data when wb_addr_i(10 downto 7) = "0001"
+        else chr_data;
+    wb_ack_o <= reg_ack or win_ack or chr_ack;
+    
+    -- Trigger the watermark interrupt when any FIFO reaches the level.
+    process(wb_clk_i)
+    begin
+        if rising_edge(wb_clk_i) then
+            if fifo_reset = '1' then
+                fifo_wm_r <= (others => '0');
+                fifo_irq <= '0';
+            else
+                fifo_wm_r <= fifo_wm;
+                if (fifo_wm and not fifo_wm_r) /= (fifo_wm'range => '0') then
+                    fifo_irq <= '1';
+                else
+                    fifo_irq <= '0';
+                end if;
+            end if;
+        end if;
+    end process;
 
 end architecture;
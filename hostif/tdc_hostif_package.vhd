@@ -12,6 +12,15 @@
 --
 -------------------------------------------------------------------------------
 -- last changes:
+-- 2026-10-18 agent Added epoch counter option
+-- 2026-10-18 agent Added channel statistics counters
+-- 2026-10-18 agent Added time difference histogram
+-- 2026-10-18 agent Added time difference unit
+-- 2026-10-18 agent Added hit filter
+-- 2026-10-18 agent Added channel registers
+-- 2026-10-18 agent Added burst event read window
+-- 2026-10-18 agent Added time-ordered event merging
+-- 2026-10-18 agent Added event FIFOs
 -- 2011-11-05 SB Added extra histogram bits support
 -- 2011-08-27 SB Reduced supported channel count to 8
 -- 2011-08-25 SB Created file
@@ -47,21 +56,30 @@ component tdc_hostif is
         g_FP_COUNT       : positive := 13;
         g_EXHIS_COUNT    : positive := 4;
         g_COARSE_COUNT   : positive := 25;
+        g_EPOCH_COUNT    : natural := 0;
         g_RO_LENGTH      : positive := 20;
         g_FCOUNTER_WIDTH : positive := 13;
-        g_FTIMER_WIDTH   : positive := 10
+        g_FTIMER_WIDTH   : positive := 10;
+        g_FIFO_DEPTH     : positive := 256;
+        g_MERGE_DELAY    : positive := 16;
+        g_CONCURRENT_SC  : boolean := false;
+        g_SCALED_OC      : boolean := false;
+        g_DIFF           : boolean := false;
+        g_DHIST          : boolean := false;
+        g_DHIST_DEPTH    : positive := 1024
     );
     port(
         rst_n_i   : in std_logic;
         wb_clk_i  : in std_logic;
         
-        wb_addr_i : in std_logic_vector(5 downto 0);
+        wb_addr_i : in std_logic_vector(10 downto 0);
         wb_data_i : in std_logic_vector(31 downto 0);
         wb_data_o : out std_logic_vector(31 downto 0);
         wb_cyc_i  : in std_logic;
         wb_sel_i  : in std_logic_vector(3 downto 0);
         wb_stb_i  : in std_logic;
         wb_we_i   : in std_logic;
+        wb_cti_i  : in std_logic_vector(2 downto 0);
         wb_ack_o  : out std_logic;
         wb_irq_o  : out std_logic;
         
@@ -89,98 +107,10 @@ component tdc_wb is
     tdc_cs_rst_o                             : out    std_logic;
 -- Port for BIT field: 'Ready' in reg: 'Control and status'
     tdc_cs_rdy_i                             : in     std_logic;
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 0 (high word)'
-    tdc_desh0_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 0 (low word)'
-    tdc_desl0_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 1 (high word)'
-    tdc_desh1_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 1 (low word)'
-    tdc_desl1_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 2 (high word)'
-    tdc_desh2_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 2 (low word)'
-    tdc_desl2_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 3 (high word)'
-    tdc_desh3_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 3 (low word)'
-    tdc_desl3_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 4 (high word)'
-    tdc_desh4_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 4 (low word)'
-    tdc_desl4_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 5 (high word)'
-    tdc_desh5_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 5 (low word)'
-    tdc_desl5_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 6 (high word)'
-    tdc_desh6_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 6 (low word)'
-    tdc_desl6_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 7 (high word)'
-    tdc_desh7_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 7 (low word)'
-    tdc_desl7_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Detected polarities'
-    tdc_pol_i                                : in     std_logic_vector(7 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 0'
-    tdc_raw0_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 0 (high word)'
-    tdc_mesh0_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 0 (low word)'
-    tdc_mesl0_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 1'
-    tdc_raw1_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 1 (high word)'
-    tdc_mesh1_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 1 (low word)'
-    tdc_mesl1_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 2'
-    tdc_raw2_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 2 (high word)'
-    tdc_mesh2_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 2 (low word)'
-    tdc_mesl2_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 3'
-    tdc_raw3_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 3 (high word)'
-    tdc_mesh3_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 3 (low word)'
-    tdc_mesl3_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 4'
-    tdc_raw4_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 4 (high word)'
-    tdc_mesh4_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 4 (low word)'
-    tdc_mesl4_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 5'
-    tdc_raw5_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 5 (high word)'
-    tdc_mesh5_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 5 (low word)'
-    tdc_mesl5_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 6'
-    tdc_raw6_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 6 (high word)'
-    tdc_mesh6_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 6 (low word)'
-    tdc_mesl6_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 7'
-    tdc_raw7_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 7 (high word)'
-    tdc_mesh7_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 7 (low word)'
-    tdc_mesl7_i                              : in     std_logic_vector(31 downto 0);
-    irq_ie0_i                                : in     std_logic;
-    irq_ie1_i                                : in     std_logic;
-    irq_ie2_i                                : in     std_logic;
-    irq_ie3_i                                : in     std_logic;
-    irq_ie4_i                                : in     std_logic;
-    irq_ie5_i                                : in     std_logic;
-    irq_ie6_i                                : in     std_logic;
-    irq_ie7_i                                : in     std_logic;
+    irq_iev_i                                : in     std_logic;
     irq_isc_i                                : in     std_logic;
     irq_icc_i                                : in     std_logic;
+    irq_ifw_i                                : in     std_logic;
 -- Port for BIT field: 'Freeze request' in reg: 'Debug control'
     tdc_dctl_req_o                           : out    std_logic;
 -- Port for BIT field: 'Freeze acknowledgement' in reg: 'Debug control'
@@ -206,8 +136,286 @@ component tdc_wb is
 -- Port for std_logic_vector field: 'Result' in reg: 'Frequency counter current value'
     tdc_fcr_i                                : in     std_logic_vector(31 downto 0);
 -- Port for std_logic_vector field: 'Result' in reg: 'Frequency counter stored value'
-    tdc_fcsr_i                               : in     std_logic_vector(31 downto 0)
+    tdc_fcsr_i                               : in     std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Level' in reg: 'FIFO watermark'
+    tdc_fwm_o                                : out    std_logic_vector(15 downto 0);
+-- Port for BIT field: 'Merge enable' in reg: 'Event merge control'
+    tdc_mctl_en_o                            : out    std_logic;
+-- Port for std_logic_vector field: 'Fill level' in reg: 'Merged FIFO status'
+    tdc_mst_lvl_i                            : in     std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'Raw value' in reg: 'Merged FIFO head channel, polarity and raw value'
+    tdc_mcr_raw_i                            : in     std_logic_vector(15 downto 0);
+-- Port for BIT field: 'Polarity' in reg: 'Merged FIFO head channel, polarity and raw value'
+    tdc_mcr_pol_i                            : in     std_logic;
+-- Port for std_logic_vector field: 'Channel' in reg: 'Merged FIFO head channel, polarity and raw value'
+    tdc_mcr_chn_i                            : in     std_logic_vector(7 downto 0);
+-- Port for std_logic_vector field: 'High word value' in reg: 'Merged FIFO head measurement (high word)'
+    tdc_mmh_i                                : in     std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Low word value' in reg: 'Merged FIFO head measurement (low word)'
+    tdc_mml_i                                : in     std_logic_vector(31 downto 0);
+    tdc_mml_pop_o                            : out    std_logic;
+-- Port for BIT field: 'Enable' in reg: 'Time difference unit control'
+    tdc_dfc_en_o                             : out    std_logic;
+-- Port for std_logic_vector field: 'Start channel' in reg: 'Time difference unit control'
+    tdc_dfc_start_o                          : out    std_logic_vector(7 downto 0);
+-- Port for std_logic_vector field: 'Value' in reg: 'Time difference range gate (minimum)'
+    tdc_dfgl_o                               : out    std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Value' in reg: 'Time difference range gate (maximum)'
+    tdc_dfgh_o                               : out    std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Fill level' in reg: 'Difference FIFO status'
+    tdc_dfs_lvl_i                            : in     std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'Loss count' in reg: 'Difference FIFO status'
+    tdc_dfs_lost_i                           : in     std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'Channel' in reg: 'Difference FIFO head channel'
+    tdc_dfch_i                               : in     std_logic_vector(7 downto 0);
+-- Port for std_logic_vector field: 'Value' in reg: 'Difference FIFO head value'
+    tdc_dfv_i                                : in     std_logic_vector(31 downto 0);
+    tdc_dfv_pop_o                            : out    std_logic;
+-- Port for BIT field: 'Enable' in reg: 'Time difference histogram control'
+    tdc_dhc_en_o                             : out    std_logic;
+-- Port for BIT field: 'Freeze' in reg: 'Time difference histogram control'
+    tdc_dhc_frz_o                            : out    std_logic;
+-- Port for MONOSTABLE field: 'Clear' in reg: 'Time difference histogram control'
+    tdc_dhc_clr_o                            : out    std_logic;
+-- Port for BIT field: 'Clear in progress' in reg: 'Time difference histogram control'
+    tdc_dhc_busy_i                           : in     std_logic;
+-- Port for std_logic_vector field: 'Bin width' in reg: 'Time difference histogram control'
+    tdc_dhc_shift_o                          : out    std_logic_vector(4 downto 0);
+-- Port for std_logic_vector field: 'Value' in reg: 'Time difference histogram offset'
+    tdc_dho_o                                : out    std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Address' in reg: 'Time difference histogram read address'
+    tdc_dha_o                                : out    std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'Data' in reg: 'Time difference histogram read data'
+    tdc_dhd_i                                : in     std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Count' in reg: 'Time difference histogram outside count'
+    tdc_dhx_i                                : in     std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Period' in reg: 'Rate meter gate'
+    tdc_rgate_o                              : out    std_logic_vector(31 downto 0)
   );
 end component;
 
+component tdc_fifo is
+    generic(
+        g_WIDTH : positive;
+        g_DEPTH : positive
+    );
+    port(
+        clk_i    : in std_logic;
+        reset_i  : in std_logic;
+        
+        push_i   : in std_logic;
+        d_i      : in std_logic_vector(g_WIDTH-1 downto 0);
+        
+        pop_i    : in std_logic;
+        q_o      : out std_logic_vector(g_WIDTH-1 downto 0);
+        
+        level_o  : out std_logic_vector(15 downto 0);
+        ovf_o    : out std_logic_vector(15 downto 0);
+        full_o   : out std_logic
+    );
+end component;
+
+component tdc_merge is
+    generic(
+        g_CHANNEL_COUNT : positive;
+        g_RAW_COUNT     : positive;
+        g_TS_WIDTH      : positive;
+        g_DELAY         : positive
+    );
+    port(
+        clk_i      : in std_logic;
+        reset_i    : in std_logic;
+        enable_i   : in std_logic;
+        
+        tag_o      : out std_logic_vector(7 downto 0);
+        
+        valid_i    : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        tag_i      : in std_logic_vector(g_CHANNEL_COUNT*8-1 downto 0);
+        polarity_i : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        raw_i      : in std_logic_vector(g_CHANNEL_COUNT*g_RAW_COUNT-1 downto 0);
+        ts_i       : in std_logic_vector(g_CHANNEL_COUNT*g_TS_WIDTH-1 downto 0);
+        pop_o      : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        full_i     : in std_logic;
+        push_o     : out std_logic;
+        channel_o  : out std_logic_vector(7 downto 0);
+        polarity_o : out std_logic;
+        raw_o      : out std_logic_vector(g_RAW_COUNT-1 downto 0);
+        ts_o       : out std_logic_vector(g_TS_WIDTH-1 downto 0)
+    );
+end component;
+
+component tdc_evwin is
+    generic(
+        g_RAW_COUNT : positive;
+        g_TS_WIDTH  : positive
+    );
+    port(
+        clk_i      : in std_logic;
+        reset_i    : in std_logic;
+        
+        wb_cyc_i   : in std_logic;
+        wb_stb_i   : in std_logic;
+        wb_we_i    : in std_logic;
+        wb_cti_i   : in std_logic_vector(2 downto 0);
+        wb_data_o  : out std_logic_vector(31 downto 0);
+        wb_ack_o   : out std_logic;
+        
+        valid_i    : in std_logic;
+        channel_i  : in std_logic_vector(7 downto 0);
+        polarity_i : in std_logic;
+        raw_i      : in std_logic_vector(g_RAW_COUNT-1 downto 0);
+        ts_i       : in std_logic_vector(g_TS_WIDTH-1 downto 0);
+        pop_o      : out std_logic;
+        
+        restart_i  : in std_logic
+    );
+end component;
+
+component tdc_hitflt is
+    port(
+        clk_i          : in std_logic;
+        reset_i        : in std_logic;
+        
+        drop_rising_i  : in std_logic;
+        drop_falling_i : in std_logic;
+        deadtime_i     : in std_logic_vector(15 downto 0);
+        prescale_i     : in std_logic_vector(15 downto 0);
+        
+        detect_i       : in std_logic;
+        polarity_i     : in std_logic;
+        
+        detect_o       : out std_logic
+    );
+end component;
+
+component tdc_diff is
+    generic(
+        g_CHANNEL_COUNT : positive;
+        g_TS_WIDTH      : positive
+    );
+    port(
+        clk_i     : in std_logic;
+        reset_i   : in std_logic;
+        enable_i  : in std_logic;
+        
+        start_i   : in std_logic_vector(7 downto 0);
+        stop_i    : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        gmin_i    : in std_logic_vector(31 downto 0);
+        gmax_i    : in std_logic_vector(31 downto 0);
+        
+        detect_i  : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        ts_i      : in std_logic_vector(g_CHANNEL_COUNT*g_TS_WIDTH-1 downto 0);
+        
+        full_i    : in std_logic;
+        push_o    : out std_logic;
+        channel_o : out std_logic_vector(7 downto 0);
+        diff_o    : out std_logic_vector(31 downto 0);
+        lost_o    : out std_logic_vector(15 downto 0)
+    );
+end component;
+
+component tdc_dhist is
+    generic(
+        g_DEPTH : positive
+    );
+    port(
+        clk_i     : in std_logic;
+        reset_i   : in std_logic;
+        
+        clear_i   : in std_logic;
+        busy_o    : out std_logic;
+        freeze_i  : in std_logic;
+        offset_i  : in std_logic_vector(31 downto 0);
+        shift_i   : in std_logic_vector(4 downto 0);
+        
+        valid_i   : in std_logic;
+        value_i   : in std_logic_vector(31 downto 0);
+        
+        rd_a_i    : in std_logic_vector(15 downto 0);
+        rd_d_o    : out std_logic_vector(31 downto 0);
+        outside_o : out std_logic_vector(31 downto 0)
+    );
+end component;
+
+component tdc_chstat is
+    generic(
+        g_CHANNEL_COUNT : positive
+    );
+    port(
+        clk_i   : in std_logic;
+        reset_i : in std_logic;
+        
+        gate_i  : in std_logic_vector(31 downto 0);
+        
+        hit_i   : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        read_i  : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        sel_i   : in std_logic_vector(7 downto 0);
+        hits_o  : out std_logic_vector(31 downto 0);
+        lost_o  : out std_logic_vector(31 downto 0);
+        rate_o  : out std_logic_vector(31 downto 0)
+    );
+end component;
+
+component tdc_chregs is
+    generic(
+        g_CHANNEL_COUNT : positive
+    );
+    port(
+        clk_i          : in std_logic;
+        reset_i        : in std_logic;
+        
+        wb_addr_i      : in std_logic_vector(10 downto 0);
+        wb_data_i      : in std_logic_vector(31 downto 0);
+        wb_data_o      : out std_logic_vector(31 downto 0);
+        wb_cyc_i       : in std_logic;
+        wb_stb_i       : in std_logic;
+        wb_we_i        : in std_logic;
+        wb_ack_o       : out std_logic;
+        wb_irq_o       : out std_logic;
+        
+        irq_ev_i       : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        tdc_desh_o     : out std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+        
+        tdc_desl_o     : out std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+        
+        tdc_ctl_ris_o  : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        tdc_ctl_fal_o  : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        tdc_ctl_stop_o : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        tdc_ctl_ie_o   : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        tdc_hf_dt_o    : out std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+        tdc_hf_psc_o   : out std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+        
+        tdc_mpr_raw_i  : in std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+        tdc_mpr_pol_i  : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        tdc_mesh_i     : in std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+        
+        tdc_mesl_i     : in std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+        tdc_mesl_rd_o  : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        tdc_fst_lvl_i  : in std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+        tdc_fst_ovf_i  : in std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+        
+        tdc_fpr_raw_i  : in std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+        tdc_fpr_pol_i  : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        tdc_fmh_i      : in std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+        
+        tdc_fml_i      : in std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+        tdc_fml_pop_o  : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        tdc_cnth_i     : in std_logic_vector(31 downto 0);
+        
+        tdc_cntl_i     : in std_logic_vector(31 downto 0);
+        
+        tdc_cntr_i     : in std_logic_vector(31 downto 0);
+        
+        sel_o          : out std_logic_vector(7 downto 0)
+    );
+end component;
+
 end package;
@@ -0,0 +1,235 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tdc_merge
+--
+-- author: agent, agent@local
+--
+-- description: Time-ordered merge of the per-channel event FIFOs
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Pipelined the comparison tree
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- Moves events from the heads of the per-channel FIFOs into a single stream,
+-- sorted by time stamp.
+--
+-- The oldest head among the non-empty channels is selected by a binary tree
+-- of comparators with c_LEVELS = ceil(log2(g_CHANNEL_COUNT)) levels, each
+-- followed by a register, so that the critical path does not grow with the
+-- number of channels. Each node keeps the index, time stamp and valid flag
+-- of the oldest of its two inputs, ties going to the lower channel index.
+-- pop_o, push_o and the merged event are registered as well.
+--
+-- After an event has been released, the tree must see the new head of its
+-- channel before the next decision, so the merger moves at most one event
+-- every c_LEVELS+2 cycles. The same wait applies after enable_i has been
+-- low, as the FIFOs may then have been popped by another reader.
+--
+-- Events of a given channel are always in order, so the selected event can
+-- be released at once if all channels had a pending event when the heads
+-- entered the tree. Otherwise, an earlier event from an empty channel may
+-- still be on its way: deskew values make channels reach the host interface
+-- with slightly different latencies, and FIFO entries only become visible
+-- two cycles after being written. In that case, the event is released only
+-- if it had been stored for at least g_DELAY cycles when the heads entered
+-- the tree, which must therefore be larger than the spread of the deskew
+-- values (in clock cycles) plus two. Both conditions are evaluated on the
+-- heads that entered the tree, so the latency of the tree does not change
+-- the requirement on g_DELAY.
+--
+-- To measure how long events have been stored, the writer of the channel
+-- FIFOs stores tag_o along with each event, and presents it back on tag_i.
+-- The tag is a free-running cycle counter, so events that have been waiting
+-- for more than 2^8 cycles may appear younger than they are. This only
+-- delays their release.
+--
+-- Time stamps are compared modulo 2^g_TS_WIDTH, so that ordering is correct
+-- across coarse counter overflows.
+--
+-- The merger stalls when full_i is asserted, and does nothing when enable_i
+-- is low.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tdc_merge is
+    generic(
+        -- Number of channels.
+        g_CHANNEL_COUNT : positive;
+        -- Number of raw value bits.
+        g_RAW_COUNT     : positive;
+        -- Number of time stamp bits.
+        g_TS_WIDTH      : positive;
+        -- Minimum storage time of an event before it can be released while
+        -- some channels are empty. Must be below 256.
+        g_DELAY         : positive
+    );
+    port(
+        clk_i      : in std_logic;
+        reset_i    : in std_logic;
+        enable_i   : in std_logic;
+        
+        -- Tag to store with events written into the channel FIFOs.
+        tag_o      : out std_logic_vector(7 downto 0);
+        
+        -- Heads of the channel FIFOs.
+        valid_i    : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        tag_i      : in std_logic_vector(g_CHANNEL_COUNT*8-1 downto 0);
+        polarity_i : in std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        raw_i      : in std_logic_vector(g_CHANNEL_COUNT*g_RAW_COUNT-1 downto 0);
+        ts_i       : in std_logic_vector(g_CHANNEL_COUNT*g_TS_WIDTH-1 downto 0);
+        pop_o      : out std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+        
+        -- Merged event stream.
+        full_i     : in std_logic;
+        push_o     : out std_logic;
+        channel_o  : out std_logic_vector(7 downto 0);
+        polarity_o : out std_logic;
+        raw_o      : out std_logic_vector(g_RAW_COUNT-1 downto 0);
+        ts_o       : out std_logic_vector(g_TS_WIDTH-1 downto 0)
+    );
+end entity;
+
+architecture rtl of tdc_merge is
+
+function f_log2_size(a : natural) return natural is
+begin
+    for i in 0 to 8 loop
+        if 2**i >= a then
+            return i;
+        end if;
+    end loop;
+    return 8;
+end function;
+
+constant c_LEVELS : natural := f_log2_size(g_CHANNEL_COUNT);
+-- tree nodes, numbered from 1 (root) with the children of node n at 2n and
+-- 2n+1, and the channels at 2**c_LEVELS and above
+constant c_NODES  : positive := 2**(c_LEVELS+1)-1;
+
+type t_ts_array is array(1 to c_NODES) of unsigned(g_TS_WIDTH-1 downto 0);
+type t_idx_array is array(1 to c_NODES) of natural range 0 to g_CHANNEL_COUNT-1;
+
+signal now     : unsigned(7 downto 0);
+signal n_ts    : t_ts_array;
+signal n_idx   : t_idx_array;
+-- the head is valid
+signal n_vld   : std_logic_vector(c_NODES downto 1);
+-- the head had been stored for at least g_DELAY cycles
+signal n_ripe  : std_logic_vector(c_NODES downto 1);
+-- all the channels below the node had a valid head
+signal n_all   : std_logic_vector(c_NODES downto 1);
+
+-- cycles until the root reflects the latest pop
+signal holdoff : natural range 0 to c_LEVELS+1;
+begin
+    process(clk_i)
+    begin
+        if rising_edge(clk_i) then
+            if reset_i = '1' then
+                now <= (others => '0');
+            else
+                now <= now + 1;
+            end if;
+        end if;
+    end process;
+    tag_o <= std_logic_vector(now);
+    
+    -- Leaves of the tree. Missing channels are never valid.
+    g_leaves: for i in 0 to 2**c_LEVELS-1 generate
+        g_channel: if i < g_CHANNEL_COUNT generate
+            n_ts(2**c_LEVELS+i) <= unsigned(ts_i((i+1)*g_TS_WIDTH-1 downto i*g_TS_WIDTH));
+            n_idx(2**c_LEVELS+i) <= i;
+            n_vld(2**c_LEVELS+i) <= valid_i(i);
+            n_ripe(2**c_LEVELS+i) <= '1' when (valid_i(i) = '1')
+                and (now - unsigned(tag_i(i*8+7 downto i*8)) >= g_DELAY) else '0';
+            n_all(2**c_LEVELS+i) <= valid_i(i);
+        end generate;
+        g_padding: if i >= g_CHANNEL_COUNT generate
+            n_ts(2**c_LEVELS+i) <= (others => '0');
+            n_idx(2**c_LEVELS+i) <= 0;
+            n_vld(2**c_LEVELS+i) <= '0';
+            n_ripe(2**c_LEVELS+i) <= '0';
+            n_all(2**c_LEVELS+i) <= '1';
+        end generate;
+    end generate;
+    
+    -- Registered comparators.
+    g_nodes: for n in 1 to 2**c_LEVELS-1 generate
+        process(clk_i)
+        variable v_diff  : unsigned(g_TS_WIDTH-1 downto 0);
+        variable v_right : std_logic;
+        begin
+            if rising_edge(clk_i) then
+                -- the time stamps of empty channels are undefined
+                v_right := n_vld(2*n+1);
+                if (n_vld(2*n) = '1') and (n_vld(2*n+1) = '1') then
+                    v_diff := n_ts(2*n+1) - n_ts(2*n);
+                    v_right := v_diff(g_TS_WIDTH-1);
+                end if;
+                if v_right = '1' then
+                    n_ts(n) <= n_ts(2*n+1);
+                    n_idx(n) <= n_idx(2*n+1);
+                    n_ripe(n) <= n_ripe(2*n+1);
+                else
+                    n_ts(n) <= n_ts(2*n);
+                    n_idx(n) <= n_idx(2*n);
+                    n_ripe(n) <= n_ripe(2*n);
+                end if;
+                n_vld(n) <= n_vld(2*n) or n_vld(2*n+1);
+                n_all(n) <= n_all(2*n) and n_all(2*n+1);
+            end if;
+        end process;
+    end generate;
+    
+    -- Release of the oldest event. The new head of a popped channel reaches
+    -- the root of the tree c_LEVELS+1 cycles after pop_o.
+    process(clk_i)
+    begin
+        if rising_edge(clk_i) then
+            if reset_i = '1' then
+                holdoff <= c_LEVELS+1;
+                pop_o <= (others => '0');
+                push_o <= '0';
+            else
+                pop_o <= (others => '0');
+                push_o <= '0';
+                if enable_i = '0' then
+                    holdoff <= c_LEVELS+1;
+                elsif holdoff /= 0 then
+                    holdoff <= holdoff - 1;
+                elsif (full_i = '0') and (n_vld(1) = '1') and ((n_all(1) = '1') or (n_ripe(1) = '1')) then
+                    holdoff <= c_LEVELS+1;
+                    pop_o(n_idx(1)) <= '1';
+                    push_o <= '1';
+                end if;
+            end if;
+            channel_o <= std_logic_vector(to_unsigned(n_idx(1), 8));
+            polarity_o <= polarity_i(n_idx(1));
+            raw_o <= raw_i((n_idx(1)+1)*g_RAW_COUNT-1 downto n_idx(1)*g_RAW_COUNT);
+            ts_o <= std_logic_vector(n_ts(1));
+        end if;
+    end process;
+end architecture;
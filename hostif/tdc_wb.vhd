@@ -2,12 +2,11 @@
 -- Title          : Wishbone slave core for TDC
 ---------------------------------------------------------------------------------------
 -- File           : tdc_wb.vhd
--- Author         : auto-generated by wbgen2 from tdc.wb
--- Created        : Tue Oct 25 16:54:19 2011
+-- Author         : auto-generated by genregs.py from hostif.wb
 -- Standard       : VHDL'87
 ---------------------------------------------------------------------------------------
--- THIS FILE WAS GENERATED BY wbgen2 FROM SOURCE FILE tdc.wb
--- DO NOT HAND-EDIT UNLESS IT'S ABSOLUTELY NECESSARY!
+-- THIS FILE WAS GENERATED BY genregs.py FROM SOURCE FILE hostif.wb
+-- DO NOT HAND-EDIT: CHANGE genwb.py AND REGENERATE IT
 ---------------------------------------------------------------------------------------
 
 library ieee;
@@ -32,98 +31,10 @@ entity tdc_wb is
     tdc_cs_rst_o                             : out    std_logic;
 -- Port for BIT field: 'Ready' in reg: 'Control and status'
     tdc_cs_rdy_i                             : in     std_logic;
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 0 (high word)'
-    tdc_desh0_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 0 (low word)'
-    tdc_desl0_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 1 (high word)'
-    tdc_desh1_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 1 (low word)'
-    tdc_desl1_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 2 (high word)'
-    tdc_desh2_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 2 (low word)'
-    tdc_desl2_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 3 (high word)'
-    tdc_desh3_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 3 (low word)'
-    tdc_desl3_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 4 (high word)'
-    tdc_desh4_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 4 (low word)'
-    tdc_desl4_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 5 (high word)'
-    tdc_desh5_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 5 (low word)'
-    tdc_desl5_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 6 (high word)'
-    tdc_desh6_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 6 (low word)'
-    tdc_desl6_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Deskew value for channel 7 (high word)'
-    tdc_desh7_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Deskew value for channel 7 (low word)'
-    tdc_desl7_o                              : out    std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Detected polarities'
-    tdc_pol_i                                : in     std_logic_vector(7 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 0'
-    tdc_raw0_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 0 (high word)'
-    tdc_mesh0_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 0 (low word)'
-    tdc_mesl0_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 1'
-    tdc_raw1_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 1 (high word)'
-    tdc_mesh1_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 1 (low word)'
-    tdc_mesl1_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 2'
-    tdc_raw2_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 2 (high word)'
-    tdc_mesh2_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 2 (low word)'
-    tdc_mesl2_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 3'
-    tdc_raw3_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 3 (high word)'
-    tdc_mesh3_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 3 (low word)'
-    tdc_mesl3_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 4'
-    tdc_raw4_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 4 (high word)'
-    tdc_mesh4_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 4 (low word)'
-    tdc_mesl4_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 5'
-    tdc_raw5_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 5 (high word)'
-    tdc_mesh5_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 5 (low word)'
-    tdc_mesl5_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 6'
-    tdc_raw6_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 6 (high word)'
-    tdc_mesh6_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 6 (low word)'
-    tdc_mesl6_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Value' in reg: 'Raw measured value for channel 7'
-    tdc_raw7_i                               : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'High word value' in reg: 'Fixed point measurement for channel 7 (high word)'
-    tdc_mesh7_i                              : in     std_logic_vector(31 downto 0);
--- Port for std_logic_vector field: 'Low word value' in reg: 'Fixed point measurement for channel 7 (low word)'
-    tdc_mesl7_i                              : in     std_logic_vector(31 downto 0);
-    irq_ie0_i                                : in     std_logic;
-    irq_ie1_i                                : in     std_logic;
-    irq_ie2_i                                : in     std_logic;
-    irq_ie3_i                                : in     std_logic;
-    irq_ie4_i                                : in     std_logic;
-    irq_ie5_i                                : in     std_logic;
-    irq_ie6_i                                : in     std_logic;
-    irq_ie7_i                                : in     std_logic;
+    irq_iev_i                                : in     std_logic;
     irq_isc_i                                : in     std_logic;
     irq_icc_i                                : in     std_logic;
+    irq_ifw_i                                : in     std_logic;
 -- Port for BIT field: 'Freeze request' in reg: 'Debug control'
     tdc_dctl_req_o                           : out    std_logic;
 -- Port for BIT field: 'Freeze acknowledgement' in reg: 'Debug control'
@@ -149,7 +60,61 @@ entity tdc_wb is
 -- Port for std_logic_vector field: 'Result' in reg: 'Frequency counter current value'
     tdc_fcr_i                                : in     std_logic_vector(31 downto 0);
 -- Port for std_logic_vector field: 'Result' in reg: 'Frequency counter stored value'
-    tdc_fcsr_i                               : in     std_logic_vector(31 downto 0)
+    tdc_fcsr_i                               : in     std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Level' in reg: 'FIFO watermark'
+    tdc_fwm_o                                : out    std_logic_vector(15 downto 0);
+-- Port for BIT field: 'Merge enable' in reg: 'Event merge control'
+    tdc_mctl_en_o                            : out    std_logic;
+-- Port for std_logic_vector field: 'Fill level' in reg: 'Merged FIFO status'
+    tdc_mst_lvl_i                            : in     std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'Raw value' in reg: 'Merged FIFO head channel, polarity and raw value'
+    tdc_mcr_raw_i                            : in     std_logic_vector(15 downto 0);
+-- Port for BIT field: 'Polarity' in reg: 'Merged FIFO head channel, polarity and raw value'
+    tdc_mcr_pol_i                            : in     std_logic;
+-- Port for std_logic_vector field: 'Channel' in reg: 'Merged FIFO head channel, polarity and raw value'
+    tdc_mcr_chn_i                            : in     std_logic_vector(7 downto 0);
+-- Port for std_logic_vector field: 'High word value' in reg: 'Merged FIFO head measurement (high word)'
+    tdc_mmh_i                                : in     std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Low word value' in reg: 'Merged FIFO head measurement (low word)'
+    tdc_mml_i                                : in     std_logic_vector(31 downto 0);
+    tdc_mml_pop_o                            : out    std_logic;
+-- Port for BIT field: 'Enable' in reg: 'Time difference unit control'
+    tdc_dfc_en_o                             : out    std_logic;
+-- Port for std_logic_vector field: 'Start channel' in reg: 'Time difference unit control'
+    tdc_dfc_start_o                          : out    std_logic_vector(7 downto 0);
+-- Port for std_logic_vector field: 'Value' in reg: 'Time difference range gate (minimum)'
+    tdc_dfgl_o                               : out    std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Value' in reg: 'Time difference range gate (maximum)'
+    tdc_dfgh_o                               : out    std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Fill level' in reg: 'Difference FIFO status'
+    tdc_dfs_lvl_i                            : in     std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'Loss count' in reg: 'Difference FIFO status'
+    tdc_dfs_lost_i                           : in     std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'Channel' in reg: 'Difference FIFO head channel'
+    tdc_dfch_i                               : in     std_logic_vector(7 downto 0);
+-- Port for std_logic_vector field: 'Value' in reg: 'Difference FIFO head value'
+    tdc_dfv_i                                : in     std_logic_vector(31 downto 0);
+    tdc_dfv_pop_o                            : out    std_logic;
+-- Port for BIT field: 'Enable' in reg: 'Time difference histogram control'
+    tdc_dhc_en_o                             : out    std_logic;
+-- Port for BIT field: 'Freeze' in reg: 'Time difference histogram control'
+    tdc_dhc_frz_o                            : out    std_logic;
+-- Port for MONOSTABLE field: 'Clear' in reg: 'Time difference histogram control'
+    tdc_dhc_clr_o                            : out    std_logic;
+-- Port for BIT field: 'Clear in progress' in reg: 'Time difference histogram control'
+    tdc_dhc_busy_i                           : in     std_logic;
+-- Port for std_logic_vector field: 'Bin width' in reg: 'Time difference histogram control'
+    tdc_dhc_shift_o                          : out    std_logic_vector(4 downto 0);
+-- Port for std_logic_vector field: 'Value' in reg: 'Time difference histogram offset'
+    tdc_dho_o                                : out    std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Address' in reg: 'Time difference histogram read address'
+    tdc_dha_o                                : out    std_logic_vector(15 downto 0);
+-- Port for std_logic_vector field: 'Data' in reg: 'Time difference histogram read data'
+    tdc_dhd_i                                : in     std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Count' in reg: 'Time difference histogram outside count'
+    tdc_dhx_i                                : in     std_logic_vector(31 downto 0);
+-- Port for std_logic_vector field: 'Period' in reg: 'Rate meter gate'
+    tdc_rgate_o                              : out    std_logic_vector(31 downto 0)
   );
 end tdc_wb;
 
@@ -157,22 +122,6 @@ architecture syn of tdc_wb is
 
 signal tdc_cs_rst_dly0                          : std_logic      ;
 signal tdc_cs_rst_int                           : std_logic      ;
-signal tdc_desh0_int                            : std_logic_vector(31 downto 0);
-signal tdc_desl0_int                            : std_logic_vector(31 downto 0);
-signal tdc_desh1_int                            : std_logic_vector(31 downto 0);
-signal tdc_desl1_int                            : std_logic_vector(31 downto 0);
-signal tdc_desh2_int                            : std_logic_vector(31 downto 0);
-signal tdc_desl2_int                            : std_logic_vector(31 downto 0);
-signal tdc_desh3_int                            : std_logic_vector(31 downto 0);
-signal tdc_desl3_int                            : std_logic_vector(31 downto 0);
-signal tdc_desh4_int                            : std_logic_vector(31 downto 0);
-signal tdc_desl4_int                            : std_logic_vector(31 downto 0);
-signal tdc_desh5_int                            : std_logic_vector(31 downto 0);
-signal tdc_desl5_int                            : std_logic_vector(31 downto 0);
-signal tdc_desh6_int                            : std_logic_vector(31 downto 0);
-signal tdc_desl6_int                            : std_logic_vector(31 downto 0);
-signal tdc_desh7_int                            : std_logic_vector(31 downto 0);
-signal tdc_desl7_int                            : std_logic_vector(31 downto 0);
 signal tdc_dctl_req_int                         : std_logic      ;
 signal tdc_csel_next_dly0                       : std_logic      ;
 signal tdc_csel_next_int                        : std_logic      ;
@@ -181,16 +130,30 @@ signal tdc_luta_int                             : std_logic_vector(15 downto 0);
 signal tdc_hisa_int                             : std_logic_vector(15 downto 0);
 signal tdc_fcc_st_dly0                          : std_logic      ;
 signal tdc_fcc_st_int                           : std_logic      ;
-signal eic_idr_int                              : std_logic_vector(9 downto 0);
+signal tdc_fwm_int                              : std_logic_vector(15 downto 0);
+signal tdc_mctl_en_int                          : std_logic      ;
+signal tdc_dfc_en_int                           : std_logic      ;
+signal tdc_dfc_start_int                        : std_logic_vector(7 downto 0);
+signal tdc_dfgl_int                             : std_logic_vector(31 downto 0);
+signal tdc_dfgh_int                             : std_logic_vector(31 downto 0);
+signal tdc_dhc_en_int                           : std_logic      ;
+signal tdc_dhc_frz_int                          : std_logic      ;
+signal tdc_dhc_clr_dly0                         : std_logic      ;
+signal tdc_dhc_clr_int                          : std_logic      ;
+signal tdc_dhc_shift_int                        : std_logic_vector(4 downto 0);
+signal tdc_dho_int                              : std_logic_vector(31 downto 0);
+signal tdc_dha_int                              : std_logic_vector(15 downto 0);
+signal tdc_rgate_int                            : std_logic_vector(31 downto 0);
+signal eic_idr_int                              : std_logic_vector(3 downto 0);
 signal eic_idr_write_int                        : std_logic      ;
-signal eic_ier_int                              : std_logic_vector(9 downto 0);
+signal eic_ier_int                              : std_logic_vector(3 downto 0);
 signal eic_ier_write_int                        : std_logic      ;
-signal eic_imr_int                              : std_logic_vector(9 downto 0);
-signal eic_isr_clear_int                        : std_logic_vector(9 downto 0);
-signal eic_isr_status_int                       : std_logic_vector(9 downto 0);
-signal eic_irq_ack_int                          : std_logic_vector(9 downto 0);
+signal eic_imr_int                              : std_logic_vector(3 downto 0);
+signal eic_isr_clear_int                        : std_logic_vector(3 downto 0);
+signal eic_isr_status_int                       : std_logic_vector(3 downto 0);
+signal eic_irq_ack_int                          : std_logic_vector(3 downto 0);
 signal eic_isr_write_int                        : std_logic      ;
-signal irq_inputs_vector_int                    : std_logic_vector(9 downto 0);
+signal irq_inputs_vector_int                    : std_logic_vector(3 downto 0);
 signal ack_sreg                                 : std_logic_vector(9 downto 0);
 signal rddata_reg                               : std_logic_vector(31 downto 0);
 signal wrdata_reg                               : std_logic_vector(31 downto 0);
@@ -221,28 +184,27 @@ begin
       ack_in_progress <= '0';
       rddata_reg <= "00000000000000000000000000000000";
       tdc_cs_rst_int <= '0';
-      tdc_desh0_int <= "00000000000000000000000000000000";
-      tdc_desl0_int <= "00000000000000000000000000000000";
-      tdc_desh1_int <= "00000000000000000000000000000000";
-      tdc_desl1_int <= "00000000000000000000000000000000";
-      tdc_desh2_int <= "00000000000000000000000000000000";
-      tdc_desl2_int <= "00000000000000000000000000000000";
-      tdc_desh3_int <= "00000000000000000000000000000000";
-      tdc_desl3_int <= "00000000000000000000000000000000";
-      tdc_desh4_int <= "00000000000000000000000000000000";
-      tdc_desl4_int <= "00000000000000000000000000000000";
-      tdc_desh5_int <= "00000000000000000000000000000000";
-      tdc_desl5_int <= "00000000000000000000000000000000";
-      tdc_desh6_int <= "00000000000000000000000000000000";
-      tdc_desl6_int <= "00000000000000000000000000000000";
-      tdc_desh7_int <= "00000000000000000000000000000000";
-      tdc_desl7_int <= "00000000000000000000000000000000";
       tdc_dctl_req_int <= '0';
       tdc_csel_next_int <= '0';
       tdc_cal_int <= '0';
       tdc_luta_int <= "0000000000000000";
       tdc_hisa_int <= "0000000000000000";
       tdc_fcc_st_int <= '0';
+      tdc_fwm_int <= "0000000000000000";
+      tdc_mctl_en_int <= '0';
+      tdc_mml_pop_o <= '0';
+      tdc_dfc_en_int <= '0';
+      tdc_dfc_start_int <= "00000000";
+      tdc_dfgl_int <= "00000000000000000000000000000000";
+      tdc_dfgh_int <= "00000000000000000000000000000000";
+      tdc_dfv_pop_o <= '0';
+      tdc_dhc_en_int <= '0';
+      tdc_dhc_frz_int <= '0';
+      tdc_dhc_clr_int <= '0';
+      tdc_dhc_shift_int <= "00000";
+      tdc_dho_int <= "00000000000000000000000000000000";
+      tdc_dha_int <= "0000000000000000";
+      tdc_rgate_int <= "00000000000000000000000000000000";
       eic_idr_write_int <= '0';
       eic_ier_write_int <= '0';
       eic_isr_write_int <= '0';
@@ -255,6 +217,9 @@ begin
           tdc_cs_rst_int <= '0';
           tdc_csel_next_int <= '0';
           tdc_fcc_st_int <= '0';
+          tdc_mml_pop_o <= '0';
+          tdc_dfv_pop_o <= '0';
+          tdc_dhc_clr_int <= '0';
           eic_idr_write_int <= '0';
           eic_ier_write_int <= '0';
           eic_isr_write_int <= '0';
@@ -307,136 +272,99 @@ begin
             ack_in_progress <= '1';
           when "000001" => 
             if (wb_we_i = '1') then
-              tdc_desh0_int <= wrdata_reg(31 downto 0);
+              rddata_reg(0) <= 'X';
+              tdc_dctl_req_int <= wrdata_reg(0);
+              rddata_reg(1) <= 'X';
             else
-              rddata_reg(31 downto 0) <= tdc_desh0_int;
+              rddata_reg(0) <= tdc_dctl_req_int;
+              rddata_reg(1) <= tdc_dctl_ack_i;
+              rddata_reg(2) <= 'X';
+              rddata_reg(3) <= 'X';
+              rddata_reg(4) <= 'X';
+              rddata_reg(5) <= 'X';
+              rddata_reg(6) <= 'X';
+              rddata_reg(7) <= 'X';
+              rddata_reg(8) <= 'X';
+              rddata_reg(9) <= 'X';
+              rddata_reg(10) <= 'X';
+              rddata_reg(11) <= 'X';
+              rddata_reg(12) <= 'X';
+              rddata_reg(13) <= 'X';
+              rddata_reg(14) <= 'X';
+              rddata_reg(15) <= 'X';
+              rddata_reg(16) <= 'X';
+              rddata_reg(17) <= 'X';
+              rddata_reg(18) <= 'X';
+              rddata_reg(19) <= 'X';
+              rddata_reg(20) <= 'X';
+              rddata_reg(21) <= 'X';
+              rddata_reg(22) <= 'X';
+              rddata_reg(23) <= 'X';
+              rddata_reg(24) <= 'X';
+              rddata_reg(25) <= 'X';
+              rddata_reg(26) <= 'X';
+              rddata_reg(27) <= 'X';
+              rddata_reg(28) <= 'X';
+              rddata_reg(29) <= 'X';
+              rddata_reg(30) <= 'X';
+              rddata_reg(31) <= 'X';
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
           when "000010" => 
             if (wb_we_i = '1') then
-              tdc_desl0_int <= wrdata_reg(31 downto 0);
+              tdc_csel_next_int <= wrdata_reg(0);
+              rddata_reg(0) <= 'X';
+              rddata_reg(1) <= 'X';
             else
-              rddata_reg(31 downto 0) <= tdc_desl0_int;
+              rddata_reg(0) <= 'X';
+              rddata_reg(1) <= tdc_csel_last_i;
+              rddata_reg(2) <= 'X';
+              rddata_reg(3) <= 'X';
+              rddata_reg(4) <= 'X';
+              rddata_reg(5) <= 'X';
+              rddata_reg(6) <= 'X';
+              rddata_reg(7) <= 'X';
+              rddata_reg(8) <= 'X';
+              rddata_reg(9) <= 'X';
+              rddata_reg(10) <= 'X';
+              rddata_reg(11) <= 'X';
+              rddata_reg(12) <= 'X';
+              rddata_reg(13) <= 'X';
+              rddata_reg(14) <= 'X';
+              rddata_reg(15) <= 'X';
+              rddata_reg(16) <= 'X';
+              rddata_reg(17) <= 'X';
+              rddata_reg(18) <= 'X';
+              rddata_reg(19) <= 'X';
+              rddata_reg(20) <= 'X';
+              rddata_reg(21) <= 'X';
+              rddata_reg(22) <= 'X';
+              rddata_reg(23) <= 'X';
+              rddata_reg(24) <= 'X';
+              rddata_reg(25) <= 'X';
+              rddata_reg(26) <= 'X';
+              rddata_reg(27) <= 'X';
+              rddata_reg(28) <= 'X';
+              rddata_reg(29) <= 'X';
+              rddata_reg(30) <= 'X';
+              rddata_reg(31) <= 'X';
             end if;
-            ack_sreg(0) <= '1';
+            ack_sreg(2) <= '1';
             ack_in_progress <= '1';
           when "000011" => 
             if (wb_we_i = '1') then
-              tdc_desh1_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desh1_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "000100" => 
-            if (wb_we_i = '1') then
-              tdc_desl1_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desl1_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "000101" => 
-            if (wb_we_i = '1') then
-              tdc_desh2_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desh2_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "000110" => 
-            if (wb_we_i = '1') then
-              tdc_desl2_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desl2_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "000111" => 
-            if (wb_we_i = '1') then
-              tdc_desh3_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desh3_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "001000" => 
-            if (wb_we_i = '1') then
-              tdc_desl3_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desl3_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "001001" => 
-            if (wb_we_i = '1') then
-              tdc_desh4_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desh4_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "001010" => 
-            if (wb_we_i = '1') then
-              tdc_desl4_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desl4_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "001011" => 
-            if (wb_we_i = '1') then
-              tdc_desh5_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desh5_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "001100" => 
-            if (wb_we_i = '1') then
-              tdc_desl5_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desl5_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "001101" => 
-            if (wb_we_i = '1') then
-              tdc_desh6_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desh6_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "001110" => 
-            if (wb_we_i = '1') then
-              tdc_desl6_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desl6_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "001111" => 
-            if (wb_we_i = '1') then
-              tdc_desh7_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desh7_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "010000" => 
-            if (wb_we_i = '1') then
-              tdc_desl7_int <= wrdata_reg(31 downto 0);
-            else
-              rddata_reg(31 downto 0) <= tdc_desl7_int;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "010001" => 
-            if (wb_we_i = '1') then
+              rddata_reg(0) <= 'X';
+              tdc_cal_int <= wrdata_reg(0);
             else
-              rddata_reg(7 downto 0) <= tdc_pol_i;
+              rddata_reg(0) <= tdc_cal_int;
+              rddata_reg(1) <= 'X';
+              rddata_reg(2) <= 'X';
+              rddata_reg(3) <= 'X';
+              rddata_reg(4) <= 'X';
+              rddata_reg(5) <= 'X';
+              rddata_reg(6) <= 'X';
+              rddata_reg(7) <= 'X';
               rddata_reg(8) <= 'X';
               rddata_reg(9) <= 'X';
               rddata_reg(10) <= 'X';
@@ -464,182 +392,76 @@ begin
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "010010" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_raw0_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "010011" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_mesh0_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "010100" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_mesl0_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "010101" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_raw1_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "010110" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_mesh1_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "010111" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_mesl1_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "011000" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_raw2_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "011001" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_mesh2_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "011010" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_mesl2_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "011011" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_raw3_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "011100" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_mesh3_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "011101" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_mesl3_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "011110" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_raw4_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "011111" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_mesh4_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "100000" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_mesl4_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "100001" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_raw5_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "100010" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_mesh5_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "100011" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_mesl5_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "100100" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_raw6_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "100101" => 
-            if (wb_we_i = '1') then
-            else
-              rddata_reg(31 downto 0) <= tdc_mesh6_i;
-            end if;
-            ack_sreg(0) <= '1';
-            ack_in_progress <= '1';
-          when "100110" => 
+          when "000100" => 
             if (wb_we_i = '1') then
+              tdc_luta_int <= wrdata_reg(15 downto 0);
             else
-              rddata_reg(31 downto 0) <= tdc_mesl6_i;
+              rddata_reg(15 downto 0) <= tdc_luta_int;
+              rddata_reg(16) <= 'X';
+              rddata_reg(17) <= 'X';
+              rddata_reg(18) <= 'X';
+              rddata_reg(19) <= 'X';
+              rddata_reg(20) <= 'X';
+              rddata_reg(21) <= 'X';
+              rddata_reg(22) <= 'X';
+              rddata_reg(23) <= 'X';
+              rddata_reg(24) <= 'X';
+              rddata_reg(25) <= 'X';
+              rddata_reg(26) <= 'X';
+              rddata_reg(27) <= 'X';
+              rddata_reg(28) <= 'X';
+              rddata_reg(29) <= 'X';
+              rddata_reg(30) <= 'X';
+              rddata_reg(31) <= 'X';
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "100111" => 
+          when "000101" => 
             if (wb_we_i = '1') then
             else
-              rddata_reg(31 downto 0) <= tdc_raw7_i;
+              rddata_reg(31 downto 0) <= tdc_lutd_i;
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "101000" => 
+          when "000110" => 
             if (wb_we_i = '1') then
+              tdc_hisa_int <= wrdata_reg(15 downto 0);
             else
-              rddata_reg(31 downto 0) <= tdc_mesh7_i;
+              rddata_reg(15 downto 0) <= tdc_hisa_int;
+              rddata_reg(16) <= 'X';
+              rddata_reg(17) <= 'X';
+              rddata_reg(18) <= 'X';
+              rddata_reg(19) <= 'X';
+              rddata_reg(20) <= 'X';
+              rddata_reg(21) <= 'X';
+              rddata_reg(22) <= 'X';
+              rddata_reg(23) <= 'X';
+              rddata_reg(24) <= 'X';
+              rddata_reg(25) <= 'X';
+              rddata_reg(26) <= 'X';
+              rddata_reg(27) <= 'X';
+              rddata_reg(28) <= 'X';
+              rddata_reg(29) <= 'X';
+              rddata_reg(30) <= 'X';
+              rddata_reg(31) <= 'X';
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "101001" => 
+          when "000111" => 
             if (wb_we_i = '1') then
             else
-              rddata_reg(31 downto 0) <= tdc_mesl7_i;
+              rddata_reg(31 downto 0) <= tdc_hisd_i;
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "101010" => 
+          when "001000" => 
             if (wb_we_i = '1') then
+              tdc_fcc_st_int <= wrdata_reg(0);
               rddata_reg(0) <= 'X';
-              tdc_dctl_req_int <= wrdata_reg(0);
               rddata_reg(1) <= 'X';
             else
-              rddata_reg(0) <= tdc_dctl_req_int;
-              rddata_reg(1) <= tdc_dctl_ack_i;
+              rddata_reg(0) <= 'X';
+              rddata_reg(1) <= tdc_fcc_rdy_i;
               rddata_reg(2) <= 'X';
               rddata_reg(3) <= 'X';
               rddata_reg(4) <= 'X';
@@ -671,30 +493,27 @@ begin
               rddata_reg(30) <= 'X';
               rddata_reg(31) <= 'X';
             end if;
+            ack_sreg(2) <= '1';
+            ack_in_progress <= '1';
+          when "001001" => 
+            if (wb_we_i = '1') then
+            else
+              rddata_reg(31 downto 0) <= tdc_fcr_i;
+            end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "101011" => 
+          when "001010" => 
             if (wb_we_i = '1') then
-              tdc_csel_next_int <= wrdata_reg(0);
-              rddata_reg(0) <= 'X';
-              rddata_reg(1) <= 'X';
             else
-              rddata_reg(0) <= 'X';
-              rddata_reg(1) <= tdc_csel_last_i;
-              rddata_reg(2) <= 'X';
-              rddata_reg(3) <= 'X';
-              rddata_reg(4) <= 'X';
-              rddata_reg(5) <= 'X';
-              rddata_reg(6) <= 'X';
-              rddata_reg(7) <= 'X';
-              rddata_reg(8) <= 'X';
-              rddata_reg(9) <= 'X';
-              rddata_reg(10) <= 'X';
-              rddata_reg(11) <= 'X';
-              rddata_reg(12) <= 'X';
-              rddata_reg(13) <= 'X';
-              rddata_reg(14) <= 'X';
-              rddata_reg(15) <= 'X';
+              rddata_reg(31 downto 0) <= tdc_fcsr_i;
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "001011" => 
+            if (wb_we_i = '1') then
+              tdc_fwm_int <= wrdata_reg(15 downto 0);
+            else
+              rddata_reg(15 downto 0) <= tdc_fwm_int;
               rddata_reg(16) <= 'X';
               rddata_reg(17) <= 'X';
               rddata_reg(18) <= 'X';
@@ -712,14 +531,14 @@ begin
               rddata_reg(30) <= 'X';
               rddata_reg(31) <= 'X';
             end if;
-            ack_sreg(2) <= '1';
+            ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "101100" => 
+          when "001100" => 
             if (wb_we_i = '1') then
               rddata_reg(0) <= 'X';
-              tdc_cal_int <= wrdata_reg(0);
+              tdc_mctl_en_int <= wrdata_reg(0);
             else
-              rddata_reg(0) <= tdc_cal_int;
+              rddata_reg(0) <= tdc_mctl_en_int;
               rddata_reg(1) <= 'X';
               rddata_reg(2) <= 'X';
               rddata_reg(3) <= 'X';
@@ -754,11 +573,10 @@ begin
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "101101" => 
+          when "001101" => 
             if (wb_we_i = '1') then
-              tdc_luta_int <= wrdata_reg(15 downto 0);
             else
-              rddata_reg(15 downto 0) <= tdc_luta_int;
+              rddata_reg(15 downto 0) <= tdc_mst_lvl_i;
               rddata_reg(16) <= 'X';
               rddata_reg(17) <= 'X';
               rddata_reg(18) <= 'X';
@@ -778,18 +596,53 @@ begin
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "101110" => 
+          when "001110" => 
             if (wb_we_i = '1') then
+              rddata_reg(16) <= 'X';
             else
-              rddata_reg(31 downto 0) <= tdc_lutd_i;
+              rddata_reg(15 downto 0) <= tdc_mcr_raw_i;
+              rddata_reg(16) <= tdc_mcr_pol_i;
+              rddata_reg(24 downto 17) <= tdc_mcr_chn_i;
+              rddata_reg(25) <= 'X';
+              rddata_reg(26) <= 'X';
+              rddata_reg(27) <= 'X';
+              rddata_reg(28) <= 'X';
+              rddata_reg(29) <= 'X';
+              rddata_reg(30) <= 'X';
+              rddata_reg(31) <= 'X';
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "101111" => 
+          when "001111" => 
             if (wb_we_i = '1') then
-              tdc_hisa_int <= wrdata_reg(15 downto 0);
             else
-              rddata_reg(15 downto 0) <= tdc_hisa_int;
+              rddata_reg(31 downto 0) <= tdc_mmh_i;
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "010000" => 
+            if (wb_we_i = '1') then
+            else
+              rddata_reg(31 downto 0) <= tdc_mml_i;
+              tdc_mml_pop_o <= '1';
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "010001" => 
+            if (wb_we_i = '1') then
+              rddata_reg(0) <= 'X';
+              tdc_dfc_en_int <= wrdata_reg(0);
+              tdc_dfc_start_int <= wrdata_reg(8 downto 1);
+            else
+              rddata_reg(0) <= tdc_dfc_en_int;
+              rddata_reg(8 downto 1) <= tdc_dfc_start_int;
+              rddata_reg(9) <= 'X';
+              rddata_reg(10) <= 'X';
+              rddata_reg(11) <= 'X';
+              rddata_reg(12) <= 'X';
+              rddata_reg(13) <= 'X';
+              rddata_reg(14) <= 'X';
+              rddata_reg(15) <= 'X';
               rddata_reg(16) <= 'X';
               rddata_reg(17) <= 'X';
               rddata_reg(18) <= 'X';
@@ -809,28 +662,85 @@ begin
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "110000" => 
+          when "010010" => 
             if (wb_we_i = '1') then
+              tdc_dfgl_int <= wrdata_reg(31 downto 0);
             else
-              rddata_reg(31 downto 0) <= tdc_hisd_i;
+              rddata_reg(31 downto 0) <= tdc_dfgl_int;
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "110001" => 
+          when "010011" => 
+            if (wb_we_i = '1') then
+              tdc_dfgh_int <= wrdata_reg(31 downto 0);
+            else
+              rddata_reg(31 downto 0) <= tdc_dfgh_int;
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "010100" => 
+            if (wb_we_i = '1') then
+            else
+              rddata_reg(15 downto 0) <= tdc_dfs_lvl_i;
+              rddata_reg(31 downto 16) <= tdc_dfs_lost_i;
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "010101" => 
+            if (wb_we_i = '1') then
+            else
+              rddata_reg(7 downto 0) <= tdc_dfch_i;
+              rddata_reg(8) <= 'X';
+              rddata_reg(9) <= 'X';
+              rddata_reg(10) <= 'X';
+              rddata_reg(11) <= 'X';
+              rddata_reg(12) <= 'X';
+              rddata_reg(13) <= 'X';
+              rddata_reg(14) <= 'X';
+              rddata_reg(15) <= 'X';
+              rddata_reg(16) <= 'X';
+              rddata_reg(17) <= 'X';
+              rddata_reg(18) <= 'X';
+              rddata_reg(19) <= 'X';
+              rddata_reg(20) <= 'X';
+              rddata_reg(21) <= 'X';
+              rddata_reg(22) <= 'X';
+              rddata_reg(23) <= 'X';
+              rddata_reg(24) <= 'X';
+              rddata_reg(25) <= 'X';
+              rddata_reg(26) <= 'X';
+              rddata_reg(27) <= 'X';
+              rddata_reg(28) <= 'X';
+              rddata_reg(29) <= 'X';
+              rddata_reg(30) <= 'X';
+              rddata_reg(31) <= 'X';
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "010110" => 
             if (wb_we_i = '1') then
-              tdc_fcc_st_int <= wrdata_reg(0);
-              rddata_reg(0) <= 'X';
-              rddata_reg(1) <= 'X';
             else
+              rddata_reg(31 downto 0) <= tdc_dfv_i;
+              tdc_dfv_pop_o <= '1';
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "010111" => 
+            if (wb_we_i = '1') then
               rddata_reg(0) <= 'X';
-              rddata_reg(1) <= tdc_fcc_rdy_i;
+              tdc_dhc_en_int <= wrdata_reg(0);
+              rddata_reg(1) <= 'X';
+              tdc_dhc_frz_int <= wrdata_reg(1);
+              tdc_dhc_clr_int <= wrdata_reg(2);
               rddata_reg(2) <= 'X';
               rddata_reg(3) <= 'X';
-              rddata_reg(4) <= 'X';
-              rddata_reg(5) <= 'X';
-              rddata_reg(6) <= 'X';
-              rddata_reg(7) <= 'X';
-              rddata_reg(8) <= 'X';
+              tdc_dhc_shift_int <= wrdata_reg(8 downto 4);
+            else
+              rddata_reg(0) <= tdc_dhc_en_int;
+              rddata_reg(1) <= tdc_dhc_frz_int;
+              rddata_reg(2) <= 'X';
+              rddata_reg(3) <= tdc_dhc_busy_i;
+              rddata_reg(8 downto 4) <= tdc_dhc_shift_int;
               rddata_reg(9) <= 'X';
               rddata_reg(10) <= 'X';
               rddata_reg(11) <= 'X';
@@ -857,21 +767,61 @@ begin
             end if;
             ack_sreg(2) <= '1';
             ack_in_progress <= '1';
-          when "110010" => 
+          when "011000" => 
             if (wb_we_i = '1') then
+              tdc_dho_int <= wrdata_reg(31 downto 0);
             else
-              rddata_reg(31 downto 0) <= tdc_fcr_i;
+              rddata_reg(31 downto 0) <= tdc_dho_int;
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "110011" => 
+          when "011001" => 
             if (wb_we_i = '1') then
+              tdc_dha_int <= wrdata_reg(15 downto 0);
             else
-              rddata_reg(31 downto 0) <= tdc_fcsr_i;
+              rddata_reg(15 downto 0) <= tdc_dha_int;
+              rddata_reg(16) <= 'X';
+              rddata_reg(17) <= 'X';
+              rddata_reg(18) <= 'X';
+              rddata_reg(19) <= 'X';
+              rddata_reg(20) <= 'X';
+              rddata_reg(21) <= 'X';
+              rddata_reg(22) <= 'X';
+              rddata_reg(23) <= 'X';
+              rddata_reg(24) <= 'X';
+              rddata_reg(25) <= 'X';
+              rddata_reg(26) <= 'X';
+              rddata_reg(27) <= 'X';
+              rddata_reg(28) <= 'X';
+              rddata_reg(29) <= 'X';
+              rddata_reg(30) <= 'X';
+              rddata_reg(31) <= 'X';
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "011010" => 
+            if (wb_we_i = '1') then
+            else
+              rddata_reg(31 downto 0) <= tdc_dhd_i;
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "011011" => 
+            if (wb_we_i = '1') then
+            else
+              rddata_reg(31 downto 0) <= tdc_dhx_i;
+            end if;
+            ack_sreg(0) <= '1';
+            ack_in_progress <= '1';
+          when "011100" => 
+            if (wb_we_i = '1') then
+              tdc_rgate_int <= wrdata_reg(31 downto 0);
+            else
+              rddata_reg(31 downto 0) <= tdc_rgate_int;
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "111000" => 
+          when "100000" => 
             if (wb_we_i = '1') then
               eic_idr_write_int <= '1';
             else
@@ -910,7 +860,7 @@ begin
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "111001" => 
+          when "100001" => 
             if (wb_we_i = '1') then
               eic_ier_write_int <= '1';
             else
@@ -949,10 +899,16 @@ begin
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "111010" => 
+          when "100010" => 
             if (wb_we_i = '1') then
             else
-              rddata_reg(9 downto 0) <= eic_imr_int(9 downto 0);
+              rddata_reg(3 downto 0) <= eic_imr_int(3 downto 0);
+              rddata_reg(4) <= 'X';
+              rddata_reg(5) <= 'X';
+              rddata_reg(6) <= 'X';
+              rddata_reg(7) <= 'X';
+              rddata_reg(8) <= 'X';
+              rddata_reg(9) <= 'X';
               rddata_reg(10) <= 'X';
               rddata_reg(11) <= 'X';
               rddata_reg(12) <= 'X';
@@ -978,11 +934,17 @@ begin
             end if;
             ack_sreg(0) <= '1';
             ack_in_progress <= '1';
-          when "111011" => 
+          when "100011" => 
             if (wb_we_i = '1') then
               eic_isr_write_int <= '1';
             else
-              rddata_reg(9 downto 0) <= eic_isr_status_int(9 downto 0);
+              rddata_reg(3 downto 0) <= eic_isr_status_int(3 downto 0);
+              rddata_reg(4) <= 'X';
+              rddata_reg(5) <= 'X';
+              rddata_reg(6) <= 'X';
+              rddata_reg(7) <= 'X';
+              rddata_reg(8) <= 'X';
+              rddata_reg(9) <= 'X';
               rddata_reg(10) <= 'X';
               rddata_reg(11) <= 'X';
               rddata_reg(12) <= 'X';
@@ -1035,63 +997,6 @@ begin
   
   
 -- Ready
--- High word value
-  tdc_desh0_o <= tdc_desh0_int;
--- Low word value
-  tdc_desl0_o <= tdc_desl0_int;
--- High word value
-  tdc_desh1_o <= tdc_desh1_int;
--- Low word value
-  tdc_desl1_o <= tdc_desl1_int;
--- High word value
-  tdc_desh2_o <= tdc_desh2_int;
--- Low word value
-  tdc_desl2_o <= tdc_desl2_int;
--- High word value
-  tdc_desh3_o <= tdc_desh3_int;
--- Low word value
-  tdc_desl3_o <= tdc_desl3_int;
--- High word value
-  tdc_desh4_o <= tdc_desh4_int;
--- Low word value
-  tdc_desl4_o <= tdc_desl4_int;
--- High word value
-  tdc_desh5_o <= tdc_desh5_int;
--- Low word value
-  tdc_desl5_o <= tdc_desl5_int;
--- High word value
-  tdc_desh6_o <= tdc_desh6_int;
--- Low word value
-  tdc_desl6_o <= tdc_desl6_int;
--- High word value
-  tdc_desh7_o <= tdc_desh7_int;
--- Low word value
-  tdc_desl7_o <= tdc_desl7_int;
--- Value
--- Value
--- High word value
--- Low word value
--- Value
--- High word value
--- Low word value
--- Value
--- High word value
--- Low word value
--- Value
--- High word value
--- Low word value
--- Value
--- High word value
--- Low word value
--- Value
--- High word value
--- Low word value
--- Value
--- High word value
--- Low word value
--- Value
--- High word value
--- Low word value
 -- Freeze request
   tdc_dctl_req_o <= tdc_dctl_req_int;
 -- Freeze acknowledgement
@@ -1133,16 +1038,66 @@ begin
 -- Measurement ready
 -- Result
 -- Result
+-- Level
+  tdc_fwm_o <= tdc_fwm_int;
+-- Merge enable
+  tdc_mctl_en_o <= tdc_mctl_en_int;
+-- Fill level
+-- Raw value
+-- Polarity
+-- Channel
+-- High word value
+-- Low word value
+-- Enable
+  tdc_dfc_en_o <= tdc_dfc_en_int;
+-- Start channel
+  tdc_dfc_start_o <= tdc_dfc_start_int;
+-- Value
+  tdc_dfgl_o <= tdc_dfgl_int;
+-- Value
+  tdc_dfgh_o <= tdc_dfgh_int;
+-- Fill level
+-- Loss count
+-- Channel
+-- Value
+-- Enable
+  tdc_dhc_en_o <= tdc_dhc_en_int;
+-- Freeze
+  tdc_dhc_frz_o <= tdc_dhc_frz_int;
+-- Clear
+  process (bus_clock_int, rst_n_i)
+  begin
+    if (rst_n_i = '0') then 
+      tdc_dhc_clr_dly0 <= '0';
+      tdc_dhc_clr_o <= '0';
+    elsif rising_edge(bus_clock_int) then
+      tdc_dhc_clr_dly0 <= tdc_dhc_clr_int;
+      tdc_dhc_clr_o <= tdc_dhc_clr_int and (not tdc_dhc_clr_dly0);
+    end if;
+  end process;
+  
+  
+-- Clear in progress
+-- Bin width
+  tdc_dhc_shift_o <= tdc_dhc_shift_int;
+-- Value
+  tdc_dho_o <= tdc_dho_int;
+-- Address
+  tdc_dha_o <= tdc_dha_int;
+-- Data
+-- Count
+-- Period
+  tdc_rgate_o <= tdc_rgate_int;
 -- extra code for reg/fifo/mem: Interrupt disable register
-  eic_idr_int(9 downto 0) <= wrdata_reg(9 downto 0);
+  eic_idr_int(3 downto 0) <= wrdata_reg(3 downto 0);
 -- extra code for reg/fifo/mem: Interrupt enable register
-  eic_ier_int(9 downto 0) <= wrdata_reg(9 downto 0);
+  eic_ier_int(3 downto 0) <= wrdata_reg(3 downto 0);
 -- extra code for reg/fifo/mem: Interrupt status register
-  eic_isr_clear_int(9 downto 0) <= wrdata_reg(9 downto 0);
+  eic_isr_clear_int(3 downto 0) <= wrdata_reg(3 downto 0);
 -- extra code for reg/fifo/mem: IRQ_CONTROLLER
   eic_irq_controller_inst : wbgen2_eic
     generic map (
-      g_num_interrupts     => 10,
+      g_num_interrupts     => 4,
       g_irq00_mode         => 0,
       g_irq01_mode         => 0,
       g_irq02_mode         => 0,
@@ -1192,16 +1147,10 @@ begin
       wb_irq_o             => wb_irq_o
     );
   
-  irq_inputs_vector_int(0) <= irq_ie0_i;
-  irq_inputs_vector_int(1) <= irq_ie1_i;
-  irq_inputs_vector_int(2) <= irq_ie2_i;
-  irq_inputs_vector_int(3) <= irq_ie3_i;
-  irq_inputs_vector_int(4) <= irq_ie4_i;
-  irq_inputs_vector_int(5) <= irq_ie5_i;
-  irq_inputs_vector_int(6) <= irq_ie6_i;
-  irq_inputs_vector_int(7) <= irq_ie7_i;
-  irq_inputs_vector_int(8) <= irq_isc_i;
-  irq_inputs_vector_int(9) <= irq_icc_i;
+  irq_inputs_vector_int(0) <= irq_iev_i;
+  irq_inputs_vector_int(1) <= irq_isc_i;
+  irq_inputs_vector_int(2) <= irq_icc_i;
+  irq_inputs_vector_int(3) <= irq_ifw_i;
   rwaddr_reg <= wb_addr_i;
 -- ACK signal generation. Just pass the LSB of ACK counter.
   wb_ack_o <= ack_sreg(0);
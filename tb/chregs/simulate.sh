@@ -0,0 +1,7 @@
+#!/bin/sh
+set -e
+ghdl -i ../../hostif/tdc_hostif_package.vhd ../../hostif/tdc_chregs.vhd tb_chregs.vhd
+ghdl -m tb_chregs
+ghdl -r tb_chregs
+ghdl -r tb_chregs -gg_CHANNEL_COUNT=64
+ghdl -r tb_chregs -gg_CHANNEL_COUNT=8
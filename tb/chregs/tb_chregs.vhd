@@ -0,0 +1,434 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tb_chregs
+--
+-- author: agent, agent@local
+--
+-- description: Test bench for the per-channel register blocks
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Adapted to the generated tdc_chregs
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- This test accesses the register blocks of g_CHANNEL_COUNT channels through
+-- Wishbone cycles. Each channel has distinct values on its inputs, and the
+-- test bench verifies that:
+--  * the configuration registers read back the written values, drive the
+--    outputs of their channel only, and are reset to 0;
+--  * the measurement, FIFO and counter registers return the inputs of the
+--    addressed channel;
+--  * reading MESL and FML pulses read_o and fifo_pop_o once, for the
+--    addressed channel only;
+--  * the blocks of channels above g_CHANNEL_COUNT read as 0;
+--  * transitions of channels with the interrupt enabled set their bits in
+--    both event pending registers and produce one interrupt edge each, even
+--    in consecutive cycles, and writing 1 clears the pending bits;
+--  * writes to the addresses around the event pending registers are
+--    ignored and these addresses read as 0.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tb_chregs is
+    generic(
+        -- At least 6.
+        g_CHANNEL_COUNT : positive := 40
+    );
+end entity;
+
+architecture tb of tb_chregs is
+
+signal clk            : std_logic;
+signal reset          : std_logic;
+signal wb_addr        : std_logic_vector(10 downto 0);
+signal wb_data_w      : std_logic_vector(31 downto 0);
+signal wb_data_r      : std_logic_vector(31 downto 0);
+signal wb_cyc         : std_logic;
+signal wb_stb         : std_logic;
+signal wb_we          : std_logic;
+signal wb_ack         : std_logic;
+signal deskew         : std_logic_vector(g_CHANNEL_COUNT*64-1 downto 0);
+signal deskew_h       : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal deskew_l       : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal drop_rising    : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal drop_falling   : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal stop           : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal deadtime       : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal prescale       : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal ie             : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal hit            : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal ev             : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal irq            : std_logic;
+signal polarity       : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal raw            : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal mes            : std_logic_vector(g_CHANNEL_COUNT*64-1 downto 0);
+signal mes_h          : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal mes_l          : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal read           : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal fifo_lvl       : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal fifo_ovf       : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal fifo_pol       : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal fifo_raw       : std_logic_vector(g_CHANNEL_COUNT*16-1 downto 0);
+signal fifo_mes       : std_logic_vector(g_CHANNEL_COUNT*64-1 downto 0);
+signal fifo_mes_h     : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal fifo_mes_l     : std_logic_vector(g_CHANNEL_COUNT*32-1 downto 0);
+signal fifo_pop       : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal sel            : std_logic_vector(7 downto 0);
+signal hits           : std_logic_vector(31 downto 0);
+signal lost           : std_logic_vector(31 downto 0);
+signal rate           : std_logic_vector(31 downto 0);
+
+type t_counts is array(0 to g_CHANNEL_COUNT-1) of natural;
+signal read_count     : t_counts;
+signal pop_count      : t_counts;
+signal irq_count      : natural;
+signal irq_r          : std_logic;
+
+signal end_simulation : boolean := false;
+
+function f_hex(v : std_logic_vector(31 downto 0)) return string is
+constant c_DIGITS : string(1 to 16) := "0123456789abcdef";
+variable v_s      : string(1 to 10);
+begin
+    v_s(1 to 2) := "0x";
+    for i in 0 to 7 loop
+        v_s(3+i) := c_DIGITS(to_integer(unsigned(v(31-4*i downto 28-4*i)))+1);
+    end loop;
+    return v_s;
+end function;
+
+function f_word(base : natural; ch : natural) return std_logic_vector is
+begin
+    return std_logic_vector(to_unsigned(base + ch, 32));
+end function;
+
+begin
+    cmp_dut: tdc_chregs
+        generic map(
+            g_CHANNEL_COUNT => g_CHANNEL_COUNT
+        )
+        port map(
+            clk_i          => clk,
+            reset_i        => reset,
+            wb_addr_i      => wb_addr,
+            wb_data_i      => wb_data_w,
+            wb_data_o      => wb_data_r,
+            wb_cyc_i       => wb_cyc,
+            wb_stb_i       => wb_stb,
+            wb_we_i        => wb_we,
+            wb_ack_o       => wb_ack,
+            wb_irq_o       => irq,
+            irq_ev_i       => ev,
+            tdc_desh_o     => deskew_h,
+            tdc_desl_o     => deskew_l,
+            tdc_ctl_ris_o  => drop_rising,
+            tdc_ctl_fal_o  => drop_falling,
+            tdc_ctl_stop_o => stop,
+            tdc_ctl_ie_o   => ie,
+            tdc_hf_dt_o    => deadtime,
+            tdc_hf_psc_o   => prescale,
+            tdc_mpr_raw_i  => raw,
+            tdc_mpr_pol_i  => polarity,
+            tdc_mesh_i     => mes_h,
+            tdc_mesl_i     => mes_l,
+            tdc_mesl_rd_o  => read,
+            tdc_fst_lvl_i  => fifo_lvl,
+            tdc_fst_ovf_i  => fifo_ovf,
+            tdc_fpr_raw_i  => fifo_raw,
+            tdc_fpr_pol_i  => fifo_pol,
+            tdc_fmh_i      => fifo_mes_h,
+            tdc_fml_i      => fifo_mes_l,
+            tdc_fml_pop_o  => fifo_pop,
+            tdc_cnth_i     => hits,
+            tdc_cntl_i     => lost,
+            tdc_cntr_i     => rate,
+            sel_o          => sel
+        );
+    -- Masked by the interrupt enable bits, as in tdc_hostif.
+    ev <= hit and ie;
+    
+    -- Distinct input values for each channel.
+    g_inputs: for i in 0 to g_CHANNEL_COUNT-1 generate
+        deskew(i*64+63 downto i*64) <= deskew_h(i*32+31 downto i*32) & deskew_l(i*32+31 downto i*32);
+        mes_h(i*32+31 downto i*32) <= mes(i*64+63 downto i*64+32);
+        mes_l(i*32+31 downto i*32) <= mes(i*64+31 downto i*64);
+        fifo_mes_h(i*32+31 downto i*32) <= fifo_mes(i*64+63 downto i*64+32);
+        fifo_mes_l(i*32+31 downto i*32) <= fifo_mes(i*64+31 downto i*64);
+        polarity(i) <= '1' when i mod 2 = 1 else '0';
+        raw(i*16+15 downto i*16) <= std_logic_vector(to_unsigned(16#100#+i, 16));
+        mes(i*64+63 downto i*64) <= f_word(16#10000000#, i) & f_word(16#20000000#, i);
+        fifo_lvl(i*16+15 downto i*16) <= std_logic_vector(to_unsigned(i+1, 16));
+        fifo_ovf(i*16+15 downto i*16) <= std_logic_vector(to_unsigned(i+2, 16));
+        fifo_pol(i) <= '1' when i mod 2 = 0 else '0';
+        fifo_raw(i*16+15 downto i*16) <= std_logic_vector(to_unsigned(16#200#+i, 16));
+        fifo_mes(i*64+63 downto i*64) <= f_word(16#30000000#, i) & f_word(16#40000000#, i);
+    end generate;
+    
+    -- Model of the statistics counters, which present the selected channel
+    -- one cycle later.
+    process(clk)
+    begin
+        if rising_edge(clk) then
+            hits <= f_word(16#50000000#, to_integer(unsigned(sel)));
+            lost <= f_word(16#60000000#, to_integer(unsigned(sel)));
+            rate <= f_word(16#70000000#, to_integer(unsigned(sel)));
+        end if;
+    end process;
+    
+    -- Count the read and pop strobes, and the interrupt edges.
+    process(clk)
+    begin
+        if rising_edge(clk) then
+            if reset = '1' then
+                read_count <= (others => 0);
+                pop_count <= (others => 0);
+                irq_count <= 0;
+                irq_r <= '0';
+            else
+                for i in 0 to g_CHANNEL_COUNT-1 loop
+                    if read(i) = '1' then
+                        read_count(i) <= read_count(i) + 1;
+                    end if;
+                    if fifo_pop(i) = '1' then
+                        pop_count(i) <= pop_count(i) + 1;
+                    end if;
+                end loop;
+                irq_r <= irq;
+                if (irq = '1') and (irq_r = '0') then
+                    irq_count <= irq_count + 1;
+                end if;
+            end if;
+        end if;
+    end process;
+    
+    process
+    begin
+        clk <= '0';
+        wait for 4 ns;
+        clk <= '1';
+        wait for 4 ns;
+        if end_simulation then
+            wait;
+        end if;
+    end process;
+    
+    process
+    variable v_data : std_logic_vector(31 downto 0);
+    
+    procedure next_cycle is
+    begin
+        wait until rising_edge(clk);
+        wait for 1 ns;
+    end procedure;
+    
+    procedure wb_cycle(a : natural; we : std_logic; d : std_logic_vector(31 downto 0)) is
+    begin
+        wb_addr <= std_logic_vector(to_unsigned(a, 11));
+        wb_we <= we;
+        wb_data_w <= d;
+        wb_cyc <= '1';
+        wb_stb <= '1';
+        loop
+            next_cycle;
+            exit when wb_ack = '1';
+        end loop;
+        v_data := wb_data_r;
+        wb_cyc <= '0';
+        wb_stb <= '0';
+        next_cycle;
+    end procedure;
+    
+    procedure wb_write(a : natural; d : std_logic_vector(31 downto 0)) is
+    begin
+        wb_cycle(a, '1', d);
+    end procedure;
+    
+    procedure expect(a : natural; e : std_logic_vector(31 downto 0)) is
+    begin
+        wb_cycle(a, '0', x"00000000");
+        assert v_data = e
+            report "Address " & integer'image(a) & ": " & f_hex(v_data)
+                & " (expected " & f_hex(e) & ")"
+            severity failure;
+    end procedure;
+    
+    -- word address of a channel register
+    function f_reg(ch : natural; r : natural) return natural is
+    begin
+        return 16#400# + 16*ch + r;
+    end function;
+    
+    procedure check_channel(ch : natural) is
+    variable v_pr : std_logic_vector(31 downto 0);
+    begin
+        v_pr := x"00000000";
+        v_pr(16) := polarity(ch);
+        v_pr(15 downto 0) := raw(ch*16+15 downto ch*16);
+        expect(f_reg(ch, 4), v_pr);
+        expect(f_reg(ch, 5), f_word(16#10000000#, ch));
+        assert read_count(ch) = 0 report "MESH read pulsed read_o" severity failure;
+        expect(f_reg(ch, 6), f_word(16#20000000#, ch));
+        expect(f_reg(ch, 7), std_logic_vector(to_unsigned(ch+2, 16) & to_unsigned(ch+1, 16)));
+        v_pr(16) := fifo_pol(ch);
+        v_pr(15 downto 0) := fifo_raw(ch*16+15 downto ch*16);
+        expect(f_reg(ch, 8), v_pr);
+        expect(f_reg(ch, 9), f_word(16#30000000#, ch));
+        assert pop_count(ch) = 0 report "FMH read pulsed fifo_pop_o" severity failure;
+        expect(f_reg(ch, 10), f_word(16#40000000#, ch));
+        expect(f_reg(ch, 11), f_word(16#50000000#, ch));
+        expect(f_reg(ch, 12), f_word(16#60000000#, ch));
+        expect(f_reg(ch, 13), f_word(16#70000000#, ch));
+        expect(f_reg(ch, 14), x"00000000");
+        expect(f_reg(ch, 15), x"00000000");
+        for i in 0 to g_CHANNEL_COUNT-1 loop
+            if i = ch then
+                assert read_count(i) = 1 report "MESL read did not pulse read_o once" severity failure;
+                assert pop_count(i) = 1 report "FML read did not pulse fifo_pop_o once" severity failure;
+            else
+                assert read_count(i) = 0 report "read_o pulsed for wrong channel" severity failure;
+                assert pop_count(i) = 0 report "fifo_pop_o pulsed for wrong channel" severity failure;
+            end if;
+        end loop;
+    end procedure;
+    
+    procedure pulse_reset is
+    begin
+        reset <= '1';
+        next_cycle;
+        reset <= '0';
+        next_cycle;
+    end procedure;
+    
+    variable v_last : natural;
+    begin
+        wb_addr <= (others => '0');
+        wb_data_w <= (others => '0');
+        wb_cyc <= '0';
+        wb_stb <= '0';
+        wb_we <= '0';
+        hit <= (others => '0');
+        pulse_reset;
+        
+        v_last := g_CHANNEL_COUNT-1;
+        
+        -- Configuration registers.
+        for ch in 0 to g_CHANNEL_COUNT-1 loop
+            if (ch = 0) or (ch = 3) or (ch = v_last) then
+                wb_write(f_reg(ch, 0), f_word(16#01000000#, ch));
+                wb_write(f_reg(ch, 1), f_word(16#02000000#, ch));
+                wb_write(f_reg(ch, 2), x"ffffff05");
+                wb_write(f_reg(ch, 3), f_word(16#00030000#, ch));
+            end if;
+        end loop;
+        for ch in 0 to g_CHANNEL_COUNT-1 loop
+            if (ch = 0) or (ch = 3) or (ch = v_last) then
+                expect(f_reg(ch, 0), f_word(16#01000000#, ch));
+                expect(f_reg(ch, 1), f_word(16#02000000#, ch));
+                expect(f_reg(ch, 2), x"00000005");
+                expect(f_reg(ch, 3), f_word(16#00030000#, ch));
+                assert deskew(ch*64+63 downto ch*64) = f_word(16#01000000#, ch) & f_word(16#02000000#, ch)
+                    report "Wrong deskew output" severity failure;
+                assert (drop_rising(ch) = '1') and (drop_falling(ch) = '0') and (stop(ch) = '1')
+                    report "Wrong control outputs" severity failure;
+                assert deadtime(ch*16+15 downto ch*16) = std_logic_vector(to_unsigned(ch, 16))
+                    report "Wrong dead time output" severity failure;
+                assert prescale(ch*16+15 downto ch*16) = x"0003"
+                    report "Wrong prescaler output" severity failure;
+            else
+                assert deskew(ch*64+63 downto ch*64) = (63 downto 0 => '0')
+                    report "Deskew of another channel written" severity failure;
+                assert (drop_rising(ch) = '0') and (drop_falling(ch) = '0') and (stop(ch) = '0')
+                    report "Control of another channel written" severity failure;
+            end if;
+        end loop;
+        expect(f_reg(1, 0), x"00000000");
+        expect(f_reg(1, 2), x"00000000");
+        
+        -- Channels above g_CHANNEL_COUNT.
+        if g_CHANNEL_COUNT < 64 then
+            wb_write(f_reg(63, 0), x"12345678");
+            expect(f_reg(63, 0), x"00000000");
+            expect(f_reg(g_CHANNEL_COUNT, 6), x"00000000");
+        end if;
+        
+        -- Read-only registers, and read/pop strobes.
+        check_channel(v_last);
+        pulse_reset;
+        check_channel(5);
+        
+        -- The reset clears the configuration.
+        expect(f_reg(3, 0), x"00000000");
+        expect(f_reg(3, 2), x"00000000");
+        
+        -- Event pending registers and interrupt.
+        wb_write(f_reg(3, 2), x"00000008");
+        wb_write(f_reg(v_last, 2), x"00000008");
+        hit(3) <= '1';
+        hit(4) <= '1';
+        next_cycle;
+        hit <= (others => '0');
+        hit(v_last) <= '1';
+        next_cycle;
+        hit <= (others => '0');
+        next_cycle;
+        next_cycle;
+        assert irq_count = 2
+            report "Interrupt edges: " & integer'image(irq_count) & " (expected 2)"
+            severity failure;
+        if v_last < 32 then
+            expect(16#40#, x"00000008" or std_logic_vector(shift_left(to_unsigned(1, 32), v_last)));
+        else
+            expect(16#40#, x"00000008");
+            expect(16#41#, std_logic_vector(shift_left(to_unsigned(1, 32), v_last-32)));
+        end if;
+        -- Only words 0x40 and 0x41 are decoded.
+        wb_write(16#42#, x"ffffffff");
+        wb_write(16#43#, x"ffffffff");
+        wb_write(16#7f#, x"ffffffff");
+        wb_write(16#140#, x"ffffffff");
+        wb_write(16#341#, x"ffffffff");
+        expect(16#42#, x"00000000");
+        expect(16#140#, x"00000000");
+        expect(16#341#, x"00000000");
+        if v_last < 32 then
+            expect(16#40#, x"00000008" or std_logic_vector(shift_left(to_unsigned(1, 32), v_last)));
+        else
+            expect(16#40#, x"00000008");
+            expect(16#41#, std_logic_vector(shift_left(to_unsigned(1, 32), v_last-32)));
+        end if;
+        wb_write(16#40#, x"00000008");
+        wb_write(16#41#, x"ffffffff");
+        if v_last < 32 then
+            expect(16#40#, std_logic_vector(shift_left(to_unsigned(1, 32), v_last)));
+            wb_write(16#40#, x"ffffffff");
+        end if;
+        expect(16#40#, x"00000000");
+        expect(16#41#, x"00000000");
+        
+        report "Test passed.";
+        end_simulation <= true;
+        wait;
+    end process;
+end architecture;
@@ -0,0 +1,5 @@
+#!/bin/sh
+set -e
+ghdl -i ../../hostif/tdc_hostif_package.vhd ../../hostif/tdc_chstat.vhd tb_chstat.vhd
+ghdl -m tb_chstat
+ghdl -r tb_chstat
@@ -0,0 +1,208 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tb_chstat
+--
+-- author: agent, agent@local
+--
+-- description: Test bench for the channel statistics counters
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- This test sends transitions on 3 channels and verifies the counters:
+--  * channel 0 is read after each of its g_HITS transitions, and must not
+--    count any lost event;
+--  * channel 1 is read once every 4 transitions, and must count 3 lost
+--    events for each read, except when the read and the transition occur
+--    in the same cycle;
+--  * with a gate period of g_GATE cycles, channels 0, 1 and 2 receive one
+--    transition every 4 cycles, 5 cycles and every cycle without being
+--    read, and the rate meters must report g_GATE/4, g_GATE/5 and g_GATE
+--    transitions.
+-- It also verifies that an out of range channel reads as 0, and that
+-- stopping the rate meter clears its results.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tb_chstat is
+    generic(
+        g_HITS : positive := 20;
+        g_GATE : positive := 100
+    );
+end entity;
+
+architecture tb of tb_chstat is
+
+constant c_CHANNEL_COUNT : positive := 3;
+
+signal clk   : std_logic;
+signal reset : std_logic;
+signal gate  : std_logic_vector(31 downto 0);
+signal hit   : std_logic_vector(c_CHANNEL_COUNT-1 downto 0);
+signal read  : std_logic_vector(c_CHANNEL_COUNT-1 downto 0);
+signal sel   : std_logic_vector(7 downto 0);
+signal hits  : std_logic_vector(31 downto 0);
+signal lost  : std_logic_vector(31 downto 0);
+signal rate  : std_logic_vector(31 downto 0);
+
+signal end_simulation : boolean := false;
+
+begin
+    cmp_dut: tdc_chstat
+        generic map(
+            g_CHANNEL_COUNT => c_CHANNEL_COUNT
+        )
+        port map(
+            clk_i   => clk,
+            reset_i => reset,
+            gate_i  => gate,
+            hit_i   => hit,
+            read_i  => read,
+            sel_i   => sel,
+            hits_o  => hits,
+            lost_o  => lost,
+            rate_o  => rate
+        );
+    
+    process
+    begin
+        clk <= '0';
+        wait for 4 ns;
+        clk <= '1';
+        wait for 4 ns;
+        if end_simulation then
+            wait;
+        end if;
+    end process;
+    
+    process
+    procedure next_cycle is
+    begin
+        wait until rising_edge(clk);
+        wait for 1 ns;
+    end procedure;
+    
+    procedure expect(ch : natural; e_hits : natural; e_lost : natural; e_rate : natural) is
+    begin
+        sel <= std_logic_vector(to_unsigned(ch, 8));
+        next_cycle;
+        next_cycle;
+        assert to_integer(unsigned(hits)) = e_hits
+            report "Channel " & integer'image(ch) & ": hit count "
+                & integer'image(to_integer(unsigned(hits)))
+                & " (expected " & integer'image(e_hits) & ")"
+            severity failure;
+        assert to_integer(unsigned(lost)) = e_lost
+            report "Channel " & integer'image(ch) & ": lost event count "
+                & integer'image(to_integer(unsigned(lost)))
+                & " (expected " & integer'image(e_lost) & ")"
+            severity failure;
+        assert to_integer(unsigned(rate)) = e_rate
+            report "Channel " & integer'image(ch) & ": rate "
+                & integer'image(to_integer(unsigned(rate)))
+                & " (expected " & integer'image(e_rate) & ")"
+            severity failure;
+    end procedure;
+    begin
+        gate <= (others => '0');
+        hit <= (others => '0');
+        read <= (others => '0');
+        sel <= (others => '0');
+        reset <= '1';
+        next_cycle;
+        reset <= '0';
+        next_cycle;
+        expect(0, 0, 0, 0);
+        
+        -- Channel 0 is read after each transition.
+        for i in 1 to g_HITS loop
+            hit(0) <= '1';
+            next_cycle;
+            hit(0) <= '0';
+            next_cycle;
+            read(0) <= '1';
+            next_cycle;
+            read(0) <= '0';
+        end loop;
+        expect(0, g_HITS, 0, 0);
+        
+        -- Channel 1 is read once every 4 transitions.
+        for i in 1 to g_HITS loop
+            hit(1) <= '1';
+            next_cycle;
+            hit(1) <= '0';
+            if i mod 4 = 0 then
+                read(1) <= '1';
+                next_cycle;
+                read(1) <= '0';
+            end if;
+        end loop;
+        expect(1, g_HITS, 3*(g_HITS/4), 0);
+        
+        -- A read in the same cycle as a transition gets the previous data.
+        hit(1) <= '1';
+        next_cycle;
+        hit(1) <= '1';
+        read(1) <= '1';
+        next_cycle;
+        hit(1) <= '0';
+        read(1) <= '0';
+        expect(1, g_HITS+2, 3*(g_HITS/4), 0);
+        hit(1) <= '1';
+        next_cycle;
+        hit(1) <= '0';
+        expect(1, g_HITS+3, 3*(g_HITS/4)+1, 0);
+        
+        -- Out of range channel.
+        expect(c_CHANNEL_COUNT, 0, 0, 0);
+        
+        -- Rate meter.
+        gate <= std_logic_vector(to_unsigned(g_GATE, 32));
+        for i in 0 to 3*g_GATE-1 loop
+            if i mod 4 = 0 then
+                hit(0) <= '1';
+            end if;
+            if i mod 5 = 0 then
+                hit(1) <= '1';
+            end if;
+            hit(2) <= '1';
+            next_cycle;
+            hit <= (others => '0');
+        end loop;
+        expect(0, g_HITS+3*g_GATE/4, 3*g_GATE/4-1, g_GATE/4);
+        expect(1, g_HITS+3+3*g_GATE/5, 3*(g_HITS/4)+1+3*g_GATE/5, g_GATE/5);
+        expect(2, 3*g_GATE, 3*g_GATE-1, g_GATE);
+        
+        -- Stopping the rate meter clears its results.
+        gate <= (others => '0');
+        next_cycle;
+        expect(2, 3*g_GATE, 3*g_GATE-1, 0);
+        
+        report "Test passed.";
+        end_simulation <= true;
+        wait;
+    end process;
+end architecture;
@@ -1,5 +1,9 @@
 #!/bin/sh
 set -e
-ghdl -i ../../core/tdc_package.vhd ../../core/tdc_divider.vhd ../../core/tdc_controller.vhd tb_controller.vhd
+ghdl -i ../../core/tdc_package.vhd ../../core/tdc_divider.vhd ../../core/tdc_hisbook.vhd ../../core/tdc_controller.vhd tb_controller.vhd
 ghdl -m tb_controller
 ghdl -r tb_controller
+ghdl -r tb_controller -gg_CHANNEL_COUNT=8
+ghdl -r tb_controller -gg_CHANNEL_COUNT=8 -gg_CONCURRENT_SC=true
+ghdl -r tb_controller -gg_CHANNEL_COUNT=8 -gg_SCALED_OC=true
+ghdl -r tb_controller -gg_CHANNEL_COUNT=2 -gg_FREQ=0
@@ -12,6 +12,12 @@
 --
 -------------------------------------------------------------------------------
 -- last changes:
+-- 2026-10-18 agent Added zero frequency case
+-- 2026-10-18 agent Added scaled online calibration
+-- 2026-10-18 agent Model the double-buffered LUT
+-- 2026-10-18 agent Measure the online calibration period
+-- 2026-10-18 agent Added multiple channels and concurrent startup calibration
+-- 2026-10-18 agent Added extra histogram bits, check LUT against exact model
 -- 2011-08-26 SB Created file
 -------------------------------------------------------------------------------
 
@@ -35,22 +41,53 @@
 -- stamps into the controller.
 -- 3. The test bench provides a model of the histogram memory to the
 -- controller. Because of the continuously incrementing time stamps provided by
--- the test bench, the controller books a histogram with the same
--- 2^(g_FP_COUNT-g_RAW_COUNT) value everywhere.
+-- the test bench, the controller books a histogram with nearly the same
+-- 2^(g_FP_COUNT+g_EXHIS_COUNT-g_RAW_COUNT) value everywhere.
 -- 4. The controller reads the frequency of the calibration ring oscillator,
--- and the test bench returns 1.
+-- and the test bench returns 1. The test bench checks that the controller
+-- only stores a measurement that it started after the previous store, and
+-- that has completed.
 -- 5. The controller performs a first round of online calibration. It reads
--- again the frequency of the ring oscillator, and the test bench returns 2.
--- This means that all delays should be halved.
+-- again the frequency of the ring oscillator, and the test bench returns
+-- g_FREQ (2 by default). This means that all delays should be halved.
 -- 6. The controller builds the LUT. The test bench provides a model of the
--- memory for this purpose.
+-- memory for this purpose, with an active and a shadow bank. The controller
+-- must write the shadow bank only, and then swap the banks.
 -- 7. The controller asserts the ready signal, and this terminates the
 -- simulation.
 --
--- The test bench then verifies that the LUT entries from i = 1 to 
--- i = 2^g_RAW_COUNT-1 all have the correct value, and reports a failed
--- assertion otherwise:
--- LUT(i) = 1/2 * (i-1) * 2^(g_FP_COUNT-g_RAW_COUNT)
+-- The test bench then verifies that all LUT entries have the value computed
+-- from the booked histogram, and reports a failed assertion otherwise:
+-- LUT(i) = min(floor((S(i)/2^g_EXHIS_COUNT)*sfreq/freq), 2^g_FP_COUNT-1)
+-- where S(i) is the sum of the histogram bins below i. This is approximately
+-- 1/2 * i * 2^(g_FP_COUNT-g_RAW_COUNT). With g_FREQ set to 0, all LUT entries
+-- must be saturated to 2^g_FP_COUNT-1.
+--
+-- The HIS WR and LUT WR reports can also be checked against the C model of
+-- the calibration datapath with demo/tools/calcheck. They are only produced
+-- with a single channel.
+--
+-- With g_CHANNEL_COUNT greater than 1, the test bench also models the
+-- channel selection and the per-channel histogram and LUT memories, and the
+-- controller performs steps 2 to 6 for each channel. All channels receive
+-- the same pulses. With g_CONCURRENT_SC, the histograms are booked by one
+-- tdc_hisbook engine per channel, as in the multi-channel bank.
+-- The test bench reports the number of clock cycles needed to complete the
+-- startup calibration of all channels, which can be compared between runs
+-- with and without g_CONCURRENT_SC.
+--
+-- Finally, the test bench measures the number of clock cycles taken by the
+-- online calibration of one channel, and verifies that the controller writes
+-- one LUT entry per cycle and swaps the LUT banks once, after the last write.
+-- With the real frequency counter, the measurement time (2^g_FTIMER_WIDTH
+-- cycles) must be added to this figure.
+--
+-- With g_SCALED_OC, the test bench also models the per-channel scale
+-- registers, and verifies the LUT values after scaling by the channel,
+-- floor(LUT(i)*R/2^(g_FP_COUNT+g_FCOUNTER_WIDTH)) saturated to
+-- 2^g_FP_COUNT-1, against the same formula. It then verifies that the
+-- following online calibration round only loads the scale register of the
+-- channel, without rewriting the LUT.
 
 library ieee;
 use ieee.std_logic_1164.all;
@@ -63,7 +100,14 @@ entity tb_controller is
     generic(
         g_RAW_COUNT      : positive := 3;
         g_FP_COUNT       : positive := 5;
-        g_FCOUNTER_WIDTH : positive := 3
+        g_EXHIS_COUNT    : positive := 2;
+        g_FCOUNTER_WIDTH : positive := 3;
+        g_CHANNEL_COUNT  : positive := 1;
+        g_CONCURRENT_SC  : boolean := false;
+        g_SCALED_OC      : boolean := false;
+        -- Frequency returned for online calibration. Must be 1 or more with
+        -- g_SCALED_OC.
+        g_FREQ           : natural := 2
     );
 end entity;
 
@@ -78,12 +122,16 @@ signal calib_sel  : std_logic;
 signal lut_a      : std_logic_vector(g_RAW_COUNT-1 downto 0);
 signal lut_we     : std_logic;
 signal lut_d_w    : std_logic_vector(g_FP_COUNT-1 downto 0);
+signal lut_shadow : std_logic;
+signal lut_swap   : std_logic;
+signal scale_we   : std_logic;
+signal scale_d    : std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
 signal c_detect   : std_logic;
 signal c_raw      : std_logic_vector(g_RAW_COUNT-1 downto 0) := (others => '0');
 signal his_a      : std_logic_vector(g_RAW_COUNT-1 downto 0);
 signal his_we     : std_logic;
-signal his_d_w    : std_logic_vector(g_FP_COUNT-1 downto 0);
-signal his_d_r    : std_logic_vector(g_FP_COUNT-1 downto 0);
+signal his_d_w    : std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+signal his_d_r    : std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
 signal oc_start   : std_logic;
 signal oc_ready   : std_logic;
 signal oc_freq    : std_logic_vector(g_FCOUNTER_WIDTH-1 downto 0);
@@ -91,10 +139,23 @@ signal oc_store   : std_logic;
 signal oc_sfreq   : std_logic_vector(g_FCOUNTER_WIDTH-1 downto 0);
 signal freeze_req : std_logic;
 signal freeze_ack : std_logic;
+signal sc_all     : std_logic;
+signal sc_book    : std_logic;
+signal sc_done    : std_logic;
+signal cs_channel : natural range 0 to g_CHANNEL_COUNT-1;
 
-type t_ctlmem is array(0 to 2**g_RAW_COUNT-1) of std_logic_vector(g_FP_COUNT-1 downto 0);
-signal his_memory: t_ctlmem;
-signal lut_memory: t_ctlmem;
+type t_hismem is array(0 to 2**g_RAW_COUNT-1) of std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+type t_lutmem is array(0 to 2**g_RAW_COUNT-1) of std_logic_vector(g_FP_COUNT-1 downto 0);
+type t_hismems is array(0 to g_CHANNEL_COUNT-1) of t_hismem;
+type t_lutmems is array(0 to g_CHANNEL_COUNT-1) of t_lutmem;
+type t_scales is array(0 to g_CHANNEL_COUNT-1) of std_logic_vector(g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
+type t_hisq is array(0 to g_CHANNEL_COUNT-1) of std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+signal his_memory : t_hismems;
+signal lut_memory : t_lutmems;
+signal lut_shadow_memory : t_lutmems;
+signal scale_memory : t_scales;
+signal his_q      : t_hisq;
+signal his_done   : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
 
 signal end_simulation : boolean := false;
 
@@ -103,7 +164,10 @@ begin
         generic map(
             g_RAW_COUNT      => g_RAW_COUNT,
             g_FP_COUNT       => g_FP_COUNT,
-            g_FCOUNTER_WIDTH => g_FCOUNTER_WIDTH
+            g_EXHIS_COUNT    => g_EXHIS_COUNT,
+            g_FCOUNTER_WIDTH => g_FCOUNTER_WIDTH,
+            g_CONCURRENT_SC  => g_CONCURRENT_SC,
+            g_SCALED_OC      => g_SCALED_OC
         )
         port map(
             clk_i        => clk,
@@ -115,12 +179,19 @@ begin
             lut_a_o      => lut_a,
             lut_we_o     => lut_we,
             lut_d_o      => lut_d_w,
+            lut_shadow_o => lut_shadow,
+            lut_swap_o   => lut_swap,
+            scale_we_o   => scale_we,
+            scale_d_o    => scale_d,
             c_detect_i   => c_detect,
             c_raw_i      => c_raw,
             his_a_o      => his_a,
             his_we_o     => his_we,
             his_d_o      => his_d_w,
             his_d_i      => his_d_r,
+            sc_all_o     => sc_all,
+            sc_book_o    => sc_book,
+            sc_done_i    => sc_done,
             oc_start_o   => oc_start,
             oc_ready_i   => oc_ready,
             oc_freq_i    => oc_freq,
@@ -143,26 +214,80 @@ begin
     end process;
     
     -- histogram memory
-    process(clk)
+    g_his: for i in 0 to g_CHANNEL_COUNT-1 generate
+    signal ram_a    : std_logic_vector(g_RAW_COUNT-1 downto 0);
+    signal ram_we   : std_logic;
+    signal ram_d_w  : std_logic_vector(g_FP_COUNT+g_EXHIS_COUNT-1 downto 0);
+    signal this_sel : std_logic;
     begin
-        if rising_edge(clk) then
-            if his_we = '1' then
-                report "HIS WR: addr=" & integer'image(to_integer(unsigned(his_a)))
-                    & " data=" & integer'image(to_integer(unsigned(his_d_w)));
-                his_memory(to_integer(unsigned(his_a))) <= his_d_w;
+        this_sel <= '1' when (cs_channel = i) or (sc_all = '1') else '0';
+        g_concurrent: if g_CONCURRENT_SC generate
+            cmp_hisbook: tdc_hisbook
+                generic map(
+                    g_RAW_COUNT   => g_RAW_COUNT,
+                    g_FP_COUNT    => g_FP_COUNT,
+                    g_EXHIS_COUNT => g_EXHIS_COUNT
+                )
+                port map(
+                    clk_i    => clk,
+                    reset_i  => reset,
+                    book_i   => sc_book,
+                    done_o   => his_done(i),
+                    sel_i    => this_sel,
+                    his_a_i  => his_a,
+                    his_we_i => his_we,
+                    his_d_i  => his_d_w,
+                    detect_i => c_detect,
+                    raw_i    => c_raw,
+                    ram_a_o  => ram_a,
+                    ram_we_o => ram_we,
+                    ram_d_o  => ram_d_w,
+                    ram_d_i  => his_q(i)
+                );
+        end generate;
+        g_sequential: if not g_CONCURRENT_SC generate
+            ram_a <= his_a;
+            ram_we <= his_we and this_sel;
+            ram_d_w <= his_d_w;
+            his_done(i) <= '0';
+        end generate;
+        
+        process(clk)
+        begin
+            if rising_edge(clk) then
+                if ram_we = '1' then
+                    if g_CHANNEL_COUNT = 1 then
+                        report "HIS WR: addr=" & integer'image(to_integer(unsigned(ram_a)))
+                            & " data=" & integer'image(to_integer(unsigned(ram_d_w)));
+                    end if;
+                    his_memory(i)(to_integer(unsigned(ram_a))) <= ram_d_w;
+                end if;
+                his_q(i) <= his_memory(i)(to_integer(unsigned(ram_a)));
             end if;
-            his_d_r <= his_memory(to_integer(unsigned(his_a)));
-        end if;
-    end process;
+        end process;
+    end generate;
+    his_d_r <= his_q(cs_channel);
+    sc_done <= '1' when (his_done = (his_done'range => '1')) else '0';
     
     -- LUT memory
     process(clk)
     begin
         if rising_edge(clk) then
             if lut_we = '1' then
-                report "LUT WR: addr=" & integer'image(to_integer(unsigned(lut_a)))
-                    & " data=" & integer'image(to_integer(unsigned(lut_d_w)));
-                lut_memory(to_integer(unsigned(lut_a))) <= lut_d_w;
+                if g_CHANNEL_COUNT = 1 then
+                    report "LUT WR: addr=" & integer'image(to_integer(unsigned(lut_a)))
+                        & " data=" & integer'image(to_integer(unsigned(lut_d_w)));
+                end if;
+                assert lut_shadow = '1'
+                    report "LUT write to the active bank" severity failure;
+                lut_shadow_memory(cs_channel)(to_integer(unsigned(lut_a))) <= lut_d_w;
+            end if;
+            if lut_swap = '1' then
+                lut_memory(cs_channel) <= lut_shadow_memory(cs_channel);
+                lut_shadow_memory(cs_channel) <= lut_memory(cs_channel);
+            end if;
+            if scale_we = '1' then
+                scale_memory(cs_channel) <= scale_d;
             end if;
         end if;
     end process;
@@ -181,51 +306,156 @@ begin
     
     -- frequency counter
     process(clk)
+    variable v_measured: boolean := false;
     begin
         if rising_edge(clk) then
             oc_ready <= '1';
             if oc_start = '1' then
                 report "FRC: start measurement";
                 oc_ready <= '0';
+                v_measured := true;
             end if;
             if oc_store = '1' then
                 report "FRC: store measurement";
+                assert v_measured and (oc_ready = '1')
+                    report "Frequency stored without a new measurement" severity failure;
+                v_measured := false;
             end if;
         end if;
     end process;
-    -- this should divide by 2.
-    oc_freq <= (1 => '1', others => '0');
+    -- this should divide by g_FREQ.
+    oc_freq <= std_logic_vector(to_unsigned(g_FREQ, g_FCOUNTER_WIDTH));
     oc_sfreq <= (0 => '1', others => '0');
 
     -- channel mux
     process(clk)
     begin
         if rising_edge(clk) then
-            if cs_next = '1' then
+            if reset = '1' then
+                cs_channel <= 0;
+            elsif cs_next = '1' then
                 report "Next channel";
+                if cs_channel = g_CHANNEL_COUNT-1 then
+                    cs_channel <= 0;
+                else
+                    cs_channel <= cs_channel + 1;
+                end if;
             end if;
         end if;
     end process;
-    cs_last <= '1';
+    cs_last <= '1' when cs_channel = g_CHANNEL_COUNT-1 else '0';
     
     process
-    variable v_bin_width: integer;
-    variable v_step: integer;
+    variable v_acc: integer;
+    variable v_expected: integer;
+    variable v_cycles: natural;
+    variable v_stores: natural;
+    variable v_writes: natural;
+    variable v_first: natural;
+    variable v_last: natural;
+    variable v_swaps: natural;
+    variable v_scales: natural;
+    variable v_value: integer;
+    variable v_scaled: unsigned(2*g_FP_COUNT+2*g_FCOUNTER_WIDTH-1 downto 0);
     begin
         reset <= '1';
         wait until rising_edge(clk);
         reset <= '0';
         wait until rising_edge(clk);
         
+        -- startup calibration ends with the last frequency store
+        v_cycles := 1;
+        v_stores := 0;
+        while v_stores < g_CHANNEL_COUNT loop
+            wait until rising_edge(clk);
+            v_cycles := v_cycles + 1;
+            if oc_store = '1' then
+                v_stores := v_stores + 1;
+            end if;
+        end loop;
+        report "Startup calibration of " & integer'image(g_CHANNEL_COUNT)
+            & " channel(s) completed in " & integer'image(v_cycles) & " cycles";
+        
         wait until ready = '1';
         
         -- verify written LUT contents
-        v_bin_width := 2**(g_FP_COUNT-g_RAW_COUNT);
-        v_step := v_bin_width/2; -- divided by 2 by online calibration (see frequencies above)
-        for i in 1 to 2**g_RAW_COUNT-1 loop
-            assert to_integer(unsigned(lut_memory(i))) = v_step*(i-1) severity failure;
+        for c in 0 to g_CHANNEL_COUNT-1 loop
+            v_acc := 0;
+            for i in 0 to 2**g_RAW_COUNT-1 loop
+                if g_FREQ = 0 then
+                    v_expected := 2**g_FP_COUNT-1;
+                else
+                    v_expected := (v_acc/2**g_EXHIS_COUNT)*to_integer(unsigned(oc_sfreq))
+                        /to_integer(unsigned(oc_freq));
+                end if;
+                if v_expected > 2**g_FP_COUNT-1 then
+                    v_expected := 2**g_FP_COUNT-1;
+                end if;
+                if g_SCALED_OC then
+                    v_scaled := shift_right(unsigned(lut_memory(c)(i))
+                        * unsigned(scale_memory(c)), g_FP_COUNT+g_FCOUNTER_WIDTH);
+                    if v_scaled > 2**g_FP_COUNT-1 then
+                        v_value := 2**g_FP_COUNT-1;
+                    else
+                        v_value := to_integer(v_scaled);
+                    end if;
+                else
+                    v_value := to_integer(unsigned(lut_memory(c)(i)));
+                end if;
+                assert v_value = v_expected
+                    report "LUT mismatch on channel " & integer'image(c)
+                    severity failure;
+                v_acc := v_acc + to_integer(unsigned(his_memory(c)(i)));
+            end loop;
         end loop;
         
+        -- measure the online calibration period
+        wait until rising_edge(clk) and (oc_start = '1');
+        v_cycles := 0;
+        v_writes := 0;
+        v_first := 0;
+        v_last := 0;
+        v_swaps := 0;
+        v_scales := 0;
+        loop
+            wait until rising_edge(clk);
+            v_cycles := v_cycles + 1;
+            exit when oc_start = '1';
+            if lut_we = '1' then
+                if v_writes = 0 then
+                    v_first := v_cycles;
+                end if;
+                v_last := v_cycles;
+                v_writes := v_writes + 1;
+                assert v_swaps = 0
+                    report "LUT write after bank swap" severity failure;
+            end if;
+            if lut_swap = '1' then
+                v_swaps := v_swaps + 1;
+            end if;
+            if scale_we = '1' then
+                v_scales := v_scales + 1;
+            end if;
+        end loop;
+        if g_SCALED_OC then
+            report "Online calibration of one channel completed in "
+                & integer'image(v_cycles) & " cycles";
+            assert (v_writes = 0) and (v_swaps = 0)
+                report "LUT rewritten in scaled mode" severity failure;
+            assert v_scales = 1
+                report "Scale register not loaded once" severity failure;
+        else
+            report "Online calibration of one channel completed in "
+                & integer'image(v_cycles) & " cycles, LUT written in "
+                & integer'image(v_last - v_first + 1) & " cycles";
+            assert v_writes = 2**g_RAW_COUNT
+                report "Wrong number of LUT writes" severity failure;
+            assert v_last - v_first = 2**g_RAW_COUNT-1
+                report "LUT not written at one entry per cycle" severity failure;
+            assert v_swaps = 1
+                report "LUT banks not swapped once" severity failure;
+        end if;
+        
         report "Test passed.";
         end_simulation <= true;
         wait;
@@ -0,0 +1,5 @@
+#!/bin/sh
+set -e
+ghdl -i ../../hostif/tdc_hostif_package.vhd ../../hostif/tdc_dhist.vhd tb_dhist.vhd
+ghdl -m tb_dhist
+ghdl -r tb_dhist
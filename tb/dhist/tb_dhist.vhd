@@ -0,0 +1,238 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tb_dhist
+--
+-- author: agent, agent@local
+--
+-- description: Test bench for the time difference histogrammer
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- This test sends g_VALUES random values to the histogrammer, one per cycle
+-- with random gaps, and compares the histogram it reads back with a model.
+-- The values follow a narrow distribution, so that consecutive values often
+-- fall into the same bin and exercise the read-modify-write forwarding, and
+-- some of them fall outside of the histogram on both sides.
+--
+-- The test is run with several bin widths and offsets. Between runs, the
+-- histogram is cleared, and the test bench verifies that all bins and the
+-- outside count read back as 0. It also verifies that values sent while the
+-- histogram is frozen are ignored.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+use ieee.math_real.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tb_dhist is
+    generic(
+        g_DEPTH  : positive := 64;
+        g_VALUES : positive := 5000
+    );
+end entity;
+
+architecture tb of tb_dhist is
+
+signal clk     : std_logic;
+signal reset   : std_logic;
+signal clear   : std_logic;
+signal busy    : std_logic;
+signal freeze  : std_logic;
+signal offset  : std_logic_vector(31 downto 0);
+signal shift   : std_logic_vector(4 downto 0);
+signal valid   : std_logic;
+signal value   : std_logic_vector(31 downto 0);
+signal rd_a    : std_logic_vector(15 downto 0);
+signal rd_d    : std_logic_vector(31 downto 0);
+signal outside : std_logic_vector(31 downto 0);
+
+signal end_simulation : boolean := false;
+
+type t_model is array(0 to g_DEPTH-1) of natural;
+
+begin
+    cmp_dut: tdc_dhist
+        generic map(
+            g_DEPTH => g_DEPTH
+        )
+        port map(
+            clk_i     => clk,
+            reset_i   => reset,
+            clear_i   => clear,
+            busy_o    => busy,
+            freeze_i  => freeze,
+            offset_i  => offset,
+            shift_i   => shift,
+            valid_i   => valid,
+            value_i   => value,
+            rd_a_i    => rd_a,
+            rd_d_o    => rd_d,
+            outside_o => outside
+        );
+    
+    process
+    begin
+        clk <= '0';
+        wait for 4 ns;
+        clk <= '1';
+        wait for 4 ns;
+        if end_simulation then
+            wait;
+        end if;
+    end process;
+    
+    process
+    variable v_seed1   : positive := 12;
+    variable v_seed2   : positive := 345;
+    variable v_rand    : real;
+    variable v_value   : integer;
+    variable v_bin     : integer;
+    variable v_model   : t_model;
+    variable v_outside : natural;
+    
+    procedure next_cycle is
+    begin
+        wait until rising_edge(clk);
+        wait for 1 ns;
+    end procedure;
+    
+    procedure do_clear is
+    begin
+        clear <= '1';
+        next_cycle;
+        clear <= '0';
+        while busy = '1' loop
+            next_cycle;
+        end loop;
+        v_model := (others => 0);
+        v_outside := 0;
+    end procedure;
+    
+    -- Freezes the histogram and compares it with the model.
+    procedure check is
+    begin
+        freeze <= '1';
+        next_cycle;
+        next_cycle;
+        next_cycle;
+        for i in 0 to g_DEPTH-1 loop
+            rd_a <= std_logic_vector(to_unsigned(i, 16));
+            next_cycle;
+            next_cycle;
+            assert to_integer(unsigned(rd_d)) = v_model(i)
+                report "Bin " & integer'image(i) & ": "
+                    & integer'image(to_integer(unsigned(rd_d)))
+                    & " (expected " & integer'image(v_model(i)) & ")"
+                severity failure;
+        end loop;
+        assert to_integer(unsigned(outside)) = v_outside
+            report "Outside count: " & integer'image(to_integer(unsigned(outside)))
+                & " (expected " & integer'image(v_outside) & ")"
+            severity failure;
+        freeze <= '0';
+        next_cycle;
+    end procedure;
+    
+    procedure run(off : integer; sh : natural) is
+    variable v_center : integer;
+    begin
+        offset <= std_logic_vector(to_signed(off, 32));
+        shift <= std_logic_vector(to_unsigned(sh, 5));
+        v_center := off + g_DEPTH*2**sh/2;
+        next_cycle;
+        for i in 1 to g_VALUES loop
+            uniform(v_seed1, v_seed2, v_rand);
+            if v_rand < 0.2 then
+                valid <= '0';
+            else
+                -- sum of two uniforms, slightly wider than the histogram
+                uniform(v_seed1, v_seed2, v_rand);
+                v_value := integer(v_rand*real(g_DEPTH*2**sh)*0.6);
+                uniform(v_seed1, v_seed2, v_rand);
+                v_value := v_value + integer(v_rand*real(g_DEPTH*2**sh)*0.6);
+                v_value := v_center + v_value - integer(real(g_DEPTH*2**sh)*0.6);
+                valid <= '1';
+                value <= std_logic_vector(to_signed(v_value, 32));
+                if v_value < off then
+                    v_outside := v_outside + 1;
+                else
+                    v_bin := (v_value - off)/2**sh;
+                    if v_bin >= g_DEPTH then
+                        v_outside := v_outside + 1;
+                    else
+                        v_model(v_bin) := v_model(v_bin) + 1;
+                    end if;
+                end if;
+            end if;
+            next_cycle;
+        end loop;
+        valid <= '0';
+        next_cycle;
+        next_cycle;
+        next_cycle;
+        check;
+        report "Offset " & integer'image(off) & ", bin width " & integer'image(2**sh)
+            & ": " & integer'image(v_outside) & " values outside";
+    end procedure;
+    begin
+        clear <= '0';
+        freeze <= '0';
+        offset <= (others => '0');
+        shift <= (others => '0');
+        valid <= '0';
+        value <= (others => '0');
+        rd_a <= (others => '0');
+        reset <= '1';
+        next_cycle;
+        reset <= '0';
+        next_cycle;
+        while busy = '1' loop
+            next_cycle;
+        end loop;
+        v_model := (others => 0);
+        v_outside := 0;
+        check;
+        
+        run(0, 0);
+        do_clear;
+        check;
+        run(-1000, 3);
+        do_clear;
+        run(123456, 5);
+        
+        -- Values sent while frozen are ignored.
+        freeze <= '1';
+        valid <= '1';
+        value <= std_logic_vector(to_signed(123456, 32));
+        next_cycle;
+        next_cycle;
+        valid <= '0';
+        check;
+        
+        report "Test passed.";
+        end_simulation <= true;
+        wait;
+    end process;
+end architecture;
@@ -0,0 +1,5 @@
+#!/bin/sh
+set -e
+ghdl -i ../../hostif/tdc_hostif_package.vhd ../../hostif/tdc_fifo.vhd ../../hostif/tdc_diff.vhd tb_diff.vhd
+ghdl -m tb_diff
+ghdl -r tb_diff
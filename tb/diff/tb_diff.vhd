@@ -0,0 +1,292 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tb_diff
+--
+-- author: agent, agent@local
+--
+-- description: Test bench for the start-stop time difference unit
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- This test connects the time difference unit to a FIFO of g_DEPTH entries,
+-- in the same way as the host interface, and sends it transitions with
+-- chosen time stamps on 4 channels. Channel 0 is the start channel, and
+-- channels 1 and 2 are stop channels.
+--
+-- It verifies that:
+--  * stops before the first start and transitions of other channels are
+--    ignored;
+--  * differences are computed against the latest start, including negative
+--    differences, a start in the same cycle and a coarse counter wrap-around;
+--  * simultaneous stops are all stored, lowest channel first;
+--  * differences outside of the range gate are discarded;
+--  * the start channel can also be a stop channel, to measure its period;
+--  * when the FIFO is full, one difference per channel is held back and
+--    overwritten differences are counted as lost.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tb_diff is
+    generic(
+        g_DEPTH : positive := 4
+    );
+end entity;
+
+architecture tb of tb_diff is
+
+constant c_CHANNEL_COUNT : positive := 4;
+constant c_TS_WIDTH      : positive := 38;
+
+subtype t_ts is unsigned(c_TS_WIDTH-1 downto 0);
+
+signal clk      : std_logic;
+signal reset    : std_logic;
+signal enable   : std_logic;
+signal start    : std_logic_vector(7 downto 0);
+signal stop     : std_logic_vector(c_CHANNEL_COUNT-1 downto 0);
+signal gmin     : std_logic_vector(31 downto 0);
+signal gmax     : std_logic_vector(31 downto 0);
+signal detect   : std_logic_vector(c_CHANNEL_COUNT-1 downto 0);
+signal ts       : std_logic_vector(c_CHANNEL_COUNT*c_TS_WIDTH-1 downto 0);
+signal full     : std_logic;
+signal push     : std_logic;
+signal channel  : std_logic_vector(7 downto 0);
+signal diff     : std_logic_vector(31 downto 0);
+signal lost     : std_logic_vector(15 downto 0);
+signal fifo_rst : std_logic;
+signal fifo_d   : std_logic_vector(39 downto 0);
+signal pop      : std_logic;
+signal q        : std_logic_vector(39 downto 0);
+signal level    : std_logic_vector(15 downto 0);
+
+signal end_simulation : boolean := false;
+
+begin
+    cmp_dut: tdc_diff
+        generic map(
+            g_CHANNEL_COUNT => c_CHANNEL_COUNT,
+            g_TS_WIDTH      => c_TS_WIDTH
+        )
+        port map(
+            clk_i     => clk,
+            reset_i   => reset,
+            enable_i  => enable,
+            start_i   => start,
+            stop_i    => stop,
+            gmin_i    => gmin,
+            gmax_i    => gmax,
+            detect_i  => detect,
+            ts_i      => ts,
+            full_i    => full,
+            push_o    => push,
+            channel_o => channel,
+            diff_o    => diff,
+            lost_o    => lost
+        );
+    
+    fifo_rst <= reset or not enable;
+    fifo_d <= channel & diff;
+    cmp_fifo: tdc_fifo
+        generic map(
+            g_WIDTH => 40,
+            g_DEPTH => g_DEPTH
+        )
+        port map(
+            clk_i   => clk,
+            reset_i => fifo_rst,
+            push_i  => push,
+            d_i     => fifo_d,
+            pop_i   => pop,
+            q_o     => q,
+            level_o => level,
+            ovf_o   => open,
+            full_o  => full
+        );
+    
+    process
+    begin
+        clk <= '0';
+        wait for 4 ns;
+        clk <= '1';
+        wait for 4 ns;
+        if end_simulation then
+            wait;
+        end if;
+    end process;
+    
+    process
+    constant c_T0  : t_ts := to_unsigned(1000000, c_TS_WIDTH);
+    constant c_MAX : t_ts := (others => '1');
+    
+    procedure next_cycle is
+    begin
+        wait until rising_edge(clk);
+        wait for 1 ns;
+    end procedure;
+    
+    procedure idle(n : natural) is
+    begin
+        for i in 1 to n loop
+            next_cycle;
+        end loop;
+    end procedure;
+    
+    -- Sends transitions on channels a and b (if different) in the same cycle.
+    procedure hit2(a : natural; ts_a : t_ts; b : natural; ts_b : t_ts) is
+    begin
+        detect <= (others => '0');
+        detect(a) <= '1';
+        ts((a+1)*c_TS_WIDTH-1 downto a*c_TS_WIDTH) <= std_logic_vector(ts_a);
+        detect(b) <= '1';
+        ts((b+1)*c_TS_WIDTH-1 downto b*c_TS_WIDTH) <= std_logic_vector(ts_b);
+        next_cycle;
+        detect <= (others => '0');
+    end procedure;
+    
+    procedure hit(a : natural; ts_a : t_ts) is
+    begin
+        hit2(a, ts_a, a, ts_a);
+    end procedure;
+    
+    -- Checks and removes the head of the FIFO.
+    procedure expect(ch : natural; value : integer) is
+    begin
+        idle(6);
+        assert unsigned(level) /= 0 report "Missing difference" severity failure;
+        assert to_integer(unsigned(q(39 downto 32))) = ch
+            report "Unexpected channel " & integer'image(to_integer(unsigned(q(39 downto 32))))
+            severity failure;
+        assert to_integer(signed(q(31 downto 0))) = value
+            report "Unexpected difference " & integer'image(to_integer(signed(q(31 downto 0))))
+                & " (expected " & integer'image(value) & ")"
+            severity failure;
+        pop <= '1';
+        next_cycle;
+        pop <= '0';
+        next_cycle;
+    end procedure;
+    
+    procedure expect_empty is
+    begin
+        idle(6);
+        assert unsigned(level) = 0 report "Unexpected difference" severity failure;
+    end procedure;
+    begin
+        detect <= (others => '0');
+        ts <= (others => '0');
+        pop <= '0';
+        enable <= '0';
+        start <= x"00";
+        stop <= "0110";
+        gmin <= std_logic_vector(to_signed(-1000, 32));
+        gmax <= std_logic_vector(to_signed(100000, 32));
+        reset <= '1';
+        next_cycle;
+        reset <= '0';
+        enable <= '1';
+        next_cycle;
+        
+        -- Stop before the first start, and transitions of other channels.
+        hit(1, c_T0);
+        hit(3, c_T0);
+        expect_empty;
+        
+        -- Basic differences.
+        hit(0, c_T0);
+        hit(3, c_T0 + 10);
+        hit(1, c_T0 + 500);
+        expect(1, 500);
+        hit(2, c_T0 + 900);
+        expect(2, 900);
+        hit(0, c_T0 + 2000);
+        hit(1, c_T0 + 1700);
+        expect(1, -300);
+        
+        -- Simultaneous stops.
+        hit2(2, c_T0 + 2700, 1, c_T0 + 2500);
+        expect(1, 500);
+        expect(2, 700);
+        
+        -- Start and stop in the same cycle.
+        hit2(0, c_T0 + 5000, 1, c_T0 + 5010);
+        expect(1, 10);
+        
+        -- Range gate.
+        hit(1, c_T0 + 5000 + 100001);
+        hit(1, c_T0 + 5000 - 1001);
+        expect_empty;
+        hit(1, c_T0 + 5000 + 100000);
+        expect(1, 100000);
+        hit(1, c_T0 + 5000 - 1000);
+        expect(1, -1000);
+        
+        -- Coarse counter wrap-around.
+        hit(0, c_MAX - 99);
+        hit(1, to_unsigned(50, c_TS_WIDTH));
+        expect(1, 150);
+        
+        -- Period of the start channel. Re-enabling clears the start.
+        enable <= '0';
+        stop <= "0011";
+        next_cycle;
+        enable <= '1';
+        hit(0, c_T0);
+        expect_empty;
+        hit(0, c_T0 + 4000);
+        expect(0, 4000);
+        hit(0, c_T0 + 8500);
+        expect(0, 4500);
+        
+        -- Full FIFO.
+        stop <= "0110";
+        hit(0, c_T0);
+        for i in 1 to g_DEPTH loop
+            hit(1, c_T0 + i);
+            idle(1);
+        end loop;
+        idle(4);
+        assert to_integer(unsigned(level)) = g_DEPTH severity failure;
+        hit(2, c_T0 + 100);
+        hit(1, c_T0 + 101);
+        hit(1, c_T0 + 102);
+        hit(1, c_T0 + 103);
+        idle(4);
+        assert to_integer(unsigned(lost)) = 2
+            report "Unexpected loss count " & integer'image(to_integer(unsigned(lost)))
+            severity failure;
+        for i in 1 to g_DEPTH loop
+            expect(1, i);
+        end loop;
+        expect(1, 103);
+        expect(2, 100);
+        expect_empty;
+        
+        report "Test passed.";
+        end_simulation <= true;
+        wait;
+    end process;
+end architecture;
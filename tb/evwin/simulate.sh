@@ -0,0 +1,5 @@
+#!/bin/sh
+set -e
+ghdl -i ../../hostif/tdc_hostif_package.vhd ../../hostif/tdc_fifo.vhd ../../hostif/tdc_evwin.vhd tb_evwin.vhd
+ghdl -m tb_evwin
+ghdl -r tb_evwin
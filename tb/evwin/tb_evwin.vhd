@@ -0,0 +1,296 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tb_evwin
+--
+-- author: agent, agent@local
+--
+-- description: Test bench for the burst event read window
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- This test connects the read window to an event FIFO and drives it with a
+-- bus functional model of a Wishbone master.
+--
+-- The FIFO is first loaded with g_EVENTS events, which are then drained
+-- with classic single reads. This has the same timing as reading the MCR,
+-- MMH and MML registers of the register bank: each transfer is acknowledged
+-- one cycle after the strobe, and the next transfer cannot be acknowledged
+-- before the following cycle.
+-- The FIFO is then loaded again, and drained with incrementing bursts of
+-- g_BURST events (3*g_BURST words).
+--
+-- For both methods, the test bench verifies that every event is read back
+-- once, in order and with the correct contents, and reports the number of
+-- events drained per bus clock cycle. It finally verifies that reading an
+-- empty FIFO returns invalid words without disturbing the stream.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tb_evwin is
+    generic(
+        g_EVENTS : positive := 120;
+        g_BURST  : positive := 4
+    );
+end entity;
+
+architecture tb of tb_evwin is
+
+constant c_RAW_COUNT : positive := 9;
+constant c_TS_WIDTH  : positive := 38;
+constant c_WIDTH     : positive := 8+1+c_RAW_COUNT+c_TS_WIDTH;
+
+signal clk      : std_logic;
+signal reset    : std_logic;
+signal push     : std_logic;
+signal d        : std_logic_vector(c_WIDTH-1 downto 0);
+signal pop      : std_logic;
+signal q        : std_logic_vector(c_WIDTH-1 downto 0);
+signal level    : std_logic_vector(15 downto 0);
+signal valid    : std_logic;
+
+signal wb_cyc   : std_logic;
+signal wb_stb   : std_logic;
+signal wb_cti   : std_logic_vector(2 downto 0);
+signal wb_data  : std_logic_vector(31 downto 0);
+signal wb_ack   : std_logic;
+
+signal end_simulation : boolean := false;
+
+-- Contents of event i, in FIFO format.
+function f_event(i : natural) return std_logic_vector is
+begin
+    return std_logic_vector(to_unsigned(i mod 8, 8))
+        & std_logic_vector(to_unsigned(i mod 2, 1))
+        & std_logic_vector(to_unsigned((i*7) mod 2**c_RAW_COUNT, c_RAW_COUNT))
+        & std_logic_vector(to_unsigned(i mod 64, c_TS_WIDTH-32))
+        & std_logic_vector(to_unsigned(i*12345, 32));
+end function;
+
+-- Word w of event i, as returned by the read window.
+function f_word(i : natural; w : natural) return std_logic_vector is
+variable v_event : std_logic_vector(c_WIDTH-1 downto 0);
+variable v_word  : std_logic_vector(31 downto 0);
+begin
+    v_event := f_event(i);
+    v_word := (others => '0');
+    case w is
+        when 0 =>
+            v_word(31) := '1';
+            v_word(24 downto 16) := v_event(c_WIDTH-1 downto c_WIDTH-9);
+            v_word(c_RAW_COUNT-1 downto 0) := v_event(c_WIDTH-10 downto c_TS_WIDTH);
+        when 1 =>
+            v_word(c_TS_WIDTH-33 downto 0) := v_event(c_TS_WIDTH-1 downto 32);
+        when others =>
+            v_word := v_event(31 downto 0);
+    end case;
+    return v_word;
+end function;
+
+begin
+    cmp_fifo: tdc_fifo
+        generic map(
+            g_WIDTH => c_WIDTH,
+            g_DEPTH => 256
+        )
+        port map(
+            clk_i   => clk,
+            reset_i => reset,
+            push_i  => push,
+            d_i     => d,
+            pop_i   => pop,
+            q_o     => q,
+            level_o => level,
+            ovf_o   => open,
+            full_o  => open
+        );
+    valid <= '0' when level = x"0000" else '1';
+    
+    cmp_dut: tdc_evwin
+        generic map(
+            g_RAW_COUNT => c_RAW_COUNT,
+            g_TS_WIDTH  => c_TS_WIDTH
+        )
+        port map(
+            clk_i      => clk,
+            reset_i    => reset,
+            wb_cyc_i   => wb_cyc,
+            wb_stb_i   => wb_stb,
+            wb_we_i    => '0',
+            wb_cti_i   => wb_cti,
+            wb_data_o  => wb_data,
+            wb_ack_o   => wb_ack,
+            valid_i    => valid,
+            channel_i  => q(c_WIDTH-1 downto c_WIDTH-8),
+            polarity_i => q(c_WIDTH-9),
+            raw_i      => q(c_WIDTH-10 downto c_TS_WIDTH),
+            ts_i       => q(c_TS_WIDTH-1 downto 0),
+            pop_o      => pop,
+            restart_i  => '0'
+        );
+    
+    process
+    begin
+        clk <= '0';
+        wait for 4 ns;
+        clk <= '1';
+        wait for 4 ns;
+        if end_simulation then
+            wait;
+        end if;
+    end process;
+    
+    process
+    variable v_next    : natural;
+    variable v_word    : natural;
+    variable v_cycles  : natural;
+    variable v_classic : real;
+    variable v_bursts  : real;
+    
+    procedure next_cycle is
+    begin
+        wait until rising_edge(clk);
+        wait for 1 ns;
+    end procedure;
+    
+    procedure load is
+    begin
+        for i in 0 to g_EVENTS-1 loop
+            push <= '1';
+            d <= f_event(i);
+            next_cycle;
+        end loop;
+        push <= '0';
+        next_cycle;
+        next_cycle;
+        assert to_integer(unsigned(level)) = g_EVENTS severity failure;
+    end procedure;
+    
+    -- Checks a word read from the window against the expected stream.
+    procedure check(data : std_logic_vector(31 downto 0)) is
+    begin
+        if (v_word = 0) and (data(31) = '0') then
+            assert v_next = g_EVENTS
+                report "Invalid word while events are pending" severity failure;
+        else
+            assert data = f_word(v_next, v_word)
+                report "Unexpected word " & integer'image(v_word)
+                    & " of event " & integer'image(v_next)
+                severity failure;
+            if v_word = 2 then
+                v_word := 0;
+                v_next := v_next + 1;
+            else
+                v_word := v_word + 1;
+            end if;
+        end if;
+    end procedure;
+    
+    -- Performs a Wishbone cycle of n reads, as a burst or as back-to-back
+    -- classic transfers.
+    procedure bus_read(n : positive; burst : boolean) is
+    variable v_done : natural;
+    begin
+        wb_cyc <= '1';
+        wb_stb <= '1';
+        v_done := 0;
+        while v_done < n loop
+            if not burst then
+                wb_cti <= "000";
+            elsif v_done = n-1 then
+                wb_cti <= "111";
+            else
+                wb_cti <= "010";
+            end if;
+            -- A transfer completes at the end of each cycle that has ack.
+            if wb_ack = '1' then
+                check(wb_data);
+                v_done := v_done + 1;
+            end if;
+            next_cycle;
+            v_cycles := v_cycles + 1;
+        end loop;
+        wb_cyc <= '0';
+        wb_stb <= '0';
+    end procedure;
+    begin
+        push <= '0';
+        d <= (others => '0');
+        wb_cyc <= '0';
+        wb_stb <= '0';
+        wb_cti <= "000";
+        reset <= '1';
+        next_cycle;
+        reset <= '0';
+        next_cycle;
+        
+        -- Classic reads.
+        load;
+        v_next := 0;
+        v_word := 0;
+        v_cycles := 0;
+        bus_read(3*g_EVENTS, false);
+        assert v_next = g_EVENTS severity failure;
+        v_classic := real(g_EVENTS)/real(v_cycles);
+        report "Classic reads: " & integer'image(g_EVENTS) & " events in "
+            & integer'image(v_cycles) & " cycles, " & real'image(v_classic)
+            & " events per cycle";
+        
+        -- Bursts.
+        load;
+        v_next := 0;
+        v_word := 0;
+        v_cycles := 0;
+        while v_next < g_EVENTS loop
+            bus_read(3*g_BURST, true);
+        end loop;
+        v_bursts := real(g_EVENTS)/real(v_cycles);
+        report "Bursts of " & integer'image(g_BURST) & " events: "
+            & integer'image(g_EVENTS) & " events in "
+            & integer'image(v_cycles) & " cycles, " & real'image(v_bursts)
+            & " events per cycle";
+        report "Drain rate at 125MHz: "
+            & integer'image(integer(v_classic*125.0e6)) & " events/s (classic), "
+            & integer'image(integer(v_bursts*125.0e6)) & " events/s (bursts)";
+        assert v_bursts > v_classic severity failure;
+        
+        -- Empty FIFO.
+        bus_read(3*g_BURST, true);
+        assert v_word = 0 severity failure;
+        push <= '1';
+        d <= f_event(g_EVENTS);
+        next_cycle;
+        push <= '0';
+        next_cycle;
+        next_cycle;
+        bus_read(3, true);
+        assert v_next = g_EVENTS+1 severity failure;
+        
+        report "Test passed.";
+        end_simulation <= true;
+        wait;
+    end process;
+end architecture;
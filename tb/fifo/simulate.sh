@@ -0,0 +1,5 @@
+#!/bin/sh
+set -e
+ghdl -i ../../hostif/tdc_hostif_package.vhd ../../hostif/tdc_fifo.vhd tb_fifo.vhd
+ghdl -m tb_fifo
+ghdl -r tb_fifo
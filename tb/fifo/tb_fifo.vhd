@@ -0,0 +1,264 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tb_fifo
+--
+-- author: agent, agent@local
+--
+-- description: Test bench for the host interface event FIFO
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- This test first verifies the FIFO with a burst of g_DEPTH+3 back-to-back
+-- events and no reads: the fill level must reach g_DEPTH, the overflow
+-- counter must be 3, and the first g_DEPTH events must then be read back in
+-- order.
+--
+-- It then measures the maximum sustained hit rate that can be handled without
+-- losing events, with and without the FIFO. Hits are generated at random
+-- (each cycle has a probability 1/M of carrying a hit) and a model of the
+-- host software needs g_READ_CYCLES clock cycles to process each event.
+-- Without the FIFO, the host interface only keeps the most recent event of a
+-- channel, so a hit arriving before the host has fetched the previous one
+-- overwrites it. This is modeled optimistically: the host is assumed to fetch
+-- the event atomically as soon as it is idle.
+-- For decreasing values of the mean hit interval M, g_HITS hits are sent and
+-- the number of lost events is reported for both designs. The test bench
+-- verifies that the events read from the FIFO are in order and that every
+-- hit is either read back or accounted for by the overflow counter.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+use ieee.math_real.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tb_fifo is
+    generic(
+        g_DEPTH       : positive := 64;
+        g_READ_CYCLES : positive := 24;
+        g_HITS        : positive := 4096
+    );
+end entity;
+
+architecture tb of tb_fifo is
+
+constant c_WIDTH : positive := 32;
+
+signal clk   : std_logic;
+signal reset : std_logic;
+signal push  : std_logic;
+signal d     : std_logic_vector(c_WIDTH-1 downto 0);
+signal pop   : std_logic;
+signal q     : std_logic_vector(c_WIDTH-1 downto 0);
+signal level : std_logic_vector(15 downto 0);
+signal ovf   : std_logic_vector(15 downto 0);
+
+signal end_simulation : boolean := false;
+
+begin
+    cmp_dut: tdc_fifo
+        generic map(
+            g_WIDTH => c_WIDTH,
+            g_DEPTH => g_DEPTH
+        )
+        port map(
+            clk_i   => clk,
+            reset_i => reset,
+            push_i  => push,
+            d_i     => d,
+            pop_i   => pop,
+            q_o     => q,
+            level_o => level,
+            ovf_o   => ovf,
+            full_o  => open
+        );
+    
+    process
+    begin
+        clk <= '0';
+        wait for 4 ns;
+        clk <= '1';
+        wait for 4 ns;
+        if end_simulation then
+            wait;
+        end if;
+    end process;
+    
+    process
+    variable v_seed1      : positive := 17;
+    variable v_seed2      : positive := 42;
+    variable v_rand       : real;
+    variable v_m          : real;
+    variable v_hits       : natural;
+    variable v_read       : natural;
+    variable v_last       : integer;
+    variable v_busy       : natural;
+    variable v_pending    : boolean;
+    variable v_latch_busy : natural;
+    variable v_latch_lost : natural;
+    variable v_fifo_lost  : natural;
+    variable v_max_level  : natural;
+    variable v_best_latch : real;
+    variable v_best_fifo  : real;
+    
+    procedure next_cycle is
+    begin
+        wait until rising_edge(clk);
+        wait for 1 ns;
+    end procedure;
+    
+    procedure do_reset is
+    begin
+        push <= '0';
+        pop <= '0';
+        d <= (others => '0');
+        reset <= '1';
+        next_cycle;
+        reset <= '0';
+        next_cycle;
+    end procedure;
+    
+    -- Model of the host reading one event from the FIFO, if idle.
+    procedure host_fifo is
+    begin
+        pop <= '0';
+        if v_busy > 0 then
+            v_busy := v_busy - 1;
+        elsif unsigned(level) /= 0 then
+            assert to_integer(unsigned(q)) > v_last
+                report "FIFO out of order" severity failure;
+            v_last := to_integer(unsigned(q));
+            v_read := v_read + 1;
+            pop <= '1';
+            v_busy := g_READ_CYCLES - 1;
+        end if;
+        if to_integer(unsigned(level)) > v_max_level then
+            v_max_level := to_integer(unsigned(level));
+        end if;
+    end procedure;
+    
+    -- Model of the host reading the latest event registers, if idle.
+    procedure host_latch is
+    begin
+        if v_latch_busy > 0 then
+            v_latch_busy := v_latch_busy - 1;
+        elsif v_pending then
+            v_pending := false;
+            v_latch_busy := g_READ_CYCLES - 1;
+        end if;
+    end procedure;
+    begin
+        -- Burst test.
+        do_reset;
+        for i in 0 to g_DEPTH+2 loop
+            push <= '1';
+            d <= std_logic_vector(to_unsigned(i, c_WIDTH));
+            next_cycle;
+        end loop;
+        push <= '0';
+        next_cycle;
+        next_cycle;
+        report "Burst: level " & integer'image(to_integer(unsigned(level)))
+            & ", overflows " & integer'image(to_integer(unsigned(ovf)));
+        assert to_integer(unsigned(level)) = g_DEPTH severity failure;
+        assert to_integer(unsigned(ovf)) = 3 severity failure;
+        for i in 0 to g_DEPTH-1 loop
+            assert to_integer(unsigned(q)) = i
+                report "Unexpected FIFO output: " & integer'image(to_integer(unsigned(q)))
+                severity failure;
+            pop <= '1';
+            next_cycle;
+            pop <= '0';
+            next_cycle;
+        end loop;
+        assert to_integer(unsigned(level)) = 0 severity failure;
+        
+        -- Sustained rate test.
+        v_best_latch := 0.0;
+        v_best_fifo := 0.0;
+        for k in 16 downto 1 loop
+            v_m := real(g_READ_CYCLES)*real(8+k)/8.0;
+            do_reset;
+            v_hits := 0;
+            v_read := 0;
+            v_last := -1;
+            v_busy := 0;
+            v_pending := false;
+            v_latch_busy := 0;
+            v_latch_lost := 0;
+            v_max_level := 0;
+            while v_hits < g_HITS loop
+                uniform(v_seed1, v_seed2, v_rand);
+                if v_rand < 1.0/v_m then
+                    push <= '1';
+                    d <= std_logic_vector(to_unsigned(v_hits, c_WIDTH));
+                    v_hits := v_hits + 1;
+                    if v_pending then
+                        v_latch_lost := v_latch_lost + 1;
+                    end if;
+                    v_pending := true;
+                else
+                    push <= '0';
+                end if;
+                host_fifo;
+                host_latch;
+                next_cycle;
+            end loop;
+            push <= '0';
+            -- Drain the FIFO.
+            for i in 0 to (g_DEPTH+2)*g_READ_CYCLES loop
+                host_fifo;
+                next_cycle;
+            end loop;
+            pop <= '0';
+            next_cycle;
+            v_fifo_lost := to_integer(unsigned(ovf));
+            assert v_read + v_fifo_lost = g_HITS
+                report "Events unaccounted for" severity failure;
+            report "Mean hit interval " & real'image(v_m) & " cycles: lost "
+                & integer'image(v_latch_lost) & " without FIFO, "
+                & integer'image(v_fifo_lost) & " with FIFO (max level "
+                & integer'image(v_max_level) & ")";
+            if v_latch_lost = 0 then
+                v_best_latch := v_m;
+            end if;
+            if v_fifo_lost = 0 then
+                v_best_fifo := v_m;
+            end if;
+        end loop;
+        
+        if v_best_latch = 0.0 then
+            report "Shortest lossless mean hit interval without FIFO: none of the tested values";
+        else
+            report "Shortest lossless mean hit interval without FIFO: " & real'image(v_best_latch) & " cycles";
+        end if;
+        report "Shortest lossless mean hit interval with FIFO: " & real'image(v_best_fifo) & " cycles";
+        assert (v_best_fifo > 0.0) and ((v_best_latch = 0.0) or (v_best_fifo <= v_best_latch))
+            severity failure;
+        
+        report "Test passed.";
+        end_simulation <= true;
+        wait;
+    end process;
+end architecture;
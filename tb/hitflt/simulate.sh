@@ -0,0 +1,5 @@
+#!/bin/sh
+set -e
+ghdl -i ../../hostif/tdc_hostif_package.vhd ../../hostif/tdc_hitflt.vhd tb_hitflt.vhd
+ghdl -m tb_hitflt
+ghdl -r tb_hitflt
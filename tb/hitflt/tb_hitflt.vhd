@@ -0,0 +1,199 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tb_hitflt
+--
+-- author: agent, agent@local
+--
+-- description: Test bench for the host interface hit filter
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- This test sends trains of g_HITS transitions of alternating polarity to the
+-- hit filter, with various settings and spacings, and verifies the number and
+-- position of the transitions that are passed on:
+--  * with all controls at 0, every transition must pass;
+--  * with the edge filter, only transitions of the other polarity must pass;
+--  * with a dead time of D cycles and one transition per cycle, one
+--    transition must pass every D+1 cycles, and all of them must pass when
+--    they are spaced by more than D cycles;
+--  * with a prescaler of N, one transition must pass out of N+1.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tb_hitflt is
+    generic(
+        g_HITS : positive := 60
+    );
+end entity;
+
+architecture tb of tb_hitflt is
+
+signal clk          : std_logic;
+signal reset        : std_logic;
+signal drop_rising  : std_logic;
+signal drop_falling : std_logic;
+signal deadtime     : std_logic_vector(15 downto 0);
+signal prescale     : std_logic_vector(15 downto 0);
+signal detect       : std_logic;
+signal polarity     : std_logic;
+signal hit          : std_logic;
+
+signal end_simulation : boolean := false;
+
+begin
+    cmp_dut: tdc_hitflt
+        port map(
+            clk_i          => clk,
+            reset_i        => reset,
+            drop_rising_i  => drop_rising,
+            drop_falling_i => drop_falling,
+            deadtime_i     => deadtime,
+            prescale_i     => prescale,
+            detect_i       => detect,
+            polarity_i     => polarity,
+            detect_o       => hit
+        );
+    
+    process
+    begin
+        clk <= '0';
+        wait for 4 ns;
+        clk <= '1';
+        wait for 4 ns;
+        if end_simulation then
+            wait;
+        end if;
+    end process;
+    
+    process
+    variable v_count : natural;
+    variable v_last  : integer;
+    
+    procedure next_cycle is
+    begin
+        wait until rising_edge(clk);
+        wait for 1 ns;
+    end procedure;
+    
+    procedure configure(ris : std_logic; fal : std_logic; dt : natural; psc : natural) is
+    begin
+        detect <= '0';
+        polarity <= '0';
+        drop_rising <= ris;
+        drop_falling <= fal;
+        deadtime <= std_logic_vector(to_unsigned(dt, 16));
+        prescale <= std_logic_vector(to_unsigned(psc, 16));
+        reset <= '1';
+        next_cycle;
+        reset <= '0';
+        next_cycle;
+    end procedure;
+    
+    -- Sends g_HITS transitions, one every spacing cycles, starting with a
+    -- rising edge. Counts the transitions that are passed on, and verifies
+    -- that consecutive ones are exactly period transitions apart.
+    procedure send(spacing : positive; period : positive) is
+    begin
+        v_count := 0;
+        v_last := -1;
+        for i in 0 to g_HITS-1 loop
+            detect <= '1';
+            if i mod 2 = 0 then
+                polarity <= '1';
+            else
+                polarity <= '0';
+            end if;
+            wait for 1 ns;
+            if hit = '1' then
+                if v_last >= 0 then
+                    assert i - v_last = period
+                        report "Transition " & integer'image(i) & " passed "
+                            & integer'image(i - v_last) & " transitions after the previous one"
+                        severity failure;
+                end if;
+                v_last := i;
+                v_count := v_count + 1;
+            end if;
+            next_cycle;
+            detect <= '0';
+            for j in 2 to spacing loop
+                next_cycle;
+            end loop;
+        end loop;
+    end procedure;
+    begin
+        -- No filtering.
+        configure('0', '0', 0, 0);
+        send(1, 1);
+        assert v_count = g_HITS severity failure;
+        
+        -- Edge filter.
+        configure('1', '0', 0, 0);
+        send(1, 2);
+        assert v_count = g_HITS/2 severity failure;
+        assert v_last mod 2 = 1 report "Rising edge passed" severity failure;
+        configure('0', '1', 0, 0);
+        send(1, 2);
+        assert v_count = g_HITS/2 severity failure;
+        assert v_last mod 2 = 0 report "Falling edge passed" severity failure;
+        configure('1', '1', 0, 0);
+        send(1, 1);
+        assert v_count = 0 severity failure;
+        
+        -- Dead time.
+        for d in 1 to 4 loop
+            configure('0', '0', d, 0);
+            send(1, d+1);
+            report "Dead time " & integer'image(d) & ": "
+                & integer'image(v_count) & " of " & integer'image(g_HITS)
+                & " transitions passed";
+            assert v_count = (g_HITS+d)/(d+1) severity failure;
+            configure('0', '0', d, 0);
+            send(d+1, 1);
+            assert v_count = g_HITS severity failure;
+        end loop;
+        
+        -- Prescaler.
+        for n in 1 to 4 loop
+            configure('0', '0', 0, n);
+            send(3, n+1);
+            report "Prescaler " & integer'image(n) & ": "
+                & integer'image(v_count) & " of " & integer'image(g_HITS)
+                & " transitions passed";
+            assert v_count = (g_HITS+n)/(n+1) severity failure;
+        end loop;
+        
+        -- Dead time, then prescaler.
+        configure('0', '0', 1, 2);
+        send(1, 6);
+        assert v_count = (g_HITS+5)/6 severity failure;
+        
+        report "Test passed.";
+        end_simulation <= true;
+        wait;
+    end process;
+end architecture;
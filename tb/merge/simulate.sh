@@ -0,0 +1,8 @@
+#!/bin/sh
+set -e
+ghdl -i ../../hostif/tdc_hostif_package.vhd ../../hostif/tdc_fifo.vhd ../../hostif/tdc_merge.vhd tb_merge.vhd
+ghdl -m tb_merge
+ghdl -r tb_merge
+ghdl -r tb_merge -gg_CHANNEL_COUNT=64
+ghdl -r tb_merge -gg_CHANNEL_COUNT=5
+ghdl -r tb_merge -gg_CHANNEL_COUNT=1
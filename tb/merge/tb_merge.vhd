@@ -0,0 +1,355 @@
+-------------------------------------------------------------------------------
+-- TDC Core / CERN
+-------------------------------------------------------------------------------
+--
+-- unit name: tb_merge
+--
+-- author: agent, agent@local
+--
+-- description: Test bench for the time-ordered merge of the event FIFOs
+--
+-- references: http://www.ohwr.org/projects/tdc-core
+--
+-------------------------------------------------------------------------------
+-- last changes:
+-- 2026-10-18 agent Created file
+-------------------------------------------------------------------------------
+
+-- Copyright (C) 2011 CERN
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU Lesser General Public License as published by
+-- the Free Software Foundation, version 3 of the License.
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+-- You should have received a copy of the GNU Lesser General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+-- DESCRIPTION:
+-- This test connects the merger to g_CHANNEL_COUNT event FIFOs. The time
+-- stamp of each event is the cycle at which it is generated, and channel i
+-- writes it into its FIFO (i mod (g_SPREAD+1)) cycles later, to model the
+-- spread of the deskew values.
+--
+-- The test bench first writes g_BURST events into each FIFO with the merger
+-- disabled, then enables it and measures the number of cycles it takes to
+-- move the events released while all channels have a pending event. It then
+-- sends g_EVENTS hits on random channels, with a mean interval of
+-- g_INTERVAL cycles, while randomly asserting the full input of the merger.
+--
+-- The test bench verifies that every event is released exactly once, with
+-- the correct contents, in time stamp order, and never while the merger is
+-- disabled or its output is full.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+use ieee.math_real.all;
+
+library work;
+use work.tdc_hostif_package.all;
+
+entity tb_merge is
+    generic(
+        g_CHANNEL_COUNT : positive := 8;
+        g_SPREAD        : natural  := 5;
+        g_BURST         : positive := 4;
+        g_INTERVAL      : positive := 16;
+        g_EVENTS        : positive := 2000
+    );
+end entity;
+
+architecture tb of tb_merge is
+
+function f_log2_size(a : natural) return natural is
+begin
+    for i in 0 to 8 loop
+        if 2**i >= a then
+            return i;
+        end if;
+    end loop;
+    return 8;
+end function;
+
+constant c_LEVELS    : natural  := f_log2_size(g_CHANNEL_COUNT);
+constant c_RAW_COUNT : positive := 8;
+constant c_TS_WIDTH  : positive := 12;
+constant c_DELAY     : positive := g_SPREAD+3;
+constant c_DEPTH     : positive := 16;
+-- FIFO entry: merge tag, polarity, raw value, time stamp
+constant c_WIDTH     : positive := 8+1+c_RAW_COUNT+c_TS_WIDTH;
+
+signal clk      : std_logic;
+signal reset    : std_logic;
+signal enable   : std_logic;
+signal tag      : std_logic_vector(7 downto 0);
+signal valid    : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal tags     : std_logic_vector(g_CHANNEL_COUNT*8-1 downto 0);
+signal polarity : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal raw      : std_logic_vector(g_CHANNEL_COUNT*c_RAW_COUNT-1 downto 0);
+signal ts       : std_logic_vector(g_CHANNEL_COUNT*c_TS_WIDTH-1 downto 0);
+signal pop      : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal full     : std_logic;
+signal push     : std_logic;
+signal m_chn    : std_logic_vector(7 downto 0);
+signal m_pol    : std_logic;
+signal m_raw    : std_logic_vector(c_RAW_COUNT-1 downto 0);
+signal m_ts     : std_logic_vector(c_TS_WIDTH-1 downto 0);
+
+-- hits generated at time stamp now_ts
+signal hit      : std_logic_vector(g_CHANNEL_COUNT-1 downto 0);
+signal now_ts   : unsigned(c_TS_WIDTH-1 downto 0) := (others => '0');
+signal received : natural;
+
+signal end_simulation : boolean := false;
+
+begin
+    g_channels: for i in 0 to g_CHANNEL_COUNT-1 generate
+        constant c_LATENCY : natural := i mod (g_SPREAD+1);
+        type t_line is array(0 to c_LATENCY) of std_logic_vector(c_TS_WIDTH downto 0);
+        signal line    : t_line;
+        signal fifo_ts : std_logic_vector(c_TS_WIDTH-1 downto 0);
+        signal d       : std_logic_vector(c_WIDTH-1 downto 0);
+        signal q       : std_logic_vector(c_WIDTH-1 downto 0);
+        signal level   : std_logic_vector(15 downto 0);
+        signal ovf     : std_logic_vector(15 downto 0);
+    begin
+        process(clk)
+        begin
+            if rising_edge(clk) then
+                line(0) <= hit(i) & std_logic_vector(now_ts);
+                for j in 1 to c_LATENCY loop
+                    line(j) <= line(j-1);
+                end loop;
+            end if;
+        end process;
+        fifo_ts <= line(c_LATENCY)(c_TS_WIDTH-1 downto 0);
+        d <= tag
+            & fifo_ts(0)
+            & (fifo_ts(c_RAW_COUNT-1 downto 0) xor std_logic_vector(to_unsigned(i, c_RAW_COUNT)))
+            & fifo_ts;
+        cmp_fifo: tdc_fifo
+            generic map(
+                g_WIDTH => c_WIDTH,
+                g_DEPTH => c_DEPTH
+            )
+            port map(
+                clk_i   => clk,
+                reset_i => reset,
+                push_i  => line(c_LATENCY)(c_TS_WIDTH),
+                d_i     => d,
+                pop_i   => pop(i),
+                q_o     => q,
+                level_o => level,
+                ovf_o   => ovf,
+                full_o  => open
+            );
+        valid(i) <= '0' when level = x"0000" else '1';
+        tags(i*8+7 downto i*8) <= q(c_WIDTH-1 downto c_WIDTH-8);
+        polarity(i) <= q(c_WIDTH-9);
+        raw((i+1)*c_RAW_COUNT-1 downto i*c_RAW_COUNT) <= q(c_WIDTH-10 downto c_TS_WIDTH);
+        ts((i+1)*c_TS_WIDTH-1 downto i*c_TS_WIDTH) <= q(c_TS_WIDTH-1 downto 0);
+        assert (reset /= '0') or (ovf = x"0000")
+            report "Channel FIFO overflow" severity failure;
+    end generate;
+    
+    cmp_dut: tdc_merge
+        generic map(
+            g_CHANNEL_COUNT => g_CHANNEL_COUNT,
+            g_RAW_COUNT     => c_RAW_COUNT,
+            g_TS_WIDTH      => c_TS_WIDTH,
+            g_DELAY         => c_DELAY
+        )
+        port map(
+            clk_i      => clk,
+            reset_i    => reset,
+            enable_i   => enable,
+            tag_o      => tag,
+            valid_i    => valid,
+            tag_i      => tags,
+            polarity_i => polarity,
+            raw_i      => raw,
+            ts_i       => ts,
+            pop_o      => pop,
+            full_i     => full,
+            push_o     => push,
+            channel_o  => m_chn,
+            polarity_o => m_pol,
+            raw_o      => m_raw,
+            ts_o       => m_ts
+        );
+    
+    process
+    begin
+        clk <= '0';
+        wait for 4 ns;
+        clk <= '1';
+        wait for 4 ns;
+        if end_simulation then
+            wait;
+        end if;
+    end process;
+    
+    process(clk)
+    begin
+        if rising_edge(clk) then
+            now_ts <= now_ts + 1;
+        end if;
+    end process;
+    
+    -- Checker of the merged stream.
+    process(clk)
+    type t_ts_array is array(0 to g_CHANNEL_COUNT-1) of unsigned(c_TS_WIDTH-1 downto 0);
+    variable v_last    : unsigned(c_TS_WIDTH-1 downto 0);
+    variable v_chlast  : t_ts_array;
+    variable v_seen    : std_logic_vector(g_CHANNEL_COUNT downto 0);
+    variable v_diff    : unsigned(c_TS_WIDTH-1 downto 0);
+    variable v_age     : unsigned(c_TS_WIDTH-1 downto 0);
+    variable v_ch      : natural;
+    variable v_full    : std_logic;
+    variable v_enable  : std_logic;
+    variable v_count   : natural;
+    begin
+        if rising_edge(clk) then
+            if reset = '1' then
+                v_seen := (others => '0');
+                v_full := '0';
+                v_enable := '0';
+                v_count := 0;
+            else
+                if push = '1' then
+                    assert v_enable = '1' report "Event released while disabled" severity failure;
+                    assert v_full = '0' report "Event released while full" severity failure;
+                    v_ch := to_integer(unsigned(m_chn));
+                    assert v_ch < g_CHANNEL_COUNT report "Invalid channel" severity failure;
+                    assert (m_pol = m_ts(0))
+                        and (m_raw = (m_ts(c_RAW_COUNT-1 downto 0) xor std_logic_vector(to_unsigned(v_ch, c_RAW_COUNT))))
+                        report "Incorrect event contents" severity failure;
+                    -- Time stamps are only comparable within half their range,
+                    -- so older releases are not checked against.
+                    if v_seen(g_CHANNEL_COUNT) = '1' then
+                        v_age := now_ts - v_last;
+                        v_diff := unsigned(m_ts) - v_last;
+                        assert (v_age(c_TS_WIDTH-1) = '1') or (v_diff(c_TS_WIDTH-1) = '0')
+                            report "Events out of order" severity failure;
+                    end if;
+                    if v_seen(v_ch) = '1' then
+                        v_age := now_ts - v_chlast(v_ch);
+                        v_diff := unsigned(m_ts) - v_chlast(v_ch);
+                        assert (v_age(c_TS_WIDTH-1) = '1') or ((v_diff /= 0) and (v_diff(c_TS_WIDTH-1) = '0'))
+                            report "Event released twice" severity failure;
+                    end if;
+                    v_last := unsigned(m_ts);
+                    v_chlast(v_ch) := unsigned(m_ts);
+                    v_seen(v_ch) := '1';
+                    v_seen(g_CHANNEL_COUNT) := '1';
+                    v_count := v_count + 1;
+                end if;
+                v_full := full;
+                v_enable := enable;
+            end if;
+            received <= v_count;
+        end if;
+    end process;
+    
+    process
+    variable v_seed1  : positive := 17;
+    variable v_seed2  : positive := 42;
+    variable v_rand   : real;
+    variable v_sent   : natural;
+    variable v_cycles : natural;
+    variable v_bound  : natural;
+    
+    procedure next_cycle is
+    begin
+        wait until rising_edge(clk);
+        wait for 1 ns;
+    end procedure;
+    
+    -- Wait until all the events sent so far have been received.
+    procedure drain(target : natural) is
+    variable v_timeout : natural;
+    begin
+        v_timeout := 0;
+        while received < target loop
+            next_cycle;
+            v_timeout := v_timeout + 1;
+            assert v_timeout < 1000 + 4*g_CHANNEL_COUNT*(c_LEVELS+2)*g_BURST
+                report "Events not released: received " & integer'image(received)
+                    & " of " & integer'image(target)
+                severity failure;
+        end loop;
+    end procedure;
+    begin
+        reset <= '1';
+        enable <= '0';
+        full <= '0';
+        hit <= (others => '0');
+        next_cycle;
+        reset <= '0';
+        next_cycle;
+        
+        -- Burst test.
+        for i in 1 to g_BURST loop
+            hit <= (others => '1');
+            next_cycle;
+        end loop;
+        hit <= (others => '0');
+        v_sent := g_CHANNEL_COUNT*g_BURST;
+        for i in 0 to g_SPREAD+c_DELAY+4 loop
+            next_cycle;
+        end loop;
+        assert received = 0 severity failure;
+        enable <= '1';
+        v_cycles := 0;
+        v_bound := g_CHANNEL_COUNT*(g_BURST-1)*(c_LEVELS+2) + c_LEVELS+4;
+        while (received < g_CHANNEL_COUNT*(g_BURST-1)) and (v_cycles <= v_bound) loop
+            next_cycle;
+            v_cycles := v_cycles + 1;
+        end loop;
+        report "Burst: " & integer'image(g_CHANNEL_COUNT*(g_BURST-1)) & " events in "
+            & integer'image(v_cycles) & " cycles (" & integer'image(c_LEVELS+2)
+            & " cycles per event expected)";
+        assert v_cycles <= v_bound
+            report "Merger too slow" severity failure;
+        drain(v_sent);
+        assert valid = (valid'range => '0')
+            report "Events left in channel FIFOs" severity failure;
+        
+        -- Random hits, with backpressure.
+        while v_sent < g_CHANNEL_COUNT*g_BURST + g_EVENTS loop
+            for i in 0 to g_CHANNEL_COUNT-1 loop
+                uniform(v_seed1, v_seed2, v_rand);
+                if v_rand*real(g_INTERVAL*g_CHANNEL_COUNT) < 1.0 then
+                    hit(i) <= '1';
+                    v_sent := v_sent + 1;
+                else
+                    hit(i) <= '0';
+                end if;
+            end loop;
+            uniform(v_seed1, v_seed2, v_rand);
+            if v_rand < 0.25 then
+                full <= '1';
+            else
+                full <= '0';
+            end if;
+            next_cycle;
+        end loop;
+        hit <= (others => '0');
+        full <= '0';
+        drain(v_sent);
+        for i in 0 to c_LEVELS+4 loop
+            next_cycle;
+        end loop;
+        assert received = v_sent
+            report "Extra events released" severity failure;
+        assert valid = (valid'range => '0')
+            report "Events left in channel FIFOs" severity failure;
+        report "Random: " & integer'image(v_sent - g_CHANNEL_COUNT*g_BURST) & " events";
+        
+        report "Test passed.";
+        end_simulation <= true;
+        wait;
+    end process;
+end architecture;